@@ -0,0 +1,97 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "attack_info.h"
+#include "position.h"
+
+
+namespace matt2
+{
+///////////////////
+
+AttackInfo::AttackInfo(const Position& pos)
+{
+   // King zones and pawn attacks are needed to account for the attacks of the other
+   // pieces.
+   for (Color side : {White, Black})
+   {
+      const Bitboard kingBB = pos.occupied(king(side));
+      m_king[toIdx(side)] = kingBB;
+      if (kingBB != EmptyBB)
+         m_kingZone[toIdx(side)] = kingBB | kingAttacks(lowestSquare(kingBB));
+   }
+   for (Color side : {White, Black})
+      addPawnAttacks(side, pos);
+
+   for (Color side : {White, Black})
+   {
+      addPieceAttacks(knight(side), pos);
+      addPieceAttacks(bishop(side), pos);
+      addPieceAttacks(rook(side), pos);
+      addPieceAttacks(queen(side), pos);
+      addPieceAttacks(king(side), pos);
+   }
+}
+
+
+void AttackInfo::addAttacks(Color side, Bitboard attacked)
+{
+   const std::size_t idx = toIdx(side);
+   m_double[idx] |= m_all[idx] & attacked;
+   m_all[idx] |= attacked;
+
+   const std::size_t oppIdx = toIdx(!side);
+   const auto numZoneAttacks = static_cast<int>(popCount(attacked & m_kingZone[oppIdx]));
+   if (numZoneAttacks > 0)
+   {
+      m_kingZoneAttacks[oppIdx] += numZoneAttacks;
+      ++m_kingZoneAttackers[oppIdx];
+   }
+}
+
+
+void AttackInfo::addPawnAttacks(Color side, const Position& pos)
+{
+   // Pawns are handled as a set. Attacks towards either side are added separately, so
+   // that squares attacked by two pawns count as double attacks.
+   const Bitboard pawns = pos.occupied(pawn(side));
+   const Bitboard down = pawnAttacksDown(side, pawns);
+   const Bitboard up = pawnAttacksUp(side, pawns);
+   addAttacks(side, down);
+   addAttacks(side, up);
+   m_byPiece[toIdx(pawn(side))] = down | up;
+}
+
+
+void AttackInfo::addPieceAttacks(Piece piece, const Position& pos)
+{
+   const Color side = color(piece);
+   const Bitboard occupied = pos.occupied();
+   // Squares that a piece can move to without being taken by a pawn.
+   const Bitboard available = ~pos.occupied(side) & ~attacks(pawn(!side));
+
+   Bitboard pieces = pos.occupied(piece);
+   while (pieces != EmptyBB)
+   {
+      const Square at = popLowestSquare(pieces);
+
+      Bitboard attacked = EmptyBB;
+      if (isKnight(piece))
+         attacked = knightAttacks(at);
+      else if (isBishop(piece))
+         attacked = bishopAttacks(at, occupied);
+      else if (isRook(piece))
+         attacked = rookAttacks(at, occupied);
+      else if (isQueen(piece))
+         attacked = queenAttacks(at, occupied);
+      else
+         attacked = kingAttacks(at);
+
+      addAttacks(side, attacked);
+      m_byPiece[toIdx(piece)] |= attacked;
+      m_mobility[toIdx(piece)] += static_cast<int>(popCount(attacked & available));
+   }
+}
+
+} // namespace matt2
@@ -0,0 +1,223 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "bitboard.h"
+#include "piece.h"
+#include "square.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace matt2
+{
+class Position;
+}
+
+
+namespace matt2
+{
+///////////////////
+// Attack sets of single pieces.
+// Squares are numbered file by file, so a step along a file changes the square value by
+// one and a step along a rank by eight.
+
+namespace attacks
+{
+
+// Directions of sliders. The first four directions increase the square value, the
+// others decrease it.
+enum Direction : std::size_t
+{
+   North,
+   East,
+   NorthEast,
+   SouthEast,
+   South,
+   West,
+   SouthWest,
+   NorthWest,
+   NumDirections
+};
+
+constexpr std::array<Offset, NumDirections> DirectionOffsets = {
+   Offset{0, 1}, {1, 0}, {1, 1}, {1, -1}, {0, -1}, {-1, 0}, {-1, -1}, {-1, 1}};
+
+constexpr bool isIncreasing(Direction dir)
+{
+   return dir < South;
+}
+
+constexpr bool isOnBoard(int f, int r)
+{
+   return f >= 0 && f < 8 && r >= 0 && r < 8;
+}
+
+constexpr Bitboard toBitboard(int f, int r)
+{
+   return Bitboard{1} << (f * 8 + r);
+}
+
+template <std::size_t N>
+constexpr std::array<Bitboard, 64> makeStepAttacks(const std::array<Offset, N>& offsets)
+{
+   std::array<Bitboard, 64> table{};
+   for (int sq = 0; sq < 64; ++sq)
+      for (const Offset& off : offsets)
+         if (isOnBoard(sq / 8 + off.df, sq % 8 + off.dr))
+            table[sq] |= toBitboard(sq / 8 + off.df, sq % 8 + off.dr);
+   return table;
+}
+
+// Squares from each square to the edge of the board in each direction, excluding the
+// square itself.
+constexpr std::array<std::array<Bitboard, 64>, NumDirections> makeRays()
+{
+   std::array<std::array<Bitboard, 64>, NumDirections> rays{};
+   for (std::size_t dir = 0; dir < NumDirections; ++dir)
+   {
+      const Offset off = DirectionOffsets[dir];
+      for (int sq = 0; sq < 64; ++sq)
+      {
+         int f = sq / 8 + off.df;
+         int r = sq % 8 + off.dr;
+         for (; isOnBoard(f, r); f += off.df, r += off.dr)
+            rays[dir][sq] |= toBitboard(f, r);
+      }
+   }
+   return rays;
+}
+
+inline constexpr std::array<Bitboard, 64> KnightAttacks = makeStepAttacks(
+   std::array<Offset, 8>{Offset{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2},
+                         {-1, 2}, {-1, -2}});
+inline constexpr std::array<Bitboard, 64> KingAttacks = makeStepAttacks(
+   std::array<Offset, 8>{Offset{1, 1}, {1, 0}, {1, -1}, {0, 1}, {0, -1}, {-1, 1},
+                         {-1, 0}, {-1, -1}});
+inline constexpr std::array<std::array<Bitboard, 64>, NumDirections> Rays = makeRays();
+
+// Returns the squares of a ray up to and including the first occupied square.
+constexpr Bitboard rayAttacks(Direction dir, Square at, Bitboard occupied)
+{
+   const Bitboard ray = Rays[dir][static_cast<std::size_t>(at)];
+   const Bitboard blockers = ray & occupied;
+   if (blockers == EmptyBB)
+      return ray;
+
+   const Square blocker =
+      isIncreasing(dir) ? lowestSquare(blockers) : highestSquare(blockers);
+   return ray & ~Rays[dir][static_cast<std::size_t>(blocker)];
+}
+
+} // namespace attacks
+
+
+constexpr Bitboard knightAttacks(Square at)
+{
+   return attacks::KnightAttacks[static_cast<std::size_t>(at)];
+}
+
+constexpr Bitboard kingAttacks(Square at)
+{
+   return attacks::KingAttacks[static_cast<std::size_t>(at)];
+}
+
+// Returns the squares attacked by the pawns of a side towards lower and higher files.
+constexpr Bitboard pawnAttacksDown(Color side, Bitboard pawns)
+{
+   const Bitboard forward =
+      side == White ? (pawns << 1) & ~Rank1BB : (pawns >> 1) & ~Rank8BB;
+   return forward >> 8;
+}
+
+constexpr Bitboard pawnAttacksUp(Color side, Bitboard pawns)
+{
+   const Bitboard forward =
+      side == White ? (pawns << 1) & ~Rank1BB : (pawns >> 1) & ~Rank8BB;
+   return forward << 8;
+}
+
+constexpr Bitboard pawnAttacks(Color side, Bitboard pawns)
+{
+   return pawnAttacksDown(side, pawns) | pawnAttacksUp(side, pawns);
+}
+
+// Attacks of sliders stop at the first occupied square in each direction. The occupied
+// square is attacked.
+constexpr Bitboard bishopAttacks(Square at, Bitboard occupied)
+{
+   using namespace attacks;
+   return rayAttacks(NorthEast, at, occupied) | rayAttacks(SouthEast, at, occupied) |
+          rayAttacks(SouthWest, at, occupied) | rayAttacks(NorthWest, at, occupied);
+}
+
+constexpr Bitboard rookAttacks(Square at, Bitboard occupied)
+{
+   using namespace attacks;
+   return rayAttacks(North, at, occupied) | rayAttacks(East, at, occupied) |
+          rayAttacks(South, at, occupied) | rayAttacks(West, at, occupied);
+}
+
+constexpr Bitboard queenAttacks(Square at, Bitboard occupied)
+{
+   return bishopAttacks(at, occupied) | rookAttacks(at, occupied);
+}
+
+
+///////////////////
+
+// Attacks of all pieces of a position.
+// Built once per position, so that evaluation terms and legality checks can share
+// them instead of tracing the moves of the pieces each.
+class AttackInfo
+{
+ public:
+   AttackInfo() = default;
+   explicit AttackInfo(const Position& pos);
+
+   // Returns the squares attacked by pieces of a given kind.
+   Bitboard attacks(Piece piece) const { return m_byPiece[toIdx(piece)]; }
+   // Returns the squares attacked by any piece of a side.
+   Bitboard attacks(Color side) const { return m_all[toIdx(side)]; }
+   // Returns the squares attacked by at least two pieces of a side.
+   Bitboard doubleAttacks(Color side) const { return m_double[toIdx(side)]; }
+   bool isAttacked(Square sq, Color by) const { return contains(attacks(by), sq); }
+   bool isCheck(Color side) const { return (m_king[toIdx(side)] & attacks(!side)) != 0; }
+
+   // Returns the king's square and the squares around it for a side.
+   Bitboard kingZone(Color side) const { return m_kingZone[toIdx(side)]; }
+   // Returns the number of attacks of the opponent on the king zone of a side. Each
+   // attacked square counts once for each piece attacking it.
+   int kingZoneAttacks(Color side) const { return m_kingZoneAttacks[toIdx(side)]; }
+   // Returns the number of opponent pieces that attack the king zone of a side. Pawns
+   // count once for each direction they attack in.
+   int kingZoneAttackers(Color side) const { return m_kingZoneAttackers[toIdx(side)]; }
+
+   // Returns the number of squares that the pieces of a given kind can move to without
+   // being taken by a pawn, summed over all pieces.
+   int mobility(Piece piece) const { return m_mobility[toIdx(piece)]; }
+
+ private:
+   void addAttacks(Color side, Bitboard attacked);
+   void addPawnAttacks(Color side, const Position& pos);
+   void addPieceAttacks(Piece piece, const Position& pos);
+
+   static constexpr std::size_t toIdx(Piece piece)
+   {
+      return static_cast<std::size_t>(piece);
+   }
+   static constexpr std::size_t toIdx(Color side) { return side == White ? 0 : 1; }
+
+ private:
+   std::array<Bitboard, 12> m_byPiece{};
+   std::array<Bitboard, 2> m_all{};
+   std::array<Bitboard, 2> m_double{};
+   std::array<Bitboard, 2> m_king{};
+   std::array<Bitboard, 2> m_kingZone{};
+   std::array<int, 2> m_kingZoneAttacks{};
+   std::array<int, 2> m_kingZoneAttackers{};
+   std::array<int, 12> m_mobility{};
+};
+
+} // namespace matt2
@@ -0,0 +1,180 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "batch_eval.h"
+#include "daily_chess_scoring.h"
+#include "daily_chess_weights.h"
+#include "eval_cache.h"
+#include "fen.h"
+#include "game.h"
+#include "nnue.h"
+#include "pawn_table.h"
+#include "position.h"
+#include "thread_pool.h"
+#include <charconv>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+void appendScore(std::string& out, Score score)
+{
+   // Enough for any score including its sign.
+   char buffer[12];
+   const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), score);
+   out.append(buffer, end);
+}
+
+} // namespace
+
+
+namespace matt2
+{
+///////////////////
+
+struct BatchEvaluator::Scratch
+{
+   Position pos;
+   dcs::PawnTable pawnTable;
+   nnue::Accumulator accumulator;
+   // Output of the task for the current chunk.
+   std::string output;
+   std::size_t numInvalid = 0;
+};
+
+///////////////////
+
+BatchEvaluator::BatchEvaluator(ThreadPool& pool, BatchOptions options)
+: m_pool{pool}, m_options{std::move(options)}, m_scratch(pool.size())
+{
+   if (m_options.weights && (m_options.network || m_options.depth > 0))
+      throw std::runtime_error("Weights are only used for static scores of the rules.");
+
+   // Networks score fast enough to not need caching.
+   if (m_options.depth > 0 && !m_options.network)
+      m_cache = std::make_unique<EvalCache>(m_options.cacheSizeMB);
+}
+
+
+BatchEvaluator::~BatchEvaluator() = default;
+
+
+void BatchEvaluator::evaluate(const std::vector<std::string>& lines,
+                              std::vector<std::optional<Score>>& scores)
+{
+   scores.resize(lines.size());
+
+   const std::size_t numTasks = m_scratch.size();
+   m_pool.run(numTasks,
+              [&](std::size_t taskIdx)
+              {
+                 Scratch& scratch = m_scratch[taskIdx];
+                 const auto [first, last] = taskRange(0, lines.size(), taskIdx, numTasks);
+                 for (std::size_t i = first; i < last; ++i)
+                    scores[i] = evaluate(lines[i], scratch);
+              });
+}
+
+
+BatchStats BatchEvaluator::run(std::istream& in, std::ostream& out)
+{
+   // Lines are read and the output is written on the calling thread. The scores are
+   // calculated and formatted by the tasks, each into its own output, so that the
+   // outputs of the tasks only have to be written one after the other.
+   const std::size_t numTasks = m_scratch.size();
+   std::vector<std::string> lines(numTasks * RecordsPerTask);
+
+   BatchStats stats;
+   while (in)
+   {
+      std::size_t numLines = 0;
+      while (numLines < lines.size() && std::getline(in, lines[numLines]))
+         ++numLines;
+      if (numLines == 0)
+         break;
+
+      m_pool.run(numTasks,
+                 [&](std::size_t taskIdx)
+                 {
+                    Scratch& scratch = m_scratch[taskIdx];
+                    scratch.output.clear();
+                    scratch.numInvalid = 0;
+
+                    const auto [first, last] = taskRange(0, numLines, taskIdx, numTasks);
+                    for (std::size_t i = first; i < last; ++i)
+                    {
+                       if (const auto score = evaluate(lines[i], scratch); score)
+                       {
+                          appendScore(scratch.output, *score);
+                       }
+                       else
+                       {
+                          scratch.output += InvalidMark;
+                          ++scratch.numInvalid;
+                       }
+                       scratch.output += '\n';
+                    }
+                 });
+
+      for (const Scratch& scratch : m_scratch)
+      {
+         out.write(scratch.output.data(),
+                   static_cast<std::streamsize>(scratch.output.size()));
+         stats.numInvalid += scratch.numInvalid;
+      }
+      stats.numRecords += numLines;
+
+      if (!out)
+         throw std::runtime_error("Failed to write scores.");
+   }
+
+   if (in.bad())
+      throw std::runtime_error("Failed to read positions.");
+   return stats;
+}
+
+
+std::optional<Score> BatchEvaluator::evaluate(std::string_view line,
+                                              Scratch& scratch) const
+{
+   // Lines of files written on Windows keep their carriage return.
+   if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+
+   FenState state;
+   try
+   {
+      state = readFenPrefix(line, scratch.pos);
+   }
+   catch (const std::runtime_error&)
+   {
+      return std::nullopt;
+   }
+
+   // Positions without kings cannot be scored.
+   Position& pos = scratch.pos;
+   if (!pos.kingLocation(White) || !pos.kingLocation(Black))
+      return std::nullopt;
+
+   if (m_options.depth > 0)
+      return calcSearchScore(pos, state.sideToMove, m_options.depth, DefaultSearchMode,
+                             m_cache.get(), m_options.network.get());
+
+   if (m_options.network)
+   {
+      nnue::refresh(scratch.accumulator, *m_options.network, pos);
+      return nnue::evaluate(scratch.accumulator, *m_options.network);
+   }
+   if (m_options.weights)
+      return dcs::score(pos, scratch.pawnTable, *m_options.weights);
+   return dcs::score(pos, scratch.pawnTable);
+}
+
+} // namespace matt2
@@ -0,0 +1,101 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "scoring.h"
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace matt2
+{
+class EvalCache;
+class ThreadPool;
+namespace dcs
+{
+class Weights;
+}
+namespace nnue
+{
+class Network;
+}
+}
+
+// Evaluation of large sets of positions, e.g. positions taken from game logs.
+// Positions are given as lines that start with a FEN record and are scored in chunks on
+// the threads of a pool. Each task keeps its position and tables across chunks, so that
+// scoring a chunk does not allocate.
+
+namespace matt2
+{
+///////////////////
+
+struct BatchOptions
+{
+   // Depth of the search for the scores in plies. Zero scores the positions statically.
+   std::size_t depth = 0;
+   // Weights of the rules for static scores. The default weights are used if none are
+   // given.
+   std::shared_ptr<const dcs::Weights> weights;
+   // Network that scores the positions instead of the rules, if any.
+   std::shared_ptr<const nnue::Network> network;
+   // Size in MB of the cache that the searches of all tasks share.
+   std::size_t cacheSizeMB = 16;
+};
+
+struct BatchStats
+{
+   std::size_t numRecords = 0;
+   // Records that could not be read or whose positions lack a king.
+   std::size_t numInvalid = 0;
+};
+
+///////////////////
+
+class BatchEvaluator
+{
+ public:
+   // Number of records per task in each chunk of a stream.
+   static constexpr std::size_t RecordsPerTask = 8192;
+   // Written in place of the score of an invalid record.
+   static constexpr std::string_view InvalidMark = "invalid";
+
+ public:
+   // Throws std::runtime_error if weights are given together with a network or a
+   // search depth.
+   explicit BatchEvaluator(ThreadPool& pool, BatchOptions options = {});
+   ~BatchEvaluator();
+   BatchEvaluator(const BatchEvaluator&) = delete;
+   BatchEvaluator& operator=(const BatchEvaluator&) = delete;
+
+   // Scores the positions of the given lines from white's point of view. The scores are
+   // stored in the order of the lines. Lines are read with readFenPrefix, so anything
+   // following the FEN record is ignored. Invalid lines get no score.
+   void evaluate(const std::vector<std::string>& lines,
+                 std::vector<std::optional<Score>>& scores);
+
+   // Reads lines from a stream, scores them in chunks and writes one line with the
+   // score of each input line to another stream. The scores are written in the order
+   // of the input lines. Throws std::runtime_error if reading or writing fails.
+   BatchStats run(std::istream& in, std::ostream& out);
+
+ private:
+   struct Scratch;
+
+   // Scores a line with the scratch space of a task.
+   std::optional<Score> evaluate(std::string_view line, Scratch& scratch) const;
+
+ private:
+   ThreadPool& m_pool;
+   BatchOptions m_options;
+   std::unique_ptr<EvalCache> m_cache;
+   // Scratch space of each task.
+   std::vector<Scratch> m_scratch;
+};
+
+} // namespace matt2
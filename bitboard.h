@@ -0,0 +1,136 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "square.h"
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+
+namespace matt2
+{
+///////////////////
+
+// Set of squares with one bit per square. The bit index of a square is the value of
+// its Square enum, i.e. bits are ordered a1, a2, ..., a8, b1, ..., h8.
+using Bitboard = uint64_t;
+
+constexpr Bitboard EmptyBB = 0;
+
+
+constexpr Bitboard toBitboard(Square sq)
+{
+   return Bitboard{1} << static_cast<unsigned>(sq);
+}
+
+constexpr bool contains(Bitboard bb, Square sq)
+{
+   return (bb & toBitboard(sq)) != 0;
+}
+
+constexpr std::size_t popCount(Bitboard bb)
+{
+   return static_cast<std::size_t>(std::popcount(bb));
+}
+
+// Returns the square with the lowest value. The bitboard must not be empty.
+constexpr Square lowestSquare(Bitboard bb)
+{
+   assert(bb != EmptyBB);
+   return static_cast<Square>(std::countr_zero(bb));
+}
+
+// Returns the square with the highest value. The bitboard must not be empty.
+constexpr Square highestSquare(Bitboard bb)
+{
+   assert(bb != EmptyBB);
+   return static_cast<Square>(63 - std::countl_zero(bb));
+}
+
+// Removes the square with the lowest value from the bitboard and returns it. The
+// bitboard must not be empty.
+constexpr Square popLowestSquare(Bitboard& bb)
+{
+   const Square sq = lowestSquare(bb);
+   bb &= bb - 1;
+   return sq;
+}
+
+// Returns the squares of a bitboard that have a higher value than a given square.
+constexpr Bitboard squaresAbove(Bitboard bb, Square sq)
+{
+   return bb & (~Bitboard{1} << static_cast<unsigned>(sq));
+}
+
+// Returns the squares of a bitboard that have a lower value than a given square.
+constexpr Bitboard squaresBelow(Bitboard bb, Square sq)
+{
+   return bb & (toBitboard(sq) - 1);
+}
+
+///////////////////
+// Files and ranks.
+// Each file occupies one byte of a bitboard with rank one in the lowest bit. Sets of
+// files are bytes with bit n set for the nth file.
+
+constexpr Bitboard FileABB = 0x00000000000000ffull;
+constexpr Bitboard Rank1BB = 0x0101010101010101ull;
+constexpr Bitboard Rank8BB = Rank1BB << 7;
+
+constexpr Bitboard fileMask(File f)
+{
+   return FileABB << (8 * static_cast<unsigned>(f));
+}
+
+// Returns the files that have at least one square in a bitboard.
+constexpr uint8_t occupiedFiles(Bitboard bb)
+{
+   // Collapse each file into its lowest bit and gather these bits in the top byte.
+   bb |= bb >> 4;
+   bb |= bb >> 2;
+   bb |= bb >> 1;
+   return static_cast<uint8_t>(((bb & Rank1BB) * 0x0102040810204080ull) >> 56);
+}
+
+// Returns the squares of a set of files.
+constexpr Bitboard filesMask(uint8_t files)
+{
+   // Spread the bit of each file to the lowest bit of its byte and fill the byte.
+   Bitboard bb = files;
+   bb = (bb | bb << 28) & 0x0000000f0000000full;
+   bb = (bb | bb << 14) & 0x0003000300030003ull;
+   bb = (bb | bb << 7) & Rank1BB;
+   return bb * 0xff;
+}
+
+// Returns the squares on the files left and right of the squares of a bitboard.
+constexpr Bitboard adjacentFiles(Bitboard bb)
+{
+   return (bb << 8) | (bb >> 8);
+}
+
+// Returns the squares that are on the same file as and on a higher rank than any
+// square of a bitboard.
+constexpr Bitboard spanUp(Bitboard bb)
+{
+   bb = (bb << 1) & ~Rank1BB;
+   bb |= (bb << 1) & ~Rank1BB;
+   bb |= (bb << 2) & ~(Rank1BB * 0x03);
+   bb |= (bb << 4) & ~(Rank1BB * 0x0f);
+   return bb;
+}
+
+// Returns the squares that are on the same file as and on a lower rank than any square
+// of a bitboard.
+constexpr Bitboard spanDown(Bitboard bb)
+{
+   bb = (bb >> 1) & ~Rank8BB;
+   bb |= (bb >> 1) & ~Rank8BB;
+   bb |= (bb >> 2) & ~(Rank1BB * 0xc0);
+   bb |= (bb >> 4) & ~(Rank1BB * 0xf0);
+   return bb;
+}
+
+} // namespace matt2
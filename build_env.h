@@ -7,3 +7,8 @@
 #ifdef _MSC_VER
 #define HAVE_STD_FORMAT
 #endif
+
+// Emscripten builds are not set up for threads.
+#ifndef wasm
+#define HAVE_THREADS
+#endif
@@ -2,12 +2,26 @@
 // Apr-2023, Michael Lindner
 // MIT license
 //
+#include "batch_eval.h"
+#include "daily_chess_scoring.h"
+#include "daily_chess_tuning.h"
+#include "daily_chess_weights.h"
+#include "fen.h"
 #include "game.h"
+#include "nnue.h"
 #include "notation.h"
+#include "perft.h"
+#include "thread_pool.h"
 #include "essentutils/string_util.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cstdio>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #ifdef _WIN32
@@ -286,8 +300,585 @@ static GameStatus enginesTurn(Game& g, size_t turnDepth, Color engineColor)
 
 ///////////////////
 
-int main()
+static void printPerftUsage()
 {
+   std::cout << "Usage:\n";
+   std::cout << " perft <depth> [<position>]        - count nodes\n";
+   std::cout << " perft divide <depth> [<position>] - count nodes for each move\n";
+   std::cout << " perft stats <depth> [<position>]  - count nodes by move type\n";
+   std::cout << " perft suite [<max depth>]         - verify all suite positions\n";
+   std::cout << "A position is the name of a suite position or a FEN record.\n";
+   std::cout << "Options for counting nodes and the suite:\n";
+   std::cout << " --threads <count> - number of threads, default is all hardware threads\n";
+   std::cout << " --hash <MB>       - size of hash table for subtrees, default is none\n";
+   std::cout << "Suite positions:";
+   for (const auto& perftCase : perftSuite())
+      std::cout << " " << perftCase.name;
+   std::cout << "\n";
+}
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+   const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   return elapsed.count();
+}
+
+static void printNodeRate(uint64_t nodes, double seconds)
+{
+   std::cout << "Nodes: " << nodes << "\n";
+   std::cout << "Time: " << seconds * 1000. << " ms\n";
+   if (seconds > 0.)
+      std::cout << "Nodes/sec: " << static_cast<uint64_t>(nodes / seconds) << "\n";
+}
+
+static std::optional<size_t> parseNumber(const std::string& arg)
+{
+   const auto isDigit = [](unsigned char ch) { return std::isdigit(ch) != 0; };
+   if (arg.empty() || !std::all_of(arg.begin(), arg.end(), isDigit))
+      return std::nullopt;
+   return std::stoul(arg);
+}
+
+// Reads a position given as the name of a suite position or as a FEN record whose fields
+// are split across the arguments. Returns the position and the side to move.
+static std::optional<std::pair<Position, Color>>
+readPerftPosition(const std::vector<std::string>& args, size_t firstIdx)
+{
+   if (firstIdx >= args.size())
+      return std::make_pair(StartPos, White);
+
+   if (const PerftCase* perftCase = findPerftCase(args[firstIdx]))
+      return std::make_pair(perftCase->pos, perftCase->side);
+
+   std::string fen;
+   for (size_t i = firstIdx; i < args.size(); ++i)
+      fen += (i > firstIdx ? " " : "") + args[i];
+
+   try
+   {
+      Position pos;
+      const FenState state = readFen(fen, pos);
+      return std::make_pair(std::move(pos), state.sideToMove);
+   }
+   catch (const std::runtime_error& e)
+   {
+      std::cout << e.what() << "\n";
+      return std::nullopt;
+   }
+}
+
+// Removes the options from the given arguments. Returns nothing if an option is
+// invalid.
+static std::optional<PerftOptions> extractPerftOptions(std::vector<std::string>& args)
+{
+   PerftOptions options;
+
+   for (size_t i = 0; i < args.size();)
+   {
+      if (args[i] != "--threads" && args[i] != "--hash")
+      {
+         ++i;
+         continue;
+      }
+
+      const auto value = i + 1 < args.size() ? parseNumber(args[i + 1]) : std::nullopt;
+      if (!value)
+         return std::nullopt;
+      if (args[i] == "--threads")
+         options.numThreads = *value;
+      else
+         options.hashSizeMB = *value;
+
+      args.erase(args.begin() + i, args.begin() + i + 2);
+   }
+
+   return options;
+}
+
+static int runPerftSuite(size_t maxDepth, const PerftOptions& options)
+{
+   uint64_t totalNodes = 0;
+   bool allPassed = true;
+   const auto start = std::chrono::steady_clock::now();
+
+   for (const auto& perftCase : perftSuite())
+   {
+      const size_t numDepths = std::min(maxDepth, perftCase.nodes.size());
+      for (size_t depth = 1; depth <= numDepths; ++depth)
+      {
+         const uint64_t nodes = perft(perftCase.pos, perftCase.side, depth, options);
+         const uint64_t expected = perftCase.nodes[depth - 1];
+         totalNodes += nodes;
+
+         std::cout << perftCase.name << " depth " << depth << ": " << nodes;
+         if (nodes == expected)
+         {
+            std::cout << " ok\n";
+         }
+         else
+         {
+            std::cout << " FAILED (expected " << expected << ")\n";
+            allPassed = false;
+         }
+      }
+   }
+
+   printNodeRate(totalNodes, elapsedSeconds(start));
+   return allPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int runPerft(std::vector<std::string> args)
+{
+   // Default depth for the suite keeps the run time in the range of seconds.
+   constexpr size_t DefaultSuiteDepth = 4;
+
+   const auto options = extractPerftOptions(args);
+   if (!options)
+   {
+      printPerftUsage();
+      return EXIT_FAILURE;
+   }
+
+   if (!args.empty() && args[0] == "suite")
+   {
+      const auto maxDepth = args.size() > 1 ? parseNumber(args[1]) : DefaultSuiteDepth;
+      if (!maxDepth)
+      {
+         printPerftUsage();
+         return EXIT_FAILURE;
+      }
+      return runPerftSuite(*maxDepth, *options);
+   }
+
+   // Optional mode followed by depth and optional position.
+   size_t argIdx = 0;
+   std::string mode;
+   if (!args.empty() && (args[0] == "divide" || args[0] == "stats"))
+      mode = args[argIdx++];
+
+   const auto depth = argIdx < args.size() ? parseNumber(args[argIdx++]) : std::nullopt;
+   const auto startPos = readPerftPosition(args, argIdx);
+   if (!depth || !startPos)
+   {
+      printPerftUsage();
+      return EXIT_FAILURE;
+   }
+
+   Position pos = startPos->first;
+   const Color side = startPos->second;
+   const auto start = std::chrono::steady_clock::now();
+
+   if (mode == "divide")
+   {
+      auto entries = perftDivide(pos, side, *depth);
+      const double seconds = elapsedSeconds(start);
+
+      // Sort by move notation to make comparing with other engines easier.
+      std::sort(entries.begin(), entries.end(),
+                [](const PerftDivideEntry& a, const PerftDivideEntry& b)
+                { return toString(a.move) < toString(b.move); });
+
+      uint64_t nodes = 0;
+      for (const auto& entry : entries)
+      {
+         std::cout << toString(entry.move) << ": " << entry.nodes << "\n";
+         nodes += entry.nodes;
+      }
+      std::cout << "Moves: " << entries.size() << "\n";
+      printNodeRate(nodes, seconds);
+   }
+   else if (mode == "stats")
+   {
+      const PerftStats stats = perftStats(pos, side, *depth);
+      const double seconds = elapsedSeconds(start);
+
+      std::cout << "Captures: " << stats.captures << "\n";
+      std::cout << "En-passants: " << stats.enPassants << "\n";
+      std::cout << "Castles: " << stats.castles << "\n";
+      std::cout << "Promotions: " << stats.promotions << "\n";
+      std::cout << "Checks: " << stats.checks << "\n";
+      std::cout << "Mates: " << stats.mates << "\n";
+      printNodeRate(stats.nodes, seconds);
+   }
+   else
+   {
+      const uint64_t nodes = perft(pos, side, *depth, *options);
+      printNodeRate(nodes, elapsedSeconds(start));
+   }
+
+   return EXIT_SUCCESS;
+}
+
+///////////////////
+
+static void printEvalUsage()
+{
+   std::cout << "Usage:\n";
+   std::cout << " eval [<position>] - print the terms of the evaluation\n";
+   std::cout << "A position is the name of a suite position or a FEN record.\n";
+   std::cout << "Options:\n";
+   std::cout << " --weights <file> - weights of the terms, default is the built-in weights\n";
+}
+
+static void printScorePair(ScorePair score)
+{
+   std::cout << std::setw(7) << score.mg() << std::setw(7) << score.eg();
+}
+
+static void printEvalTrace(const dcs::EvalTrace& trace)
+{
+   // Middlegame and endgame values of the terms for white and black. Rules without
+   // terms for either side are left out.
+   std::cout << std::left << std::setw(36) << "Term" << std::right << std::setw(14)
+             << "White" << std::setw(14) << "Black" << "\n";
+   std::cout << std::setw(36) << "" << std::setw(7) << "mg" << std::setw(7) << "eg"
+             << std::setw(7) << "mg" << std::setw(7) << "eg" << "\n";
+
+   for (size_t idx = 0; idx < dcs::NumRules; ++idx)
+   {
+      const dcs::Rules rule = dcs::ruleAt(idx);
+      const ScorePair white = trace.term(White, rule);
+      const ScorePair black = trace.term(Black, rule);
+      if (white == ScorePair{} && black == ScorePair{})
+         continue;
+
+      std::cout << std::left << std::setw(36) << dcs::ruleName(rule) << std::right;
+      printScorePair(white);
+      printScorePair(black);
+      std::cout << "\n";
+   }
+
+   std::cout << "\n";
+   struct PieceRow
+   {
+      Piece white;
+      Piece black;
+      const char* name;
+   };
+   constexpr PieceRow Pieces[] = {{Kw, Kb, "King"},   {Qw, Qb, "Queen"},
+                                  {Rw, Rb, "Rook"},   {Bw, Bb, "Bishop"},
+                                  {Nw, Nb, "Knight"}, {Pw, Pb, "Pawn"}};
+   for (const PieceRow& row : Pieces)
+   {
+      std::cout << std::left << std::setw(36) << row.name << std::right;
+      printScorePair(trace.pieceScore(row.white));
+      printScorePair(trace.pieceScore(row.black));
+      std::cout << "\n";
+   }
+
+   std::cout << "\nPhase: " << trace.phase << " of " << dcs::MaxPhase << "\n";
+   std::cout << "Score: " << trace.score << " (white's point of view)\n";
+}
+
+static int runEval(std::vector<std::string> args)
+{
+   dcs::Weights weights = dcs::DefaultWeights;
+   const auto weightsOpt = std::find(args.begin(), args.end(), "--weights");
+   if (weightsOpt != args.end())
+   {
+      if (weightsOpt + 1 == args.end())
+      {
+         printEvalUsage();
+         return EXIT_FAILURE;
+      }
+
+      try
+      {
+         weights = dcs::Weights::load(*(weightsOpt + 1));
+      }
+      catch (const std::runtime_error& e)
+      {
+         std::cout << e.what() << "\n";
+         return EXIT_FAILURE;
+      }
+      args.erase(weightsOpt, weightsOpt + 2);
+   }
+
+   const auto pos = readPerftPosition(args, 0);
+   if (!pos)
+   {
+      printEvalUsage();
+      return EXIT_FAILURE;
+   }
+
+   printEvalTrace(dcs::traceScore(pos->first, weights));
+   return EXIT_SUCCESS;
+}
+
+///////////////////
+
+struct TuneOptions
+{
+   // Number of epochs to tune up to. Resumed tuning counts the epochs of the
+   // checkpoint.
+   size_t numEpochs = 10;
+   // Zero uses all hardware threads.
+   size_t numThreads = 0;
+   std::string checkpointPath;
+   bool resume = false;
+};
+
+static void printTuneUsage()
+{
+   std::cout << "Usage:\n";
+   std::cout << " tune <positions file> <weights file> - tune the weights of the terms\n";
+   std::cout << "Each line of the positions file holds a FEN record followed by the\n";
+   std::cout << "game result, e.g. 1-0, 0-1, 1/2-1/2 or 1.0, 0.0, 0.5. The tuned\n";
+   std::cout << "weights are written to the weights file after each epoch.\n";
+   std::cout << "Options:\n";
+   std::cout << " --epochs <count>    - number of passes over the positions, default is 10\n";
+   std::cout << " --threads <count>   - number of threads, default is all hardware threads\n";
+   std::cout << " --checkpoint <file> - save the state of the tuning after each epoch\n";
+   std::cout << " --resume            - continue the tuning of the checkpoint\n";
+}
+
+// Removes the options from the given arguments. Returns nothing if an option is
+// invalid.
+static std::optional<TuneOptions> extractTuneOptions(std::vector<std::string>& args)
+{
+   TuneOptions options;
+
+   for (size_t i = 0; i < args.size();)
+   {
+      if (args[i] == "--resume")
+      {
+         options.resume = true;
+         args.erase(args.begin() + i);
+         continue;
+      }
+      if (args[i] != "--epochs" && args[i] != "--threads" && args[i] != "--checkpoint")
+      {
+         ++i;
+         continue;
+      }
+
+      if (i + 1 >= args.size())
+         return std::nullopt;
+      if (args[i] == "--checkpoint")
+      {
+         options.checkpointPath = args[i + 1];
+      }
+      else
+      {
+         const auto value = parseNumber(args[i + 1]);
+         if (!value)
+            return std::nullopt;
+         if (args[i] == "--epochs")
+            options.numEpochs = *value;
+         else
+            options.numThreads = *value;
+      }
+
+      args.erase(args.begin() + i, args.begin() + i + 2);
+   }
+
+   if (options.resume && options.checkpointPath.empty())
+      return std::nullopt;
+   return options;
+}
+
+static int runTune(std::vector<std::string> args)
+{
+   const auto options = extractTuneOptions(args);
+   if (!options || args.size() != 2)
+   {
+      printTuneUsage();
+      return EXIT_FAILURE;
+   }
+   const std::string& positionsPath = args[0];
+   const std::string& weightsPath = args[1];
+
+   try
+   {
+      ThreadPool pool{options->numThreads};
+
+      auto start = std::chrono::steady_clock::now();
+      const dcs::TuningSet set = dcs::TuningSet::load(positionsPath, pool);
+      std::cout << "Positions: " << set.size() << " (" << set.numSkipped()
+                << " skipped)\n";
+      std::cout << "Time: " << elapsedSeconds(start) << " s\n";
+      if (set.size() == 0)
+         return EXIT_FAILURE;
+
+      dcs::TexelTuner tuner{set, pool};
+      if (options->resume)
+         tuner.loadCheckpoint(options->checkpointPath);
+      else
+         tuner.fitScale();
+      std::cout << "Scale: " << tuner.scale() << "\n";
+      std::cout << "Epoch " << tuner.epoch() << ": error " << tuner.error() << "\n";
+
+      while (tuner.epoch() < options->numEpochs)
+      {
+         start = std::chrono::steady_clock::now();
+         tuner.runEpoch();
+         const double seconds = elapsedSeconds(start);
+
+         tuner.weights().save(weightsPath);
+         if (!options->checkpointPath.empty())
+            tuner.saveCheckpoint(options->checkpointPath);
+         std::cout << "Epoch " << tuner.epoch() << ": error " << tuner.error() << ", "
+                   << seconds << " s\n";
+      }
+   }
+   catch (const std::runtime_error& e)
+   {
+      std::cout << e.what() << "\n";
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+///////////////////
+
+struct BatchCliOptions
+{
+   // Zero uses all hardware threads.
+   size_t numThreads = 0;
+   size_t depth = 0;
+   std::string weightsPath;
+   std::string networkPath;
+};
+
+static void printBatchUsage()
+{
+   std::cout << "Usage:\n";
+   std::cout << " batch [<positions file>] - score each line of the file, default is stdin\n";
+   std::cout << "Each line starts with a FEN record. The scores are written to stdout in\n";
+   std::cout << "the order of the lines, from white's point of view. Lines without a\n";
+   std::cout << "valid position get '" << BatchEvaluator::InvalidMark << "'.\n";
+   std::cout << "Options:\n";
+   std::cout << " --depth <plies>    - score with a search, default is the static score\n";
+   std::cout << " --threads <count>  - number of threads, default is all hardware threads\n";
+   std::cout << " --weights <file>   - weights of the terms for static scores\n";
+   std::cout << " --network <file>   - score with a network instead of the terms\n";
+}
+
+// Removes the options from the given arguments. Returns nothing if an option is
+// invalid.
+static std::optional<BatchCliOptions> extractBatchOptions(std::vector<std::string>& args)
+{
+   BatchCliOptions options;
+
+   for (size_t i = 0; i < args.size();)
+   {
+      if (args[i] != "--depth" && args[i] != "--threads" && args[i] != "--weights" &&
+          args[i] != "--network")
+      {
+         ++i;
+         continue;
+      }
+
+      if (i + 1 >= args.size())
+         return std::nullopt;
+      if (args[i] == "--weights")
+      {
+         options.weightsPath = args[i + 1];
+      }
+      else if (args[i] == "--network")
+      {
+         options.networkPath = args[i + 1];
+      }
+      else
+      {
+         const auto value = parseNumber(args[i + 1]);
+         if (!value)
+            return std::nullopt;
+         if (args[i] == "--depth")
+            options.depth = *value;
+         else
+            options.numThreads = *value;
+      }
+
+      args.erase(args.begin() + i, args.begin() + i + 2);
+   }
+
+   return options;
+}
+
+static int runBatch(std::vector<std::string> args)
+{
+   const auto options = extractBatchOptions(args);
+   if (!options || args.size() > 1)
+   {
+      printBatchUsage();
+      return EXIT_FAILURE;
+   }
+
+   // Scores are written in bulk, so the streams don't need to be synchronized with C
+   // stdio.
+   std::ios::sync_with_stdio(false);
+
+   try
+   {
+      BatchOptions batchOptions;
+      batchOptions.depth = options->depth;
+      if (!options->weightsPath.empty())
+         batchOptions.weights =
+            std::make_shared<dcs::Weights>(dcs::Weights::load(options->weightsPath));
+      if (!options->networkPath.empty())
+         batchOptions.network = nnue::Network::load(options->networkPath);
+
+      std::ifstream file;
+      if (!args.empty() && args[0] != "-")
+      {
+         file.open(args[0]);
+         if (!file)
+            throw std::runtime_error("Failed to open positions file " + args[0] + ".");
+      }
+      std::istream& in = file.is_open() ? file : std::cin;
+
+      ThreadPool pool{options->numThreads};
+      BatchEvaluator evaluator{pool, std::move(batchOptions)};
+
+      const auto start = std::chrono::steady_clock::now();
+      const BatchStats stats = evaluator.run(in, std::cout);
+      std::cout.flush();
+      const double seconds = elapsedSeconds(start);
+
+      // Statistics go to stderr to keep the scores separate.
+      std::cerr << "Positions: " << stats.numRecords << " (" << stats.numInvalid
+                << " invalid)\n";
+      std::cerr << "Time: " << seconds << " s\n";
+      if (seconds > 0.)
+         std::cerr << "Positions/sec: "
+                   << static_cast<uint64_t>(stats.numRecords / seconds) << "\n";
+   }
+   catch (const std::runtime_error& e)
+   {
+      std::cerr << e.what() << "\n";
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+///////////////////
+
+int main(int argc, char* argv[])
+{
+   // Non-interactive commands.
+   if (argc > 1)
+   {
+      const std::string command = argv[1];
+      const std::vector<std::string> args(argv + 2, argv + argc);
+      if (command == "perft")
+         return runPerft(args);
+      if (command == "eval")
+         return runEval(args);
+      if (command == "tune")
+         return runTune(args);
+      if (command == "batch")
+         return runBatch(args);
+
+      printPerftUsage();
+      printEvalUsage();
+      printTuneUsage();
+      printBatchUsage();
+      return EXIT_FAILURE;
+   }
+
    setupUtf8();
 
    printWelcome();
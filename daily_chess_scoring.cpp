@@ -3,32 +3,26 @@
 // MIT license
 //
 #include "daily_chess_scoring.h"
+#include "attack_info.h"
+#include "pawn_table.h"
 #include "piece.h"
 #include "piece_value_scoring.h"
 #include "position.h"
 #include "rules.h"
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <numeric>
-#include <unordered_map>
+#include <optional>
+#include <string_view>
 
 namespace matt2
 {
 namespace dcs
 {
 
-class PositionStats;
-
 ///////////////////
 
-// Piece values.
-constexpr double KingValue = 10000.;
-constexpr double QueenValue = 900.;
-constexpr double RookValue = 500.;
-constexpr double BishopValue = 340.;
-constexpr double KnightValue = 325.;
-constexpr double PawnValue = 100.;
-
 // Piece value lookup table.
 constexpr pvs::PieceValueTable PieceValues{
    KingValue, QueenValue, RookValue, BishopValue, KnightValue, PawnValue,
@@ -37,65 +31,18 @@ constexpr pvs::PieceValueTable PieceValues{
 
 ///////////////////
 
-// Pawn scoring
-// clang-format off
-static const std::unordered_map<Square, double> PawnWhitePosScore = {
-   {a2, 0.}, {b2, 0.},  {c2, 0.},  {d2, 0.},  {e2, 0.},  {f2, 0.},  {g2, 0.},  {h2, 0.},
-   {a3, 0.}, {b3, 2.},  {c3, 12.}, {d3, 22.}, {e3, 22.}, {f3, 12.}, {g3, 2.},  {h3, 0.},
-   {a4, 0.}, {b4, 4.},  {c4, 14.}, {d4, 24.}, {e4, 24.}, {f4, 14.}, {g4, 4.},  {h4, 0.},
-   {a5, 0.}, {b5, 6.},  {c5, 16.}, {d5, 26.}, {e5, 26.}, {f5, 16.}, {g5, 6.},  {h5, 0.},
-   {a6, 0.}, {b6, 8.},  {c6, 18.}, {d6, 28.}, {e6, 28.}, {f6, 18.}, {g6, 8.},  {h6, 0.},
-   {a7, 0.}, {b7, 10.}, {c7, 20.}, {d7, 30.}, {e7, 30.}, {f7, 20.}, {g7, 10.}, {h7, 0.},
-};
-static const std::unordered_map<Square, double> PawnBlackPosScore = {
-   {a7, 0.}, {b7, 0.},  {c7, 0.},  {d7, 0.},  {e7, 0.},  {f7, 0.},  {g7, 0.},  {h7, 0.},
-   {a6, 0.}, {b6, 2.},  {c6, 12.}, {d6, 22.}, {e6, 22.}, {f6, 12.}, {g6, 2.},  {h6, 0.},
-   {a5, 0.}, {b5, 4.},  {c5, 14.}, {d5, 24.}, {e5, 24.}, {f5, 14.}, {g5, 4.},  {h5, 0.},
-   {a4, 0.}, {b4, 6.},  {c4, 16.}, {d4, 26.}, {e4, 26.}, {f4, 16.}, {g4, 6.},  {h4, 0.},
-   {a3, 0.}, {b3, 8.},  {c3, 18.}, {d3, 28.}, {e3, 28.}, {f3, 18.}, {g3, 8.},  {h3, 0.},
-   {a2, 0.}, {b2, 10.}, {c2, 20.}, {d2, 30.}, {e2, 30.}, {f2, 20.}, {g2, 10.}, {h2, 0.},
-};
-// clang-format on
-constexpr double DoublePawnPenality = 7.;
-constexpr double IsolatedPawnPenality = 2.;
-constexpr double PassedPawnRankFactor = 1.;
-
-// Knight scoring
-// clang-format off
-static const std::unordered_map<Square, double> KnightPosScore = {
-   {a1, -14.}, {b1, -7.}, {c1, -7.}, {d1, -7.}, {e1, -7.}, {f1, -7.}, {g1, -7.}, {h1, -14.},
-   {a2, -7.},  {b2, 0.},  {c2, 0.},  {d2, 0.},  {e2, 0.},  {f2, 0.},  {g2, 0.},  {h2, -7.},
-   {a3, -7.},  {b3, 0.},  {c3, 4.},  {d3, 4.},  {e3, 4.},  {f3, 4.},  {g3, 0.},  {h3, -7.},
-   {a4, -7.},  {b4, 0.},  {c4, 4.},  {d4, 7.},  {e4, 7.},  {f4, 4.},  {g4, 0.},  {h4, -7.},
-   {a5, -7.},  {b5, 0.},  {c5, 4.},  {d5, 7.},  {e5, 7.},  {f5, 4.},  {g5, 0.},  {h5, -7.},
-   {a6, -7.},  {b6, 0.},  {c6, 4.},  {d6, 4.},  {e6, 4.},  {f6, 4.},  {g6, 0.},  {h6, -7.},
-   {a7, -7.},  {b7, 0.},  {c7, 0.},  {d7, 0.},  {e7, 0.},  {f7, 0.},  {g7, 0.},  {h7, -7.},
-   {a8, -14.}, {b8, -7.}, {c8, -7.}, {d8, -7.}, {e8, -7.}, {f8, -7.}, {g8, -7.}, {h8, -14.},
-};
-// clang-format on
-constexpr double KnightEnemyKingDistanceBonus = 1.;
-
-// Bishop scoring
-constexpr double MultipleBishopBonus = 20.;
-constexpr double BishopAdjacentPawnPenality = 5.;
-
-// Rook scoring
-constexpr double RookEnemyKingDistanceBonus = 5.;
-constexpr double RookSeventhRankBonus = 20.;
-constexpr double RookSharedFileBonus = 15.;
-constexpr double RookNoPawnsOnFileBonus = 10.;
-constexpr double RookOnlyEnemyPawnsOnFileBonus = 3.;
-
-// Queen scoring
-constexpr double QueenEnemyKingDistanceBonus = 5.;
-constexpr double QueenBishopDiagonalBonus = 1.;
+// Constants of the rules that are not weights.
 
-// King scoring
+// Number of pieces that a queen counts as in a king's quadrant.
 constexpr size_t QueenValueInKingQuadrant = 3;
-constexpr double KingQuadrantPenaltyFactor = 5.;
-constexpr double KingNeverCastledPenality = 15.;
-constexpr double KingsideRookMovedBeforeCastlingPenality = 12.;
-constexpr double QueensideRookMovedBeforeCastlingPenality = 8.;
+// Mobility is the number of squares that a piece can move to without being taken by a
+// pawn. It is scored relative to the mobility that a piece typically has.
+constexpr int TypicalKnightMobility = 4;
+constexpr int TypicalBishopMobility = 6;
+constexpr int TypicalRookMobility = 6;
+constexpr int TypicalQueenMobility = 12;
+// Min number of pieces that have to attack the king zone for the attacks to count.
+constexpr int MinKingZoneAttackers = 2;
 
 
 ///////////////////
@@ -197,359 +144,231 @@ static std::optional<int> minDistanceToEnemyKing(Piece p, const Position& pos)
 // -10,000 to encourage to program to delay the loss for as long as possible in the
 // unsportsmanlike hope that the opponent will make a mistake.
 
-class Score
+// Calculates the score of a side for a rule mask that is known at compile time. Checks
+// of rules outside of the mask are compiled out. Scorers with runtime rules check the
+// rules of the mask against the runtime rules, too. Used for arbitrary rule
+// combinations, e.g. in tests.
+// Terms are the weights of the rules multiplied by the number of times that the rules
+// apply. Scorers without runtime weights use the default weights as compile-time
+// constants. Traced scorers record each term and each number in a trace. Recording is
+// compiled out of the other scorers.
+template <Rules Mask, bool HasRuntimeRules = false, bool HasRuntimeWeights = false,
+          bool Traced = false>
+class Scorer
 {
  public:
-   Score(const Position& pos, const PositionStats& posStats, Color side, Rules rules);
-   ~Score() = default;
-   Score(const Score&) = delete;
-   Score& operator=(const Score&) = delete;
+   Scorer(const Position& pos, const PawnEntry& pawns, const AttackInfo& attacks,
+          const Weights& weights, Color side, Rules rules = Mask,
+          EvalTrace* trace = nullptr);
+   ~Scorer() = default;
+   Scorer(const Scorer&) = delete;
+   Scorer& operator=(const Scorer&) = delete;
 
-   double score() const { return m_score; }
-   double calc();
+   ScorePair score() const { return m_score; }
+   ScorePair calc();
 
  private:
-   double calcPawnScore();
-   double calcKnightScore();
-   double calcBishopScore();
-   double calcRookScore();
-   double calcQueenScore();
-   double calcKingScore();
+   ScorePair calcPawnScore();
+   ScorePair calcKnightScore();
+   ScorePair calcBishopScore();
+   ScorePair calcRookScore();
+   ScorePair calcQueenScore();
+   ScorePair calcKingScore();
+   ScorePair calcAttackScore();
+
+   ScorePair calcPieceValue(Piece piece) const;
+   ScorePair calcPositionBonus(Piece piece) const;
+   ScorePair calcRookPawnsOnFileBonus() const;
+   ScorePair calcMobilityBonus() const;
+   ScorePair calcKingZoneAttackPenalty() const;
 
  private:
-   bool useRule(Rules rule) const;
+   template <Rules Rule> bool useRule() const;
+   // Checks if a rule is used and its term has to be calculated, i.e. it is not
+   // covered by the running score sums of the position.
+   template <Rules Rule> bool needsCalc() const;
+   // Checks if the terms of the piece values and position bonuses are taken from the
+   // running sums of the position.
+   bool usesRunningSums() const;
+   // Returns the term of a weight that applies a given number of times. Penalties apply
+   // negative times. Traced scorers record the number as coefficient of the weight.
+   ScorePair weigh(param::Id id, int count) const;
+   // Record terms of rules and scores of pieces in the trace. Return the given score.
+   template <Rules Rule> ScorePair record(ScorePair term) const;
+   ScorePair record(Piece piece, ScorePair score) const;
 
  private:
    const Position& m_pos;
-   const PositionStats& m_stats;
+   // Scoring results of the pawn structure.
+   const PawnEntry& m_pawns;
+   // Attacks of both sides.
+   const AttackInfo& m_attacks;
+   // Only used with runtime weights.
+   const Weights& m_weights;
    Color m_side = White;
-   Rules m_rules = Rules::All;
-   double m_score = 0.;
+   // Only used with runtime rules.
+   Rules m_rules = Mask;
+   // Only used by traced scorers.
+   EvalTrace* m_trace = nullptr;
+   ScorePair m_score;
 };
 
-Score::Score(const Position& pos, const PositionStats& posStats, Color side, Rules rules)
-: m_pos{pos}, m_stats{posStats}, m_side{side}, m_rules{rules}
-{
-}
-
-double Score::calc()
-{
-   m_score = 0.;
-   m_score += calcPawnScore();
-   m_score += calcKnightScore();
-   m_score += calcBishopScore();
-   m_score += calcRookScore();
-   m_score += calcQueenScore();
-   m_score += calcKingScore();
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::Scorer(
+   const Position& pos, const PawnEntry& pawns, const AttackInfo& attacks,
+   const Weights& weights, Color side, Rules rules, EvalTrace* trace)
+: m_pos{pos}, m_pawns{pawns}, m_attacks{attacks}, m_weights{weights}, m_side{side},
+  m_rules{rules}, m_trace{trace}
+{
+   static_assert(!Traced || HasRuntimeWeights);
+   assert(!Traced || m_trace);
+   assert(HasRuntimeWeights || &m_weights == &DefaultWeights);
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calc()
+{
+   // Middlegame and endgame scores are summed in one pass. The caller interpolates
+   // between them.
+   m_score = record(pawn(m_side), calcPawnScore()) +
+             record(knight(m_side), calcKnightScore()) +
+             record(bishop(m_side), calcBishopScore()) +
+             record(rook(m_side), calcRookScore()) +
+             record(queen(m_side), calcQueenScore()) +
+             record(king(m_side), calcKingScore()) + calcAttackScore();
+   if (usesRunningSums())
+      m_score += m_pos.psqScore(m_side);
    return m_score;
 }
 
-///////////////////
-
-static size_t index(File f)
-{
-   return static_cast<size_t>(f);
-}
-
-// Files occupied by a piece type.
-struct PieceFiles
-{
-   using iterator = std::array<File, 10>::iterator;
-   using const_iterator = std::array<File, 10>::const_iterator;
-
-   std::array<File, 10> files;
-   // Number of file elements that are populated.
-   size_t numFiles = 0;
-
-   void add(File f) { files[numFiles++] = f; }
-   iterator begin() { return files.begin(); }
-   iterator end() { return files.begin() + numFiles; }
-   const_iterator begin() const { return files.begin(); }
-   const_iterator end() const { return files.begin() + numFiles; }
-};
-
-static constexpr size_t NumRanks = 8;
-using FileRanks_t = std::array<Rank, NumRanks>;
-
-struct PopulatedFileRanks
-{
-   const FileRanks_t& ranks;
-   // Number of rank elements that are populated.
-   size_t numRanks = 0;
-};
-
-// Occupied ranks by file.
-class FileStats
-{
-
- public:
-   void add(File f, Rank r);
-   bool isOccupied(File f) const;
-   PopulatedFileRanks ranks(File f) const;
-
- private:
-   static constexpr size_t NumFiles = 8;
-   std::array<FileRanks_t, NumFiles> m_stats;
-   // Number of populated ranks in file-rank arrays.
-   std::array<size_t, NumFiles> m_rankCount{0, 0, 0, 0, 0, 0, 0, 0};
-};
-
-void FileStats::add(File f, Rank r)
-{
-   const size_t fileIdx = index(f);
-   size_t& count = m_rankCount[fileIdx];
-   m_stats[fileIdx][count++] = r;
-}
-
-bool FileStats::isOccupied(File f) const
-{
-   return m_rankCount[index(f)] > 0;
-}
-
-PopulatedFileRanks FileStats::ranks(File f) const
-{
-   const size_t fileIdx = index(f);
-   return {m_stats[fileIdx], m_rankCount[fileIdx]};
-}
-
-///////////////////
-
-// Finds all ranks by file that pieces of a given type are on.
-static void collectFileStats(Piece p, const Position& pos, FileStats& stats)
-{
-   auto end = pos.end(p);
-   for (auto it = pos.begin(p); it != end; ++it)
-   {
-      const Square sq = *it;
-      const Rank r = rank(sq);
-      stats.add(file(sq), r);
-   }
-}
-
-// Returns all files that pieces of a given type are on.
-static PieceFiles collectFilesSorted(Piece p, const Position& pos)
-{
-   PieceFiles files;
-   std::for_each(pos.begin(p), pos.end(p),
-                 [&files](Square sq) { return files.add(file(sq)); });
-   std::sort(files.begin(), files.end());
-   return files;
-}
-
-///////////////////
-
-class ColorStats
-{
- public:
-   ColorStats() = default;
-   ColorStats(const Position& pos, Color side);
-
-   const FileStats& pawnStats() const { return m_pawnStats; }
-   const PieceFiles& pawnFiles() const { return m_sortedPawnFiles; }
-   const PieceFiles& rookFiles() const { return m_sortedRookFiles; }
-
- private:
-   Color m_side;
-   FileStats m_pawnStats;
-   PieceFiles m_sortedPawnFiles;
-   PieceFiles m_sortedRookFiles;
-};
-
-ColorStats::ColorStats(const Position& pos, Color side)
-: m_side{side}, m_sortedPawnFiles{collectFilesSorted(pawn(side), pos)},
-  m_sortedRookFiles{collectFilesSorted(rook(side), pos)}
-{
-   collectFileStats(pawn(side), pos, m_pawnStats);
-}
-
-///////////////////
-
-class PositionStats
-{
- public:
-   PositionStats() = default;
-   PositionStats(const Position& pos);
-
-   const FileStats& pawnStats(Color side) const;
-   const PieceFiles& pawnFiles(Color side) const;
-   const PieceFiles& rookFiles(Color side) const;
-
- private:
-   ColorStats m_whiteStats;
-   ColorStats m_blackStats;
-};
-
-PositionStats::PositionStats(const Position& pos)
-: m_whiteStats{pos, White}, m_blackStats{pos, Black}
-{
-}
-
-const FileStats& PositionStats::pawnStats(Color side) const
-{
-   return side == White ? m_whiteStats.pawnStats() : m_blackStats.pawnStats();
-}
-
-const PieceFiles& PositionStats::pawnFiles(Color side) const
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcPieceValue(
+   Piece piece) const
 {
-   return side == White ? m_whiteStats.pawnFiles() : m_blackStats.pawnFiles();
+   const auto count = static_cast<int>(m_pos.count(piece));
+   // Kings have a fixed value.
+   if (isKing(piece))
+      return ScorePair{KingValue * count};
+   return weigh(param::pieceValue(piece), count);
 }
 
-const PieceFiles& PositionStats::rookFiles(Color side) const
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcPositionBonus(
+   Piece piece) const
 {
-   return side == White ? m_whiteStats.rookFiles() : m_blackStats.rookFiles();
+   ScorePair bonus;
+   Bitboard pieces = m_pos.occupied(piece);
+   while (pieces != EmptyBB)
+      bonus += weigh(param::positionBonus(piece, popLowestSquare(pieces)), 1);
+   return bonus;
 }
 
 ///////////////////
 
-static bool isDoublePawn(const PopulatedFileRanks& pawnRanks)
-{
-   return pawnRanks.numRanks > 1;
-}
-
-static size_t countDoublePawns(const FileStats& stats)
-{
-   size_t count = 0;
-
-   for (File f = fa; f <= fh; f = f + 1)
-      if (isDoublePawn(stats.ranks(f)))
-         ++count;
-
-   return count;
-}
+// Pawn structure terms are calculated with masks over the pawn bitboards. Each file
+// occupies one byte of a bitboard, so moving squares between files are byte shifts and
+// moving them along files are bit shifts within the bytes.
 
 // A side is penalised for having two or more pawns on the same file (doubled
 // pawns).
-static double calcDoublePawnPenalty(const FileStats& pawnStats)
+static int countDoubledFiles(Bitboard pawns)
 {
-   return countDoublePawns(pawnStats) * DoublePawnPenality;
-}
-
-static bool isIsolatedPawn(File f, const FileStats& stats)
-{
-   // Is pawn on checked file?
-   if (!stats.isOccupied(f))
-      return false;
-
-   // Count its neighbors.
-   size_t numNeighbors = 0;
-   if (f != fa && stats.isOccupied(f - 1))
-      ++numNeighbors;
-   if (f != fh && stats.isOccupied(f + 1))
-      ++numNeighbors;
-
-   return numNeighbors == 0;
-}
-
-static size_t countIsolatedPawns(const FileStats& stats)
-{
-   size_t count = 0;
-   for (File f = fa; f <= fh; f = f + 1)
-      if (isIsolatedPawn(f, stats))
-         ++count;
-   return count;
+   // Pawns with another pawn below them on their file.
+   const Bitboard doubled = pawns & spanUp(pawns);
+   return std::popcount(occupiedFiles(doubled));
 }
 
 // A penalty is inflicted for isolated pawns.
-static double calcIsolatedPawnPenalty(const FileStats& pawnStats)
+static int countIsolatedFiles(Bitboard pawns)
 {
-   return countIsolatedPawns(pawnStats) * IsolatedPawnPenality;
+   // Files with pawns but without pawns on either neighbor file.
+   const uint8_t files = occupiedFiles(pawns);
+   const uint8_t isolated = files & ~occupiedFiles(adjacentFiles(filesMask(files)));
+   return std::popcount(isolated);
 }
 
-static bool hasOpponentPawnInFront(Color side, Rank sideRank,
-                                   const PopulatedFileRanks& opponentRanks)
+// Returns the pawns of a side that have no opponent pawns in front of them on their own
+// or the adjacent files.
+static Bitboard collectPassedPawns(Color side, Bitboard pawns, Bitboard opponentPawns)
 {
-   auto isInFront = [](Color side, Rank a, Rank b)
-   { return side == White ? a > b : a < b; };
-
-   for (size_t i = 0; i < opponentRanks.numRanks; ++i)
-      if (isInFront(side, opponentRanks.ranks[i], sideRank))
-         return true;
-   return false;
+   // Squares that are controlled or blocked by opponent pawns when advancing.
+   const Bitboard front =
+      side == White ? spanDown(opponentPawns) : spanUp(opponentPawns);
+   return pawns & ~(front | adjacentFiles(front));
 }
 
-static double calcPassedPawnBonus(Color side, File f, Rank r,
-                                  const FileStats& opponentsStats)
+static int rankNumber(Color side, Rank r)
 {
-   // Check for opponent pawns in front on file of pawn.
-   if (hasOpponentPawnInFront(side, r, opponentsStats.ranks(f)))
-      return 0.;
-
-   // Check for opponent pawns in front on adjacent files.
-   if (f != fa && hasOpponentPawnInFront(side, r, opponentsStats.ranks(f - 1)))
-      return 0.;
-   if (f != fh && hasOpponentPawnInFront(side, r, opponentsStats.ranks(f + 1)))
-      return 0.;
-
-   const size_t rankNumber =
-      side == White ? static_cast<size_t>(r) : 9 - static_cast<size_t>(r);
-   return rankNumber * PassedPawnRankFactor;
+   return side == White ? static_cast<int>(r) : 9 - static_cast<int>(r);
 }
 
 // Passed pawns are awarded a bonus that relates to the pawn's rank number. If there is a
 // hostile piece in front of a passed pawn, a value, also relating to the pawn's rank
 // number is deducted from the score.
-static double calcPassedPawnBonus(Color side, const FileStats& pawnStats,
-                                  const FileStats& opponentsStats)
+static int sumPassedPawnRanks(Color side, Bitboard passedPawns)
 {
-   double bonus = 0.;
+   int sum = 0;
+   while (passedPawns != EmptyBB)
+      sum += rankNumber(side, rank(popLowestSquare(passedPawns)));
+   return sum;
+}
 
-   for (File f = fa; f <= fh; f = f + 1)
+// Calculates the scoring results that only depend on the pawn structure.
+static void calcPawnEntry(const Position& pos, PawnEntry& entry)
+{
+   for (Color side : {White, Black})
    {
-      const PopulatedFileRanks& pawnRanks = pawnStats.ranks(f);
-      for (size_t i = 0; i < pawnRanks.numRanks; ++i)
-         bonus += calcPassedPawnBonus(side, f, pawnRanks.ranks[i], opponentsStats);
+      const size_t idx = PawnEntry::colorIdx(side);
+      const Bitboard pawns = pos.occupied(pawn(side));
+      const Bitboard opponentPawns = pos.occupied(pawn(!side));
+
+      entry.passedPawns[idx] = collectPassedPawns(side, pawns, opponentPawns);
+      entry.passedPawnRanks[idx] =
+         static_cast<uint8_t>(sumPassedPawnRanks(side, entry.passedPawns[idx]));
+      entry.numDoubledFiles[idx] = static_cast<uint8_t>(countDoubledFiles(pawns));
+      entry.numIsolatedFiles[idx] = static_cast<uint8_t>(countIsolatedFiles(pawns));
+      entry.pawnFiles[idx] = occupiedFiles(pawns);
    }
-
-   return bonus;
 }
 
-// Pawns other than those on files one and eight are awarded bonuses for advancement.
-static double calcPawnPositionBonus(Color side, const FileStats& pawnStats)
+// Returns the scoring results for the pawn structure of a position. Only calculates
+// them if the structure is not cached yet.
+static const PawnEntry& lookupPawnEntry(const Position& pos, PawnTable& table)
 {
-   const auto& posScore = side == White ? PawnWhitePosScore : PawnBlackPosScore;
-
-   double bonus = 0.;
+   if (const PawnEntry* cached = table.probe(pos))
+      return *cached;
 
-   for (File f = fa; f <= fh; f = f + 1)
-   {
-      const PopulatedFileRanks& pawnRanks = pawnStats.ranks(f);
-      for (size_t i = 0; i < pawnRanks.numRanks; ++i)
-         bonus += posScore.at(makeSquare(f, pawnRanks.ranks[i]));
-   }
-
-   return bonus;
+   PawnEntry& entry = table.store(pos);
+   calcPawnEntry(pos, entry);
+   return entry;
 }
 
-double Score::calcPawnScore()
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcPawnScore()
 {
-   double score = 0.;
+   ScorePair score;
+   const size_t idx = PawnEntry::colorIdx(m_side);
 
-   if (useRule(Rules::PawnPieceValue))
-      score += pvs::score(m_pos, pawn(m_side), PieceValues);
-   if (useRule(Rules::PawnPositionBonus))
-      score += calcPawnPositionBonus(m_side, m_stats.pawnStats(m_side));
-   if (useRule(Rules::PassedPawnBonus))
-      score += calcPassedPawnBonus(m_side, m_stats.pawnStats(m_side),
-                                   m_stats.pawnStats(!m_side));
-   if (useRule(Rules::DoublePawnPenalty))
-      score -= calcDoublePawnPenalty(m_stats.pawnStats(m_side));
-   if (useRule(Rules::IsolatedPawnPenalty))
-      score -= calcIsolatedPawnPenalty(m_stats.pawnStats(m_side));
+   // Pawns other than those on files one and eight are awarded bonuses for advancement.
+   if (needsCalc<Rules::PawnPieceValue>())
+      score += record<Rules::PawnPieceValue>(calcPieceValue(pawn(m_side)));
+   if (needsCalc<Rules::PawnPositionBonus>())
+      score += record<Rules::PawnPositionBonus>(calcPositionBonus(pawn(m_side)));
+   if (useRule<Rules::PassedPawnBonus>())
+      score += record<Rules::PassedPawnBonus>(
+         weigh(param::PassedPawnRankFactor, m_pawns.passedPawnRanks[idx]));
+   if (useRule<Rules::DoublePawnPenalty>())
+      score += record<Rules::DoublePawnPenalty>(
+         weigh(param::DoublePawnPenalty, -m_pawns.numDoubledFiles[idx]));
+   if (useRule<Rules::IsolatedPawnPenalty>())
+      score += record<Rules::IsolatedPawnPenalty>(
+         weigh(param::IsolatedPawnPenalty, -m_pawns.numIsolatedFiles[idx]));
 
    return score;
 }
 
-// Knights are awarded bonuses for closeness to the centre of the board.
-static double calcKnightCenterBonus(Color side, const Position& pos)
-{
-   const Piece kn = knight(side);
-   return std::accumulate(pos.begin(kn), pos.end(kn), 0.,
-                          [side](double val, Square sq)
-                          { return val + KnightPosScore.at(sq); });
-}
-
-// Calculate bonus for an individual knight's closeness to the enemy king.
-static double calcKnightKingClosenessBonus(Square knightSq, Square enemyKingSq)
+// Calculate closeness of an individual knight to the enemy king.
+static int calcKnightKingCloseness(Square knightSq, Square enemyKingSq)
 {
    constexpr int MaxDistSum = 2 * MaxFRDistance;
 
@@ -557,46 +376,45 @@ static double calcKnightKingClosenessBonus(Square knightSq, Square enemyKingSq)
    const int distSum = std::abs(off.df) + std::abs(off.dr);
 
    // Higher bonus the closer the distance is.
-   return (MaxDistSum - distSum) * KnightEnemyKingDistanceBonus;
+   return MaxDistSum - distSum;
 }
 
-// Calculate bonus for an all knights' closeness to the enemy king.
-static double calcKnightKingClosenessBonus(Color side, const Position& pos)
+// Calculate closeness of all knights to the enemy king.
+static int calcKnightKingCloseness(Color side, const Position& pos)
 {
    const Piece kn = knight(side);
 
    auto enemyKingSq = pos.kingLocation(!side);
    if (!enemyKingSq)
-      return 0.;
+      return 0;
 
-   // Sum up bonus for all knights.
+   // Sum up closeness of all knights.
    return std::accumulate(
-      pos.begin(kn), pos.end(kn), 0.,
-      [enemyKingSq](double val, Square knightSq)
-      { return val + calcKnightKingClosenessBonus(knightSq, *enemyKingSq); });
+      pos.begin(kn), pos.end(kn), 0, [enemyKingSq](int val, Square knightSq)
+      { return val + calcKnightKingCloseness(knightSq, *enemyKingSq); });
 }
 
-double Score::calcKnightScore()
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcKnightScore()
 {
-   double score = 0.;
+   ScorePair score;
 
-   if (useRule(Rules::KnightPieceValue))
-      score += pvs::score(m_pos, knight(m_side), PieceValues);
-   if (useRule(Rules::KnightCenterBonus))
-      score += calcKnightCenterBonus(m_side, m_pos);
-   if (useRule(Rules::KnightKingClosenessBonus))
-      score += calcKnightKingClosenessBonus(m_side, m_pos);
+   // Knights are awarded bonuses for closeness to the centre of the board.
+   if (needsCalc<Rules::KnightPieceValue>())
+      score += record<Rules::KnightPieceValue>(calcPieceValue(knight(m_side)));
+   if (needsCalc<Rules::KnightCenterBonus>())
+      score += record<Rules::KnightCenterBonus>(calcPositionBonus(knight(m_side)));
+   if (useRule<Rules::KnightKingClosenessBonus>())
+      score += record<Rules::KnightKingClosenessBonus>(weigh(
+         param::KnightEnemyKingDistanceBonus, calcKnightKingCloseness(m_side, m_pos)));
 
    return score;
 }
 
 // A bonus is given for the presence of two bishops.
-static double calcMultipleBishopBonus(Color side, const Position& pos)
+static bool hasMultipleBishops(Color side, const Position& pos)
 {
-   if (pos.count(bishop(side)) < 2)
-      return 0.;
-
-   return MultipleBishopBonus;
+   return pos.count(bishop(side)) >= 2;
 }
 
 static bool isPawnDiagonalNeighbor(Square sq, const Position& pos)
@@ -623,125 +441,111 @@ static bool isPawnDiagonalNeighbor(Square sq, const Position& pos)
 
 // Each of the squares diagonally adjacent to the bishop's square are considered with a
 // penalty being inflicted for each square that is occupied by a pawn of either colour.
-static double calcAdjacentPawnBishopPenalty(Color side, const Position& pos)
+static int countBishopsAdjacentToPawns(Color side, const Position& pos)
 {
    const Piece p = bishop(side);
-   return std::accumulate(
-      pos.begin(p), pos.end(p), 0.,
-      [&pos](double val, Square sq) {
-         return val + (isPawnDiagonalNeighbor(sq, pos) ? BishopAdjacentPawnPenality : 0.);
-      });
+   return static_cast<int>(std::count_if(pos.begin(p), pos.end(p),
+                                         [&pos](Square sq)
+                                         { return isPawnDiagonalNeighbor(sq, pos); }));
 }
 
-double Score::calcBishopScore()
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcBishopScore()
 {
-   double score = 0.;
+   ScorePair score;
 
-   if (useRule(Rules::BishopPieceValue))
-      score += pvs::score(m_pos, bishop(m_side), PieceValues);
-   if (useRule(Rules::MultipleBishopBonus))
-      score += calcMultipleBishopBonus(m_side, m_pos);
-   if (useRule(Rules::BishopAdjacentPawnPenality))
-      score -= calcAdjacentPawnBishopPenalty(m_side, m_pos);
+   if (needsCalc<Rules::BishopPieceValue>())
+      score += record<Rules::BishopPieceValue>(calcPieceValue(bishop(m_side)));
+   if (useRule<Rules::MultipleBishopBonus>())
+      score += record<Rules::MultipleBishopBonus>(
+         weigh(param::MultipleBishopBonus, hasMultipleBishops(m_side, m_pos)));
+   if (useRule<Rules::BishopAdjacentPawnPenality>())
+      score += record<Rules::BishopAdjacentPawnPenality>(weigh(
+         param::BishopAdjacentPawnPenalty, -countBishopsAdjacentToPawns(m_side, m_pos)));
 
    return score;
 }
 
 // Rooks are awarded a bonus for king tropism that is based on the minimum of the rank and
 // file distances from the enemy king.
-static double calcRookKingClosenessBonus(Color side, const Position& pos)
+static int calcRookKingCloseness(Color side, const Position& pos)
 {
    auto minDist = minDistanceToEnemyKing(rook(side), pos);
    if (!minDist)
-      return 0.;
+      return 0;
 
    // Higher bonus the closer the distance is.
-   return (MaxFRDistance - *minDist) * RookEnemyKingDistanceBonus;
+   return MaxFRDistance - *minDist;
 }
 
 // Rooks on the seventh rank receive a bonus.
-static double calcRookSeventhRankBonus(Color side, const Position& pos)
+static bool hasRookOnSeventhRank(Color side, const Position& pos)
 {
    const Piece r = rook(side);
    const Rank seventhRank = side == White ? r7 : r2;
-   const bool on7th =
-      std::any_of(pos.begin(r), pos.end(r),
-                  [seventhRank](Square sq) { return rank(sq) == seventhRank; });
-
-   return on7th ? RookSeventhRankBonus : 0.;
+   return std::any_of(pos.begin(r), pos.end(r),
+                      [seventhRank](Square sq) { return rank(sq) == seventhRank; });
 }
 
 // If two friendly rooks share the same file, the side receives a bonus.
-static double calcRookSharedFileBonus(const PieceFiles& sortedRookFiles)
+static bool haveRooksSharedFile(Color side, const Position& pos)
 {
-   // Check if any consecutive files are the same, i.e. shared between those pieces.
-   const auto last = std::end(sortedRookFiles);
-   const bool onSameFile = std::adjacent_find(std::begin(sortedRookFiles), last) != last;
-
-   return onSameFile ? RookSharedFileBonus : 0.;
+   const Bitboard rooks = pos.occupied(rook(side));
+   return (rooks & spanUp(rooks)) != EmptyBB;
 }
 
 // If there are no pawns on the same file as a rook, a bonus is given.
 // If there are enemy pawns on the same file but no friendly pawns, a smaller bonus is
 // given.
-static double calcRookPawnsOnFileBonus(Color side, const PositionStats& stats)
-{
-   const PieceFiles& ownPawnFilesSorted = stats.pawnFiles(side);
-   auto ownFirst = std::begin(ownPawnFilesSorted);
-   auto ownLast = std::end(ownPawnFilesSorted);
-
-   const PieceFiles& enemyPawnFilesSorted = stats.pawnFiles(!side);
-   auto enemyFirst = std::begin(enemyPawnFilesSorted);
-   auto enemyLast = std::end(enemyPawnFilesSorted);
-
-   size_t numFilesWithoutPawn = 0;
-   size_t numFilesWithOnlyEnemyPawn = 0;
-   for (File rookFile : stats.rookFiles(side))
-   {
-      const bool hasOwnPawn = std::find(ownFirst, ownLast, rookFile) != ownLast;
-      const bool hasEnemyPawn = std::find(enemyFirst, enemyLast, rookFile) != enemyLast;
-
-      if (!hasOwnPawn && !hasEnemyPawn)
-         ++numFilesWithoutPawn;
-      if (!hasOwnPawn && hasEnemyPawn)
-         ++numFilesWithOnlyEnemyPawn;
-   }
-
-   return numFilesWithoutPawn * RookNoPawnsOnFileBonus +
-          numFilesWithOnlyEnemyPawn * RookOnlyEnemyPawnsOnFileBonus;
-}
-
-double Score::calcRookScore()
-{
-   double score = 0.;
-
-   if (useRule(Rules::RookPieceValue))
-      score += pvs::score(m_pos, rook(m_side), PieceValues);
-   if (useRule(Rules::RookKingClosenessBonus))
-      score += calcRookKingClosenessBonus(m_side, m_pos);
-   if (useRule(Rules::RookSeventhRankBonus))
-      score += calcRookSeventhRankBonus(m_side, m_pos);
-   if (useRule(Rules::RookSharedFileBonus))
-      score += calcRookSharedFileBonus(m_stats.rookFiles(m_side));
-   if (useRule(Rules::RookPawnsOnFileBonus))
-      score += calcRookPawnsOnFileBonus(m_side, m_stats);
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair
+Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcRookPawnsOnFileBonus() const
+{
+   const Bitboard rooks = m_pos.occupied(rook(m_side));
+   const auto numOnOpenFiles =
+      static_cast<int>(popCount(rooks & filesMask(m_pawns.openFiles())));
+   const auto numOnHalfOpenFiles =
+      static_cast<int>(popCount(rooks & filesMask(m_pawns.halfOpenFiles(m_side))));
+
+   return weigh(param::RookNoPawnsOnFileBonus, numOnOpenFiles) +
+          weigh(param::RookOnlyEnemyPawnsOnFileBonus, numOnHalfOpenFiles);
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcRookScore()
+{
+   ScorePair score;
+
+   if (needsCalc<Rules::RookPieceValue>())
+      score += record<Rules::RookPieceValue>(calcPieceValue(rook(m_side)));
+   if (useRule<Rules::RookKingClosenessBonus>())
+      score += record<Rules::RookKingClosenessBonus>(
+         weigh(param::RookEnemyKingDistanceBonus, calcRookKingCloseness(m_side, m_pos)));
+   if (useRule<Rules::RookSeventhRankBonus>())
+      score += record<Rules::RookSeventhRankBonus>(
+         weigh(param::RookSeventhRankBonus, hasRookOnSeventhRank(m_side, m_pos)));
+   if (useRule<Rules::RookSharedFileBonus>())
+      score += record<Rules::RookSharedFileBonus>(
+         weigh(param::RookSharedFileBonus, haveRooksSharedFile(m_side, m_pos)));
+   if (useRule<Rules::RookPawnsOnFileBonus>())
+      score += record<Rules::RookPawnsOnFileBonus>(calcRookPawnsOnFileBonus());
 
    return score;
 }
 
 // Queens are awarded points for closeness to the enemy king.
-static double calcQueenKingClosenessBonus(Color side, const Position& pos)
+static int calcQueenKingCloseness(Color side, const Position& pos)
 {
    auto minDist = minDistanceToEnemyKing(queen(side), pos);
    if (!minDist)
-      return 0.;
+      return 0;
 
    // Higher bonus the closer the distance is.
-   return (MaxFRDistance - *minDist) * QueenEnemyKingDistanceBonus;
+   return MaxFRDistance - *minDist;
 }
 
 // A small bonus is awarded if a queen is on the same diagonal as a friendly bishop.
-static double calcQueenBishopDiagonalBonus(Color side, const Position& pos)
+static int countQueenBishopDiagonals(Color side, const Position& pos)
 {
    const Piece q = queen(side);
    const Piece b = bishop(side);
@@ -752,8 +556,8 @@ static double calcQueenBishopDiagonalBonus(Color side, const Position& pos)
                   [](Square sq) { return sq; });
 
    // For all queens calculate the bonus of shared diagonals with bishops.
-   return std::accumulate(pos.begin(q), pos.end(q), 0.,
-                          [&bishopSquares](double bonus, Square queenSq)
+   return std::accumulate(pos.begin(q), pos.end(q), 0,
+                          [&bishopSquares](int count, Square queenSq)
                           {
                              // Count shared diagonals with bishops.
                              auto numSharedDiags = std::count_if(
@@ -761,136 +565,443 @@ static double calcQueenBishopDiagonalBonus(Color side, const Position& pos)
                                 [queenSq](Square bishopSq)
                                 { return onSameDiagonal(bishopSq, queenSq); });
 
-                             return bonus + numSharedDiags * QueenBishopDiagonalBonus;
+                             return count + static_cast<int>(numSharedDiags);
                           });
 }
 
-double Score::calcQueenScore()
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcQueenScore()
 {
-   double score = 0.;
+   ScorePair score;
 
-   if (useRule(Rules::QueenPieceValue))
-      score += pvs::score(m_pos, queen(m_side), PieceValues);
-   if (useRule(Rules::QueenKingClosenessValue))
-      score += calcQueenKingClosenessBonus(m_side, m_pos);
-   if (useRule(Rules::QueenBishopDiagonalClosenessValue))
-      score += calcQueenBishopDiagonalBonus(m_side, m_pos);
+   if (needsCalc<Rules::QueenPieceValue>())
+      score += record<Rules::QueenPieceValue>(calcPieceValue(queen(m_side)));
+   if (useRule<Rules::QueenKingClosenessValue>())
+      score += record<Rules::QueenKingClosenessValue>(weigh(
+         param::QueenEnemyKingDistanceBonus, calcQueenKingCloseness(m_side, m_pos)));
+   if (useRule<Rules::QueenBishopDiagonalClosenessValue>())
+      score += record<Rules::QueenBishopDiagonalClosenessValue>(weigh(
+         param::QueenBishopDiagonalBonus, countQueenBishopDiagonals(m_side, m_pos)));
 
    return score;
 }
 
-static size_t countPiecesInQuadrant(Quadrant quad, Color side, const Position& pos,
-                                    size_t queenValue, size_t kingValue)
+static Bitboard quadrantMask(Quadrant quad)
 {
-   size_t count = 0;
-
-   const auto end = pos.end(side);
-   for (auto iter = pos.begin(side); iter != end; ++iter)
+   switch (quad)
    {
-      if (inQuadrant(iter.at(), quad))
-      {
-         Piece p = iter.piece();
-         // Queen can have custom value.
-         if (isQueen(p))
-            count += queenValue;
-         // King can have custom value - used to exclude it from own piece count.
-         else if (isKing(p))
-            count += kingValue;
-         else
-            count += 1;
-      }
+   case Quadrant::a1:
+      return 0x000000000f0f0f0full;
+   case Quadrant::a8:
+      return 0x00000000f0f0f0f0ull;
+   case Quadrant::h1:
+      return 0x0f0f0f0f00000000ull;
+   default:
+      return 0xf0f0f0f000000000ull;
    }
+}
 
-   return count;
+static size_t countPiecesInQuadrant(Quadrant quad, Color side, const Position& pos,
+                                    size_t queenValue, size_t kingValue)
+{
+   const Bitboard inQuad = pos.occupied(side) & quadrantMask(quad);
+   const Bitboard queens = inQuad & pos.occupied(queen(side));
+   const Bitboard kings = inQuad & pos.occupied(king(side));
+
+   // Queen can have custom value.
+   // King can have custom value - used to exclude it from own piece count.
+   return popCount(inQuad & ~(queens | kings)) + queenValue * popCount(queens) +
+          kingValue * popCount(kings);
 }
 
 // If the number of enemy pieces and pawns in the friendly king's board quadrant is
 // greater than the number of friendly pieces and pawns in the same quadrant, the side is
 // penalised the difference multiplied by five. When considering enemy presence in the
 // quadrant a queen is counted as three pieces.
-static double calcKingQuadrantPenality(Color side, const Position& pos)
+static int calcKingQuadrantExcess(Color side, const Position& pos)
 {
    const auto kingSq = pos.kingLocation(side);
    if (!kingSq)
-      return 0.;
+      return 0;
    // King has to be in quadrant on its side of the board.
    const Quadrant kingQuad = quadrant(*kingSq);
    if (!isFriendlyQuadrant(kingQuad, side))
-      return 0.;
+      return 0;
 
    const size_t numFriendly =
       countPiecesInQuadrant(kingQuad, side, pos, QueenValueInKingQuadrant, 0);
    const size_t numEnemy =
       countPiecesInQuadrant(kingQuad, !side, pos, QueenValueInKingQuadrant, 1);
    if (numEnemy <= numFriendly)
-      return 0.;
+      return 0;
 
-   return (numEnemy - numFriendly) * KingQuadrantPenaltyFactor;
+   return static_cast<int>(numEnemy - numFriendly);
 }
 
 // If a side has not castled and castling is no longer possible, that side is penalised.
 // If castling is still possible then a penalty is given if one of the rooks has
 // moved; more points for the king's rook than for the queen's rook.
-static double calcKingCastlingPenality(Color side, const Position& pos)
+// Returns the weight of the penalty, if any.
+static std::optional<param::Id> findKingCastlingPenalty(Color side, const Position& pos,
+                                                        const AttackInfo& attacks)
 {
-   const bool canCastleKingside = canCastle(side, true, pos);
-   const bool canCastleQueenside = canCastle(side, false, pos);
+   const bool canCastleKingside = canCastle(side, true, pos, attacks);
+   const bool canCastleQueenside = canCastle(side, false, pos, attacks);
    const bool canCastle = canCastleKingside || canCastleQueenside;
    const Position::CastlingState castleState = pos.castlingState(side);
 
    if (!canCastle && !castleState.hasCastled)
-      return KingNeverCastledPenality;
+      return param::KingNeverCastledPenalty;
 
    if (canCastle)
    {
       if (castleState.hasKingsideRookMoved)
-         return KingsideRookMovedBeforeCastlingPenality;
+         return param::KingsideRookMovedBeforeCastlingPenalty;
       else if (castleState.hasQueensideRookMoved)
-         return QueensideRookMovedBeforeCastlingPenality;
+         return param::QueensideRookMovedBeforeCastlingPenalty;
    }
 
-   return 0.;
+   return std::nullopt;
 }
 
-double Score::calcKingScore()
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcKingScore()
 {
-   double score = 0.;
+   ScorePair score;
 
-   if (useRule(Rules::KingPieceValue))
-      score += pvs::score(m_pos, king(m_side), PieceValues);
-   if (useRule(Rules::KingQuadrantPenalty))
-      score -= calcKingQuadrantPenality(m_side, m_pos);
-   if (useRule(Rules::KingCastlingPenalty))
-      score -= calcKingCastlingPenality(m_side, m_pos);
+   if (needsCalc<Rules::KingPieceValue>())
+      score += record<Rules::KingPieceValue>(calcPieceValue(king(m_side)));
+   if (useRule<Rules::KingQuadrantPenalty>())
+      score += record<Rules::KingQuadrantPenalty>(
+         weigh(param::KingQuadrantPenaltyFactor, -calcKingQuadrantExcess(m_side, m_pos)));
+   if (useRule<Rules::KingCastlingPenalty>())
+   {
+      if (const auto penalty = findKingCastlingPenalty(m_side, m_pos, m_attacks))
+         score += record<Rules::KingCastlingPenalty>(weigh(*penalty, -1));
+   }
 
    return score;
 }
 
-bool Score::useRule(Rules rule) const
+// Pieces are awarded a bonus for each square they can move to beyond the number of
+// squares they typically can move to and a penalty for each square less.
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair
+Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcMobilityBonus() const
 {
-   const uint64_t ruleFlag = static_cast<uint64_t>(rule);
-   return (static_cast<uint64_t>(m_rules) & ruleFlag) == ruleFlag;
+   const auto bonus = [&](Piece p, param::Id weight, int typicalMobility)
+   {
+      const int typical = typicalMobility * static_cast<int>(m_pos.count(p));
+      return weigh(weight, m_attacks.mobility(p) - typical);
+   };
+
+   return bonus(knight(m_side), param::KnightMobilityBonus, TypicalKnightMobility) +
+          bonus(bishop(m_side), param::BishopMobilityBonus, TypicalBishopMobility) +
+          bonus(rook(m_side), param::RookMobilityBonus, TypicalRookMobility) +
+          bonus(queen(m_side), param::QueenMobilityBonus, TypicalQueenMobility);
+}
+
+// A side is penalised for each attack of enemy pieces on the squares around its king
+// if at least two pieces take part in the attack. Squares attacked by more than one
+// enemy piece are penalised again.
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair
+Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcKingZoneAttackPenalty()
+   const
+{
+   if (m_attacks.kingZoneAttackers(m_side) < MinKingZoneAttackers)
+      return {};
+
+   const auto numDoubleAttacked = static_cast<int>(
+      popCount(m_attacks.doubleAttacks(!m_side) & m_attacks.kingZone(m_side)));
+   return weigh(param::KingZoneAttackPenalty, -m_attacks.kingZoneAttacks(m_side)) +
+          weigh(param::KingZoneDoubleAttackPenalty, -numDoubleAttacked);
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::calcAttackScore()
+{
+   ScorePair score;
+
+   if (useRule<Rules::MobilityBonus>())
+      score += record<Rules::MobilityBonus>(calcMobilityBonus());
+   if (useRule<Rules::KingZoneAttackPenalty>())
+      score += record<Rules::KingZoneAttackPenalty>(calcKingZoneAttackPenalty());
+
+   return score;
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+template <Rules Rule>
+bool Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::useRule() const
+{
+   if constexpr (!hasRules(Mask, Rule))
+      return false;
+   else if constexpr (HasRuntimeRules)
+      return hasRules(m_rules, Rule);
+   else
+      return true;
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+template <Rules Rule>
+bool Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::needsCalc() const
+{
+   return !usesRunningSums() && useRule<Rule>();
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+bool Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::usesRunningSums() const
+{
+   // The running sums can be used if all of their terms are used and have the default
+   // weights. Traced scorers calculate the terms to record them separately.
+   if constexpr (Traced)
+      return false;
+   else if constexpr (HasRuntimeWeights)
+      return useRule<SummedRules>() && m_weights.hasDefaultPieceSquares();
+   else
+      return useRule<SummedRules>();
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::weigh(param::Id id,
+                                                                  int count) const
+{
+   if constexpr (Traced)
+      m_trace->coefficients[id] += m_side == White ? count : -count;
+   if constexpr (HasRuntimeWeights)
+      return m_weights[id] * count;
+   else
+      return DefaultWeights[id] * count;
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+template <Rules Rule>
+ScorePair
+Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::record(ScorePair term) const
+{
+   if constexpr (Traced)
+      m_trace->terms[EvalTrace::colorIdx(m_side)][ruleIndex(Rule)] += term;
+   return term;
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights, bool Traced>
+ScorePair Scorer<Mask, HasRuntimeRules, HasRuntimeWeights, Traced>::record(Piece piece,
+                                                        ScorePair score) const
+{
+   if constexpr (Traced)
+      m_trace->pieceScores[static_cast<size_t>(piece)] += score;
+   return score;
 }
 
 ///////////////////
 
-double score(const Position& pos, const PositionStats& posStats, Color side, Rules rules)
+// Rules that need the scoring results of the pawn structure.
+constexpr Rules PawnStructureRules[] = {Rules::PassedPawnBonus, Rules::DoublePawnPenalty,
+                                        Rules::IsolatedPawnPenalty,
+                                        Rules::RookPawnsOnFileBonus};
+
+constexpr bool needsPawnEntry(Rules mask)
+{
+   for (Rules rule : PawnStructureRules)
+      if (hasRules(mask, rule))
+         return true;
+   return false;
+}
+
+// Returns the scoring results of the pawn structure. Masks without pawn structure rules
+// don't look up the structure.
+template <Rules Mask>
+static const PawnEntry& lookupPawnEntryFor(const Position& pos, PawnTable& table)
+{
+   if constexpr (needsPawnEntry(Mask))
+   {
+      return lookupPawnEntry(pos, table);
+   }
+   else
+   {
+      static const PawnEntry NoPawnEntry;
+      return NoPawnEntry;
+   }
+}
+
+// Rules that need the attacks of the position.
+constexpr Rules AttackRules[] = {Rules::KingCastlingPenalty, Rules::MobilityBonus,
+                                 Rules::KingZoneAttackPenalty};
+
+constexpr bool needsAttackInfo(Rules mask)
+{
+   for (Rules rule : AttackRules)
+      if (hasRules(mask, rule))
+         return true;
+   return false;
+}
+
+// Returns the attacks of a position. Masks without attack rules don't calculate them.
+template <Rules Mask> static AttackInfo makeAttackInfoFor(const Position& pos)
+{
+   if constexpr (needsAttackInfo(Mask))
+      return AttackInfo{pos};
+   else
+      return {};
+}
+
+template <Rules Mask, bool HasRuntimeRules, bool HasRuntimeWeights>
+static ScorePair scoreSide(const Position& pos, const PawnEntry& pawns,
+                           const AttackInfo& attacks, const Weights& weights, Color side,
+                           Rules rules)
+{
+   return Scorer<Mask, HasRuntimeRules, HasRuntimeWeights>{
+      pos, pawns, attacks, weights, side, rules}
+      .calc();
+}
+
+template <Rules Mask, bool HasRuntimeRules = false, bool HasRuntimeWeights = false>
+static Score scoreSides(const Position& pos, PawnTable& pawnTable,
+                        const Weights& weights = DefaultWeights, Rules rules = Mask)
+{
+   constexpr auto scoreSideFor = scoreSide<Mask, HasRuntimeRules, HasRuntimeWeights>;
+
+   // The pawn structure and the attacks are shared by the scorers of both sides.
+   const PawnEntry& pawns = lookupPawnEntryFor<Mask>(pos, pawnTable);
+   const AttackInfo attacks = makeAttackInfoFor<Mask>(pos);
+   const ScorePair score = scoreSideFor(pos, pawns, attacks, weights, White, rules) -
+                           scoreSideFor(pos, pawns, attacks, weights, Black, rules);
+   // Tapers the difference of the sides, so that rounding is the same for both colors.
+   return taper(score, pos.phase());
+}
+
+template <Rules Mask> Score score(const Position& pos, PawnTable& pawnTable)
+{
+   return scoreSides<Mask>(pos, pawnTable);
+}
+
+template <Rules Mask> Score score(const Position& pos)
+{
+   return scoreSides<Mask>(pos, pawnTable());
+}
+
+template Score score<Rules::All>(const Position& pos, PawnTable& pawnTable);
+template Score score<Rules::All>(const Position& pos);
+template Score score<SummedRules>(const Position& pos, PawnTable& pawnTable);
+template Score score<SummedRules>(const Position& pos);
+
+Score score(const Position& pos, Color side, Rules rules)
+{
+   const PawnEntry& pawns = lookupPawnEntry(pos, pawnTable());
+   const AttackInfo attacks{pos};
+   const ScorePair score =
+      rules == Rules::All
+         ? scoreSide<Rules::All, false, false>(pos, pawns, attacks, DefaultWeights,
+                                               side, rules)
+         : scoreSide<Rules::All, true, false>(pos, pawns, attacks, DefaultWeights, side,
+                                              rules);
+   return taper(score, pos.phase());
+}
+
+Score score(const Position& pos, PawnTable& pawnTable, Rules rules)
+{
+   // Uses the instances for fixed masks where possible.
+   if (rules == Rules::All)
+      return score<Rules::All>(pos, pawnTable);
+   else if (rules == SummedRules)
+      return score<SummedRules>(pos, pawnTable);
+   return scoreSides<Rules::All, true>(pos, pawnTable, DefaultWeights, rules);
+}
+
+Score score(const Position& pos, const Weights& weights, Rules rules)
+{
+   return score(pos, pawnTable(), weights, rules);
+}
+
+Score score(const Position& pos, PawnTable& pawnTable, const Weights& weights,
+            Rules rules)
+{
+   if (rules == Rules::All)
+      return scoreSides<Rules::All, false, true>(pos, pawnTable, weights);
+   return scoreSides<Rules::All, true, true>(pos, pawnTable, weights, rules);
+}
+
+Score score(const Position& pos, Rules rules)
+{
+   return score(pos, pawnTable(), rules);
+}
+
+EvalTrace traceScore(const Position& pos, const Weights& weights)
+{
+   using TracedScorer = Scorer<Rules::All, false, true, true>;
+
+   EvalTrace trace;
+   const PawnEntry& pawns = lookupPawnEntry(pos, pawnTable());
+   const AttackInfo attacks{pos};
+   const ScorePair score =
+      TracedScorer{pos, pawns, attacks, weights, White, Rules::All, &trace}.calc() -
+      TracedScorer{pos, pawns, attacks, weights, Black, Rules::All, &trace}.calc();
+   trace.phase = pos.phase();
+   trace.score = taper(score, trace.phase);
+   return trace;
+}
+
+std::string_view ruleName(Rules rule)
+{
+   // Indexed by rule index.
+   static constexpr std::array<std::string_view, NumRules> Names = {
+      "PawnPieceValue",
+      "PawnPositionBonus",
+      "PassedPawnBonus",
+      "DoublePawnPenalty",
+      "IsolatedPawnPenalty",
+      "KnightPieceValue",
+      "KnightCenterBonus",
+      "KnightKingClosenessBonus",
+      "BishopPieceValue",
+      "MultipleBishopBonus",
+      "BishopAdjacentPawnPenality",
+      "RookPieceValue",
+      "RookKingClosenessBonus",
+      "RookSeventhRankBonus",
+      "RookSharedFileBonus",
+      "RookPawnsOnFileBonus",
+      "QueenPieceValue",
+      "QueenKingClosenessValue",
+      "QueenBishopDiagonalClosenessValue",
+      "KingPieceValue",
+      "KingQuadrantPenalty",
+      "KingCastlingPenalty",
+      "MobilityBonus",
+      "KingZoneAttackPenalty",
+   };
+   return Names[ruleIndex(rule)];
+}
+
+Score summedScore(const Position& pos)
+{
+   return taper(pos.psqScore(White) - pos.psqScore(Black), pos.phase());
+}
+
+Score score(const Position& pos, Score alpha, Score beta)
 {
-   return Score{pos, posStats, side, rules}.calc();
+   assert(alpha < beta);
+   const Score summed = summedScore(pos);
+   if (isOutsideLazyWindow(summed, alpha, beta))
+      return summed;
+   return score(pos);
 }
 
-double score(const Position& pos, Rules rules)
+PawnTable& pawnTable()
 {
-   PositionStats posStats{pos};
-   return score(pos, posStats, White, rules) - score(pos, posStats, Black, rules);
+   thread_local PawnTable table;
+   return table;
 }
 
-double scoreMate(const Position& pos, size_t atDepth, Color side)
+Score scoreMate(const Position& /*pos*/, size_t atDepth, Color side)
 {
-   return pvs::scoreMate(pos, atDepth, side, PieceValues);
+   // Uses the common encoding of mate scores instead of the king value, so that mates
+   // always score beyond any position.
+   return matedScore(side, atDepth);
 }
 
-double scoreTie(const Position& pos, Color side)
+Score scoreTie(const Position& pos, Color side)
 {
    return pvs::scoreTie(pos, side, PieceValues);
 }
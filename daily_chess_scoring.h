@@ -3,12 +3,27 @@
 // MIT license
 //
 #pragma once
+#include "daily_chess_tables.h"
+#include "daily_chess_weights.h"
 #include "piece.h"
+#include "scoring.h"
+#include "square.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 namespace matt2
 {
 class Position;
+namespace dcs
+{
+class PawnTable;
 }
+} // namespace matt2
 
 // Scoring policy based on rules by Daily Chess website.
 // https://www.dailychess.com/rival/programming/evaluation.php
@@ -20,45 +35,180 @@ namespace dcs
 ///////////////////
 
 // Flags for individual scoring rules
-// Exposed to allow more focused unit testing.
+// Exposed to allow more focused unit testing. Each rule has its own bit, so that masks
+// of multiple rules never contain other rules.
 enum class Rules : uint64_t
 {
    // Pawn
-   PawnPieceValue = 0x01000001,
-   PawnPositionBonus = 0x01000002,
-   PassedPawnBonus = 0x01000004,
-   DoublePawnPenalty = 0x01000008,
-   IsolatedPawnPenalty = 0x01000010,
+   PawnPieceValue = 0x000001,
+   PawnPositionBonus = 0x000002,
+   PassedPawnBonus = 0x000004,
+   DoublePawnPenalty = 0x000008,
+   IsolatedPawnPenalty = 0x000010,
    // Knight
-   KnightPieceValue = 0x02000001,
-   KnightCenterBonus = 0x02000002,
-   KnightKingClosenessBonus = 0x02000004,
+   KnightPieceValue = 0x000020,
+   KnightCenterBonus = 0x000040,
+   KnightKingClosenessBonus = 0x000080,
    // Bishop
-   BishopPieceValue = 0x04000001,
-   MultipleBishopBonus = 0x04000002,
-   BishopAdjacentPawnPenality = 0x04000004,
+   BishopPieceValue = 0x000100,
+   MultipleBishopBonus = 0x000200,
+   BishopAdjacentPawnPenality = 0x000400,
    // Rook
-   RookPieceValue = 0x08000001,
-   RookKingClosenessBonus = 0x08000002,
-   RookSeventhRankBonus = 0x08000004,
-   RookSharedFileBonus = 0x08000008,
-   RookPawnsOnFileBonus = 0x08000010,
+   RookPieceValue = 0x000800,
+   RookKingClosenessBonus = 0x001000,
+   RookSeventhRankBonus = 0x002000,
+   RookSharedFileBonus = 0x004000,
+   RookPawnsOnFileBonus = 0x008000,
    // Queen
-   QueenPieceValue = 0x10000001,
-   QueenKingClosenessValue = 0x10000002,
-   QueenBishopDiagonalClosenessValue = 0x10000004,
+   QueenPieceValue = 0x010000,
+   QueenKingClosenessValue = 0x020000,
+   QueenBishopDiagonalClosenessValue = 0x040000,
    // King
-   KingPieceValue = 0x20000001,
-   KingQuadrantPenalty = 0x20000002,
-   KingCastlingPenalty = 0x20000004,
+   KingPieceValue = 0x080000,
+   KingQuadrantPenalty = 0x100000,
+   KingCastlingPenalty = 0x200000,
+   // Attacks
+   MobilityBonus = 0x400000,
+   KingZoneAttackPenalty = 0x800000,
    // All
    All = 0xffffffff
 };
 
-double score(const Position& pos, Color side, Rules rules = Rules::All);
-double score(const Position& pos, Rules rules = Rules::All);
-double scoreMate(const Position& pos, size_t atDepth, Color side);
-double scoreTie(const Position& pos, Color side);
+// Number of individual rules.
+constexpr std::size_t NumRules = 24;
+
+// Returns the index of an individual rule, i.e. the position of its bit.
+constexpr std::size_t ruleIndex(Rules rule)
+{
+   return static_cast<std::size_t>(std::countr_zero(static_cast<uint64_t>(rule)));
+}
+
+// Returns the rule of a given index.
+constexpr Rules ruleAt(std::size_t idx)
+{
+   assert(idx < NumRules);
+   return static_cast<Rules>(uint64_t{1} << idx);
+}
+
+static_assert(ruleIndex(Rules::KingZoneAttackPenalty) + 1 == NumRules);
+
+// Returns the name of an individual rule.
+std::string_view ruleName(Rules rule);
+
+// Checks if a mask contains all given rules.
+constexpr bool hasRules(Rules mask, Rules rules)
+{
+   const uint64_t flags = static_cast<uint64_t>(rules);
+   return (static_cast<uint64_t>(mask) & flags) == flags;
+}
+
+// Rules whose terms only depend on pieces and their squares, i.e. piece values and
+// position bonuses. Positions keep running sums of these terms.
+constexpr Rules SummedRules = static_cast<Rules>(
+   static_cast<uint64_t>(Rules::PawnPieceValue) |
+   static_cast<uint64_t>(Rules::PawnPositionBonus) |
+   static_cast<uint64_t>(Rules::KnightPieceValue) |
+   static_cast<uint64_t>(Rules::KnightCenterBonus) |
+   static_cast<uint64_t>(Rules::BishopPieceValue) |
+   static_cast<uint64_t>(Rules::RookPieceValue) |
+   static_cast<uint64_t>(Rules::QueenPieceValue) |
+   static_cast<uint64_t>(Rules::KingPieceValue));
+
+// Scores a position with a rule mask that is known at compile time. Checks of the rules
+// are compiled out, so reduced evaluators cost nothing for the rules they leave out.
+// The pawn structure is only looked up if the mask needs it. Instantiated for
+// Rules::All and for SummedRules, the evaluator of piece values and position bonuses.
+template <Rules Mask> Score score(const Position& pos, PawnTable& pawnTable);
+template <Rules Mask> Score score(const Position& pos);
+extern template Score score<Rules::All>(const Position& pos, PawnTable& pawnTable);
+extern template Score score<Rules::All>(const Position& pos);
+extern template Score score<SummedRules>(const Position& pos, PawnTable& pawnTable);
+extern template Score score<SummedRules>(const Position& pos);
+
+// Scores a position with rules that are given at runtime. Uses the instances for fixed
+// masks where possible and checks each rule otherwise.
+Score score(const Position& pos, Color side, Rules rules = Rules::All);
+Score score(const Position& pos, Rules rules = Rules::All);
+// Scores a position with a given table for the results of pawn structures. The other
+// overloads use the table of the calling thread.
+Score score(const Position& pos, PawnTable& pawnTable, Rules rules = Rules::All);
+// Scores a position with given weights. The other overloads use the default weights.
+Score score(const Position& pos, const Weights& weights, Rules rules = Rules::All);
+// Scores a position with given weights and a given table for pawn structures.
+Score score(const Position& pos, PawnTable& pawnTable, const Weights& weights,
+            Rules rules = Rules::All);
+Score scoreMate(const Position& pos, size_t atDepth, Color side);
+Score scoreTie(const Position& pos, Color side);
+
+// Returns the pawn structure table of the calling thread.
+PawnTable& pawnTable();
+
+// Lazy evaluation.
+// Scores of the terms that positions keep running sums of, i.e. piece values and
+// position bonuses, are available without visiting the pieces. The other terms are
+// small in comparison. Full scores are expected to differ from the summed score by at
+// most the lazy margin. The margin is checked against the full scores of the positions
+// of the perft suite trees. The largest difference found there is 116.
+constexpr Score LazyMargin = 150;
+
+// Returns the score of the summed terms of a position.
+Score summedScore(const Position& pos);
+
+// Checks if a summed score is beyond a search window (alpha, beta) by more than the
+// lazy margin, so that the full score is beyond the window as well.
+constexpr bool isOutsideLazyWindow(Score summed, Score alpha, Score beta)
+{
+   return summed + LazyMargin <= alpha || summed - LazyMargin >= beta;
+}
+
+// Scores a position for a search window (alpha, beta) from white's point of view.
+// If the summed score is outside the window by more than the lazy margin, it is
+// returned as a bound instead of the full score. Otherwise the full score is returned.
+Score score(const Position& pos, Score alpha, Score beta);
+
+// Evaluation trace.
+// Breakdown of the score of a position into the terms of the individual rules. Traces are
+// recorded by separate instances of the scorers, so that scoring without trace does not
+// pay for it. Meant for debugging evaluation.
+struct EvalTrace
+{
+   static constexpr std::size_t colorIdx(Color side) { return side == White ? 0 : 1; }
+
+   ScorePair term(Color side, Rules rule) const
+   {
+      return terms[colorIdx(side)][ruleIndex(rule)];
+   }
+   ScorePair pieceScore(Piece piece) const
+   {
+      return pieceScores[static_cast<std::size_t>(piece)];
+   }
+
+   // Terms of each rule for each side before tapering. Penalties are negative.
+   std::array<std::array<ScorePair, NumRules>, 2> terms{};
+   // Sum of the terms of the rules for each kind of piece, indexed by piece. The
+   // mobility and king zone attack terms are not part of any piece's score.
+   std::array<ScorePair, 12> pieceScores{};
+   // Number of times that each weight is applied, white's minus black's. The score is
+   // the tapered sum of the weights multiplied by their coefficients, apart from the
+   // king values, which cancel out.
+   std::array<int, param::NumParams> coefficients{};
+   int phase = 0;
+   // Tapered score from white's point of view. Same as the score without trace.
+   Score score = 0;
+};
+
+// Scores a position with all rules and records the terms in a trace.
+EvalTrace traceScore(const Position& pos, const Weights& weights = DefaultWeights);
+
+///////////////////
+
+// Interpolates between the middlegame and endgame scores of a pair for a given phase.
+// Phases above the max phase, e.g. after promotions, count as middlegame.
+constexpr Score taper(ScorePair score, int phase)
+{
+   const int mgPhase = std::min(phase, MaxPhase);
+   return (score.mg() * mgPhase + score.eg() * (MaxPhase - mgPhase)) / MaxPhase;
+}
 
 } // namespace dcs
 } // namespace matt2
@@ -0,0 +1,167 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "piece.h"
+#include "scoring.h"
+#include "square.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Piece-square values and phase weights of the scoring rules based on the Daily Chess
+// website. Positions keep running sums of them without depending on the scoring.
+
+namespace matt2
+{
+namespace dcs
+{
+///////////////////
+
+// Default weights of the terms that only depend on a piece and its square, i.e. piece
+// values and position bonuses. Positions keep running sums of them for each color, so
+// that scoring with the default weights does not have to visit each piece for these
+// terms.
+
+// Piece values.
+constexpr int16_t KingValue = 10000;
+constexpr int16_t QueenValue = 900;
+constexpr int16_t RookValue = 500;
+constexpr int16_t BishopValue = 340;
+constexpr int16_t KnightValue = 325;
+constexpr int16_t PawnValue = 100;
+
+// Scores indexed by square.
+using SquareTable = std::array<int16_t, 64>;
+
+struct SquareScore
+{
+   Square sq;
+   int16_t score = 0;
+};
+
+// Builds a table from scores of individual squares. Squares without score get zero.
+template <std::size_t N>
+constexpr SquareTable makeSquareTable(const SquareScore (&scores)[N])
+{
+   SquareTable table{};
+   for (const SquareScore& entry : scores)
+      table[static_cast<std::size_t>(entry.sq)] = entry.score;
+   return table;
+}
+
+constexpr int16_t lookup(const SquareTable& table, Square sq)
+{
+   return table[static_cast<std::size_t>(sq)];
+}
+
+// Position bonuses of white pieces. The bonuses of black pieces are the same for the
+// squares mirrored along the middle of the board.
+
+// Pawn position bonus.
+// clang-format off
+constexpr SquareTable PawnPosScore = makeSquareTable({
+   {a2, 0}, {b2, 0},  {c2, 0},  {d2, 0},  {e2, 0},  {f2, 0},  {g2, 0},  {h2, 0},
+   {a3, 0}, {b3, 2},  {c3, 12}, {d3, 22}, {e3, 22}, {f3, 12}, {g3, 2},  {h3, 0},
+   {a4, 0}, {b4, 4},  {c4, 14}, {d4, 24}, {e4, 24}, {f4, 14}, {g4, 4},  {h4, 0},
+   {a5, 0}, {b5, 6},  {c5, 16}, {d5, 26}, {e5, 26}, {f5, 16}, {g5, 6},  {h5, 0},
+   {a6, 0}, {b6, 8},  {c6, 18}, {d6, 28}, {e6, 28}, {f6, 18}, {g6, 8},  {h6, 0},
+   {a7, 0}, {b7, 10}, {c7, 20}, {d7, 30}, {e7, 30}, {f7, 20}, {g7, 10}, {h7, 0},
+});
+// clang-format on
+
+// Knight center bonus.
+// clang-format off
+constexpr SquareTable KnightPosScore = makeSquareTable({
+   {a1, -14}, {b1, -7}, {c1, -7}, {d1, -7}, {e1, -7}, {f1, -7}, {g1, -7}, {h1, -14},
+   {a2, -7},  {b2, 0},  {c2, 0},  {d2, 0},  {e2, 0},  {f2, 0},  {g2, 0},  {h2, -7},
+   {a3, -7},  {b3, 0},  {c3, 4},  {d3, 4},  {e3, 4},  {f3, 4},  {g3, 0},  {h3, -7},
+   {a4, -7},  {b4, 0},  {c4, 4},  {d4, 7},  {e4, 7},  {f4, 4},  {g4, 0},  {h4, -7},
+   {a5, -7},  {b5, 0},  {c5, 4},  {d5, 7},  {e5, 7},  {f5, 4},  {g5, 0},  {h5, -7},
+   {a6, -7},  {b6, 0},  {c6, 4},  {d6, 4},  {e6, 4},  {f6, 4},  {g6, 0},  {h6, -7},
+   {a7, -7},  {b7, 0},  {c7, 0},  {d7, 0},  {e7, 0},  {f7, 0},  {g7, 0},  {h7, -7},
+   {a8, -14}, {b8, -7}, {c8, -7}, {d8, -7}, {e8, -7}, {f8, -7}, {g8, -7}, {h8, -14},
+});
+// clang-format on
+
+constexpr SquareTable mirrorRanks(const SquareTable& table)
+{
+   SquareTable mirrored{};
+   for (std::size_t i = 0; i < mirrored.size(); ++i)
+      mirrored[i] = lookup(table, flipRank(static_cast<Square>(i)));
+   return mirrored;
+}
+
+// Position bonuses indexed by piece and square.
+using PieceSquareTables = std::array<SquareTable, 12>;
+
+constexpr PieceSquareTables makePositionScores()
+{
+   PieceSquareTables tables{};
+   tables[static_cast<std::size_t>(Pw)] = PawnPosScore;
+   tables[static_cast<std::size_t>(Pb)] = mirrorRanks(PawnPosScore);
+   tables[static_cast<std::size_t>(Nw)] = KnightPosScore;
+   tables[static_cast<std::size_t>(Nb)] = mirrorRanks(KnightPosScore);
+   return tables;
+}
+
+inline constexpr PieceSquareTables PositionScores = makePositionScores();
+
+constexpr int16_t materialValue(Piece piece)
+{
+   constexpr std::array<int16_t, 6> Values = {KingValue,   QueenValue,  RookValue,
+                                              BishopValue, KnightValue, PawnValue};
+   // Indexed by piece enum value with the color stripped off.
+   return Values[static_cast<std::size_t>(piece) % Values.size()];
+}
+
+constexpr int16_t positionValue(Piece piece, Square at)
+{
+   return lookup(PositionScores[static_cast<std::size_t>(piece)], at);
+}
+
+// Combined piece values and position bonuses indexed by piece and square. The rules do
+// not distinguish between game phases, so both phases have the same score.
+using PieceSquareValues = std::array<std::array<ScorePair, 64>, 12>;
+
+constexpr PieceSquareValues makePieceSquareValues()
+{
+   PieceSquareValues values{};
+   for (std::size_t p = 0; p < values.size(); ++p)
+   {
+      const Piece piece = static_cast<Piece>(p);
+      for (std::size_t sq = 0; sq < values[p].size(); ++sq)
+         values[p][sq] =
+            ScorePair{materialValue(piece) + positionValue(piece, static_cast<Square>(sq))};
+   }
+   return values;
+}
+
+inline constexpr PieceSquareValues PieceSquareScores = makePieceSquareValues();
+
+constexpr ScorePair pieceSquareValue(Piece piece, Square at)
+{
+   return PieceSquareScores[static_cast<std::size_t>(piece)][static_cast<std::size_t>(at)];
+}
+
+///////////////////
+
+// Game phase.
+// Each term has a middlegame and an endgame weight. Scores are interpolated between
+// both by the phase of the game, which is derived from the pieces on the board. The
+// phase starts at MaxPhase for the full set of pieces and drops to zero when only kings
+// and pawns are left. Positions keep the phase up to date as pieces are added and
+// removed.
+
+constexpr int MaxPhase = 24;
+
+constexpr uint8_t phaseWeight(Piece piece)
+{
+   // Indexed by piece enum value with the color stripped off.
+   constexpr std::array<uint8_t, 6> Weights = {0, 4, 2, 1, 1, 0};
+   return Weights[static_cast<std::size_t>(piece) % Weights.size()];
+}
+
+} // namespace dcs
+} // namespace matt2
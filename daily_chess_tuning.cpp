@@ -0,0 +1,576 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "daily_chess_tuning.h"
+#include "daily_chess_scoring.h"
+#include "fen.h"
+#include "position.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+using namespace matt2;
+using namespace matt2::dcs;
+
+
+namespace
+{
+///////////////////
+
+uint8_t packCastlingState(const Position::CastlingState& state)
+{
+   return static_cast<uint8_t>(state.hasKingMoved | (state.hasKingsideRookMoved << 1) |
+                               (state.hasQueensideRookMoved << 2) |
+                               (state.hasCastled << 3));
+}
+
+Position::CastlingState unpackCastlingState(uint8_t bits)
+{
+   return {(bits & 1) != 0, (bits & 2) != 0, (bits & 4) != 0, (bits & 8) != 0};
+}
+
+///////////////////
+
+// Characters that can enclose or terminate the result of a line.
+constexpr std::string_view ResultDecoration = "[](){}\"';,";
+
+std::optional<GameResult> readResult(std::string_view field)
+{
+   const std::size_t start = field.find_first_not_of(ResultDecoration);
+   if (start == std::string_view::npos)
+      return std::nullopt;
+   const std::size_t end = field.find_last_not_of(ResultDecoration);
+   field = field.substr(start, end - start + 1);
+
+   if (field == "1-0" || field == "1.0" || field == "1")
+      return GameResult::Win;
+   if (field == "0-1" || field == "0.0" || field == "0")
+      return GameResult::Loss;
+   if (field == "1/2-1/2" || field == "0.5")
+      return GameResult::Draw;
+   return std::nullopt;
+}
+
+// Reads the FEN record at the start of a line and the result in its last field.
+// Fields between both, e.g. EPD operations, are ignored. Returns nothing if the line is
+// invalid.
+std::optional<GameResult> readLine(std::string_view line, Position& pos)
+{
+   constexpr std::string_view Whitespace = " \t\r";
+
+   const std::size_t resultEnd = line.find_last_not_of(Whitespace);
+   if (resultEnd == std::string_view::npos)
+      return std::nullopt;
+   line = line.substr(0, resultEnd + 1);
+   const std::size_t fenEnd = line.find_last_of(Whitespace);
+   if (fenEnd == std::string_view::npos)
+      return std::nullopt;
+
+   const auto result = readResult(line.substr(fenEnd + 1));
+   if (!result)
+      return std::nullopt;
+
+   try
+   {
+      readFenPrefix(line.substr(0, fenEnd), pos);
+   }
+   catch (const std::runtime_error&)
+   {
+      return std::nullopt;
+   }
+   return result;
+}
+
+///////////////////
+
+// Adam parameters.
+constexpr double Beta1 = 0.9;
+constexpr double Beta2 = 0.999;
+constexpr double Epsilon = 1e-8;
+// Fixed part of the seed of the order of the positions in each epoch.
+constexpr uint64_t ShuffleSeed = 0x7e8e11d5a3c4f961;
+
+constexpr std::string_view CheckpointHeader = "texel-checkpoint";
+constexpr int CheckpointVersion = 1;
+
+// Expected result of a position from white's point of view.
+double sigmoid(double score, double scale)
+{
+   return 1. / (1. + std::pow(10., -scale * score / 400.));
+}
+
+// Returns the share of the middlegame weights in the tapered score of a phase.
+double middlegameFactor(int phase)
+{
+   return static_cast<double>(std::min(phase, MaxPhase)) / static_cast<double>(MaxPhase);
+}
+
+// Scores a position from its trace with real-valued weights.
+double evaluate(const EvalTrace& trace, const std::vector<double>& params)
+{
+   const double mgFactor = middlegameFactor(trace.phase);
+   double mg = 0.;
+   double eg = 0.;
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+   {
+      if (const int coeff = trace.coefficients[i]; coeff != 0)
+      {
+         mg += coeff * params[2 * i];
+         eg += coeff * params[2 * i + 1];
+      }
+   }
+   return mg * mgFactor + eg * (1. - mgFactor);
+}
+
+Score roundWeight(double value)
+{
+   constexpr double MaxWeight = std::numeric_limits<int16_t>::max();
+   return static_cast<Score>(std::lround(std::clamp(value, -MaxWeight, MaxWeight)));
+}
+
+[[noreturn]] void throwInvalidCheckpoint(const std::string& path)
+{
+   throw std::runtime_error("Invalid checkpoint file " + path + ".");
+}
+
+} // namespace
+
+
+namespace matt2
+{
+namespace dcs
+{
+///////////////////
+
+bool pack(const Position& pos, GameResult result, PackedPosition& packed)
+{
+   packed = PackedPosition{};
+   packed.occupied = pos.occupied();
+   if (popCount(packed.occupied) > MaxPackedPieces)
+      return false;
+
+   Bitboard occupied = packed.occupied;
+   for (std::size_t i = 0; occupied != EmptyBB; ++i)
+   {
+      const auto piece = static_cast<uint8_t>(*pos[popLowestSquare(occupied)]);
+      packed.pieces[i / 2] |= static_cast<uint8_t>(piece << (4 * (i % 2)));
+   }
+
+   const uint8_t white = packCastlingState(pos.castlingState(White));
+   const uint8_t black = packCastlingState(pos.castlingState(Black));
+   packed.castling = static_cast<uint8_t>(white | (black << 4));
+   packed.result = result;
+   return true;
+}
+
+
+void unpack(const PackedPosition& packed, Position& pos)
+{
+   pos.clear();
+
+   Bitboard occupied = packed.occupied;
+   for (std::size_t i = 0; occupied != EmptyBB; ++i)
+   {
+      const uint8_t pieceBits = (packed.pieces[i / 2] >> (4 * (i % 2))) & 0xf;
+      pos.add(Placement{static_cast<Piece>(pieceBits), popLowestSquare(occupied)});
+   }
+
+   pos.setCastlingState(White, unpackCastlingState(packed.castling & 0xf));
+   pos.setCastlingState(Black, unpackCastlingState(packed.castling >> 4));
+}
+
+///////////////////
+
+TuningSet TuningSet::load(const std::string& path, ThreadPool& pool)
+{
+   // Lines are read on the calling thread and parsed on the pool in chunks of this
+   // number of lines per task.
+   constexpr std::size_t LinesPerTask = 16384;
+
+   std::ifstream in{path};
+   if (!in)
+      throw std::runtime_error("Failed to open tuning set " + path + ".");
+
+   const std::size_t numTasks = pool.size();
+   std::vector<std::string> lines(numTasks * LinesPerTask);
+   std::vector<TuningSet> parts(numTasks);
+
+   TuningSet set;
+   while (in)
+   {
+      std::size_t numLines = 0;
+      while (numLines < lines.size() && std::getline(in, lines[numLines]))
+         ++numLines;
+
+      pool.run(numTasks,
+               [&](std::size_t taskIdx)
+               {
+                  TuningSet& part = parts[taskIdx];
+                  part.m_positions.clear();
+                  part.m_numSkipped = 0;
+
+                  Position pos;
+                  const auto [first, last] = taskRange(0, numLines, taskIdx, numTasks);
+                  for (std::size_t i = first; i < last; ++i)
+                  {
+                     if (lines[i].find_first_not_of(" \t\r") == std::string::npos)
+                        continue;
+                     const auto result = readLine(lines[i], pos);
+                     if (!result || !part.add(pos, *result))
+                        ++part.m_numSkipped;
+                  }
+               });
+
+      for (const TuningSet& part : parts)
+      {
+         set.m_positions.insert(set.m_positions.end(), part.m_positions.begin(),
+                                part.m_positions.end());
+         set.m_numSkipped += part.m_numSkipped;
+      }
+   }
+
+   if (in.bad())
+      throw std::runtime_error("Failed to read tuning set " + path + ".");
+   return set;
+}
+
+
+bool TuningSet::add(const Position& pos, GameResult result)
+{
+   // Positions without kings cannot be scored.
+   if (!pos.kingLocation(White) || !pos.kingLocation(Black))
+      return false;
+
+   PackedPosition packed;
+   if (!pack(pos, result, packed))
+      return false;
+   m_positions.push_back(packed);
+   return true;
+}
+
+///////////////////
+
+TexelTuner::TexelTuner(const TuningSet& set, ThreadPool& pool, const Weights& start,
+                       std::size_t batchSize, double learningRate)
+: m_set{set}, m_pool{pool}, m_batchSize{batchSize}, m_learningRate{learningRate},
+  m_params(2 * param::NumParams), m_moments(2 * param::NumParams),
+  m_velocities(2 * param::NumParams), m_taskGradients(pool.size()),
+  m_taskErrors(pool.size())
+{
+   assert(m_batchSize > 0);
+   if (m_set.size() > std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error("Too many positions for tuning.");
+
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+   {
+      const ScorePair weight = start[static_cast<param::Id>(i)];
+      m_params[2 * i] = weight.mg();
+      m_params[2 * i + 1] = weight.eg();
+   }
+   for (Params& gradient : m_taskGradients)
+      gradient.resize(2 * param::NumParams);
+}
+
+
+double TexelTuner::fitScale()
+{
+   // Bounds of the search for the scale. The error is assumed to have a single minimum
+   // between them.
+   constexpr double MinScale = 0.;
+   constexpr double MaxScale = 10.;
+   constexpr std::size_t NumIterations = 60;
+
+   // The scores don't depend on the scale, so they are calculated once.
+   m_order.resize(m_set.size());
+   for (std::size_t i = 0; i < m_order.size(); ++i)
+      m_order[i] = static_cast<uint32_t>(i);
+   calcScores(0, m_set.size());
+
+   const auto errorFor = [this](double scale)
+   {
+      m_scale = scale;
+      return calcError();
+   };
+
+   // Golden section search.
+   const double ratio = (std::sqrt(5.) - 1.) / 2.;
+   double low = MinScale;
+   double high = MaxScale;
+   double a = high - ratio * (high - low);
+   double b = low + ratio * (high - low);
+   double errorA = errorFor(a);
+   double errorB = errorFor(b);
+   for (std::size_t i = 0; i < NumIterations; ++i)
+   {
+      if (errorA < errorB)
+      {
+         high = b;
+         b = a;
+         errorB = errorA;
+         a = high - ratio * (high - low);
+         errorA = errorFor(a);
+      }
+      else
+      {
+         low = a;
+         a = b;
+         errorA = errorB;
+         b = low + ratio * (high - low);
+         errorB = errorFor(b);
+      }
+   }
+
+   m_scale = (low + high) / 2.;
+   return m_scale;
+}
+
+
+double TexelTuner::error()
+{
+   m_order.resize(m_set.size());
+   for (std::size_t i = 0; i < m_order.size(); ++i)
+      m_order[i] = static_cast<uint32_t>(i);
+   calcScores(0, m_set.size());
+   return calcError();
+}
+
+
+void TexelTuner::runEpoch()
+{
+   shuffle();
+   for (std::size_t first = 0; first < m_set.size(); first += m_batchSize)
+   {
+      calcGradient(first, std::min(first + m_batchSize, m_set.size()));
+      applyGradient();
+   }
+   ++m_epoch;
+}
+
+
+Weights TexelTuner::weights() const
+{
+   Weights weights = DefaultWeights;
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+      weights.set(static_cast<param::Id>(i), ScorePair{roundWeight(m_params[2 * i]),
+                                                       roundWeight(m_params[2 * i + 1])});
+   return weights;
+}
+
+
+void TexelTuner::saveCheckpoint(const std::string& path) const
+{
+   const std::string tmpPath = path + ".tmp";
+   {
+      std::ofstream out{tmpPath, std::ios::trunc};
+      if (!out)
+         throw std::runtime_error("Failed to create checkpoint file " + tmpPath + ".");
+
+      out << std::setprecision(std::numeric_limits<double>::max_digits10);
+      out << CheckpointHeader << ' ' << CheckpointVersion << '\n';
+      out << "epoch " << m_epoch << '\n';
+      out << "step " << m_step << '\n';
+      out << "scale " << m_scale << '\n';
+      for (std::size_t i = 0; i < param::NumParams; ++i)
+      {
+         out << param::name(static_cast<param::Id>(i));
+         for (const Params* values : {&m_params, &m_moments, &m_velocities})
+            out << ' ' << (*values)[2 * i] << ' ' << (*values)[2 * i + 1];
+         out << '\n';
+      }
+
+      if (!out)
+         throw std::runtime_error("Failed to write checkpoint file " + tmpPath + ".");
+   }
+
+   std::error_code err;
+   std::filesystem::rename(tmpPath, path, err);
+   if (err)
+      throw std::runtime_error("Failed to replace checkpoint file " + path + ".");
+}
+
+
+void TexelTuner::loadCheckpoint(const std::string& path)
+{
+   std::ifstream in{path};
+   if (!in)
+      throw std::runtime_error("Failed to open checkpoint file " + path + ".");
+
+   std::string header;
+   int version = 0;
+   std::string epochLabel, stepLabel, scaleLabel;
+   std::size_t epoch = 0;
+   std::size_t step = 0;
+   double scale = 0.;
+   if (!(in >> header >> version >> epochLabel >> epoch >> stepLabel >> step >>
+         scaleLabel >> scale) ||
+       header != CheckpointHeader || version != CheckpointVersion ||
+       epochLabel != "epoch" || stepLabel != "step" || scaleLabel != "scale")
+      throwInvalidCheckpoint(path);
+
+   Params params(2 * param::NumParams);
+   Params moments(2 * param::NumParams);
+   Params velocities(2 * param::NumParams);
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+   {
+      std::string name;
+      if (!(in >> name) || name != param::name(static_cast<param::Id>(i)))
+         throwInvalidCheckpoint(path);
+      for (Params* values : {&params, &moments, &velocities})
+      {
+         if (!(in >> (*values)[2 * i] >> (*values)[2 * i + 1]))
+            throwInvalidCheckpoint(path);
+      }
+   }
+
+   std::string rest;
+   if (in >> rest)
+      throwInvalidCheckpoint(path);
+
+   m_epoch = epoch;
+   m_step = step;
+   m_scale = scale;
+   m_params = std::move(params);
+   m_moments = std::move(moments);
+   m_velocities = std::move(velocities);
+}
+
+
+void TexelTuner::calcScores(std::size_t first, std::size_t last)
+{
+   m_scores.resize(m_set.size());
+   const std::size_t numTasks = m_pool.size();
+   m_pool.run(numTasks,
+              [&](std::size_t taskIdx)
+              {
+                 Position pos;
+                 const auto [taskFirst, taskLast] =
+                    taskRange(first, last, taskIdx, numTasks);
+                 for (std::size_t i = taskFirst; i < taskLast; ++i)
+                 {
+                    unpack(m_set[m_order[i]], pos);
+                    m_scores[i] = static_cast<float>(evaluate(traceScore(pos), m_params));
+                 }
+              });
+}
+
+
+double TexelTuner::calcError()
+{
+   if (m_set.size() == 0)
+      return 0.;
+
+   const std::size_t numTasks = m_pool.size();
+   m_pool.run(numTasks,
+              [&](std::size_t taskIdx)
+              {
+                 double error = 0.;
+                 const auto [first, last] = taskRange(0, m_set.size(), taskIdx, numTasks);
+                 for (std::size_t i = first; i < last; ++i)
+                 {
+                    const double diff = toScore(m_set[m_order[i]].result) -
+                                        sigmoid(m_scores[i], m_scale);
+                    error += diff * diff;
+                 }
+                 m_taskErrors[taskIdx] = error;
+              });
+
+   double error = 0.;
+   for (double taskError : m_taskErrors)
+      error += taskError;
+   return error / static_cast<double>(m_set.size());
+}
+
+
+void TexelTuner::calcGradient(std::size_t first, std::size_t last)
+{
+   // Derivative of the sigmoid without the factor of sigmoid * (1 - sigmoid).
+   const double sigmoidFactor = m_scale * std::log(10.) / 400.;
+   // Derivative of the mean of the squared errors.
+   const double errorFactor = 2. / static_cast<double>(last - first);
+
+   const std::size_t numTasks = m_pool.size();
+   m_pool.run(numTasks,
+              [&](std::size_t taskIdx)
+              {
+                 Params& gradient = m_taskGradients[taskIdx];
+                 std::fill(gradient.begin(), gradient.end(), 0.);
+
+                 Position pos;
+                 const auto [taskFirst, taskLast] =
+                    taskRange(first, last, taskIdx, numTasks);
+                 for (std::size_t i = taskFirst; i < taskLast; ++i)
+                 {
+                    const PackedPosition& packed = m_set[m_order[i]];
+                    unpack(packed, pos);
+                    const EvalTrace trace = traceScore(pos);
+
+                    const double expected = sigmoid(evaluate(trace, m_params), m_scale);
+                    const double delta = errorFactor *
+                                         (expected - toScore(packed.result)) * expected *
+                                         (1. - expected) * sigmoidFactor;
+                    const double mgFactor = middlegameFactor(trace.phase);
+
+                    for (std::size_t p = 0; p < param::NumParams; ++p)
+                    {
+                       if (const int coeff = trace.coefficients[p]; coeff != 0)
+                       {
+                          gradient[2 * p] += delta * coeff * mgFactor;
+                          gradient[2 * p + 1] += delta * coeff * (1. - mgFactor);
+                       }
+                    }
+                 }
+              });
+
+   // Sum up the gradients of all tasks in the first one.
+   Params& gradient = m_taskGradients[0];
+   for (std::size_t t = 1; t < numTasks; ++t)
+      for (std::size_t i = 0; i < gradient.size(); ++i)
+         gradient[i] += m_taskGradients[t][i];
+}
+
+
+void TexelTuner::applyGradient()
+{
+   ++m_step;
+   const double step = static_cast<double>(m_step);
+   const double momentCorrection = 1. - std::pow(Beta1, step);
+   const double velocityCorrection = 1. - std::pow(Beta2, step);
+
+   const Params& gradient = m_taskGradients[0];
+   for (std::size_t i = 0; i < m_params.size(); ++i)
+   {
+      m_moments[i] = Beta1 * m_moments[i] + (1. - Beta1) * gradient[i];
+      m_velocities[i] =
+         Beta2 * m_velocities[i] + (1. - Beta2) * gradient[i] * gradient[i];
+      const double moment = m_moments[i] / momentCorrection;
+      const double velocity = m_velocities[i] / velocityCorrection;
+      m_params[i] -= m_learningRate * moment / (std::sqrt(velocity) + Epsilon);
+   }
+}
+
+
+void TexelTuner::shuffle()
+{
+   m_order.resize(m_set.size());
+   for (std::size_t i = 0; i < m_order.size(); ++i)
+      m_order[i] = static_cast<uint32_t>(i);
+
+   // Shuffles with the engine directly instead of std::shuffle, whose results differ
+   // between standard libraries.
+   std::mt19937_64 rng{ShuffleSeed + m_epoch};
+   for (std::size_t i = m_order.size(); i > 1; --i)
+      std::swap(m_order[i - 1], m_order[rng() % i]);
+}
+
+} // namespace dcs
+} // namespace matt2
@@ -0,0 +1,177 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "bitboard.h"
+#include "daily_chess_weights.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace matt2
+{
+class Position;
+class ThreadPool;
+}
+
+// Tuning of the weights of the dcs rules (Texel tuning).
+// The score of a position is mapped to an expected game result by a sigmoid. The
+// weights are adjusted to minimize the squared difference between the expected and the
+// actual results of a large set of positions taken from played games. The score is a
+// linear function of the weights, so its gradient is given by the coefficients of the
+// weights in the evaluation trace.
+
+namespace matt2
+{
+namespace dcs
+{
+///////////////////
+
+// Results of games from white's point of view in halves of a point.
+enum class GameResult : uint8_t
+{
+   Loss = 0,
+   Draw = 1,
+   Win = 2
+};
+
+constexpr double toScore(GameResult result)
+{
+   return static_cast<double>(result) / 2.;
+}
+
+
+// Position of a tuning set packed into 32 bytes, so that sets of tens of millions of
+// positions fit into memory. Holds what the rules need to score the position and the
+// result of the game it was taken from.
+struct PackedPosition
+{
+   // Squares with pieces.
+   Bitboard occupied = EmptyBB;
+   // Pieces of the occupied squares in square order, two to a byte.
+   std::array<uint8_t, 16> pieces{};
+   // Castling states of white and black, four bits each.
+   uint8_t castling = 0;
+   GameResult result = GameResult::Draw;
+
+   friend bool operator==(const PackedPosition& a, const PackedPosition& b) = default;
+};
+
+// Positions with more than 32 pieces cannot be packed.
+constexpr std::size_t MaxPackedPieces = 32;
+
+// Packs a position. Returns false if it has too many pieces.
+bool pack(const Position& pos, GameResult result, PackedPosition& packed);
+// Unpacks a position into a given position, whose previous pieces are replaced.
+void unpack(const PackedPosition& packed, Position& pos);
+
+///////////////////
+
+// Positions with known game results to tune weights with.
+class TuningSet
+{
+ public:
+   // Reads positions from a text file. Each line holds a FEN record followed by the
+   // result of the game as 1-0, 0-1, 1/2-1/2, 1.0, 0.5 or 0.0. The result may be
+   // enclosed in brackets or quotes. Lines are parsed in chunks on the threads of the
+   // pool. Lines with invalid positions or results are skipped. Throws
+   // std::runtime_error if the file cannot be read.
+   static TuningSet load(const std::string& path, ThreadPool& pool);
+
+   // Returns false if the position cannot be packed or has no kings.
+   bool add(const Position& pos, GameResult result);
+
+   std::size_t size() const { return m_positions.size(); }
+   const PackedPosition& operator[](std::size_t idx) const { return m_positions[idx]; }
+   // Number of lines that were skipped when loading.
+   std::size_t numSkipped() const { return m_numSkipped; }
+
+ private:
+   std::vector<PackedPosition> m_positions;
+   std::size_t m_numSkipped = 0;
+};
+
+///////////////////
+
+// Tunes weights with mini-batch gradient descent (Adam). Gradients of the positions of
+// each batch are calculated in parallel on the threads of a pool. The weights are kept
+// as real numbers while tuning and are rounded when taken out.
+class TexelTuner
+{
+ public:
+   static constexpr std::size_t DefaultBatchSize = 16384;
+   // In centipawns.
+   static constexpr double DefaultLearningRate = 1.;
+
+ public:
+   TexelTuner(const TuningSet& set, ThreadPool& pool,
+              const Weights& start = DefaultWeights,
+              std::size_t batchSize = DefaultBatchSize,
+              double learningRate = DefaultLearningRate);
+
+   // Sets the scale of the sigmoid to the value that fits the results of the set best
+   // for the current weights. Should be called before tuning, so that the weights keep
+   // their scale of centipawns.
+   double fitScale();
+   double scale() const { return m_scale; }
+   void setScale(double scale) { m_scale = scale; }
+
+   // Mean squared error of the expected results of the set for the current weights.
+   double error();
+   // Makes one pass over the set in shuffled batches and adjusts the weights after each
+   // batch.
+   void runEpoch();
+   // Number of finished epochs.
+   std::size_t epoch() const { return m_epoch; }
+   Weights weights() const;
+
+   // Saves the state of the tuning into a file, so that it can be resumed. The file is
+   // replaced only after the state has been written completely. Throws
+   // std::runtime_error if the file cannot be written.
+   void saveCheckpoint(const std::string& path) const;
+   // Restores the state of the tuning from a file. Throws std::runtime_error if the
+   // file cannot be read or is not a valid checkpoint.
+   void loadCheckpoint(const std::string& path);
+
+ private:
+   // Real-valued weights, middlegame and endgame weight of each parameter after each
+   // other.
+   using Params = std::vector<double>;
+
+   // Calculates the scores of the positions in a range of the current order.
+   void calcScores(std::size_t first, std::size_t last);
+   // Mean squared error of the set for the calculated scores.
+   double calcError();
+   // Sums up the gradient of the error for a batch of positions of the current order.
+   void calcGradient(std::size_t first, std::size_t last);
+   // Adjusts the weights by the gradient of the last batch.
+   void applyGradient();
+   void shuffle();
+
+ private:
+   const TuningSet& m_set;
+   ThreadPool& m_pool;
+   std::size_t m_batchSize = DefaultBatchSize;
+   double m_learningRate = DefaultLearningRate;
+   double m_scale = 1.;
+   Params m_params;
+   // Adam moments of each parameter.
+   Params m_moments;
+   Params m_velocities;
+   std::size_t m_epoch = 0;
+   std::size_t m_step = 0;
+   // Order of the positions in the current epoch. Depends only on the epoch, so that
+   // resumed tuning visits the positions in the same order.
+   std::vector<uint32_t> m_order;
+   // Scratch space of the tasks that work on a batch.
+   std::vector<Params> m_taskGradients;
+   std::vector<double> m_taskErrors;
+   // Scores of the positions in the current order.
+   std::vector<float> m_scores;
+};
+
+} // namespace dcs
+} // namespace matt2
@@ -0,0 +1,178 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "daily_chess_weights.h"
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+using namespace matt2;
+using namespace matt2::dcs;
+
+
+namespace
+{
+///////////////////
+
+// Names of the weights that are not position bonuses. Indexed by id.
+constexpr std::array<std::string_view, param::PawnPositionBonus> Names = {
+   "PawnValue",
+   "KnightValue",
+   "BishopValue",
+   "RookValue",
+   "QueenValue",
+   "DoublePawnPenalty",
+   "IsolatedPawnPenalty",
+   "PassedPawnRankFactor",
+   "KnightEnemyKingDistanceBonus",
+   "MultipleBishopBonus",
+   "BishopAdjacentPawnPenalty",
+   "RookEnemyKingDistanceBonus",
+   "RookSeventhRankBonus",
+   "RookSharedFileBonus",
+   "RookNoPawnsOnFileBonus",
+   "RookOnlyEnemyPawnsOnFileBonus",
+   "QueenEnemyKingDistanceBonus",
+   "QueenBishopDiagonalBonus",
+   "KingQuadrantPenaltyFactor",
+   "KingNeverCastledPenalty",
+   "KingsideRookMovedBeforeCastlingPenalty",
+   "QueensideRookMovedBeforeCastlingPenalty",
+   "KnightMobilityBonus",
+   "BishopMobilityBonus",
+   "RookMobilityBonus",
+   "QueenMobilityBonus",
+   "KingZoneAttackPenalty",
+   "KingZoneDoubleAttackPenalty",
+};
+
+constexpr bool isPieceSquareWeight(param::Id id)
+{
+   return id <= param::QueenValue || id >= param::PawnPositionBonus;
+}
+
+std::unordered_map<std::string, param::Id> makeIdsByName()
+{
+   std::unordered_map<std::string, param::Id> ids;
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+   {
+      const auto id = static_cast<param::Id>(i);
+      ids[param::name(id)] = id;
+   }
+   return ids;
+}
+
+[[noreturn]] void throwInvalidLine(const std::string& path, std::size_t lineNumber)
+{
+   throw std::runtime_error("Invalid weight in line " + std::to_string(lineNumber) +
+                            " of " + path + ".");
+}
+
+bool isInScoreRange(long value)
+{
+   constexpr long MaxWeight = std::numeric_limits<int16_t>::max();
+   return value >= -MaxWeight && value <= MaxWeight;
+}
+
+} // namespace
+
+
+namespace matt2
+{
+namespace dcs
+{
+///////////////////
+
+std::string param::name(Id id)
+{
+   assert(id < NumParams);
+   if (id < PawnPositionBonus)
+      return std::string{Names[id]};
+
+   const bool isPawnBonus = id < KnightPositionBonus;
+   const Id first = isPawnBonus ? PawnPositionBonus : KnightPositionBonus;
+   const auto at = static_cast<Square>(id - first);
+   return (isPawnBonus ? "PawnPositionBonus." : "KnightPositionBonus.") + toString(at);
+}
+
+///////////////////
+
+Weights Weights::load(const std::string& path)
+{
+   std::ifstream in{path};
+   if (!in)
+      throw std::runtime_error("Failed to open weights file " + path + ".");
+
+   static const std::unordered_map<std::string, param::Id> IdsByName = makeIdsByName();
+
+   Weights weights = DefaultWeights;
+   std::string line;
+   std::size_t lineNumber = 0;
+   while (std::getline(in, line))
+   {
+      ++lineNumber;
+      std::istringstream is{line};
+      std::string name;
+      if (!(is >> name) || name[0] == '#')
+         continue;
+
+      long mg = 0;
+      long eg = 0;
+      std::string rest;
+      if (!(is >> mg >> eg) || (is >> rest) || !isInScoreRange(mg) ||
+          !isInScoreRange(eg))
+         throwInvalidLine(path, lineNumber);
+
+      const auto pos = IdsByName.find(name);
+      if (pos == IdsByName.end())
+         throwInvalidLine(path, lineNumber);
+      weights.set(pos->second, ScorePair{static_cast<Score>(mg), static_cast<Score>(eg)});
+   }
+
+   if (in.bad())
+      throw std::runtime_error("Failed to read weights file " + path + ".");
+   return weights;
+}
+
+
+void Weights::save(const std::string& path) const
+{
+   std::ofstream out{path, std::ios::trunc};
+   if (!out)
+      throw std::runtime_error("Failed to create weights file " + path + ".");
+
+   out << "# name middlegame endgame\n";
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+   {
+      const auto id = static_cast<param::Id>(i);
+      out << param::name(id) << ' ' << m_values[id].mg() << ' ' << m_values[id].eg()
+          << '\n';
+   }
+
+   if (!out)
+      throw std::runtime_error("Failed to write weights file " + path + ".");
+}
+
+
+void Weights::set(param::Id id, ScorePair weight)
+{
+   assert(id < param::NumParams);
+   m_values[id] = weight;
+   if (!isPieceSquareWeight(id))
+      return;
+
+   m_hasDefaultPieceSquares = true;
+   for (std::size_t i = 0; i < param::NumParams && m_hasDefaultPieceSquares; ++i)
+   {
+      const auto other = static_cast<param::Id>(i);
+      if (isPieceSquareWeight(other) && m_values[other] != DefaultWeights[other])
+         m_hasDefaultPieceSquares = false;
+   }
+}
+
+} // namespace dcs
+} // namespace matt2
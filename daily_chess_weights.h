@@ -0,0 +1,236 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "daily_chess_tables.h"
+#include "piece.h"
+#include "scoring.h"
+#include "square.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Weights of the scoring rules based on the Daily Chess website.
+// The rules take their weights from a parameter block at runtime, so that the weights
+// can be fitted to game data. The defaults are the weights given by the website.
+
+namespace matt2
+{
+namespace dcs
+{
+///////////////////
+
+// Default weights of the other terms. Weights are pairs of middlegame and endgame
+// values. The original rules use the same weights for the whole game. Endgame weights
+// differ where the rules don't fit endgames: king safety does not matter once the
+// attacking pieces are gone and passed pawns become more valuable.
+
+// Pawn scoring
+constexpr ScorePair DoublePawnPenality{7};
+constexpr ScorePair IsolatedPawnPenality{2};
+constexpr ScorePair PassedPawnRankFactor{1, 2};
+
+// Knight scoring
+constexpr ScorePair KnightEnemyKingDistanceBonus{1};
+
+// Bishop scoring
+constexpr ScorePair MultipleBishopBonus{20};
+constexpr ScorePair BishopAdjacentPawnPenality{5};
+
+// Rook scoring
+constexpr ScorePair RookEnemyKingDistanceBonus{5};
+constexpr ScorePair RookSeventhRankBonus{20};
+constexpr ScorePair RookSharedFileBonus{15};
+constexpr ScorePair RookNoPawnsOnFileBonus{10};
+constexpr ScorePair RookOnlyEnemyPawnsOnFileBonus{3};
+
+// Queen scoring
+constexpr ScorePair QueenEnemyKingDistanceBonus{5};
+constexpr ScorePair QueenBishopDiagonalBonus{1};
+
+// King scoring
+constexpr ScorePair KingQuadrantPenaltyFactor{5, 0};
+constexpr ScorePair KingNeverCastledPenality{15, 0};
+constexpr ScorePair KingsideRookMovedBeforeCastlingPenality{12, 0};
+constexpr ScorePair QueensideRookMovedBeforeCastlingPenality{8, 0};
+
+// Attack scoring
+// Not part of the original rules.
+constexpr ScorePair KnightMobilityBonus{4, 4};
+constexpr ScorePair BishopMobilityBonus{3, 3};
+constexpr ScorePair RookMobilityBonus{2, 4};
+constexpr ScorePair QueenMobilityBonus{1, 2};
+constexpr ScorePair KingZoneAttackPenalty{3, 0};
+constexpr ScorePair KingZoneDoubleAttackPenalty{4, 0};
+
+///////////////////
+// Parameter block.
+
+namespace param
+{
+
+// Indices of the weights in a parameter block. The king value is not a weight because
+// both sides always have their king. Position bonuses have a weight for each square of
+// a white piece. Black pieces use the weight of the square mirrored along the middle of
+// the board.
+enum Id : std::size_t
+{
+   // Piece values
+   PawnValue,
+   KnightValue,
+   BishopValue,
+   RookValue,
+   QueenValue,
+   // Pawn
+   DoublePawnPenalty,
+   IsolatedPawnPenalty,
+   PassedPawnRankFactor,
+   // Knight
+   KnightEnemyKingDistanceBonus,
+   // Bishop
+   MultipleBishopBonus,
+   BishopAdjacentPawnPenalty,
+   // Rook
+   RookEnemyKingDistanceBonus,
+   RookSeventhRankBonus,
+   RookSharedFileBonus,
+   RookNoPawnsOnFileBonus,
+   RookOnlyEnemyPawnsOnFileBonus,
+   // Queen
+   QueenEnemyKingDistanceBonus,
+   QueenBishopDiagonalBonus,
+   // King
+   KingQuadrantPenaltyFactor,
+   KingNeverCastledPenalty,
+   KingsideRookMovedBeforeCastlingPenalty,
+   QueensideRookMovedBeforeCastlingPenalty,
+   // Attacks
+   KnightMobilityBonus,
+   BishopMobilityBonus,
+   RookMobilityBonus,
+   QueenMobilityBonus,
+   KingZoneAttackPenalty,
+   KingZoneDoubleAttackPenalty,
+   // Position bonuses, one for each square
+   PawnPositionBonus,
+   KnightPositionBonus = PawnPositionBonus + 64,
+   NumParams = KnightPositionBonus + 64
+};
+
+// Returns the id of the value of a piece. Kings have no value weight.
+constexpr Id pieceValue(Piece piece)
+{
+   assert(!isKing(piece));
+   // Indexed by piece enum value with the color stripped off.
+   constexpr std::array<Id, 6> Ids = {NumParams,   QueenValue,  RookValue,
+                                      BishopValue, KnightValue, PawnValue};
+   return Ids[static_cast<std::size_t>(piece) % Ids.size()];
+}
+
+constexpr bool hasPositionBonus(Piece piece)
+{
+   return isPawn(piece) || isKnight(piece);
+}
+
+// Returns the id of the position bonus of a pawn or knight on a square.
+constexpr Id positionBonus(Piece piece, Square at)
+{
+   assert(hasPositionBonus(piece));
+   const Square whiteSq = isWhite(piece) ? at : flipRank(at);
+   const Id first = isPawn(piece) ? PawnPositionBonus : KnightPositionBonus;
+   return static_cast<Id>(first + static_cast<std::size_t>(whiteSq));
+}
+
+// Returns the name of a weight. Position bonuses are named after their square, e.g.
+// KnightPositionBonus.e4.
+std::string name(Id id);
+
+} // namespace param
+
+
+// Middlegame and endgame weights of all scoring terms.
+class Weights
+{
+ public:
+   // All weights are zero.
+   constexpr Weights() = default;
+   // Weights given by the Daily Chess website.
+   static constexpr Weights makeDefaults();
+
+   // Reads weights from a text file. Each line holds the name of a weight followed by
+   // its middlegame and endgame values. Empty lines and lines starting with '#' are
+   // skipped. Weights that are not in the file keep their defaults. Throws
+   // std::runtime_error if the file cannot be read or has invalid lines.
+   static Weights load(const std::string& path);
+   // Writes all weights into a file that can be loaded. Throws std::runtime_error if
+   // the file cannot be written.
+   void save(const std::string& path) const;
+
+   constexpr ScorePair operator[](param::Id id) const { return m_values[id]; }
+   void set(param::Id id, ScorePair weight);
+
+   // Checks if the piece values and position bonuses are the defaults, so that the
+   // running sums of positions can be used for them.
+   constexpr bool hasDefaultPieceSquares() const { return m_hasDefaultPieceSquares; }
+
+   friend constexpr bool operator==(const Weights& a, const Weights& b) = default;
+
+ private:
+   std::array<ScorePair, param::NumParams> m_values{};
+   bool m_hasDefaultPieceSquares = false;
+};
+
+///////////////////
+
+constexpr Weights Weights::makeDefaults()
+{
+   Weights weights;
+   auto& w = weights.m_values;
+
+   for (Piece piece : {Qw, Rw, Bw, Nw, Pw})
+      w[param::pieceValue(piece)] = ScorePair{materialValue(piece)};
+
+   w[param::DoublePawnPenalty] = DoublePawnPenality;
+   w[param::IsolatedPawnPenalty] = IsolatedPawnPenality;
+   w[param::PassedPawnRankFactor] = PassedPawnRankFactor;
+   w[param::KnightEnemyKingDistanceBonus] = KnightEnemyKingDistanceBonus;
+   w[param::MultipleBishopBonus] = MultipleBishopBonus;
+   w[param::BishopAdjacentPawnPenalty] = BishopAdjacentPawnPenality;
+   w[param::RookEnemyKingDistanceBonus] = RookEnemyKingDistanceBonus;
+   w[param::RookSeventhRankBonus] = RookSeventhRankBonus;
+   w[param::RookSharedFileBonus] = RookSharedFileBonus;
+   w[param::RookNoPawnsOnFileBonus] = RookNoPawnsOnFileBonus;
+   w[param::RookOnlyEnemyPawnsOnFileBonus] = RookOnlyEnemyPawnsOnFileBonus;
+   w[param::QueenEnemyKingDistanceBonus] = QueenEnemyKingDistanceBonus;
+   w[param::QueenBishopDiagonalBonus] = QueenBishopDiagonalBonus;
+   w[param::KingQuadrantPenaltyFactor] = KingQuadrantPenaltyFactor;
+   w[param::KingNeverCastledPenalty] = KingNeverCastledPenality;
+   w[param::KingsideRookMovedBeforeCastlingPenalty] =
+      KingsideRookMovedBeforeCastlingPenality;
+   w[param::QueensideRookMovedBeforeCastlingPenalty] =
+      QueensideRookMovedBeforeCastlingPenality;
+   w[param::KnightMobilityBonus] = KnightMobilityBonus;
+   w[param::BishopMobilityBonus] = BishopMobilityBonus;
+   w[param::RookMobilityBonus] = RookMobilityBonus;
+   w[param::QueenMobilityBonus] = QueenMobilityBonus;
+   w[param::KingZoneAttackPenalty] = KingZoneAttackPenalty;
+   w[param::KingZoneDoubleAttackPenalty] = KingZoneDoubleAttackPenalty;
+
+   for (std::size_t sq = 0; sq < 64; ++sq)
+   {
+      const auto at = static_cast<Square>(sq);
+      w[param::positionBonus(Pw, at)] = ScorePair{positionValue(Pw, at)};
+      w[param::positionBonus(Nw, at)] = ScorePair{positionValue(Nw, at)};
+   }
+
+   weights.m_hasDefaultPieceSquares = true;
+   return weights;
+}
+
+inline constexpr Weights DefaultWeights = Weights::makeDefaults();
+
+} // namespace dcs
+} // namespace matt2
@@ -9,6 +9,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <iterator>
+#include <limits>
 #ifdef VS_COMPILER
 #include <malloc.h>
 #endif
@@ -1270,7 +1271,7 @@ template <typename T, std::size_t N> void swap(SboVector<T, N>& a, SboVector<T,
 // Const iterator for SboVector.
 template <typename T, std::size_t N> class SboVectorConstIterator
 {
-   template <typename T, std::size_t N> friend class SboVector;
+   template <typename U, std::size_t M> friend class SboVector;
 
  public:
    using SV = SboVector<T, N>;
@@ -1463,10 +1464,10 @@ SboVectorConstIterator<T, N>::operator-=(difference_type offset)
 template <typename T, std::size_t N>
 class SboVectorIterator : public SboVectorConstIterator<T, N>
 {
-   template <typename T, std::size_t N> friend class SboVector;
+   template <typename U, std::size_t M> friend class SboVector;
 
  public:
-   using SboVectorConstIterator<T, N>::SV;
+   using SV = typename SboVectorConstIterator<T, N>::SV;
    using iterator_category = std::random_access_iterator_tag;
    using value_type = typename SV::value_type;
    using difference_type = typename SV::difference_type;
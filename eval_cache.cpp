@@ -0,0 +1,105 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "eval_cache.h"
+#include <algorithm>
+#include <limits>
+
+
+namespace
+{
+///////////////////
+
+// Returns the counter slot of the calling thread. Slots are handed out to threads in
+// the order in which they first use a cache.
+std::size_t threadSlot(std::size_t numSlots)
+{
+   static std::atomic<std::size_t> nextSlot{0};
+   thread_local const std::size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+   return slot % numSlots;
+}
+
+} // namespace
+
+
+namespace matt2
+{
+///////////////////
+
+EvalCache::EvalCache(std::size_t sizeMB)
+{
+   // Use the largest power of two number of entries that fits into the size.
+   const std::size_t maxEntries =
+      std::max<std::size_t>(sizeMB * 1024 * 1024 / sizeof(std::atomic<uint64_t>), 1);
+   std::size_t numEntries = 1;
+   while (numEntries * 2 <= maxEntries)
+      numEntries *= 2;
+
+   m_entries = std::make_unique<std::atomic<uint64_t>[]>(numEntries);
+   m_indexMask = numEntries - 1;
+}
+
+
+std::optional<Score> EvalCache::probe(uint64_t key)
+{
+   const uint64_t data = entry(key).load(std::memory_order_relaxed);
+   if ((data & ~ScoreMask) != (key & ~ScoreMask))
+   {
+      threadCounters().misses.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+   }
+
+   threadCounters().hits.fetch_add(1, std::memory_order_relaxed);
+   return static_cast<int16_t>(static_cast<uint16_t>(data & ScoreMask));
+}
+
+
+void EvalCache::store(uint64_t key, Score score)
+{
+   // Scores that do not fit are not cached. Evaluations are always in range.
+   if (score < std::numeric_limits<int16_t>::min() ||
+       score > std::numeric_limits<int16_t>::max())
+      return;
+
+   const uint64_t data = (key & ~ScoreMask) | (static_cast<uint64_t>(score) & ScoreMask);
+   entry(key).store(data, std::memory_order_relaxed);
+}
+
+
+void EvalCache::clear()
+{
+   for (std::size_t i = 0; i < size(); ++i)
+      m_entries[i].store(0, std::memory_order_relaxed);
+   for (Counters& counters : m_counters)
+   {
+      counters.hits.store(0, std::memory_order_relaxed);
+      counters.misses.store(0, std::memory_order_relaxed);
+   }
+}
+
+
+uint64_t EvalCache::hits() const
+{
+   uint64_t sum = 0;
+   for (const Counters& counters : m_counters)
+      sum += counters.hits.load(std::memory_order_relaxed);
+   return sum;
+}
+
+
+uint64_t EvalCache::misses() const
+{
+   uint64_t sum = 0;
+   for (const Counters& counters : m_counters)
+      sum += counters.misses.load(std::memory_order_relaxed);
+   return sum;
+}
+
+
+EvalCache::Counters& EvalCache::threadCounters()
+{
+   return m_counters[threadSlot(NumCounterSlots)];
+}
+
+} // namespace matt2
@@ -0,0 +1,67 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "scoring.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+
+namespace matt2
+{
+///////////////////
+
+// Fixed-size cache for the scores of positions keyed by position hash.
+// Can be shared between threads without locking. Each entry packs the upper bits of
+// its key and its score into a single word that is read and written atomically, so
+// entries are never seen half written. Entries are replaced unconditionally.
+class EvalCache
+{
+ public:
+   // Size of the cache in MB. The number of entries is rounded down to a power of two.
+   explicit EvalCache(std::size_t sizeMB);
+
+   // Returns the cached score for a key or nothing if the key is not cached.
+   std::optional<Score> probe(uint64_t key);
+   // Scores outside of the 16 bit range are not stored.
+   void store(uint64_t key, Score score);
+   // Removes all entries and resets the counters. Must not be called while other
+   // threads use the cache.
+   void clear();
+
+   std::size_t size() const { return m_indexMask + 1; }
+   // Sums of the counters of all threads.
+   uint64_t hits() const;
+   uint64_t misses() const;
+
+ private:
+   // Scores fit into the lower bits of an entry. The other bits hold the key.
+   static constexpr uint64_t ScoreBits = 16;
+   static constexpr uint64_t ScoreMask = (uint64_t{1} << ScoreBits) - 1;
+
+   // Number of counter slots. Threads beyond that share slots.
+   static constexpr std::size_t NumCounterSlots = 16;
+
+   // Counters of the threads that use a slot. Each slot is on its own cache line, so
+   // threads never contend for their counters.
+   struct alignas(64) Counters
+   {
+      std::atomic<uint64_t> hits{0};
+      std::atomic<uint64_t> misses{0};
+   };
+
+   std::atomic<uint64_t>& entry(uint64_t key) { return m_entries[key & m_indexMask]; }
+   Counters& threadCounters();
+
+ private:
+   std::unique_ptr<std::atomic<uint64_t>[]> m_entries;
+   uint64_t m_indexMask = 0;
+   std::array<Counters, NumCounterSlots> m_counters;
+};
+
+} // namespace matt2
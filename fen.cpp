@@ -0,0 +1,140 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "fen.h"
+#include "position.h"
+#include "square.h"
+#include <charconv>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+using fenimpl::FenFieldDelimCh;
+using fenimpl::FenRankDelimCh;
+constexpr char NoneCh = '-';
+
+// FEN characters of the pieces indexed by the piece enum value.
+constexpr char PieceChars[] = "KQRBNPkqrbnp";
+
+
+char toFenChar(Piece piece)
+{
+   return PieceChars[static_cast<std::size_t>(piece)];
+}
+
+
+void writePlacements(std::string& out, const Position& pos)
+{
+   for (int r = 7; r >= 0; --r)
+   {
+      int numEmpty = 0;
+      for (int f = 0; f < 8; ++f)
+      {
+         const auto piece = pos[makeSquare(static_cast<File>(f), static_cast<Rank>(r))];
+         if (!piece)
+         {
+            ++numEmpty;
+            continue;
+         }
+
+         if (numEmpty > 0)
+            out += static_cast<char>('0' + numEmpty);
+         numEmpty = 0;
+         out += toFenChar(*piece);
+      }
+
+      if (numEmpty > 0)
+         out += static_cast<char>('0' + numEmpty);
+      if (r > 0)
+         out += FenRankDelimCh;
+   }
+}
+
+
+bool hasCastlingRight(const Position& pos, Color side, bool onKingside)
+{
+   const Square kingAt = side == White ? e1 : e8;
+   const Square rookAt =
+      onKingside ? (side == White ? h1 : h8) : (side == White ? a1 : a8);
+   return !pos.hasKingMoved(side) && !pos.hasRookMoved(side, onKingside) &&
+          pos[kingAt] == king(side) && pos[rookAt] == rook(side);
+}
+
+
+void writeCastlingRights(std::string& out, const Position& pos)
+{
+   const std::size_t start = out.size();
+   if (hasCastlingRight(pos, White, true))
+      out += 'K';
+   if (hasCastlingRight(pos, White, false))
+      out += 'Q';
+   if (hasCastlingRight(pos, Black, true))
+      out += 'k';
+   if (hasCastlingRight(pos, Black, false))
+      out += 'q';
+   if (out.size() == start)
+      out += NoneCh;
+}
+
+
+void writeEnPassantSquare(std::string& out, const Position& pos)
+{
+   const auto pawnAt = pos.enPassantSquare();
+   if (!pawnAt)
+   {
+      out += NoneCh;
+      return;
+   }
+
+   // The square behind the pawn that can be taken.
+   out += toChar(file(*pawnAt));
+   out += toChar(rank(*pawnAt) == r4 ? r3 : r6);
+}
+
+
+void writeCounter(std::string& out, unsigned value)
+{
+   char buffer[16];
+   const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+   out.append(buffer, end);
+}
+
+} // namespace
+
+
+namespace matt2
+{
+///////////////////
+
+std::string& writeFen(std::string& out, const Position& pos, const FenState& state)
+{
+   out.clear();
+   writePlacements(out, pos);
+   out += FenFieldDelimCh;
+   out += state.sideToMove == White ? 'w' : 'b';
+   out += FenFieldDelimCh;
+   writeCastlingRights(out, pos);
+   out += FenFieldDelimCh;
+   writeEnPassantSquare(out, pos);
+   out += FenFieldDelimCh;
+   writeCounter(out, state.halfmoveClock);
+   out += FenFieldDelimCh;
+   writeCounter(out, state.fullmoveNumber);
+   return out;
+}
+
+
+std::string toFen(const Position& pos, const FenState& state)
+{
+   std::string fen;
+   // Longest possible record fits without reallocating.
+   fen.reserve(90);
+   return writeFen(fen, pos, state);
+}
+
+} // namespace matt2
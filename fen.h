@@ -0,0 +1,344 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "piece.h"
+#include "placement.h"
+#include "position.h"
+#include "square.h"
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+
+namespace matt2
+{
+///////////////////
+
+// Game state of a FEN record that is not part of a position.
+struct FenState
+{
+   Color sideToMove = White;
+   // Number of plies since the last capture or pawn move.
+   unsigned halfmoveClock = 0;
+   // Number of the full move, starting at one and incremented after black's move.
+   unsigned fullmoveNumber = 1;
+
+   friend bool operator==(const FenState& a, const FenState& b) = default;
+};
+
+// FEN record of the initial position.
+constexpr std::string_view StartFen =
+   "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Reads a position and its game state from a record in Forsyth-Edwards Notation.
+// The given position is cleared and refilled, so that reading many records into the
+// same position does not allocate. The halfmove clock and fullmove number fields are
+// optional and default to zero and one.
+// Can be evaluated at compile time. Throws std::runtime_error for invalid records.
+constexpr FenState readFen(std::string_view fen, Position& pos);
+// Reads a position and its game state from the FEN record at the start of a line.
+// What follows the record, e.g. EPD operations or a game result, is ignored. Fields
+// after the en-passant square are only taken as move counters if they are numbers.
+// Throws std::runtime_error for invalid records.
+constexpr FenState readFenPrefix(std::string_view line, Position& pos);
+// Returns the position of a FEN record. Can be used to build positions at compile
+// time.
+constexpr Position makeFenPosition(std::string_view fen);
+
+// Writes the FEN record of a position into a given string and returns it. The string's
+// previous content is replaced but its memory is reused.
+std::string& writeFen(std::string& out, const Position& pos, const FenState& state);
+std::string toFen(const Position& pos, const FenState& state);
+
+
+///////////////////
+// Implementation of FEN reading.
+
+namespace fenimpl
+{
+
+constexpr char FenFieldDelimCh = ' ';
+constexpr char FenRankDelimCh = '/';
+
+[[noreturn]] inline void throwInvalidFen(const char* reason)
+{
+   throw std::runtime_error(reason);
+}
+
+// Returns the next field of a record and removes it from the remaining record.
+// Returns an empty field if no fields are left.
+constexpr std::string_view nextFenField(std::string_view& rest)
+{
+   const std::size_t start = rest.find_first_not_of(FenFieldDelimCh);
+   if (start == std::string_view::npos)
+   {
+      rest = {};
+      return {};
+   }
+
+   const std::size_t end = rest.find(FenFieldDelimCh, start);
+   const std::string_view field = rest.substr(start, end - start);
+   rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end);
+   return field;
+}
+
+constexpr std::optional<Piece> pieceFromFenChar(char ch)
+{
+   switch (ch)
+   {
+   case 'K':
+      return Kw;
+   case 'Q':
+      return Qw;
+   case 'R':
+      return Rw;
+   case 'B':
+      return Bw;
+   case 'N':
+      return Nw;
+   case 'P':
+      return Pw;
+   case 'k':
+      return Kb;
+   case 'q':
+      return Qb;
+   case 'r':
+      return Rb;
+   case 'b':
+      return Bb;
+   case 'n':
+      return Nb;
+   case 'p':
+      return Pb;
+   default:
+      return std::nullopt;
+   }
+}
+
+constexpr void readFenPlacements(std::string_view field, Position& pos)
+{
+   // Ranks are listed from the 8th to the 1st, files from a to h.
+   int r = 7;
+   int f = 0;
+   for (char ch : field)
+   {
+      if (ch == FenRankDelimCh)
+      {
+         if (f != 8 || r == 0)
+            throwInvalidFen("Invalid rank in FEN.");
+         --r;
+         f = 0;
+      }
+      else if (ch >= '1' && ch <= '8')
+      {
+         f += ch - '0';
+         if (f > 8)
+            throwInvalidFen("Invalid rank in FEN.");
+      }
+      else
+      {
+         const auto piece = pieceFromFenChar(ch);
+         if (!piece || f >= 8)
+            throwInvalidFen("Invalid piece placement in FEN.");
+         const Square at = makeSquare(static_cast<File>(f), static_cast<Rank>(r));
+         pos.add(Placement{*piece, at});
+         ++f;
+      }
+   }
+
+   if (r != 0 || f != 8)
+      throwInvalidFen("Invalid number of ranks in FEN.");
+}
+
+constexpr Color readFenSideToMove(std::string_view field)
+{
+   if (field == "w")
+      return White;
+   if (field == "b")
+      return Black;
+   throwInvalidFen("Invalid side to move in FEN.");
+}
+
+constexpr void readFenCastlingRights(std::string_view field, Position& pos)
+{
+   // Kingside and queenside rights of white and black.
+   bool rights[2][2] = {};
+   if (field != "-")
+   {
+      for (char ch : field)
+      {
+         switch (ch)
+         {
+         case 'K':
+            rights[0][0] = true;
+            break;
+         case 'Q':
+            rights[0][1] = true;
+            break;
+         case 'k':
+            rights[1][0] = true;
+            break;
+         case 'q':
+            rights[1][1] = true;
+            break;
+         default:
+            throwInvalidFen("Invalid castling rights in FEN.");
+         }
+      }
+   }
+
+   // Rights can only be taken away from the state derived from the placements. A right
+   // for a king or rook that is not in place is ignored.
+   for (Color side : {White, Black})
+   {
+      const bool* sideRights = rights[side == White ? 0 : 1];
+      Position::CastlingState state = pos.castlingState(side);
+      state.hasKingMoved = state.hasKingMoved || !(sideRights[0] || sideRights[1]);
+      state.hasKingsideRookMoved = state.hasKingsideRookMoved || !sideRights[0];
+      state.hasQueensideRookMoved = state.hasQueensideRookMoved || !sideRights[1];
+      state.hasCastled = false;
+      pos.setCastlingState(side, state);
+   }
+}
+
+constexpr void readFenEnPassantSquare(std::string_view field, Color sideToMove,
+                                      Position& pos)
+{
+   if (field == "-")
+      return;
+
+   if (field.size() != 2 || field[0] < 'a' || field[0] > 'h')
+      throwInvalidFen("Invalid en-passant square in FEN.");
+
+   // The record holds the square behind the pawn that can be taken. The position
+   // tracks the square of the pawn itself.
+   const char targetRankCh = sideToMove == White ? '6' : '3';
+   if (field[1] != targetRankCh)
+      throwInvalidFen("Invalid en-passant square in FEN.");
+
+   const Square pawnAt =
+      makeSquare(fileFromChar(field[0]), sideToMove == White ? r5 : r4);
+   if (pos[pawnAt] != pawn(!sideToMove))
+      throwInvalidFen("Invalid en-passant square in FEN.");
+
+   pos.setEnPassantSquare(pawnAt);
+}
+
+constexpr unsigned readFenCounter(std::string_view field, unsigned defaultValue)
+{
+   if (field.empty())
+      return defaultValue;
+
+   // Counters of real games are far below the limit of the value type.
+   constexpr std::size_t MaxDigits = 9;
+   if (field.size() > MaxDigits)
+      throwInvalidFen("Invalid move counter in FEN.");
+
+   unsigned value = 0;
+   for (char ch : field)
+   {
+      if (ch < '0' || ch > '9')
+         throwInvalidFen("Invalid move counter in FEN.");
+      value = value * 10 + static_cast<unsigned>(ch - '0');
+   }
+   return value;
+}
+
+constexpr bool isFenCounter(std::string_view field)
+{
+   if (field.empty())
+      return false;
+   for (char ch : field)
+      if (ch < '0' || ch > '9')
+         return false;
+   return true;
+}
+
+// Returns a field of a line without the terminators of EPD operations.
+constexpr std::string_view trimFenTerminator(std::string_view field)
+{
+   while (!field.empty() && field.back() == ';')
+      field.remove_suffix(1);
+   return field;
+}
+
+constexpr FenState readFenFields(std::string_view placements, std::string_view side,
+                                 std::string_view castling, std::string_view enPassant,
+                                 std::string_view halfmoves, std::string_view fullmoves,
+                                 Position& pos)
+{
+   pos.clear();
+
+   FenState state;
+   readFenPlacements(placements, pos);
+   state.sideToMove = readFenSideToMove(side);
+   readFenCastlingRights(castling, pos);
+   readFenEnPassantSquare(enPassant, state.sideToMove, pos);
+   state.halfmoveClock = readFenCounter(halfmoves, 0);
+   state.fullmoveNumber = readFenCounter(fullmoves, 1);
+   return state;
+}
+
+} // namespace fenimpl
+
+
+constexpr FenState readFen(std::string_view fen, Position& pos)
+{
+   using namespace fenimpl;
+
+   std::string_view rest = fen;
+   const std::string_view placements = nextFenField(rest);
+   const std::string_view side = nextFenField(rest);
+   const std::string_view castling = nextFenField(rest);
+   const std::string_view enPassant = nextFenField(rest);
+   const std::string_view halfmoves = nextFenField(rest);
+   const std::string_view fullmoves = nextFenField(rest);
+   if (castling.empty() || enPassant.empty() || !nextFenField(rest).empty())
+      throwInvalidFen("Invalid number of fields in FEN.");
+
+   return readFenFields(placements, side, castling, enPassant, halfmoves, fullmoves,
+                        pos);
+}
+
+
+constexpr FenState readFenPrefix(std::string_view line, Position& pos)
+{
+   using namespace fenimpl;
+
+   std::string_view rest = line;
+   const std::string_view placements = nextFenField(rest);
+   const std::string_view side = nextFenField(rest);
+   const std::string_view castling = nextFenField(rest);
+   const std::string_view enPassant = trimFenTerminator(nextFenField(rest));
+   if (castling.empty() || enPassant.empty())
+      throwInvalidFen("Invalid number of fields in FEN.");
+
+   std::string_view halfmoves = trimFenTerminator(nextFenField(rest));
+   std::string_view fullmoves;
+   if (isFenCounter(halfmoves))
+   {
+      fullmoves = trimFenTerminator(nextFenField(rest));
+      if (!isFenCounter(fullmoves))
+         fullmoves = {};
+   }
+   else
+   {
+      halfmoves = {};
+   }
+
+   return readFenFields(placements, side, castling, enPassant, halfmoves, fullmoves,
+                        pos);
+}
+
+
+constexpr Position makeFenPosition(std::string_view fen)
+{
+   Position pos;
+   readFen(fen, pos);
+   return pos;
+}
+
+} // namespace matt2
@@ -4,9 +4,13 @@
 //
 #include "game.h"
 #include "console.h"
+#include "eval_cache.h"
+#include "nnue.h"
 #include "notation.h"
 #include "rules.h"
 #include "scoring.h"
+#include <algorithm>
+#include <cstdlib>
 #include <limits>
 #include <queue>
 #include <variant>
@@ -20,20 +24,13 @@ namespace
 {
 ///////////////////
 
-std::string toString(const Move& m)
+std::string toString(const std::optional<PackedMove>& move, Score score)
 {
    std::string s;
-   return notate(s, m, Lan{});
-}
-
-std::string toString(const std::optional<Move>& move, double score)
-{
-   std::string s;
-   Lan n;
 
    if (move)
    {
-      notate(s, *move, n);
+      s += matt2::toString(*move);
       s += "(score=" + std::to_string(score) + ")";
    }
    else
@@ -62,8 +59,8 @@ void printCalculatingStatus(Color /*side*/, size_t /*plyDepth*/, const Position&
 #endif // ENABLE_PRINTING
 
 #ifdef ENABLE_PRINTING
-void printCalculatedStatus(Color side, size_t plyDepth, const std::optional<Move>& move,
-                           double score)
+void printCalculatedStatus(Color side, size_t plyDepth, const std::optional<PackedMove>& move,
+                           Score score)
 {
    std::string s = "Calculated move for ";
    s += ::toString(side);
@@ -75,14 +72,14 @@ void printCalculatedStatus(Color side, size_t plyDepth, const std::optional<Move
 }
 #else
 void printCalculatedStatus(Color /*side*/, size_t /*plyDepth*/,
-                           const std::optional<Move>& /*move*/, double /*score*/)
+                           const std::optional<PackedMove>& /*move*/, Score /*score*/)
 {
 }
 #endif // ENABLE_PRINTING
 
 #ifdef ENABLE_PRINTING
 void printEvaluatingStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
-                           size_t numMoves, const Move& move, const Position& pos)
+                           size_t numMoves, PackedMove move, const Position& pos)
 {
    std::string s = "Evaluating move #";
    s += std::to_string(moveIdx_0based + 1);
@@ -93,13 +90,13 @@ void printEvaluatingStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
    s += " with depth ";
    s += std::to_string(plyDepth);
    s += ": ";
-   s += ::toString(move);
+   s += matt2::toString(move);
    printPosition(s, pos);
    consoleOut(s);
 }
 #else
 void printEvaluatingStatus(Color /*side*/, size_t /*plyDepth*/, size_t /*moveIdx_0based*/,
-                           size_t /*numMoves*/, const Move& /*move*/,
+                           size_t /*numMoves*/, PackedMove /*move*/,
                            const Position& /*pos*/)
 {
 }
@@ -107,7 +104,7 @@ void printEvaluatingStatus(Color /*side*/, size_t /*plyDepth*/, size_t /*moveIdx
 
 #ifdef ENABLE_PRINTING
 void printEvaluatedStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
-                          size_t numMoves, const Move& move, double score,
+                          size_t numMoves, PackedMove move, Score score,
                           bool isBetterMove)
 {
    std::string s = "Evaluated move #";
@@ -119,7 +116,7 @@ void printEvaluatedStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
    s += " with depth ";
    s += std::to_string(plyDepth);
    s += ": ";
-   s += ::toString(move);
+   s += matt2::toString(move);
    s += " ==> score=";
    s += std::to_string(score);
    if (isBetterMove)
@@ -130,7 +127,7 @@ void printEvaluatedStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
 }
 #else
 void printEvaluatedStatus(Color /*side*/, size_t /*plyDepth*/, size_t /*moveIdx_0based*/,
-                          size_t /*numMoves*/, const Move& /*move*/, double /*score*/,
+                          size_t /*numMoves*/, PackedMove /*move*/, Score /*score*/,
                           bool /*isBetterMove*/)
 {
 }
@@ -138,8 +135,8 @@ void printEvaluatedStatus(Color /*side*/, size_t /*plyDepth*/, size_t /*moveIdx_
 
 #ifdef ENABLE_PRINTING
 void printPruningStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
-                        size_t numMoves, const Move& move, double score,
-                        double bestOpposingScore)
+                        size_t numMoves, PackedMove move, Score score,
+                        Score bestOpposingScore)
 {
    std::string s = "Pruning after move #";
    s += std::to_string(moveIdx_0based + 1);
@@ -150,7 +147,7 @@ void printPruningStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
    s += " with depth ";
    s += std::to_string(plyDepth);
    s += ": ";
-   s += ::toString(move);
+   s += matt2::toString(move);
    s += " ==> score=";
    s += std::to_string(score);
    s += ", best known opponent score=";
@@ -159,8 +156,8 @@ void printPruningStatus(Color side, size_t plyDepth, size_t moveIdx_0based,
 }
 #else
 void printPruningStatus(Color /*side*/, size_t /*plyDepth*/, size_t /*moveIdx_0based*/,
-                        size_t /*numMoves*/, const Move& /*move*/, double /*score*/,
-                        double /*bestOpposingScore*/)
+                        size_t /*numMoves*/, PackedMove /*move*/, Score /*score*/,
+                        Score /*bestOpposingScore*/)
 {
 }
 #endif // ENABLE_PRINTING
@@ -168,18 +165,24 @@ void printPruningStatus(Color /*side*/, size_t /*plyDepth*/, size_t /*moveIdx_0b
 ///////////////////
 
 // Calculates the next move for a given position.
-class MoveCalculator
+// The search mode decides at compile time how moves are made and taken back.
+template <SearchMode Mode> class MoveCalculator
 {
  public:
-   MoveCalculator(Position& pos);
+   // Scores of positions at the max depth are looked up in a given cache, if any. If a
+   // network is given, it scores the positions instead of the rules.
+   MoveCalculator(Position& pos, EvalCache* cache = nullptr,
+                  const nnue::Network* network = nullptr);
 
    std::optional<Move> next(Color side, size_t plyDepth);
+   // Returns the score of the best line.
+   Score score(Color side, size_t plyDepth);
 
  private:
    struct MoveScore
    {
-      std::optional<Move> move;
-      double score = 0.;
+      std::optional<PackedMove> move;
+      Score score = 0;
    };
    struct MaxDepthReached
    {
@@ -189,66 +192,151 @@ class MoveCalculator
    };
    using MoveResult = std::variant<MoveScore, MaxDepthReached, NoValidMoveFound>;
 
-   MoveResult next(Color side, size_t plyDepth, bool calcMax, double bestOpposingScore);
-   void collectMoves(Color side, std::vector<Move>& moves) const;
+   // Searches the position for a given side from the root.
+   MoveResult search(Color side, size_t plyDepth);
+   // Search node for the side to move. Instantiated for each side, so that color
+   // decisions are made at compile time.
+   template <Color Us> MoveResult next(size_t plyDepth, Score bestOpposingScore);
+   template <Color Us> void collectMoves(size_t ply, PackedMoveList& moves);
+   template <Color Us> void removeIfCheck(PackedMoveList& moves, size_t ply);
+   // Scores a position at the max depth for the best scores that the side to move and
+   // its opponent have found so far.
+   template <Color Us>
+   Score scoreLeaf(const Position& pos, Score bestScore, Score bestOpposingScore);
+
+   // Returns the position at a given ply.
+   Position& position(size_t ply);
+   // Makes a move on the position at a given ply and returns the resulting position.
+   Position& makeMove(size_t ply, PackedMove move);
+   // Takes back a move made on the position at a given ply.
+   void unmakeMove(size_t ply, PackedMove move);
 
  private:
    Position& m_pos;
+   EvalCache* m_cache = nullptr;
+   const nnue::Network* m_network = nullptr;
+   // Accumulators of the network for the positions along the searched line. Kept
+   // beside the positions instead of in them to keep positions small.
+   std::optional<nnue::AccumulatorStack> m_accumulators;
    size_t m_totalPlies = 0;
+   // Positions for each ply when making moves by copying. The root position is at
+   // index zero.
+   std::vector<Position> m_plyPositions;
+   // Info to unmake the move made at each ply when making and unmaking moves.
+   std::vector<Position::UndoState> m_undoStates;
 };
 
 
-MoveCalculator::MoveCalculator(Position& pos) : m_pos{pos}
+template <SearchMode Mode>
+MoveCalculator<Mode>::MoveCalculator(Position& pos, EvalCache* cache,
+                                     const nnue::Network* network)
+: m_pos{pos}, m_cache{cache}, m_network{network}
 {
+   if (m_network)
+      m_accumulators.emplace(*m_network);
 }
 
 
-std::optional<Move> MoveCalculator::next(Color side, size_t plyDepth)
+template <SearchMode Mode>
+std::optional<Move> MoveCalculator<Mode>::next(Color side, size_t plyDepth)
 {
-   m_totalPlies = plyDepth;
-   const bool calcMax = side == White;
-   const MoveResult result = next(side, plyDepth, calcMax, getWorstScoreValue(!calcMax));
+   const MoveResult result = search(side, plyDepth);
    if (std::holds_alternative<MoveScore>(result))
-      return std::get<MoveScore>(result).move;
+   {
+      // The position is back at its initial state, so the best move can be converted
+      // to a full move.
+      const auto& bestMove = std::get<MoveScore>(result).move;
+      if (bestMove)
+         return unpack(*bestMove, m_pos);
+   }
    return {};
 }
 
 
-MoveCalculator::MoveResult MoveCalculator::next(Color side, size_t plyDepth, bool calcMax,
-                                                double bestOpposingScore)
+template <SearchMode Mode> Score MoveCalculator<Mode>::score(Color side, size_t plyDepth)
 {
+   if (plyDepth == 0)
+   {
+      if (m_network)
+         return nnue::evaluate(*m_network, m_pos);
+      return m_cache ? calcScore(m_pos, *m_cache) : calcScore(m_pos);
+   }
+
+   const MoveResult result = search(side, plyDepth);
+   if (std::holds_alternative<MoveScore>(result))
+      return std::get<MoveScore>(result).score;
+
+   // No legal move at the root.
+   if (isCheck(side, m_pos))
+      return calcMateScore(side, m_pos, 0);
+   return calcTieScore(!side, m_pos);
+}
+
+
+template <SearchMode Mode>
+typename MoveCalculator<Mode>::MoveResult MoveCalculator<Mode>::search(Color side,
+                                                                       size_t plyDepth)
+{
+   m_totalPlies = plyDepth;
+   if constexpr (Mode == SearchMode::CopyMake)
+   {
+      // Allocate the positions for all plies upfront.
+      m_plyPositions.assign(plyDepth + 1, m_pos);
+   }
+   else
+   {
+      m_undoStates.resize(plyDepth);
+   }
+   if (m_accumulators)
+      m_accumulators->reset(m_pos);
+
+   return side == White ? next<White>(plyDepth, getWorstScoreValue<Black>())
+                        : next<Black>(plyDepth, getWorstScoreValue<White>());
+}
+
+
+template <SearchMode Mode>
+template <Color Us>
+typename MoveCalculator<Mode>::MoveResult
+MoveCalculator<Mode>::next(size_t plyDepth, Score bestOpposingScore)
+{
+   constexpr Color Them = !Us;
+
    assert(plyDepth > 0);
    if (plyDepth == 0)
       return MaxDepthReached{};
 
-   printCalculatingStatus(side, plyDepth, m_pos);
+   const size_t ply = m_totalPlies - plyDepth;
+   printCalculatingStatus(Us, plyDepth, position(ply));
 
    // Collect all possible moves.
-   std::vector<Move> moves;
-   // Reserve some space to avoid too many allocations.
-   moves.reserve(100);
-   collectMoves(side, moves);
+   PackedMoveList moves;
+   collectMoves<Us>(ply, moves);
    if (moves.empty())
       return NoValidMoveFound{};
 
    // Find best move.
-   MoveScore bestMove{std::nullopt, getWorstScoreValue(calcMax)};
+   MoveScore bestMove{std::nullopt, getWorstScoreValue<Us>()};
 
    // Track move index for debugging.
    size_t moveIdx = 0;
 
-   for (auto& m : moves)
+   for (PackedMove m : moves)
    {
-      makeMove(m_pos, m);
-      printEvaluatingStatus(side, plyDepth, moveIdx, moves.size(), m, m_pos);
+      // Only moves that are searched update the accumulators. Moves that are made to
+      // check their legality don't need them.
+      if (m_accumulators)
+         m_accumulators->push(position(ply), m);
+      Position& pos = makeMove(ply, m);
+      printEvaluatingStatus(Us, plyDepth, moveIdx, moves.size(), m, pos);
 
       // Find best counter move for opponent, if more plies should be explored.
       MoveResult bestCounterMove = MaxDepthReached{};
       if (plyDepth > 1)
-         bestCounterMove = next(!side, plyDepth - 1, !calcMax, bestMove.score);
+         bestCounterMove = next<Them>(plyDepth - 1, bestMove.score);
 
       // Score of move becomes the score of the best counter move if one was found.
-      double moveScore = 0.;
+      Score moveScore = 0;
       if (std::holds_alternative<MoveScore>(bestCounterMove))
       {
          moveScore = std::get<MoveScore>(bestCounterMove).score;
@@ -257,16 +345,16 @@ MoveCalculator::MoveResult MoveCalculator::next(Color side, size_t plyDepth, boo
       // use the score of the position as score of the current move.
       else if (std::holds_alternative<MaxDepthReached>(bestCounterMove))
       {
-         moveScore = m_pos.updateScore();
+         moveScore = scoreLeaf<Us>(pos, bestMove.score, bestOpposingScore);
       }
       // If there is no counter move because no legal move is possible,
       // it's either a mate or a tie.
       else if (std::holds_alternative<NoValidMoveFound>(bestCounterMove))
       {
-         if (isCheck(!side, m_pos))
-            moveScore = calcMateScore(!side, m_pos, m_totalPlies - plyDepth);
+         if (isCheck<Them>(pos))
+            moveScore = calcMateScore(Them, pos, m_totalPlies - plyDepth);
          else
-            moveScore = calcTieScore(side, m_pos);
+            moveScore = calcTieScore(Us, pos);
       }
       else
       {
@@ -274,23 +362,25 @@ MoveCalculator::MoveResult MoveCalculator::next(Color side, size_t plyDepth, boo
       }
 
       // Use current move if it leads to a better score for the player.
-      const bool isBetterMove = bt(moveScore, bestMove.score, calcMax);
+      const bool isBetterMove = bt<Us>(moveScore, bestMove.score);
       if (isBetterMove)
          bestMove = {m, moveScore};
 
-      printEvaluatedStatus(side, plyDepth, moveIdx, moves.size(), m, moveScore,
+      printEvaluatedStatus(Us, plyDepth, moveIdx, moves.size(), m, moveScore,
                            isBetterMove);
 
-      reverseMove(m_pos, m);
+      unmakeMove(ply, m);
+      if (m_accumulators)
+         m_accumulators->pop();
 
       // Alpha-beta pruning.
       // If the passed best opposing score at this point is better-or-equal (for
       // the opponent) than the best score here, then it will always get chosen over
       // whatever score we can find here because any improvements here go in the opposite
       // value direction. Therefore, we can abort checking any further moves here.
-      if (cmp(bestOpposingScore, bestMove.score, !calcMax) >= 0)
+      if (cmp<Them>(bestOpposingScore, bestMove.score) >= 0)
       {
-         printPruningStatus(side, plyDepth, moveIdx, moves.size(), m, moveScore,
+         printPruningStatus(Us, plyDepth, moveIdx, moves.size(), m, moveScore,
                             bestOpposingScore);
          break;
       }
@@ -298,33 +388,119 @@ MoveCalculator::MoveResult MoveCalculator::next(Color side, size_t plyDepth, boo
       ++moveIdx;
    }
 
-   printCalculatedStatus(side, plyDepth, bestMove.move, bestMove.score);
+   printCalculatedStatus(Us, plyDepth, bestMove.move, bestMove.score);
    return bestMove;
 }
 
-static void removeIfCheck(std::vector<Move>& moves, Position pos, Color side)
+
+template <SearchMode Mode>
+template <Color Us>
+void MoveCalculator<Mode>::collectMoves(size_t ply, PackedMoveList& moves)
+{
+   collectSideMoves<Us>(position(ply), moves);
+
+   // Eliminate moves that would lead to check.
+   removeIfCheck<Us>(moves, ply);
+}
+
+
+template <SearchMode Mode>
+template <Color Us>
+void MoveCalculator<Mode>::removeIfCheck(PackedMoveList& moves, size_t ply)
 {
-   std::erase_if(moves,
-                 [&pos, side](Move& m)
-                 {
-                    makeMove(pos, m);
-                    const bool leadsToCheck = isCheck(side, pos);
-                    reverseMove(pos, m);
-                    return leadsToCheck;
-                 });
+   auto checkIt = std::remove_if(moves.begin(), moves.end(),
+                                 [this, ply](PackedMove m)
+                                 {
+                                    const bool leadsToCheck =
+                                       isCheck<Us>(makeMove(ply, m));
+                                    unmakeMove(ply, m);
+                                    return leadsToCheck;
+                                 });
+   moves.erase(checkIt, moves.end());
 }
 
-void MoveCalculator::collectMoves(Color side, std::vector<Move>& moves) const
+
+template <SearchMode Mode>
+template <Color Us>
+Score MoveCalculator<Mode>::scoreLeaf(const Position& pos, Score bestScore,
+                                      Score bestOpposingScore)
 {
-   const auto endIter = m_pos.end(side);
-   for (auto iter = m_pos.begin(side); iter < endIter; ++iter)
-      matt2::collectMoves(iter.piece(), iter.at(), m_pos, moves);
+   if (m_accumulators)
+      return m_accumulators->evaluate();
 
-   collectCastlingMoves(side, m_pos, moves);
-   collectEnPassantMoves(side, m_pos, moves);
+   // Scores outside of the window between the best scores cannot change the best move,
+   // so they don't have to be exact. Scores that are worse than the best score are
+   // rejected and scores that are at least as good as the best opposing score cause
+   // pruning, whether they are exact or not.
+   if constexpr (Us == White)
+      return calcScore(pos, bestScore, bestOpposingScore, m_cache);
+   else
+      return calcScore(pos, bestOpposingScore, bestScore, m_cache);
+}
 
-   // Eliminate moves that would lead to check.
-   removeIfCheck(moves, m_pos, side);
+
+template <SearchMode Mode> Position& MoveCalculator<Mode>::position(size_t ply)
+{
+   if constexpr (Mode == SearchMode::CopyMake)
+      return m_plyPositions[ply];
+   else
+      return m_pos;
+}
+
+
+template <SearchMode Mode>
+Position& MoveCalculator<Mode>::makeMove(size_t ply, PackedMove move)
+{
+   if constexpr (Mode == SearchMode::CopyMake)
+   {
+      Position& child = m_plyPositions[ply + 1];
+      child = m_plyPositions[ply];
+      child.makeMove(move);
+      return child;
+   }
+   else
+   {
+      m_undoStates[ply] = m_pos.makeMove(move);
+      return m_pos;
+   }
+}
+
+
+template <SearchMode Mode>
+void MoveCalculator<Mode>::unmakeMove(size_t ply, PackedMove move)
+{
+   // Nothing to do for copy-make because the position of the ply is unchanged.
+   if constexpr (Mode == SearchMode::MakeUnmake)
+      m_pos.unmakeMove(move, m_undoStates[ply]);
+}
+
+template <SearchMode Mode>
+std::optional<Move> calcMove(Position& pos, Color side, size_t plyDepth, EvalCache* cache,
+                             const nnue::Network* network)
+{
+   MoveCalculator<Mode> calc{pos, cache, network};
+   return calc.next(side, plyDepth);
+}
+
+std::optional<Move> calcMove(Position& pos, Color side, size_t plyDepth, SearchMode mode,
+                             EvalCache* cache = nullptr,
+                             const nnue::Network* network = nullptr)
+{
+   switch (mode)
+   {
+   case SearchMode::CopyMake:
+      return calcMove<SearchMode::CopyMake>(pos, side, plyDepth, cache, network);
+   default:
+      return calcMove<SearchMode::MakeUnmake>(pos, side, plyDepth, cache, network);
+   }
+}
+
+template <SearchMode Mode>
+Score searchScore(Position& pos, Color side, size_t plyDepth, EvalCache* cache,
+                  const nnue::Network* network)
+{
+   MoveCalculator<Mode> calc{pos, cache, network};
+   return calc.score(side, plyDepth);
 }
 
 ///////////////////
@@ -342,13 +518,32 @@ namespace matt2
 {
 ///////////////////
 
-std::pair<bool, std::string> Game::calcNextMove(size_t turnDepth)
+Score calcSearchScore(Position& pos, Color side, size_t plyDepth, SearchMode mode,
+                      EvalCache* cache, const nnue::Network* network)
+{
+   switch (mode)
+   {
+   case SearchMode::CopyMake:
+      return searchScore<SearchMode::CopyMake>(pos, side, plyDepth, cache, network);
+   default:
+      return searchScore<SearchMode::MakeUnmake>(pos, side, plyDepth, cache, network);
+   }
+}
+
+///////////////////
+
+std::pair<bool, std::string> Game::calcNextMove(size_t turnDepth, SearchMode mode)
 {
    if (isMate(m_nextTurn))
       return {false, "Cannot move when mate."};
 
-   MoveCalculator calc{m_currPos};
-   auto move = calc.next(m_nextTurn, 2 * turnDepth);
+   // Positions repeat across the searches of a game, so the cache is kept for the
+   // whole game. Network scores are cheap enough to not need caching.
+   if (!m_evalCache && !m_network)
+      m_evalCache = std::make_shared<EvalCache>(EvalCacheSizeMB);
+
+   auto move = calcMove(m_currPos, m_nextTurn, 2 * turnDepth, mode, m_evalCache.get(),
+                        m_network.get());
    if (!move)
       return {false, "No move found."};
 
@@ -388,8 +583,7 @@ bool Game::canMove(Color side) const
       return false;
 
    Position copy = m_currPos;
-   MoveCalculator calc{copy};
-   const auto move = calc.next(side, 1);
+   const auto move = calcMove(copy, side, 1, DefaultSearchMode);
    return move.has_value();
 }
 
@@ -398,6 +592,34 @@ bool Game::isMate(Color side) const
    return matt2::isMate(side, m_currPos);
 }
 
+std::string Game::fen() const
+{
+   const size_t numMoves = atStart() ? 0 : m_currMove + 1;
+
+   FenState state;
+   state.sideToMove = m_nextTurn;
+
+   // The fullmove number increases with each move of black.
+   const size_t numBlackMoves =
+      m_startState.sideToMove == Color::White ? numMoves / 2 : (numMoves + 1) / 2;
+   state.fullmoveNumber =
+      m_startState.fullmoveNumber + static_cast<unsigned>(numBlackMoves);
+
+   // The halfmove clock restarts with each capture or pawn move.
+   state.halfmoveClock = m_startState.halfmoveClock + static_cast<unsigned>(numMoves);
+   for (size_t i = numMoves; i > 0; --i)
+   {
+      const Move& m = m_moves[i - 1];
+      if (isPawn(piece(m)) || taken(m).has_value())
+      {
+         state.halfmoveClock = static_cast<unsigned>(numMoves - i);
+         break;
+      }
+   }
+
+   return toFen(m_currPos, state);
+}
+
 std::optional<Position> Game::forward()
 {
    if (atEnd())
@@ -539,6 +761,10 @@ buildBasicMove(const MoveDescription& descr, const Position& pos)
 
    const auto taken = pos[to];
 
+   // Double pawn pushes allow the opponent to take the pawn en-passant.
+   if (isPawn(*piece) && !taken && std::abs(distance(rank(from), rank(to))) == 2)
+      return {BasicMove{*piece, from, to, EnablesEnPassant}, ""};
+
    // Validation of fields happens later.
    return {BasicMove{*piece, from, to, taken}, ""};
 }
@@ -3,10 +3,14 @@
 // MIT license
 //
 #pragma once
+#include "fen.h"
 #include "move.h"
 #include "position.h"
 #include <cstddef>
+#include <memory>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -14,7 +18,37 @@
 namespace matt2
 {
 
+class EvalCache;
 struct MoveResult;
+namespace nnue
+{
+class Network;
+}
+
+///////////////////
+
+// How the search makes and takes back moves.
+enum class SearchMode
+{
+   // Makes and unmakes moves on a single position.
+   MakeUnmake,
+   // Copies the position into a preallocated per-ply stack and makes the move on the
+   // copy. Taking a move back is free.
+   CopyMake
+};
+
+// Search mode used unless a mode is given explicitly.
+constexpr SearchMode DefaultSearchMode = SearchMode::MakeUnmake;
+
+// Searches a position with a given side to move to a given depth in plies and returns
+// the score of the best line from white's point of view. A depth of zero scores the
+// position itself. Positions without legal moves are scored as mate or tie. The
+// position is back at its initial state when the search returns. Scores of positions
+// at the max depth are looked up in a given cache, if any. If a network is given, it
+// scores the positions instead of the rules.
+Score calcSearchScore(Position& pos, Color side, size_t plyDepth,
+                      SearchMode mode = DefaultSearchMode, EvalCache* cache = nullptr,
+                      const nnue::Network* network = nullptr);
 
 ///////////////////
 
@@ -23,16 +57,28 @@ class Game
  public:
    Game();
    Game(Position pos, Color nextTurn);
+   // Starts a game at a position given in Forsyth-Edwards Notation. Throws
+   // std::runtime_error for invalid records.
+   explicit Game(std::string_view fen);
 
    // Taking turns.
    Color nextTurn() const { return m_nextTurn; }
-   std::pair<bool, std::string> calcNextMove(size_t turnDepth);
+   std::pair<bool, std::string> calcNextMove(size_t turnDepth,
+                                             SearchMode mode = DefaultSearchMode);
    std::pair<bool, std::string> enterNextMove(std::string_view movePacnNotation);
    bool canMove(Color side) const;
    bool isMate(Color side) const;
+   // Sets a network that scores positions in place of the rules when calculating
+   // moves. Passing null switches back to the rules.
+   void setNetwork(std::shared_ptr<const nnue::Network> network)
+   {
+      m_network = std::move(network);
+   }
 
    // Iterate over game positions.
    const Position& current() const { return m_currPos; }
+   // Returns the FEN record of the current position, including the move counters.
+   std::string fen() const;
    std::optional<Position> forward();
    std::optional<Position> backward();
 
@@ -67,6 +113,15 @@ class Game
    std::vector<Move> m_moves;
    // Index of move that leads to current position.
    size_t m_currMove = static_cast<size_t>(-1);
+   // Game state of the position that the game started at. Used to calculate the move
+   // counters of later positions.
+   FenState m_startState;
+   // Cache for the scores of positions evaluated by searches. Created with the first
+   // search and shared by copies of the game.
+   std::shared_ptr<EvalCache> m_evalCache;
+   static constexpr std::size_t EvalCacheSizeMB = 4;
+   // Network for scoring positions, if any.
+   std::shared_ptr<const nnue::Network> m_network;
 };
 
 
@@ -75,8 +130,14 @@ inline Game::Game() : m_currPos{StartPos}
 }
 
 inline Game::Game(Position pos, Color nextTurn)
-: m_nextTurn{nextTurn}, m_currPos{std::move(pos)}
+: m_nextTurn{nextTurn}, m_currPos{std::move(pos)}, m_startState{nextTurn}
+{
+}
+
+inline Game::Game(std::string_view fen)
+: m_startState{readFen(fen, m_currPos)}
 {
+   m_nextTurn = m_startState.sideToMove;
 }
 
 } // namespace matt2
@@ -42,7 +42,7 @@ std::pair<bool, std::string> BasicMove::isValid(const Position& pos, Color turn)
       return {false, "The moved piece is not on the side whose turn it is."};
 
    // Check that the moves is part of the legal moves.
-   std::vector<Move> legalMoves;
+   MoveList legalMoves;
    collectMoves(piece(), from(), pos, legalMoves);
 
    auto iter = std::find(legalMoves.begin(), legalMoves.end(), Move{*this});
@@ -67,7 +67,7 @@ std::pair<bool, std::string> Castling::isValid(const Position& pos, Color turn)
       return {false, "Only a king can castle. The moved piece is not a king."};
 
    // Check that the moves is part of the legal moves.
-   std::vector<Move> legalMoves;
+   MoveList legalMoves;
    collectCastlingMoves(turn, pos, legalMoves);
 
    auto iter = std::find(legalMoves.begin(), legalMoves.end(), Move{*this});
@@ -93,7 +93,7 @@ std::pair<bool, std::string> EnPassant::isValid(const Position& pos, Color turn)
               "Only a pawn can make an en-passant move. The moved piece is not a pawn."};
 
    // Check that the moves is part of the legal moves.
-   std::vector<Move> legalMoves;
+   MoveList legalMoves;
    collectEnPassantMoves(turn, pos, legalMoves);
 
    auto iter = std::find(legalMoves.begin(), legalMoves.end(), Move{*this});
@@ -118,7 +118,7 @@ std::pair<bool, std::string> Promotion::isValid(const Position& pos, Color turn)
       return {false, "Only a pawn can be promoted. The moved piece is not a pawn."};
 
    // Check that the moves is part of the legal moves.
-   std::vector<Move> legalMoves;
+   MoveList legalMoves;
    collectMoves(piece(), from(), pos, legalMoves);
 
    auto iter = std::find(legalMoves.begin(), legalMoves.end(), Move{*this});
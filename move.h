@@ -3,10 +3,14 @@
 // MIT license
 //
 #pragma once
+#include "packed_move.h"
 #include "piece.h"
 #include "position.h"
 #include "relocation.h"
+#include "dscpp/SboVector.h"
+#include <cstddef>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <variant>
@@ -142,12 +146,13 @@ inline BasicMove::BasicMove(const Relocation& moved, EnablesEnPassant_t)
 
 inline void BasicMove::move(Position& pos)
 {
+   collectCastlingState(pos);
+
    if (m_taken)
       pos.remove(Placement{*m_taken, m_moved.to()});
    pos.move(m_moved);
 
    setEnPassantState(m_enPassantSquare, pos);
-   collectCastlingState(pos);
 }
 
 inline void BasicMove::reverse(Position& pos)
@@ -253,12 +258,13 @@ inline Castling::Castling(Queenside_t, Color side)
 
 inline void Castling::move(Position& pos)
 {
+   collectCastlingState(pos);
+
    pos.move(m_king);
    pos.move(m_rook);
    pos.setHasCastled(color(m_king.piece()));
 
    setEnPassantState(std::nullopt, pos);
-   collectCastlingState(pos);
 }
 
 inline void Castling::reverse(Position& pos)
@@ -333,11 +339,12 @@ inline EnPassant::EnPassant(const Relocation& pawn)
 
 inline void EnPassant::move(Position& pos)
 {
+   collectCastlingState(pos);
+
    pos.move(m_movedPawn);
    pos.remove(m_takenPawn);
 
    setEnPassantState(std::nullopt, pos);
-   collectCastlingState(pos);
 }
 
 inline void EnPassant::reverse(Position& pos)
@@ -416,13 +423,14 @@ inline Promotion::Promotion(const Relocation& pawn, Piece promotedTo,
 
 inline void Promotion::move(Position& pos)
 {
+   collectCastlingState(pos);
+
    if (m_taken)
       pos.remove(Placement{*m_taken, m_promoted.at()});
    pos.remove(m_movedPawn);
    pos.add(m_promoted);
 
    setEnPassantState(std::nullopt, pos);
-   collectCastlingState(pos);
 }
 
 inline void Promotion::reverse(Position& pos)
@@ -463,6 +471,14 @@ inline bool operator!=(const Promotion& a, const Promotion& b)
 // Any of the possible move types.
 using Move = std::variant<BasicMove, Castling, EnPassant, Promotion>;
 
+// Max number of legal moves in any chess position.
+constexpr std::size_t MaxMoves = 218;
+
+// Collection of moves that stores up to the max number of legal moves without
+// allocating heap memory.
+using MoveList = ds::SboVector<Move, MaxMoves>;
+using PackedMoveList = ds::SboVector<PackedMove, MaxMoves>;
+
 
 inline std::pair<bool, std::string> isValidMove(const Move& move, const Position& pos, Color turn)
 {
@@ -522,6 +538,66 @@ inline std::optional<Piece> additionalPiece(const Move& move)
    return std::visit(dispatch, move);
 }
 
+///////////////////
+// Conversions between moves and packed moves.
+
+inline PackedMove pack(const BasicMove& move)
+{
+   using Flag = PackedMove::Flag;
+   const Flag flag = move.enPassantSquare().has_value()
+                        ? Flag::DoublePawnPush
+                        : (move.taken().has_value() ? Flag::Capture : Flag::Quiet);
+   return {move.from(), move.to(), flag};
+}
+
+inline PackedMove pack(const Castling& move)
+{
+   using Flag = PackedMove::Flag;
+   return {move.from(), move.to(),
+           move.isKingside() ? Flag::KingsideCastling : Flag::QueensideCastling};
+}
+
+inline PackedMove pack(const EnPassant& move)
+{
+   return {move.from(), move.to(), PackedMove::Flag::EnPassant};
+}
+
+inline PackedMove pack(const Promotion& move)
+{
+   return {move.from(), move.to(),
+           PackedMove::promotionFlag(move.promotedTo(), move.taken().has_value())};
+}
+
+inline PackedMove pack(const Move& move)
+{
+   auto dispatch = [](const auto& specificMove) { return pack(specificMove); };
+   return std::visit(dispatch, move);
+}
+
+// Converts a packed move to a full move. The packed move must not have been made on
+// the passed position yet because the position provides the moved and taken pieces.
+inline Move unpack(PackedMove move, const Position& pos)
+{
+   const auto piece = pos[move.from()];
+   if (!piece)
+      throw std::runtime_error("No piece to unpack move for.");
+
+   if (move.isCastling())
+   {
+      if (move.isKingsideCastling())
+         return Castling{Kingside, color(*piece)};
+      return Castling{Queenside, color(*piece)};
+   }
+   if (move.isEnPassant())
+      return EnPassant{*piece, move.from(), move.to()};
+   if (move.isPromotion())
+      return Promotion{*piece, move.from(), move.to(), move.promotedTo(color(*piece)),
+                       pos[move.to()]};
+   if (move.isDoublePawnPush())
+      return BasicMove{*piece, move.from(), move.to(), EnablesEnPassant};
+   return BasicMove{*piece, move.from(), move.to(), pos[move.to()]};
+}
+
 ///////////////////
 
 // Description of a move as entered by player.
@@ -0,0 +1,594 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "nnue.h"
+#include "daily_chess_scoring.h"
+#include "position.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_AVX2
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define NNUE_SSE4
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define NNUE_NEON
+#endif
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace matt2;
+using namespace matt2::nnue;
+
+
+namespace
+{
+///////////////////
+// Network file layout.
+// A header is followed by the hidden biases, the feature weights, the output weights
+// and the output bias. Values are stored in little-endian byte order. The header is
+// padded so that the weights start at a cache line boundary.
+
+constexpr char FileMagic[8] = {'M', 'A', 'T', 'T', 'N', 'N', 'U', 'E'};
+constexpr uint32_t FileVersion = 1;
+
+struct FileHeader
+{
+   char magic[8];
+   uint32_t version;
+   uint32_t numFeatures;
+   uint32_t hiddenSize;
+   char padding[44];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+constexpr std::size_t HiddenBiasesOffset = sizeof(FileHeader);
+constexpr std::size_t FeatureWeightsOffset =
+   HiddenBiasesOffset + HiddenSize * sizeof(int16_t);
+constexpr std::size_t OutputWeightsOffset =
+   FeatureWeightsOffset + NumFeatures * HiddenSize * sizeof(int16_t);
+constexpr std::size_t OutputBiasOffset =
+   OutputWeightsOffset + 2 * HiddenSize * sizeof(int16_t);
+constexpr std::size_t FileSize = OutputBiasOffset + sizeof(int32_t);
+
+[[noreturn]] void throwInvalidNetwork(const std::string& reason)
+{
+   throw std::runtime_error(reason);
+}
+
+///////////////////
+// Vector operations on the hidden neurons.
+// Each instruction set processes a fixed number of neurons per step. The number of
+// hidden neurons is a multiple of all step sizes.
+
+#if defined(NNUE_AVX2)
+constexpr std::size_t StepSize = 16;
+#elif defined(NNUE_SSE4) || defined(NNUE_NEON)
+constexpr std::size_t StepSize = 8;
+#else
+constexpr std::size_t StepSize = 1;
+#endif
+static_assert(HiddenSize % StepSize == 0);
+
+// Max number of pieces that a move adds or removes.
+constexpr std::size_t MaxChanges = 2;
+
+// Feature weights to add to and subtract from the neurons of one perspective.
+struct WeightChanges
+{
+   std::array<const int16_t*, MaxChanges> added{};
+   std::array<const int16_t*, MaxChanges> removed{};
+   std::size_t numAdded = 0;
+   std::size_t numRemoved = 0;
+};
+
+// Calculates the neurons of a perspective from the neurons before a move.
+void updateNeurons(int16_t* out, const int16_t* in, const WeightChanges& changes)
+{
+   for (std::size_t i = 0; i < HiddenSize; i += StepSize)
+   {
+#if defined(NNUE_AVX2)
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+      for (std::size_t c = 0; c < changes.numAdded; ++c)
+         v = _mm256_add_epi16(
+            v,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(changes.added[c] + i)));
+      for (std::size_t c = 0; c < changes.numRemoved; ++c)
+         v = _mm256_sub_epi16(
+            v,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(changes.removed[c] + i)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+#elif defined(NNUE_SSE4)
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      for (std::size_t c = 0; c < changes.numAdded; ++c)
+         v = _mm_add_epi16(
+            v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(changes.added[c] + i)));
+      for (std::size_t c = 0; c < changes.numRemoved; ++c)
+         v = _mm_sub_epi16(
+            v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(changes.removed[c] + i)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+#elif defined(NNUE_NEON)
+      int16x8_t v = vld1q_s16(in + i);
+      for (std::size_t c = 0; c < changes.numAdded; ++c)
+         v = vaddq_s16(v, vld1q_s16(changes.added[c] + i));
+      for (std::size_t c = 0; c < changes.numRemoved; ++c)
+         v = vsubq_s16(v, vld1q_s16(changes.removed[c] + i));
+      vst1q_s16(out + i, v);
+#else
+      int16_t v = in[i];
+      for (std::size_t c = 0; c < changes.numAdded; ++c)
+         v = static_cast<int16_t>(v + changes.added[c][i]);
+      for (std::size_t c = 0; c < changes.numRemoved; ++c)
+         v = static_cast<int16_t>(v - changes.removed[c][i]);
+      out[i] = v;
+#endif
+   }
+}
+
+// Adds the weights of a feature to the neurons of a perspective.
+void addNeurons(int16_t* neurons, const int16_t* weights)
+{
+   WeightChanges changes;
+   changes.added[changes.numAdded++] = weights;
+   updateNeurons(neurons, neurons, changes);
+}
+
+// Sums the products of the clipped neurons of a perspective and their output weights.
+int32_t sumOutput(const int16_t* neurons, const int16_t* weights)
+{
+#if defined(NNUE_AVX2)
+   const __m256i zero = _mm256_setzero_si256();
+   const __m256i max = _mm256_set1_epi16(ActivationMax);
+   __m256i sum = _mm256_setzero_si256();
+   for (std::size_t i = 0; i < HiddenSize; i += StepSize)
+   {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(neurons + i));
+      v = _mm256_min_epi16(_mm256_max_epi16(v, zero), max);
+      const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+   }
+   const __m128i half =
+      _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+   const __m128i quarter = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+   return _mm_cvtsi128_si32(_mm_add_epi32(quarter, _mm_shuffle_epi32(quarter, 0xb1)));
+#elif defined(NNUE_SSE4)
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i max = _mm_set1_epi16(ActivationMax);
+   __m128i sum = _mm_setzero_si128();
+   for (std::size_t i = 0; i < HiddenSize; i += StepSize)
+   {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(neurons + i));
+      v = _mm_min_epi16(_mm_max_epi16(v, zero), max);
+      const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+   }
+   const __m128i half = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+   return _mm_cvtsi128_si32(_mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1)));
+#elif defined(NNUE_NEON)
+   const int16x8_t zero = vdupq_n_s16(0);
+   const int16x8_t max = vdupq_n_s16(ActivationMax);
+   int32x4_t sum = vdupq_n_s32(0);
+   for (std::size_t i = 0; i < HiddenSize; i += StepSize)
+   {
+      const int16x8_t v = vminq_s16(vmaxq_s16(vld1q_s16(neurons + i), zero), max);
+      const int16x8_t w = vld1q_s16(weights + i);
+      sum = vmlal_s16(sum, vget_low_s16(v), vget_low_s16(w));
+      sum = vmlal_s16(sum, vget_high_s16(v), vget_high_s16(w));
+   }
+   return vaddvq_s32(sum);
+#else
+   int32_t sum = 0;
+   for (std::size_t i = 0; i < HiddenSize; ++i)
+   {
+      const int32_t v = std::clamp<int16_t>(neurons[i], 0, ActivationMax);
+      sum += v * weights[i];
+   }
+   return sum;
+#endif
+}
+
+///////////////////
+
+// Collects the feature weights of the pieces that a move adds and removes for one
+// perspective. Has to be given the position before the move.
+WeightChanges collectChanges(const Network& net, Color perspective, const Position& pos,
+                             PackedMove move)
+{
+   WeightChanges changes;
+   const auto add = [&](Piece piece, Square at)
+   {
+      assert(changes.numAdded < MaxChanges);
+      changes.added[changes.numAdded++] =
+         net.featureWeights(featureIndex(perspective, piece, at));
+   };
+   const auto remove = [&](Piece piece, Square at)
+   {
+      assert(changes.numRemoved < MaxChanges);
+      changes.removed[changes.numRemoved++] =
+         net.featureWeights(featureIndex(perspective, piece, at));
+   };
+
+   const Square from = move.from();
+   const Square to = move.to();
+   assert(pos[from].has_value());
+   const Piece piece = *pos[from];
+   const Color side = color(piece);
+
+   // Same cases as for making moves on positions.
+   if (move.isCastling())
+   {
+      const Rank r = rank(from);
+      const bool onKingside = move.isKingsideCastling();
+      remove(piece, from);
+      add(piece, to);
+      remove(rook(side), makeSquare(onKingside ? fh : fa, r));
+      add(rook(side), makeSquare(onKingside ? ff : fd, r));
+   }
+   else if (move.isEnPassant())
+   {
+      const Square takenAt = makeSquare(file(to), rank(from));
+      remove(piece, from);
+      add(piece, to);
+      remove(pawn(!side), takenAt);
+   }
+   else
+   {
+      remove(piece, from);
+      if (move.isCapture())
+      {
+         assert(pos[to].has_value());
+         remove(*pos[to], to);
+      }
+      add(move.isPromotion() ? move.promotedTo(side) : piece, to);
+   }
+
+   return changes;
+}
+
+} // namespace
+
+
+namespace matt2
+{
+namespace nnue
+{
+///////////////////
+
+// Read-only memory mapping of a file.
+class Network::MappedFile
+{
+ public:
+   explicit MappedFile(const std::string& path);
+   ~MappedFile();
+   MappedFile(const MappedFile&) = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+
+   const std::byte* data() const { return m_data; }
+   std::size_t size() const { return m_size; }
+
+ private:
+   const std::byte* m_data = nullptr;
+   std::size_t m_size = 0;
+#ifdef _WIN32
+   HANDLE m_file = INVALID_HANDLE_VALUE;
+   HANDLE m_mapping = nullptr;
+#endif
+};
+
+
+#ifdef _WIN32
+
+Network::MappedFile::MappedFile(const std::string& path)
+{
+   m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (m_file == INVALID_HANDLE_VALUE)
+      throwInvalidNetwork("Failed to open network file.");
+
+   LARGE_INTEGER size;
+   if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+   {
+      CloseHandle(m_file);
+      throwInvalidNetwork("Invalid network file.");
+   }
+
+   m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   const void* view =
+      m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+   if (!view)
+   {
+      if (m_mapping)
+         CloseHandle(m_mapping);
+      CloseHandle(m_file);
+      throwInvalidNetwork("Failed to map network file.");
+   }
+
+   m_data = static_cast<const std::byte*>(view);
+   m_size = static_cast<std::size_t>(size.QuadPart);
+}
+
+
+Network::MappedFile::~MappedFile()
+{
+   UnmapViewOfFile(m_data);
+   CloseHandle(m_mapping);
+   CloseHandle(m_file);
+}
+
+#else
+
+Network::MappedFile::MappedFile(const std::string& path)
+{
+   const int fd = open(path.c_str(), O_RDONLY);
+   if (fd < 0)
+      throwInvalidNetwork("Failed to open network file.");
+
+   struct stat info;
+   if (fstat(fd, &info) != 0 || info.st_size == 0)
+   {
+      close(fd);
+      throwInvalidNetwork("Invalid network file.");
+   }
+
+   // The mapping stays valid after closing the file.
+   const std::size_t size = static_cast<std::size_t>(info.st_size);
+   void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (mapped == MAP_FAILED)
+      throwInvalidNetwork("Failed to map network file.");
+
+   m_data = static_cast<const std::byte*>(mapped);
+   m_size = size;
+}
+
+
+Network::MappedFile::~MappedFile()
+{
+   munmap(const_cast<std::byte*>(m_data), m_size);
+}
+
+#endif // _WIN32
+
+///////////////////
+
+Network::~Network() = default;
+
+
+std::unique_ptr<Network> Network::load(const std::string& path)
+{
+   std::unique_ptr<Network> net{new Network};
+   net->m_file = std::make_unique<MappedFile>(path);
+   net->attach(net->m_file->data(), net->m_file->size());
+   return net;
+}
+
+
+std::unique_ptr<Network> Network::create(const NetworkWeights& weights)
+{
+   if (weights.hiddenBiases.size() != HiddenSize ||
+       weights.featureWeights.size() != NumFeatures * HiddenSize ||
+       weights.outputWeights.size() != 2 * HiddenSize)
+      throwInvalidNetwork("Invalid network weights.");
+
+   // Builds the content of a network file, so that both kinds of networks are
+   // accessed the same way.
+   std::unique_ptr<Network> net{new Network};
+   net->m_buffer.resize(FileSize);
+   std::byte* data = net->m_buffer.data();
+
+   FileHeader header{};
+   std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+   header.version = FileVersion;
+   header.numFeatures = NumFeatures;
+   header.hiddenSize = HiddenSize;
+   std::memcpy(data, &header, sizeof(header));
+
+   std::memcpy(data + HiddenBiasesOffset, weights.hiddenBiases.data(),
+               HiddenSize * sizeof(int16_t));
+   std::memcpy(data + FeatureWeightsOffset, weights.featureWeights.data(),
+               NumFeatures * HiddenSize * sizeof(int16_t));
+   std::memcpy(data + OutputWeightsOffset, weights.outputWeights.data(),
+               2 * HiddenSize * sizeof(int16_t));
+   std::memcpy(data + OutputBiasOffset, &weights.outputBias, sizeof(int32_t));
+
+   net->attach(data, net->m_buffer.size());
+   return net;
+}
+
+
+std::unique_ptr<Network> Network::makePieceSquareNetwork()
+{
+   // Each perspective has one neuron for each square, which holds the value of the
+   // side's own piece on the square divided by the scale. Kings are left out because
+   // both sides always have one. The output weights multiply the values back, adding
+   // them for white and subtracting them for black.
+   constexpr int16_t Scale = 4;
+   static_assert(dcs::QueenValue / Scale < ActivationMax);
+
+   NetworkWeights weights;
+   for (std::size_t p = 0; p < 6; ++p)
+   {
+      const Piece piece = static_cast<Piece>(p);
+      if (isKing(piece))
+         continue;
+
+      for (std::size_t sq = 0; sq < 64; ++sq)
+      {
+         const Square at = static_cast<Square>(sq);
+         // The position bonuses of black pieces are mirrored, so the same weights fit
+         // both perspectives.
+         const std::size_t feature = featureIndex(White, piece, at);
+         weights.featureWeights[feature * HiddenSize + sq] =
+            static_cast<int16_t>(dcs::pieceSquareValue(piece, at).mg() / Scale);
+      }
+   }
+
+   for (std::size_t sq = 0; sq < 64; ++sq)
+   {
+      weights.outputWeights[sq] = Scale * OutputScale;
+      weights.outputWeights[HiddenSize + sq] = -Scale * OutputScale;
+   }
+
+   return create(weights);
+}
+
+
+void Network::save(const std::string& path) const
+{
+   std::ofstream out{path, std::ios::binary | std::ios::trunc};
+   if (!out)
+      throwInvalidNetwork("Failed to create network file.");
+
+   const std::byte* data = m_file ? m_file->data() : m_buffer.data();
+   out.write(reinterpret_cast<const char*>(data), FileSize);
+   if (!out)
+      throwInvalidNetwork("Failed to write network file.");
+}
+
+
+void Network::attach(const std::byte* data, std::size_t size)
+{
+   if (size != FileSize)
+      throwInvalidNetwork("Invalid size of network file.");
+
+   FileHeader header;
+   std::memcpy(&header, data, sizeof(header));
+   if (std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 ||
+       header.version != FileVersion)
+      throwInvalidNetwork("Invalid network file.");
+   if (header.numFeatures != NumFeatures || header.hiddenSize != HiddenSize)
+      throwInvalidNetwork("Unsupported network layout.");
+
+   m_hiddenBiases = reinterpret_cast<const int16_t*>(data + HiddenBiasesOffset);
+   m_featureWeights = reinterpret_cast<const int16_t*>(data + FeatureWeightsOffset);
+   m_outputWeights = reinterpret_cast<const int16_t*>(data + OutputWeightsOffset);
+   std::memcpy(&m_outputBias, data + OutputBiasOffset, sizeof(int32_t));
+}
+
+///////////////////
+
+void refresh(Accumulator& acc, const Network& net, const Position& pos)
+{
+   for (Color perspective : {White, Black})
+   {
+      int16_t* neurons = acc.values[perspectiveIdx(perspective)].data();
+      std::copy_n(net.hiddenBiases(), HiddenSize, neurons);
+
+      for (std::size_t p = 0; p < 12; ++p)
+      {
+         const Piece piece = static_cast<Piece>(p);
+         Bitboard pieces = pos.occupied(piece);
+         while (pieces != EmptyBB)
+         {
+            const Square at = popLowestSquare(pieces);
+            addNeurons(neurons, net.featureWeights(featureIndex(perspective, piece, at)));
+         }
+      }
+   }
+}
+
+
+Score evaluate(const Accumulator& acc, const Network& net)
+{
+   const int32_t sum = sumOutput(acc.values[0].data(), net.outputWeights(White)) +
+                       sumOutput(acc.values[1].data(), net.outputWeights(Black)) +
+                       net.outputBias();
+   constexpr Score MaxScore = MateScore - MaxMatePly;
+   return std::clamp<Score>(sum / OutputScale, -MaxScore, MaxScore);
+}
+
+
+Score evaluate(const Network& net, const Position& pos)
+{
+   Accumulator acc;
+   refresh(acc, net, pos);
+   return evaluate(acc, net);
+}
+
+///////////////////
+
+AccumulatorStack::AccumulatorStack(const Network& net) : m_net{net}
+{
+   // Enough for the depths of typical searches.
+   m_stack.reserve(32);
+}
+
+
+void AccumulatorStack::reset(const Position& pos)
+{
+   if (m_stack.empty())
+      m_stack.emplace_back();
+   m_size = 1;
+   refresh(m_stack[0], m_net, pos);
+}
+
+
+void AccumulatorStack::push(const Position& pos, PackedMove move)
+{
+   assert(m_size > 0);
+   if (m_size == m_stack.size())
+      m_stack.emplace_back();
+
+   const Accumulator& prev = m_stack[m_size - 1];
+   Accumulator& next = m_stack[m_size];
+   for (Color perspective : {White, Black})
+   {
+      const std::size_t idx = perspectiveIdx(perspective);
+      updateNeurons(next.values[idx].data(), prev.values[idx].data(),
+                    collectChanges(m_net, perspective, pos, move));
+   }
+   ++m_size;
+}
+
+
+void AccumulatorStack::pop()
+{
+   assert(m_size > 1);
+   --m_size;
+}
+
+
+Position::UndoState AccumulatorStack::makeMove(Position& pos, PackedMove move)
+{
+   push(pos, move);
+   return pos.makeMove(move);
+}
+
+
+void AccumulatorStack::unmakeMove(Position& pos, PackedMove move,
+                                  const Position::UndoState& undo)
+{
+   pos.unmakeMove(move, undo);
+   pop();
+}
+
+
+std::string_view simdName()
+{
+#if defined(NNUE_AVX2)
+   return "AVX2";
+#elif defined(NNUE_SSE4)
+   return "SSE4.1";
+#elif defined(NNUE_NEON)
+   return "NEON";
+#else
+   return "scalar";
+#endif
+}
+
+} // namespace nnue
+} // namespace matt2
@@ -0,0 +1,188 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "packed_move.h"
+#include "piece.h"
+#include "position.h"
+#include "scoring.h"
+#include "square.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Scoring with an efficiently updatable neural network (NNUE).
+// The network has one input feature for each kind of piece on each square. Features
+// are seen from the perspective of each side, with the side's own pieces first and the
+// board mirrored for black. Both perspectives share the weights of the hidden layer.
+// The hidden neurons of each perspective are kept in an accumulator, which is updated
+// incrementally when pieces move instead of being calculated from all pieces. The
+// clipped hidden neurons of both perspectives feed a single output neuron that scores
+// the position from white's point of view.
+
+namespace matt2
+{
+namespace nnue
+{
+///////////////////
+
+constexpr std::size_t NumFeatures = 768;
+constexpr std::size_t HiddenSize = 256;
+
+// Quantization.
+// Weights are 16-bit integers. Hidden neurons are clipped to [0, ActivationMax] before
+// feeding the output neuron, whose sum is divided by the output scale to get a score
+// in centipawns.
+constexpr int16_t ActivationMax = 255;
+constexpr int32_t OutputScale = 64;
+
+// Returns the index of the input feature for a piece on a square seen from the
+// perspective of a given side.
+constexpr std::size_t featureIndex(Color perspective, Piece piece, Square at)
+{
+   const std::size_t relColor = color(piece) == perspective ? 0 : 1;
+   const std::size_t type = static_cast<std::size_t>(piece) % 6;
+   const Square relSq = perspective == White ? at : flipRank(at);
+   return (relColor * 6 + type) * 64 + static_cast<std::size_t>(relSq);
+}
+
+constexpr std::size_t perspectiveIdx(Color side)
+{
+   return side == White ? 0 : 1;
+}
+
+///////////////////
+
+// Weights of a network in the order in which they are stored in network files.
+struct NetworkWeights
+{
+   // Biases of the hidden neurons.
+   std::vector<int16_t> hiddenBiases = std::vector<int16_t>(HiddenSize);
+   // Weights from the input features to the hidden neurons. The weights of each
+   // feature are consecutive.
+   std::vector<int16_t> featureWeights = std::vector<int16_t>(NumFeatures * HiddenSize);
+   // Weights from the hidden neurons of white's and then black's perspective to the
+   // output neuron.
+   std::vector<int16_t> outputWeights = std::vector<int16_t>(2 * HiddenSize);
+   int32_t outputBias = 0;
+};
+
+
+// Network with read-only weights. Networks loaded from files are mapped into memory
+// instead of being copied.
+class Network
+{
+ public:
+   ~Network();
+   Network(const Network&) = delete;
+   Network& operator=(const Network&) = delete;
+
+   // Maps a network file into memory. Throws std::runtime_error if the file cannot be
+   // read or does not hold a network of the expected layout.
+   static std::unique_ptr<Network> load(const std::string& path);
+   static std::unique_ptr<Network> create(const NetworkWeights& weights);
+   // Creates a network whose score approximates the sums of piece values and position
+   // bonuses of the dcs rules. Stands in for a trained network and is useful for
+   // testing.
+   static std::unique_ptr<Network> makePieceSquareNetwork();
+
+   // Writes the network into a file that can be loaded. Throws std::runtime_error if
+   // the file cannot be written.
+   void save(const std::string& path) const;
+
+   const int16_t* hiddenBiases() const { return m_hiddenBiases; }
+   const int16_t* featureWeights(std::size_t feature) const
+   {
+      return m_featureWeights + feature * HiddenSize;
+   }
+   const int16_t* outputWeights(Color perspective) const
+   {
+      return m_outputWeights + perspectiveIdx(perspective) * HiddenSize;
+   }
+   int32_t outputBias() const { return m_outputBias; }
+
+ private:
+   class MappedFile;
+
+   Network() = default;
+   // Points the weights into the memory of a network file.
+   void attach(const std::byte* data, std::size_t size);
+
+ private:
+   // Memory that holds the file content. Either a mapped file or a buffer.
+   std::unique_ptr<MappedFile> m_file;
+   std::vector<std::byte> m_buffer;
+   const int16_t* m_hiddenBiases = nullptr;
+   const int16_t* m_featureWeights = nullptr;
+   const int16_t* m_outputWeights = nullptr;
+   int32_t m_outputBias = 0;
+};
+
+///////////////////
+
+// Hidden neurons of both perspectives for a position.
+struct Accumulator
+{
+   alignas(64) std::array<std::array<int16_t, HiddenSize>, 2> values;
+};
+
+// Calculates the accumulator of a position from all its pieces.
+void refresh(Accumulator& acc, const Network& net, const Position& pos);
+// Scores a position from white's point of view. Scores are kept below the range of
+// mate scores.
+Score evaluate(const Accumulator& acc, const Network& net);
+// Scores a position by calculating its accumulator from scratch.
+Score evaluate(const Network& net, const Position& pos);
+
+
+// Accumulators of the positions along a line of moves. Making a move pushes an
+// accumulator that is updated from the previous one for the pieces that the move
+// changes. Taking the move back pops it again.
+class AccumulatorStack
+{
+ public:
+   explicit AccumulatorStack(const Network& net);
+
+   // Calculates the accumulator of a position from scratch and makes it the only one
+   // on the stack.
+   void reset(const Position& pos);
+   // Pushes the accumulator of the position after a move. Has to be given the position
+   // before the move.
+   void push(const Position& pos, PackedMove move);
+   void pop();
+   // Make and take back a move on a position and update the stack along with it.
+   Position::UndoState makeMove(Position& pos, PackedMove move);
+   void unmakeMove(Position& pos, PackedMove move, const Position::UndoState& undo);
+
+   std::size_t size() const { return m_size; }
+   const Accumulator& top() const;
+   // Scores the position of the top accumulator.
+   Score evaluate() const { return nnue::evaluate(top(), m_net); }
+
+ private:
+   const Network& m_net;
+   // Accumulators are kept when popped, so that pushing does not allocate once the
+   // stack has grown to the depth of a search.
+   std::vector<Accumulator> m_stack;
+   std::size_t m_size = 0;
+};
+
+// Returns the name of the instruction set that the network calculations use.
+std::string_view simdName();
+
+///////////////////
+
+inline const Accumulator& AccumulatorStack::top() const
+{
+   assert(m_size > 0);
+   return m_stack[m_size - 1];
+}
+
+} // namespace nnue
+} // namespace matt2
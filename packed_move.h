@@ -0,0 +1,140 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "piece.h"
+#include "square.h"
+#include <cstdint>
+#include <string>
+
+
+namespace matt2
+{
+///////////////////
+
+// Compact representation of a move in 16 bits.
+// Bits 0-5 hold the origin square, bits 6-11 the destination square and bits 12-15
+// flags that describe the move type. The moved and taken pieces are not stored and have
+// to be looked up in the position that the move is applied to.
+// Meant to be used where many moves are stored or copied, e.g. move generation,
+// ordering, hash entries and move history.
+class PackedMove
+{
+ public:
+   // clang-format off
+   enum class Flag : uint16_t
+   {
+      Quiet = 0,
+      DoublePawnPush = 1,
+      KingsideCastling = 2,
+      QueensideCastling = 3,
+      Capture = 4,
+      EnPassant = 5,
+      KnightPromotion = 8,
+      BishopPromotion = 9,
+      RookPromotion = 10,
+      QueenPromotion = 11,
+      KnightPromotionCapture = 12,
+      BishopPromotionCapture = 13,
+      RookPromotionCapture = 14,
+      QueenPromotionCapture = 15
+   };
+   // clang-format on
+
+ public:
+   PackedMove() = default;
+   PackedMove(Square from, Square to, Flag flag = Flag::Quiet);
+
+   Square from() const { return static_cast<Square>(m_data & SquareMask); }
+   Square to() const { return static_cast<Square>((m_data >> ToShift) & SquareMask); }
+   Flag flag() const { return static_cast<Flag>(m_data >> FlagShift); }
+   uint16_t value() const { return m_data; }
+   // A default constructed move is not a valid move because its origin and destination
+   // are the same.
+   bool isNull() const { return m_data == 0; }
+
+   bool isCapture() const { return (flagBits() & CaptureBit) != 0; }
+   bool isPromotion() const { return (flagBits() & PromotionBit) != 0; }
+   bool isEnPassant() const { return flag() == Flag::EnPassant; }
+   bool isDoublePawnPush() const { return flag() == Flag::DoublePawnPush; }
+   bool isCastling() const;
+   bool isKingsideCastling() const { return flag() == Flag::KingsideCastling; }
+   // Returns the piece that a pawn of the given color is promoted to. Only valid for
+   // promotions.
+   Piece promotedTo(Color side) const;
+
+   friend bool operator==(PackedMove a, PackedMove b) { return a.m_data == b.m_data; }
+   friend bool operator!=(PackedMove a, PackedMove b) { return !(a == b); }
+
+   static Flag promotionFlag(Piece promotedTo, bool isCapture);
+
+ private:
+   uint16_t flagBits() const { return m_data >> FlagShift; }
+
+ private:
+   static constexpr uint16_t SquareMask = 0x3f;
+   static constexpr uint16_t ToShift = 6;
+   static constexpr uint16_t FlagShift = 12;
+   static constexpr uint16_t CaptureBit = 0x4;
+   static constexpr uint16_t PromotionBit = 0x8;
+
+   uint16_t m_data = 0;
+};
+
+static_assert(sizeof(PackedMove) == 2);
+
+
+inline PackedMove::PackedMove(Square from, Square to, Flag flag)
+: m_data{static_cast<uint16_t>(static_cast<uint16_t>(from) |
+                               (static_cast<uint16_t>(to) << ToShift) |
+                               (static_cast<uint16_t>(flag) << FlagShift))}
+{
+}
+
+inline bool PackedMove::isCastling() const
+{
+   return flag() == Flag::KingsideCastling || flag() == Flag::QueensideCastling;
+}
+
+inline Piece PackedMove::promotedTo(Color side) const
+{
+   // Lowest two flag bits encode the piece type.
+   switch (flagBits() & 0x3)
+   {
+   case 0:
+      return knight(side);
+   case 1:
+      return bishop(side);
+   case 2:
+      return rook(side);
+   default:
+      return queen(side);
+   }
+}
+
+inline PackedMove::Flag PackedMove::promotionFlag(Piece promotedTo, bool isCapture)
+{
+   uint16_t bits = PromotionBit | (isCapture ? CaptureBit : 0);
+   if (isBishop(promotedTo))
+      bits |= 1;
+   else if (isRook(promotedTo))
+      bits |= 2;
+   else if (isQueen(promotedTo))
+      bits |= 3;
+   return static_cast<Flag>(bits);
+}
+
+// Returns move in Pure Algebraic Coordinate Notation, e.g. "e2e4" or "b7b8q".
+inline std::string toString(PackedMove move)
+{
+   std::string s = toString(move.from()) + toString(move.to());
+   if (move.isPromotion())
+   {
+      static constexpr char PromotionChars[] = {'n', 'b', 'r', 'q'};
+      s += PromotionChars[static_cast<uint16_t>(move.flag()) & 0x3];
+   }
+   return s;
+}
+
+} // namespace matt2
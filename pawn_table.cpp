@@ -0,0 +1,60 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "pawn_table.h"
+#include "position.h"
+#include <algorithm>
+
+namespace matt2
+{
+namespace dcs
+{
+///////////////////
+
+PawnTable::PawnTable(std::size_t numEntries)
+{
+   std::size_t size = 1;
+   while (size * 2 <= numEntries)
+      size *= 2;
+
+   m_entries = std::make_unique<PawnEntry[]>(size);
+   m_indexMask = size - 1;
+}
+
+
+const PawnEntry* PawnTable::probe(const Position& pos)
+{
+   const Bitboard whitePawns = pos.occupied(Pw);
+   const Bitboard blackPawns = pos.occupied(Pb);
+   const PawnEntry& e = entry(pos.pawnKey());
+   if (e.pawns[0] != whitePawns || e.pawns[1] != blackPawns)
+   {
+      ++m_misses;
+      return nullptr;
+   }
+
+   ++m_hits;
+   return &e;
+}
+
+
+PawnEntry& PawnTable::store(const Position& pos)
+{
+   PawnEntry& e = entry(pos.pawnKey());
+   e = PawnEntry{};
+   e.pawns = {pos.occupied(Pw), pos.occupied(Pb)};
+   return e;
+}
+
+
+void PawnTable::clear()
+{
+   // Empty entries hold the results for positions without pawns.
+   std::fill(m_entries.get(), m_entries.get() + m_indexMask + 1, PawnEntry{});
+   m_hits = 0;
+   m_misses = 0;
+}
+
+} // namespace dcs
+} // namespace matt2
@@ -0,0 +1,98 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "bitboard.h"
+#include "piece.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace matt2
+{
+class Position;
+}
+
+
+namespace matt2
+{
+namespace dcs
+{
+///////////////////
+
+// Scoring results that only depend on the pawn structure of a position. Values are
+// indexed by color.
+struct PawnEntry
+{
+   static constexpr std::size_t colorIdx(Color side) { return side == White ? 0 : 1; }
+
+   // Squares of the pawns of each color. Identify the structure exactly, so that
+   // entries of different structures with the same key are never mixed up.
+   std::array<Bitboard, 2> pawns = {EmptyBB, EmptyBB};
+   std::array<Bitboard, 2> passedPawns = {EmptyBB, EmptyBB};
+   // Numbers that the pawn rules apply with. Their weights are applied when scoring,
+   // so that entries don't depend on the weights.
+   std::array<uint8_t, 2> passedPawnRanks = {0, 0};
+   std::array<uint8_t, 2> numDoubledFiles = {0, 0};
+   std::array<uint8_t, 2> numIsolatedFiles = {0, 0};
+   // Files with pawns of each color. Bit n is set for the nth file.
+   std::array<uint8_t, 2> pawnFiles = {0, 0};
+
+   // Files without pawns of either color.
+   uint8_t openFiles() const;
+   // Files with pawns of the opponent of a given side but without own pawns.
+   uint8_t halfOpenFiles(Color side) const;
+};
+
+///////////////////
+
+// Cache for the scoring results of pawn structures. Pawn structures change rarely
+// between the positions of a search, so most lookups hit.
+// Not thread-safe. Each thread needs its own table.
+class PawnTable
+{
+ public:
+   static constexpr std::size_t DefaultNumEntries = std::size_t{1} << 14;
+
+   // The number of entries is rounded down to a power of two.
+   explicit PawnTable(std::size_t numEntries = DefaultNumEntries);
+
+   // Returns the entry for the pawn structure of a position or nullptr if the structure
+   // is not cached.
+   const PawnEntry* probe(const Position& pos);
+   // Returns the entry to fill with the results for the pawn structure of a position.
+   // The previous content of the entry is replaced.
+   PawnEntry& store(const Position& pos);
+   void clear();
+
+   uint64_t hits() const { return m_hits; }
+   uint64_t misses() const { return m_misses; }
+
+ private:
+   PawnEntry& entry(uint64_t key) { return m_entries[key & m_indexMask]; }
+
+ private:
+   std::unique_ptr<PawnEntry[]> m_entries;
+   uint64_t m_indexMask = 0;
+   uint64_t m_hits = 0;
+   uint64_t m_misses = 0;
+};
+
+
+///////////////////
+
+inline uint8_t PawnEntry::openFiles() const
+{
+   return static_cast<uint8_t>(~(pawnFiles[0] | pawnFiles[1]));
+}
+
+inline uint8_t PawnEntry::halfOpenFiles(Color side) const
+{
+   const std::size_t idx = colorIdx(side);
+   return static_cast<uint8_t>(~pawnFiles[idx] & pawnFiles[1 - idx]);
+}
+
+} // namespace dcs
+} // namespace matt2
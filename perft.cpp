@@ -0,0 +1,358 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "perft.h"
+#include "move.h"
+#include "rules.h"
+#include "thread_pool.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+template <Color Us> void collectLegalMoves(Position& pos, PackedMoveList& moves)
+{
+   collectSideMoves<Us>(pos, moves);
+
+   // Eliminate moves that would lead to check.
+   auto checkIt = std::remove_if(moves.begin(), moves.end(),
+                                 [&pos](PackedMove m)
+                                 {
+                                    const auto undo = pos.makeMove(m);
+                                    const bool leadsToCheck = isCheck<Us>(pos);
+                                    pos.unmakeMove(m, undo);
+                                    return leadsToCheck;
+                                 });
+   moves.erase(checkIt, moves.end());
+}
+
+
+// Hash table for node counts of subtrees.
+// Can be shared between threads without locking. Each entry stores its key xor-ed with
+// its data, so that entries that are written by multiple threads at the same time are
+// detected as invalid instead of returning wrong counts.
+class PerftHashTable
+{
+ public:
+   explicit PerftHashTable(std::size_t sizeMB);
+
+   std::optional<uint64_t> probe(uint64_t key, std::size_t depth) const;
+   void store(uint64_t key, std::size_t depth, uint64_t nodes);
+
+ private:
+   struct Entry
+   {
+      std::atomic<uint64_t> check{0};
+      std::atomic<uint64_t> data{0};
+   };
+
+   // The depth is stored in the lowest bits of the data, the node count in the others.
+   static constexpr uint64_t DepthBits = 8;
+   static constexpr uint64_t DepthMask = (uint64_t{1} << DepthBits) - 1;
+
+   const Entry& entry(uint64_t key) const { return m_entries[key & m_indexMask]; }
+   Entry& entry(uint64_t key) { return m_entries[key & m_indexMask]; }
+
+ private:
+   std::unique_ptr<Entry[]> m_entries;
+   uint64_t m_indexMask = 0;
+};
+
+
+PerftHashTable::PerftHashTable(std::size_t sizeMB)
+{
+   // Use the largest power of two number of entries that fits into the size.
+   const std::size_t maxEntries =
+      std::max<std::size_t>(sizeMB * 1024 * 1024 / sizeof(Entry), 1);
+   std::size_t numEntries = 1;
+   while (numEntries * 2 <= maxEntries)
+      numEntries *= 2;
+
+   m_entries = std::make_unique<Entry[]>(numEntries);
+   m_indexMask = numEntries - 1;
+}
+
+
+std::optional<uint64_t> PerftHashTable::probe(uint64_t key, std::size_t depth) const
+{
+   const Entry& e = entry(key);
+   const uint64_t data = e.data.load(std::memory_order_relaxed);
+   const uint64_t check = e.check.load(std::memory_order_relaxed);
+   if ((check ^ data) != key || (data & DepthMask) != depth)
+      return std::nullopt;
+   return data >> DepthBits;
+}
+
+
+void PerftHashTable::store(uint64_t key, std::size_t depth, uint64_t nodes)
+{
+   assert(depth <= DepthMask);
+   const uint64_t data = (nodes << DepthBits) | depth;
+   Entry& e = entry(key);
+   e.data.store(data, std::memory_order_relaxed);
+   e.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+///////////////////
+
+template <Color Us>
+uint64_t countNodes(Position& pos, std::size_t depth, PerftHashTable* table = nullptr)
+{
+   assert(depth > 0);
+
+   PackedMoveList moves;
+   collectLegalMoves<Us>(pos, moves);
+
+   // The legal moves at the last ply are the leaf nodes.
+   if (depth == 1)
+      return moves.size();
+
+   // Nodes before the last ply are counted in bulk already.
+   const bool useTable = table != nullptr;
+   uint64_t key = 0;
+   if (useTable)
+   {
+      key = zobristHash(pos, Us);
+      if (const auto nodes = table->probe(key, depth); nodes.has_value())
+         return *nodes;
+   }
+
+   uint64_t nodes = 0;
+   for (PackedMove m : moves)
+   {
+      const auto undo = pos.makeMove(m);
+      nodes += countNodes<!Us>(pos, depth - 1, table);
+      pos.unmakeMove(m, undo);
+   }
+
+   if (useTable)
+      table->store(key, depth, nodes);
+   return nodes;
+}
+
+
+// Position at the root of a subtree that is counted as a separate task.
+struct PerftTask
+{
+   Position pos;
+   Color side = White;
+};
+
+
+template <Color Us>
+void collectTasks(Position& pos, std::size_t plies, std::vector<PerftTask>& tasks)
+{
+   if (plies == 0)
+   {
+      tasks.push_back({pos, Us});
+      return;
+   }
+
+   PackedMoveList moves;
+   collectLegalMoves<Us>(pos, moves);
+   for (PackedMove m : moves)
+   {
+      const auto undo = pos.makeMove(m);
+      collectTasks<!Us>(pos, plies - 1, tasks);
+      pos.unmakeMove(m, undo);
+   }
+}
+
+
+// Counts a leaf node. The move leading to the node has to be made already.
+template <Color Us> void countLeaf(Position& pos, PackedMove m, PerftStats& stats)
+{
+   ++stats.nodes;
+   if (m.isCapture())
+      ++stats.captures;
+   if (m.isEnPassant())
+      ++stats.enPassants;
+   if (m.isCastling())
+      ++stats.castles;
+   if (m.isPromotion())
+      ++stats.promotions;
+
+   if (isCheck<!Us>(pos))
+   {
+      ++stats.checks;
+
+      PackedMoveList replies;
+      collectLegalMoves<!Us>(pos, replies);
+      if (replies.empty())
+         ++stats.mates;
+   }
+}
+
+
+template <Color Us> void countStats(Position& pos, std::size_t depth, PerftStats& stats)
+{
+   assert(depth > 0);
+
+   PackedMoveList moves;
+   collectLegalMoves<Us>(pos, moves);
+
+   for (PackedMove m : moves)
+   {
+      const auto undo = pos.makeMove(m);
+      if (depth == 1)
+         countLeaf<Us>(pos, m, stats);
+      else
+         countStats<!Us>(pos, depth - 1, stats);
+      pos.unmakeMove(m, undo);
+   }
+}
+
+
+template <Color Us>
+std::vector<PerftDivideEntry> divide(Position& pos, std::size_t depth)
+{
+   assert(depth > 0);
+
+   PackedMoveList moves;
+   collectLegalMoves<Us>(pos, moves);
+
+   std::vector<PerftDivideEntry> entries;
+   entries.reserve(moves.size());
+   for (PackedMove m : moves)
+   {
+      const auto undo = pos.makeMove(m);
+      entries.push_back({m, depth > 1 ? countNodes<!Us>(pos, depth - 1) : 1});
+      pos.unmakeMove(m, undo);
+   }
+   return entries;
+}
+
+} // namespace
+
+
+namespace matt2
+{
+///////////////////
+
+uint64_t perft(Position& pos, Color side, std::size_t depth)
+{
+   // The root is the only node of a tree without moves.
+   if (depth == 0)
+      return 1;
+   return side == White ? countNodes<White>(pos, depth) : countNodes<Black>(pos, depth);
+}
+
+
+uint64_t perft(const Position& pos, Color side, std::size_t depth,
+               const PerftOptions& options)
+{
+   // Count the subtrees below the split plies as separate tasks. At least one ply has
+   // to be left for each task.
+   const std::size_t maxSplitPlies = depth > 0 ? depth - 1 : 0;
+   const std::size_t splitPlies =
+      std::min(std::clamp<std::size_t>(options.splitPlies, 1, 2), maxSplitPlies);
+   if (splitPlies == 0)
+   {
+      Position root = pos;
+      return perft(root, side, depth);
+   }
+
+   std::vector<PerftTask> tasks;
+   Position root = pos;
+   if (side == White)
+      collectTasks<White>(root, splitPlies, tasks);
+   else
+      collectTasks<Black>(root, splitPlies, tasks);
+
+   std::unique_ptr<PerftHashTable> table;
+   if (options.hashSizeMB > 0)
+      table = std::make_unique<PerftHashTable>(options.hashSizeMB);
+
+   // Each task writes its own count, so that the sum does not depend on the order in
+   // which tasks finish.
+   std::vector<uint64_t> counts(tasks.size(), 0);
+   const std::size_t taskDepth = depth - splitPlies;
+
+   ThreadPool pool{options.numThreads};
+   pool.run(tasks.size(),
+            [&](std::size_t taskIdx)
+            {
+               PerftTask& task = tasks[taskIdx];
+               counts[taskIdx] = task.side == White
+                                    ? countNodes<White>(task.pos, taskDepth, table.get())
+                                    : countNodes<Black>(task.pos, taskDepth, table.get());
+            });
+
+   uint64_t nodes = 0;
+   for (uint64_t count : counts)
+      nodes += count;
+   return nodes;
+}
+
+
+PerftStats perftStats(Position& pos, Color side, std::size_t depth)
+{
+   PerftStats stats;
+   if (depth == 0)
+      stats.nodes = 1;
+   else if (side == White)
+      countStats<White>(pos, depth, stats);
+   else
+      countStats<Black>(pos, depth, stats);
+   return stats;
+}
+
+
+std::vector<PerftDivideEntry> perftDivide(Position& pos, Color side, std::size_t depth)
+{
+   if (depth == 0)
+      return {};
+   return side == White ? divide<White>(pos, depth) : divide<Black>(pos, depth);
+}
+
+///////////////////
+
+const std::vector<PerftCase>& perftSuite()
+{
+   // Positions and counts from the Chess Programming Wiki's perft results page.
+   // Castling rights follow from the placement of kings and rooks and en-passant is not
+   // available initially in any of the positions. The positions are built at compile
+   // time.
+   static constexpr Position Kiwipete{
+      "Rba8 Kbe8 Rbh8 ba7 bc7 bd7 Qbe7 bf7 Bbg7 Bba6 Nbb6 be6 Nbf6 bg6 wd5 Nwe5 bb4 we4 "
+      "Nwc3 Qwf3 bh3 wa2 wb2 wc2 Bwd2 Bwe2 wf2 wg2 wh2 Rwa1 Kwe1 Rwh1"};
+   static constexpr Position Pos3{"bc7 bd6 Kwa5 wb5 Rbh5 Rwb4 bf4 Kbh4 we2 wg2"};
+   static constexpr Position Pos4{
+      "Rba8 Kbe8 Rbh8 wa7 bb7 bc7 bd7 bf7 bg7 bh7 Bbb6 Nbf6 Bbg6 Nwh6 Nba5 wb5 Bwa4 Bwb4 "
+      "wc4 we4 Qba3 Nwf3 wa2 bb2 wd2 wg2 wh2 Rwa1 Qwd1 Rwf1 Kwg1"};
+   static constexpr Position Pos5{
+      "Rba8 Nbb8 Bbc8 Qbd8 Kbf8 Rbh8 ba7 bb7 wd7 Bbe7 bf7 bg7 bh7 bc6 Bwc4 wa2 wb2 wc2 "
+      "Nwe2 Nbf2 wg2 wh2 Rwa1 Nwb1 Bwc1 Qwd1 Kwe1 Rwh1"};
+   static constexpr Position Pos6{
+      "Rba8 Rbf8 Kbg8 bb7 bc7 Qbe7 bf7 bg7 bh7 ba6 Nbc6 bd6 Nbf6 Bbc5 be5 Bwg5 Bwc4 we4 "
+      "Bbg4 wa3 Nwc3 wd3 Nwf3 wb2 wc2 Qwe2 wf2 wg2 wh2 Rwa1 Rwf1 Kwg1"};
+
+   static const std::vector<PerftCase> Suite = {
+      {"start", StartPos, White, {20, 400, 8902, 197281, 4865609}},
+      {"kiwipete", Kiwipete, White, {48, 2039, 97862, 4085603}},
+      {"pos3", Pos3, White, {14, 191, 2812, 43238, 674624}},
+      {"pos4", Pos4, White, {6, 264, 9467, 422333}},
+      {"pos5", Pos5, White, {44, 1486, 62379, 2103487}},
+      {"pos6", Pos6, White, {46, 2079, 89890, 3894594}},
+   };
+   return Suite;
+}
+
+
+const PerftCase* findPerftCase(std::string_view name)
+{
+   const auto& suite = perftSuite();
+   const auto it = std::find_if(suite.begin(), suite.end(),
+                                [name](const PerftCase& c) { return c.name == name; });
+   return it != suite.end() ? &*it : nullptr;
+}
+
+} // namespace matt2
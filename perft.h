@@ -0,0 +1,110 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "packed_move.h"
+#include "piece.h"
+#include "position.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace matt2
+{
+///////////////////
+
+// Counters for the leaf nodes of a move tree. Each counter besides the node count
+// counts the leaf nodes that were reached with a move of the given type or that have
+// the given property.
+struct PerftStats
+{
+   uint64_t nodes = 0;
+   uint64_t captures = 0;
+   uint64_t enPassants = 0;
+   uint64_t castles = 0;
+   uint64_t promotions = 0;
+   uint64_t checks = 0;
+   uint64_t mates = 0;
+
+   PerftStats& operator+=(const PerftStats& other);
+   friend bool operator==(const PerftStats& a, const PerftStats& b) = default;
+};
+
+
+// Node count for a move at the root of the move tree.
+struct PerftDivideEntry
+{
+   PackedMove move;
+   uint64_t nodes = 0;
+};
+
+
+// Counts the leaf nodes of the tree of legal moves with a given depth. The moves at the
+// last ply are counted without making them (bulk counting).
+// The position is modified while counting but restored before returning.
+uint64_t perft(Position& pos, Color side, std::size_t depth);
+
+// Counts the leaf nodes of the tree of legal moves with a given depth and collects
+// statistics about them. Slower than plain counting because all leaf nodes have to be
+// visited.
+PerftStats perftStats(Position& pos, Color side, std::size_t depth);
+
+// Settings for counting nodes in parallel.
+struct PerftOptions
+{
+   // Number of threads. Zero uses the number of hardware threads.
+   std::size_t numThreads = 0;
+   // Size of the hash table for subtree counts in MB. Transposed subtrees are only
+   // counted once. Zero disables the table.
+   std::size_t hashSizeMB = 0;
+   // Number of plies at the root whose moves are split into separate tasks, one or
+   // two.
+   std::size_t splitPlies = 2;
+};
+
+// Counts the leaf nodes like perft() but splits the work across threads and optionally
+// uses a hash table. The result does not depend on the number of threads.
+uint64_t perft(const Position& pos, Color side, std::size_t depth,
+               const PerftOptions& options);
+
+// Counts the leaf nodes separately for each legal move at the root. Moves are in the
+// order they are generated.
+std::vector<PerftDivideEntry> perftDivide(Position& pos, Color side, std::size_t depth);
+
+///////////////////
+
+// Position with known node counts.
+struct PerftCase
+{
+   std::string name;
+   Position pos;
+   Color side = White;
+   // Expected node counts. Index zero holds the count for depth one.
+   std::vector<uint64_t> nodes;
+};
+
+// Standard positions that cover tricky move generation cases.
+const std::vector<PerftCase>& perftSuite();
+// Returns nullptr if no suite position with the given name exists.
+const PerftCase* findPerftCase(std::string_view name);
+
+
+///////////////////
+
+inline PerftStats& PerftStats::operator+=(const PerftStats& other)
+{
+   nodes += other.nodes;
+   captures += other.captures;
+   enPassants += other.enPassants;
+   castles += other.castles;
+   promotions += other.promotions;
+   checks += other.checks;
+   mates += other.mates;
+   return *this;
+}
+
+} // namespace matt2
@@ -3,7 +3,9 @@
 // MIT license
 //
 #pragma once
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 
 namespace matt2
@@ -21,7 +23,7 @@ constexpr Color White = Color::White;
 constexpr Color Black = Color::Black;
 
 
-inline Color operator!(Color c)
+constexpr Color operator!(Color c)
 {
    return c == White ? Black : White;
 }
@@ -61,29 +63,86 @@ constexpr Piece Pb = Piece::Pb;
 // Create a piece from a given notation. A piece notation consists of a code for
 // the figure, e.g. 'K', 'Q', 'B', and a code for the piece color, e.g. 'w', 'b'.
 // Examples: "Kb", "Rw", "b" (for black pawn).
-Piece makePiece(std::string_view notation);
+constexpr Piece makePiece(std::string_view notation);
 
 // clang-format off
-inline bool isKing(Piece p) { return p == Kw || p == Kb; }
-inline bool isQueen(Piece p) { return p == Qw || p == Qb; }
-inline bool isRook(Piece p) { return p == Rw || p == Rb; }
-inline bool isBishop(Piece p) { return p == Bw || p == Bb; }
-inline bool isKnight(Piece p) { return p == Nw || p == Nb; }
-inline bool isPawn(Piece p) { return p == Pw || p == Pb; }
-
-inline Color color(Piece p) { return p < Kb ? White : Black; }
-inline bool isWhite(Piece p) { return color(p) == White; }
-inline bool isBlack(Piece p) { return color(p) == Black; }
-inline bool haveSameColor(Piece a, Piece b) { return color(a) == color(b); }
-
-inline Piece king(Color side) { return side == White ? Kw : Kb; }
-inline Piece queen(Color side) { return side == White ? Qw : Qb; }
-inline Piece rook(Color side) { return side == White ? Rw : Rb; }
-inline Piece bishop(Color side) { return side == White ? Bw : Bb; }
-inline Piece knight(Color side) { return side == White ? Nw : Nb; }
-inline Piece pawn(Color side) { return side == White ? Pw : Pb; }
+constexpr bool isKing(Piece p) { return p == Kw || p == Kb; }
+constexpr bool isQueen(Piece p) { return p == Qw || p == Qb; }
+constexpr bool isRook(Piece p) { return p == Rw || p == Rb; }
+constexpr bool isBishop(Piece p) { return p == Bw || p == Bb; }
+constexpr bool isKnight(Piece p) { return p == Nw || p == Nb; }
+constexpr bool isPawn(Piece p) { return p == Pw || p == Pb; }
+
+constexpr Color color(Piece p) { return p < Kb ? White : Black; }
+constexpr bool isWhite(Piece p) { return color(p) == White; }
+constexpr bool isBlack(Piece p) { return color(p) == Black; }
+constexpr bool haveSameColor(Piece a, Piece b) { return color(a) == color(b); }
+
+constexpr Piece king(Color side) { return side == White ? Kw : Kb; }
+constexpr Piece queen(Color side) { return side == White ? Qw : Qb; }
+constexpr Piece rook(Color side) { return side == White ? Rw : Rb; }
+constexpr Piece bishop(Color side) { return side == White ? Bw : Bb; }
+constexpr Piece knight(Color side) { return side == White ? Nw : Nb; }
+constexpr Piece pawn(Color side) { return side == White ? Pw : Pb; }
 // clang-format on
 
 std::string toString(Piece piece);
 
+
+constexpr Piece makePiece(std::string_view notation)
+{
+   if (notation.empty())
+      throw std::runtime_error("Invalid notation for piece.");
+
+   // Read piece type as the white piece of the type.
+   std::size_t idx = 0;
+   Piece whitePiece = Pw;
+   switch (notation[idx])
+   {
+   // Pieces with letter notation.
+   case 'K':
+      whitePiece = Kw;
+      ++idx;
+      break;
+   case 'Q':
+      whitePiece = Qw;
+      ++idx;
+      break;
+   case 'R':
+      whitePiece = Rw;
+      ++idx;
+      break;
+   case 'B':
+      whitePiece = Bw;
+      ++idx;
+      break;
+   case 'N':
+      whitePiece = Nw;
+      ++idx;
+      break;
+   // Pawns have no letter to identify them.
+   case 'w':
+   case 'b':
+      break;
+   default:
+      throw std::runtime_error("Invalid notation for piece.");
+   }
+
+   if (idx >= notation.size())
+      throw std::runtime_error("Invalid notation for piece.");
+
+   // Read piece color.
+   switch (notation[idx])
+   {
+   case 'w':
+      return whitePiece;
+   case 'b':
+      // Black pieces follow the white pieces in the same order.
+      return static_cast<Piece>(static_cast<unsigned char>(whitePiece) +
+                                static_cast<unsigned char>(Kb));
+   default:
+      throw std::runtime_error("Invalid notation for piece.");
+   }
+}
+
 } // namespace matt2
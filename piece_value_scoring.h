@@ -4,6 +4,7 @@
 //
 #pragma once
 #include "piece.h"
+#include "scoring.h"
 #include <array>
 #include <optional>
 
@@ -19,10 +20,10 @@ namespace pvs
 ///////////////////
 
 // Lookup table for piece values. Indexed by Piece values.
-using PieceValueTable = std::array<double, 12>;
+using PieceValueTable = std::array<Score, 12>;
 
 // Simplify lookup for individual piece.
-inline double lookupValue(Piece piece, const PieceValueTable& values)
+inline Score lookupValue(Piece piece, const PieceValueTable& values)
 {
    return values[static_cast<size_t>(piece)];
 }
@@ -30,24 +31,24 @@ inline double lookupValue(Piece piece, const PieceValueTable& values)
 ///////////////////
 
 // Calculate score for one type of piece.
-double score(const Position& pos, Piece piece,
-             const std::optional<PieceValueTable>& values = std::nullopt);
+Score score(const Position& pos, Piece piece,
+            const std::optional<PieceValueTable>& values = std::nullopt);
 
 // Calculate score for one side.
-double score(const Position& pos, Color side,
-             const std::optional<PieceValueTable>& values = std::nullopt);
+Score score(const Position& pos, Color side,
+            const std::optional<PieceValueTable>& values = std::nullopt);
 
 // Calculate score for entire position.
-double score(const Position& pos,
-             const std::optional<PieceValueTable>& values = std::nullopt);
+Score score(const Position& pos,
+            const std::optional<PieceValueTable>& values = std::nullopt);
 
 // Calculate score for a mate.
-double scoreMate(const Position& pos, size_t atDepth, Color side,
-                 const std::optional<PieceValueTable>& values = std::nullopt);
+Score scoreMate(const Position& pos, size_t atDepth, Color side,
+                const std::optional<PieceValueTable>& values = std::nullopt);
 
 // Calculate score for a tie.
-double scoreTie(const Position& pos, Color side,
-                const std::optional<PieceValueTable>& values = std::nullopt);
+Score scoreTie(const Position& pos, Color side,
+               const std::optional<PieceValueTable>& values = std::nullopt);
 
 } // namespace pvs
 } // namespace matt2
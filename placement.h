@@ -6,6 +6,7 @@
 #include "piece.h"
 #include "square.h"
 #include <string>
+#include <string_view>
 
 
 namespace matt2
@@ -16,12 +17,12 @@ namespace matt2
 class Placement
 {
  public:
-   Placement(Piece piece, Square at);
+   constexpr Placement(Piece piece, Square at);
    // Notation examples: "Kbb3", "Rwh1", "bc7"
-   explicit Placement(std::string_view notation);
+   constexpr explicit Placement(std::string_view notation);
 
-   Piece piece() const { return m_piece; }
-   Square at() const { return m_at; }
+   constexpr Piece piece() const { return m_piece; }
+   constexpr Square at() const { return m_at; }
 
  private:
    Piece m_piece;
@@ -29,13 +30,13 @@ class Placement
 };
 
 
-inline Placement::Placement(Piece piece, Square at) : m_piece{piece}, m_at{at}
+constexpr Placement::Placement(Piece piece, Square at) : m_piece{piece}, m_at{at}
 {
 }
 
-inline Placement::Placement(std::string_view notation) : m_piece{makePiece(notation)}
+constexpr Placement::Placement(std::string_view notation)
+: m_piece{makePiece(notation)}, m_at{makeSquare(notation.substr(isPawn(m_piece) ? 1 : 2))}
 {
-   m_at = makeSquare(notation.substr(isPawn(m_piece) ? 1 : 2));
 }
 
 inline bool operator==(const Placement& a, const Placement& b)
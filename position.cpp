@@ -11,77 +11,64 @@
 using namespace matt2;
 
 
-namespace
-{
-///////////////////
-
-static constexpr char PieceDelimCh = ' ';
-static constexpr std::size_t PieceDelimLen = 1;
-
-} // namespace
-
-
 namespace matt2
 {
 ///////////////////
 
-Position::Position(std::string_view placements)
-{
-   populate(placements);
-}
 
-
-void Position::populate(std::string_view placements)
+void Position::remove(const Placement& placement)
 {
-   std::size_t pos = 0;
-   std::size_t next = placements.find(PieceDelimCh, pos);
-   while (next != -1)
-   {
-      if (next > pos)
-         add(placements.substr(pos, next - pos));
-
-      pos = next + PieceDelimLen;
-      next = placements.find(PieceDelimCh, pos);
-   }
-
-   // Process last placement.
-   if (pos < placements.size())
-      add(placements.substr(pos));
-}
+   const Piece piece = placement.piece();
+   const Square at = placement.at();
+   assert((*this)[at] == piece);
 
+   m_board[toIdx(at)] = EmptySquare;
+   clearBits(piece, at);
+   removeScoreTerms(piece, at);
 
-void Position::add(const Placement& placement)
-{
-   m_board[toIdx(placement.at())] = placement.piece();
-   m_pieces[toColorIdx(placement.piece())].add(placement);
+   if (isKing(piece))
+      setCastlingBit(color(piece), KingMovedBit, true);
+   else if (isRook(piece))
+      updateRookMovedFlag(color(piece), at);
 
    invalidateScore();
 }
 
 
-void Position::remove(const Placement& placement)
+void Position::move(const Relocation& relocation)
 {
-   m_board[toIdx(placement.at())] = std::nullopt;
-   m_pieces[toColorIdx(placement.piece())].remove(placement);
-
-   invalidateScore();
-}
+   const Piece piece = relocation.piece();
+   const Square from = relocation.from();
+   const Square to = relocation.to();
+   assert((*this)[from] == piece);
 
+   // Keep the bitboards and score sums consistent with the board if a piece is
+   // replaced.
+   if (const auto prev = (*this)[to]; prev.has_value())
+   {
+      clearBits(*prev, to);
+      removeScoreTerms(*prev, to);
+   }
 
-void Position::move(const Relocation& relocation)
-{
-   m_board[toIdx(relocation.from())] = std::nullopt;
-   m_board[toIdx(relocation.to())] = relocation.piece();
+   m_board[toIdx(from)] = EmptySquare;
+   m_board[toIdx(to)] = static_cast<uint8_t>(piece);
+   clearBits(piece, from);
+   setBits(piece, to);
+   removeScoreTerms(piece, from);
+   addScoreTerms(piece, to);
 
-   m_pieces[toColorIdx(relocation.piece())].move(relocation.placement(), relocation.to());
+   if (isKing(piece))
+      setCastlingBit(color(piece), KingMovedBit, true);
+   else if (isRook(piece))
+      updateRookMovedFlag(color(piece), from);
 
    invalidateScore();
 }
 
-double Position::updateScore()
+Score Position::updateScore(EvalCache* cache)
 {
-   m_score = calcScore(*this);
-   return *m_score;
+   m_score = cache ? calcScore(*this, *cache) : calcScore(*this);
+   return m_score;
 }
 
 
@@ -122,297 +109,134 @@ bool Position::canAttack(Square sq, const Placement& placement) const
    return std::find(std::begin(attacked), std::end(attacked), sq) != std::end(attacked);
 }
 
-std::optional<Square> Position::kingLocation(Color side) const
+Position::UndoState Position::makeMove(PackedMove move)
 {
-   const ColorPlacements& pieces = m_pieces[Position::toColorIdx(side)];
-   
-   const Piece k = king(side);
-   if (pieces.pieceCount(k) > 0)
-      return pieces.pieceLocation(k, 0);
-   return {};
-}
+   const Square from = move.from();
+   const Square to = move.to();
+   assert((*this)[from].has_value());
+   const Piece piece = *(*this)[from];
+   const Color side = color(piece);
 
-///////////////////
-
-void Position::ColorPlacements::add(const Placement& placement)
-{
-   const Piece& piece = placement.piece();
-   const Square& at = placement.at();
+   // Remember the state before the move, so that we can restore it.
+   UndoState undo{std::nullopt, enPassantSquare(), m_castlingRights};
+   std::optional<Square> enPassantSquare;
 
-   if (isKing(piece))
-   {
-      m_king = at;
-      initKingMovedFlag(color(piece), at);
-   }
-   else if (isQueen(piece))
-   {
-      m_queens.add(at);
-   }
-   else if (isRook(piece))
+   if (move.isCastling())
    {
-      m_rooks.add(at);
-      initRookMovedFlag(color(piece));
+      const Rank r = rank(from);
+      const bool onKingside = move.isKingsideCastling();
+      this->move(Relocation{piece, from, to});
+      this->move(Relocation{rook(side), makeSquare(onKingside ? fh : fa, r),
+                            makeSquare(onKingside ? ff : fd, r)});
+      setHasCastled(side);
    }
-   else if (isBishop(piece))
-   {
-      m_bishops.add(at);
-   }
-   else if (isKnight(piece))
+   else if (move.isEnPassant())
    {
-      m_knights.add(at);
+      const Square takenAt = makeSquare(file(to), rank(from));
+      undo.taken = (*this)[takenAt];
+      assert(undo.taken.has_value());
+      this->move(Relocation{piece, from, to});
+      remove(Placement{*undo.taken, takenAt});
    }
    else
    {
-      assert(isPawn(piece));
-      m_pawns.add(at);
-   }
-}
+      if (move.isCapture())
+      {
+         undo.taken = (*this)[to];
+         assert(undo.taken.has_value());
+         remove(Placement{*undo.taken, to});
+      }
 
+      if (move.isPromotion())
+      {
+         // Adding a rook re-derives the castling rights of its side from the rook
+         // placements. Promotions do not change the rights, so they are restored.
+         const uint8_t castlingRights = m_castlingRights;
+         remove(Placement{piece, from});
+         add(Placement{move.promotedTo(side), to});
+         m_castlingRights = castlingRights;
+      }
+      else
+      {
+         this->move(Relocation{piece, from, to});
+      }
 
-void Position::ColorPlacements::remove(const Placement& placement)
-{
-   const Piece& piece = placement.piece();
-   const Square& at = placement.at();
-
-   if (isKing(piece))
-   {
-      m_king = std::nullopt;
-      m_castlingState.hasKingMoved = true;
-   }
-   else if (isQueen(piece))
-   {
-      m_queens.remove(at);
-   }
-   else if (isRook(piece))
-   {
-      m_rooks.remove(at);
-      updateRookMovedFlag(at);
-   }
-   else if (isBishop(piece))
-   {
-      m_bishops.remove(at);
+      // Moving by two squares allows opponent to use en-passant rule in the next move.
+      if (move.isDoublePawnPush())
+         enPassantSquare = to;
    }
-   else if (isKnight(piece))
-   {
-      m_knights.remove(at);
-   }
-   else
-   {
-      assert(isPawn(piece));
-      m_pawns.remove(at);
-   }
-}
-
-
-void Position::ColorPlacements::move(const Placement& from, Square to)
-{
-   const Piece& piece = from.piece();
-   const Square& at = from.at();
 
-   if (isKing(piece))
-   {
-      m_king = to;
-      m_castlingState.hasKingMoved = true;
-   }
-   else if (isQueen(piece))
-   {
-      m_queens.move(at, to);
-   }
-   else if (isRook(piece))
-   {
-      m_rooks.move(at, to);
-      updateRookMovedFlag(at);
-   }
-   else if (isBishop(piece))
-   {
-      m_bishops.move(at, to);
-   }
-   else if (isKnight(piece))
-   {
-      m_knights.move(at, to);
-   }
-   else
-   {
-      assert(isPawn(piece));
-      m_pawns.move(at, to);
-   }
+   setEnPassantSquare(enPassantSquare);
+   return undo;
 }
 
-std::size_t Position::ColorPlacements::pieceCount(Piece piece) const
-{
-   if (isKing(piece))
-   {
-      return m_king.has_value() ? 1 : 0;
-   }
-   else if (isQueen(piece))
-   {
-      return m_queens.count();
-   }
-   else if (isRook(piece))
-   {
-      return m_rooks.count();
-   }
-   else if (isBishop(piece))
-   {
-      return m_bishops.count();
-   }
-   else if (isKnight(piece))
-   {
-      return m_knights.count();
-   }
-   else if (isPawn(piece))
-   {
-      return m_pawns.count();
-   }
-
-   return 0;
-}
 
-Square Position::ColorPlacements::pieceLocation(Piece piece, std::size_t idx) const
+void Position::unmakeMove(PackedMove move, const UndoState& undo)
 {
-   if (isKing(piece))
-   {
-      if (m_king.has_value() && idx == 0)
-         return *m_king;
-   }
-   else if (isQueen(piece))
-   {
-      if (idx < m_queens.count())
-         return m_queens[idx];
-   }
-   else if (isRook(piece))
-   {
-      if (idx < m_rooks.count())
-         return m_rooks[idx];
-   }
-   else if (isBishop(piece))
-   {
-      if (idx < m_bishops.count())
-         return m_bishops[idx];
-   }
-   else if (isKnight(piece))
+   const Square from = move.from();
+   const Square to = move.to();
+   assert((*this)[to].has_value());
+   const Piece piece = *(*this)[to];
+   const Color side = color(piece);
+
+   if (move.isCastling())
    {
-      if (idx < m_knights.count())
-         return m_knights[idx];
+      const Rank r = rank(from);
+      const bool onKingside = move.isKingsideCastling();
+      this->move(Relocation{rook(side), makeSquare(onKingside ? ff : fd, r),
+                            makeSquare(onKingside ? fh : fa, r)});
+      this->move(Relocation{piece, to, from});
    }
-   else if (isPawn(piece))
+   else if (move.isEnPassant())
    {
-      if (idx < m_pawns.count())
-         return m_pawns[idx];
+      this->move(Relocation{piece, to, from});
+      add(Placement{*undo.taken, makeSquare(file(to), rank(from))});
    }
    else
    {
-      throw std::runtime_error("Unknown piece.");
-   }
-
-   throw std::runtime_error("Piece index out of range.");
-}
+      if (move.isPromotion())
+      {
+         remove(Placement{piece, to});
+         add(Placement{pawn(side), from});
+      }
+      else
+      {
+         this->move(Relocation{piece, to, from});
+      }
 
-
-std::vector<Square> Position::ColorPlacements::locations(Piece piece) const
-{
-   if (isKing(piece))
-   {
-      if (m_king.has_value())
-         return {*m_king};
-   }
-   else if (isQueen(piece))
-   {
-      return m_queens.locations();
-   }
-   else if (isRook(piece))
-   {
-      return m_rooks.locations();
-   }
-   else if (isBishop(piece))
-   {
-      return m_bishops.locations();
-   }
-   else if (isKnight(piece))
-   {
-      return m_knights.locations();
-   }
-   else if (isPawn(piece))
-   {
-      return m_pawns.locations();
+      if (undo.taken)
+         add(Placement{*undo.taken, to});
    }
 
-   return {};
+   // Restore state after the pieces are in place because adding pieces reinitializes
+   // some of the castling state.
+   setEnPassantSquare(undo.enPassantSquare);
+   m_castlingRights = undo.castlingRights;
 }
 
 
-Square Position::ColorPlacements::placement(std::size_t idx) const
+std::vector<Square> Position::locations(Piece piece) const
 {
-   std::size_t numPieces = m_rooks.count();
-   if (idx < numPieces)
-      return m_rooks[idx];
-   idx -= numPieces;
-
-   numPieces = m_bishops.count();
-   if (idx < numPieces)
-      return m_bishops[idx];
-   idx -= numPieces;
-
-   numPieces = m_knights.count();
-   if (idx < numPieces)
-      return m_knights[idx];
-   idx -= numPieces;
-
-   numPieces = m_queens.count();
-   if (idx < numPieces)
-      return m_queens[idx];
-   idx -= numPieces;
-
-   numPieces = m_pawns.count();
-   if (idx < numPieces)
-      return m_pawns[idx];
-   idx -= numPieces;
-
-   numPieces = m_king.has_value() ? 1 : 0;
-   if (idx < numPieces)
-      return *m_king;
-
-   throw std::out_of_range("Invalid index for placement in position.");
-}
-
+   std::vector<Square> locs;
+   locs.reserve(count(piece));
 
-void Position::ColorPlacements::initRookMovedFlag(Color side)
-{
-   const Square kingsideLoc = side == White ? h1 : h8;
-   const Square queensideLoc = side == White ? a1 : a8;
+   Bitboard bb = occupied(piece);
+   while (bb != EmptyBB)
+      locs.push_back(popLowestSquare(bb));
 
-   // Init flags for both rooks based on the current state of the position.
-   m_castlingState.hasKingsideRookMoved = true;
-   m_castlingState.hasQueensideRookMoved = true;
-
-   for (std::size_t i = 0; i < m_rooks.count(); ++i)
-   {
-      if (m_rooks[i] == kingsideLoc)
-         m_castlingState.hasKingsideRookMoved = false;
-      if (m_rooks[i] == queensideLoc)
-         m_castlingState.hasQueensideRookMoved = false;
-   }
+   return locs;
 }
 
 
-void Position::ColorPlacements::updateRookMovedFlag(Square from)
+void Position::updateRookMovedFlag(Color side, Square from)
 {
-   if (!m_castlingState.hasKingsideRookMoved && file(from) == fh)
-      m_castlingState.hasKingsideRookMoved = true;
-   if (!m_castlingState.hasQueensideRookMoved && file(from) == fa)
-      m_castlingState.hasQueensideRookMoved = true;
+   // Only rooks leaving their initial squares affect castling. Other rooks on the
+   // a- or h-file, e.g. from a promotion, do not.
+   if (from == (side == White ? h1 : h8))
+      setCastlingBit(side, KingsideRookMovedBit, true);
+   if (from == (side == White ? a1 : a8))
+      setCastlingBit(side, QueensideRookMovedBit, true);
 }
 
 
-///////////////////
-
-// clang-format off
-const Position StartPos{
-   "Rba8 Nbb8 Bbc8 Qbd8 Kbe8 Bbf8 Nbg8 Rbh8 "
-   "ba7  bb7  bc7  bd7  be7  bf7  bg7  bh7 "
-   "wa2  wb2  wc2  wd2  we2  wf2  wg2  wh2 "
-   "Rwa1 Nwb1 Bwc1 Qwd1 Kwe1 Bwf1 Nwg1 Rwh1"
-};
-// clang-format on
-
 } // namespace matt2
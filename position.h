@@ -3,7 +3,10 @@
 // MIT license
 //
 #pragma once
+#include "bitboard.h"
 #include "console.h"
+#include "daily_chess_tables.h"
+#include "packed_move.h"
 #include "piece.h"
 #include "placement.h"
 #include "relocation.h"
@@ -11,9 +14,14 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 // clang-format off
@@ -57,16 +65,26 @@ class Position
       }
    };
 
+   // State of the position before a packed move was made. Needed to unmake the move.
+   // Kept by the callers that make moves, e.g. on the stack of a search, so that
+   // positions stay small and trivially copyable.
+   struct UndoState
+   {
+      std::optional<Piece> taken;
+      std::optional<Square> enPassantSquare;
+      uint8_t castlingRights = 0;
+   };
+
  public:
    Position() = default;
-   explicit Position(std::string_view placements);
+   constexpr explicit Position(std::string_view placements);
 
    // Returns piece at given location on board.
-   std::optional<Piece> operator[](Square at) const { return m_board[toIdx(at)]; }
+   constexpr std::optional<Piece> operator[](Square at) const;
 
    // Adds given piece at given square. Does not validate correctness of position.
-   void add(std::string_view placement) { add(Placement{placement}); }
-   void add(const Placement& placement);
+   constexpr void add(std::string_view placement) { add(Placement{placement}); }
+   constexpr void add(const Placement& placement);
 
    // Removes given piece from given square. Does not validate correctness of position.
    void remove(std::string_view placement) { remove(Placement{placement}); }
@@ -76,331 +94,459 @@ class Position
    // move.
    void move(const Relocation& relocation);
 
-   bool operator==(const Position& other) const;
-   bool operator!=(const Position& other) const;
-   bool isEqual(const Position& other, bool withGameState) const;
+   // Removes all pieces and resets the game state, so that the position can be reused.
+   constexpr void clear();
 
-   size_t count(Color side) const;
+   constexpr bool operator==(const Position& other) const;
+   constexpr bool operator!=(const Position& other) const;
+   constexpr bool isEqual(const Position& other, bool withGameState) const;
+
+   constexpr size_t count(Color side) const;
    PlacementIterator begin(Color side) const;
    PlacementIterator end(Color side) const;
-   size_t count(Piece piece) const;
+   constexpr size_t count(Piece piece) const;
    PieceIterator begin(Piece piece) const;
    PieceIterator end(Piece piece) const;
 
-   std::optional<Square> kingLocation(Color side) const;
+   constexpr std::optional<Square> kingLocation(Color side) const;
    // Returns all locations of a given piece.
    // Caution - Not meant to be used in performance critical code.
    std::vector<Square> locations(Piece piece) const;
 
-   std::optional<double> score() const { return m_score; }
-   double updateScore();
-
-   std::optional<Square> enPassantSquare() const { return m_enPassantSquare; }
-   void setEnPassantSquare(std::optional<Square> square) { m_enPassantSquare = square; }
-
-   bool hasCastled(Color side) const;
-   void setHasCastled(Color side);
-   bool hasKingMoved(Color side) const;
-   bool hasRookMoved(Color side, bool onKingside) const;
-   CastlingState castlingState(Color side) const;
-   void setCastlingState(Color side, const CastlingState& state);
+   // Returns the squares occupied by the pieces of a color or by a given piece.
+   constexpr Bitboard occupied(Color side) const { return m_colorBB[toColorIdx(side)]; }
+   constexpr Bitboard occupied() const
+   {
+      return m_colorBB[WhiteIdx] | m_colorBB[BlackIdx];
+   }
+   constexpr Bitboard occupied(Piece piece) const;
+
+   std::optional<Score> score() const;
+   // Calculates the score. Looks up and stores the score in a given cache.
+   Score updateScore(EvalCache* cache = nullptr);
+   // Running sum of the scoring terms that only depend on pieces and their squares,
+   // i.e. piece values and position bonuses. Kept up to date as pieces are added,
+   // removed and moved.
+   constexpr ScorePair psqScore(Color side) const { return m_psq[toColorIdx(side)]; }
+   // Phase of the game derived from the pieces on the board. See dcs::MaxPhase.
+   constexpr int phase() const { return m_phase; }
+   // Hash key of the pawn structure, i.e. of the squares of the pawns of both colors.
+   constexpr uint64_t pawnKey() const;
+
+   constexpr std::optional<Square> enPassantSquare() const;
+   constexpr void setEnPassantSquare(std::optional<Square> square);
+
+   constexpr bool hasCastled(Color side) const;
+   constexpr void setHasCastled(Color side);
+   constexpr bool hasKingMoved(Color side) const;
+   constexpr bool hasRookMoved(Color side, bool onKingside) const;
+   constexpr CastlingState castlingState(Color side) const;
+   constexpr void setCastlingState(Color side, const CastlingState& state);
 
    bool canAttack(Square sq, Color side) const;
    bool canAttack(Square sq, const Placement& placement) const;
 
+   // Makes a packed move and returns the info to unmake it. Callers that keep a copy of
+   // the position before the move instead (copy-make) can drop the info. Does not
+   // validate that the move is legal.
+   UndoState makeMove(PackedMove move);
+   // Unmakes the last made packed move with the info returned when making it.
+   void unmakeMove(PackedMove move, const UndoState& undo);
+
  private:
    // Array indices for piece locations of each color.
    static constexpr std::size_t WhiteIdx = 0;
    static constexpr std::size_t BlackIdx = 1;
 
-   using Count = unsigned char;
-
-   // Placements for pieces of a type, e.g. rooks, pawns.
-   template <std::size_t N> class PiecePlacements
-   {
-    public:
-      PiecePlacements();
-
-      void add(Square at);
-      void remove(Square at);
-      void move(Square from, Square to);
-      std::vector<Square> locations() const;
-      std::size_t count() const { return m_numPieces; }
-      Square operator[](std::size_t idx) const { return m_sortedLocations[idx]; }
-
-      bool operator==(const PiecePlacements& other) const;
-      bool operator!=(const PiecePlacements& other) const;
-
-    private:
-      void sort();
-
-    private:
-      static constexpr Square NoSquare = static_cast<Square>(-1);
-      // Locations of available pieces (of the tracked type). Sorted by square value, so
-      // that adding or removing pieces does not break equality of PiecePlacements
-      // instances.
-      std::array<Square, N> m_sortedLocations;
-      Count m_numPieces = 0;
-   };
-
-   // Placements of all pieces of one color.
-   class ColorPlacements
-   {
-    public:
-      void add(const Placement& placement);
-      void remove(const Placement& placement);
-      void move(const Placement& from, Square to);
-      std::size_t pieceCount(Piece piece) const;
-      Square pieceLocation(Piece piece, std::size_t idx) const;
-      std::vector<Square> locations(Piece piece) const;
-      std::size_t count() const;
-      Square placement(std::size_t idx) const;
-      bool hasCastled() const { return m_castlingState.hasCastled; }
-      void setHasCastled() { m_castlingState.hasCastled = true; }
-      bool hasKingMoved() const { return m_castlingState.hasKingMoved; }
-      bool hasRookMoved(bool onKingside) const;
-      CastlingState castlingState() const { return m_castlingState; }
-      void setCastlingState(const CastlingState& state) { m_castlingState = state; }
-
-      bool isEqual(const ColorPlacements& other, bool withCastlingState) const;
-
-    private:
-      void initKingMovedFlag(Color side, Square at);
-      void initRookMovedFlag(Color side);
-      void updateRookMovedFlag(Square from);
-
-    private:
-      // Placements of pieces.
-      PiecePlacements<10> m_rooks;
-      PiecePlacements<10> m_bishops;
-      PiecePlacements<10> m_knights;
-      PiecePlacements<9> m_queens;
-      PiecePlacements<8> m_pawns;
-      std::optional<Square> m_king;
-      // Info needed to check if castling is allowed.
-      CastlingState m_castlingState;
-   };
+   // Indices of piece types in the order in which the placements of a color are
+   // iterated.
+   static constexpr std::size_t RookIdx = 0;
+   static constexpr std::size_t BishopIdx = 1;
+   static constexpr std::size_t KnightIdx = 2;
+   static constexpr std::size_t QueenIdx = 3;
+   static constexpr std::size_t PawnIdx = 4;
+   static constexpr std::size_t KingIdx = 5;
+   static constexpr std::size_t NumPieceTypes = 6;
+
+   // Board value for squares without piece.
+   static constexpr uint8_t EmptySquare = 0xff;
+   // Value for no en-passant square.
+   static constexpr uint8_t NoSquare = 0xff;
+   // Separator of placements in position descriptions.
+   static constexpr char PieceDelimCh = ' ';
+   static constexpr std::size_t PieceDelimLen = 1;
+
+   // Castling rights bits for white. The bits for black are shifted by
+   // BlackCastlingShift.
+   static constexpr uint8_t KingMovedBit = 0x1;
+   static constexpr uint8_t KingsideRookMovedBit = 0x2;
+   static constexpr uint8_t QueensideRookMovedBit = 0x4;
+   static constexpr uint8_t CastledBit = 0x8;
+   static constexpr unsigned BlackCastlingShift = 4;
 
  private:
-   void populate(std::string_view placements);
-   void invalidateScore() { m_score.reset(); }
-
-   Square piece(Color side, std::size_t idx) const;
-
-   // Returns placements of pieces with the same color as a given piece.
-   ColorPlacements& pieces(Color side);
-   const ColorPlacements& pieces(Color side) const;
-
-   static std::size_t toIdx(Square at) { return static_cast<std::size_t>(at); }
-   static std::size_t toColorIdx(Piece piece)
+   constexpr void populate(std::string_view placements);
+   constexpr void invalidateScore() { m_score = NoScore; }
+
+   // Returns the squares occupied by the pieces of a given type and color.
+   constexpr Bitboard occupied(Color side, std::size_t typeIdx) const;
+   constexpr void setBits(Piece piece, Square at);
+   constexpr void clearBits(Piece piece, Square at);
+   constexpr void addScoreTerms(Piece piece, Square at);
+   constexpr void removeScoreTerms(Piece piece, Square at);
+
+   constexpr bool hasCastlingBit(Color side, uint8_t bit) const;
+   constexpr void setCastlingBit(Color side, uint8_t bit, bool on);
+   constexpr void initKingMovedFlag(Color side);
+   constexpr void initRookMovedFlags(Color side);
+   void updateRookMovedFlag(Color side, Square from);
+
+   static constexpr std::size_t toIdx(Square at) { return static_cast<std::size_t>(at); }
+   static constexpr std::size_t toColorIdx(Piece piece)
    {
       return isWhite(piece) ? WhiteIdx : BlackIdx;
    }
-   static std::size_t toColorIdx(Color side);
+   static constexpr std::size_t toColorIdx(Color side);
+   static constexpr std::size_t toTypeIdx(Piece piece);
+
+   static constexpr std::array<uint8_t, 64> makeEmptyBoard()
+   {
+      std::array<uint8_t, 64> board{};
+      for (auto& val : board)
+         val = EmptySquare;
+      return board;
+   }
 
  private:
-   // Board indexed by squares with information what piece is located there.
-   std::array<std::optional<Piece>, 64> m_board;
-   // Locations of each piece separated by color.
-   std::array<ColorPlacements, 2> m_pieces;
+   // Score value for a score that has not been calculated.
+   static constexpr Score NoScore = std::numeric_limits<Score>::min();
+
+   // The state of the position is laid out compactly to make copying positions cheap
+   // and to allow storing many positions in memory.
+
+   // Board indexed by squares with the piece enum value of the piece located there or
+   // EmptySquare.
+   std::array<uint8_t, 64> m_board = makeEmptyBoard();
+   // Squares occupied by each color.
+   std::array<Bitboard, 2> m_colorBB = {EmptyBB, EmptyBB};
+   // Squares occupied by piece types of either color. Queens are part of both slider
+   // bitboards. Kings are the occupied squares not covered by any other bitboard.
+   Bitboard m_pawnBB = EmptyBB;
+   Bitboard m_knightBB = EmptyBB;
+   Bitboard m_diagonalSliderBB = EmptyBB;
+   Bitboard m_orthogonalSliderBB = EmptyBB;
    // Score of position. Calculated explicitly and invalidated when position changes.
-   std::optional<double> m_score;
-   // Square on which a pawn is located that can be taken with an en-passant move.
-   std::optional<Square> m_enPassantSquare;
+   // NoScore if not calculated.
+   Score m_score = NoScore;
+   // Running sums of piece values and piece-square bonuses for each color.
+   std::array<ScorePair, 2> m_psq = {};
+   // Info needed to check if castling is allowed, as castling rights bits for both
+   // colors.
+   uint8_t m_castlingRights = 0;
+   // Square on which a pawn is located that can be taken with an en-passant move or
+   // NoSquare.
+   uint8_t m_enPassantSquare = NoSquare;
+   // Running sum of the phase weights of all pieces.
+   uint8_t m_phase = 0;
 };
 
+// Size budgets. Positions have to fit into two cache lines and are copied as plain
+// memory.
+static_assert(sizeof(Position) <= 128);
+static_assert(std::is_trivially_copyable_v<Position>);
+static_assert(sizeof(Position::UndoState) <= 8);
+
 
 ///////////////////
 // Implementation of Position.
 
-inline std::vector<Square> Position::locations(Piece piece) const
+constexpr Position::Position(std::string_view placements)
 {
-   return pieces(color(piece)).locations(piece);
+   populate(placements);
 }
 
-inline bool Position::hasCastled(Color side) const
+constexpr void Position::populate(std::string_view placements)
 {
-   return m_pieces[Position::toColorIdx(side)].hasCastled();
+   std::size_t pos = 0;
+   std::size_t next = placements.find(PieceDelimCh, pos);
+   while (next != std::string_view::npos)
+   {
+      if (next > pos)
+         add(placements.substr(pos, next - pos));
+
+      pos = next + PieceDelimLen;
+      next = placements.find(PieceDelimCh, pos);
+   }
+
+   // Process last placement.
+   if (pos < placements.size())
+      add(placements.substr(pos));
 }
 
-inline void Position::setHasCastled(Color side)
+constexpr void Position::add(const Placement& placement)
 {
-   return m_pieces[Position::toColorIdx(side)].setHasCastled();
+   const Piece piece = placement.piece();
+   const Square at = placement.at();
+
+   // Keep the bitboards and score sums consistent with the board if a piece is
+   // replaced.
+   if (const auto prev = (*this)[at]; prev.has_value())
+   {
+      clearBits(*prev, at);
+      removeScoreTerms(*prev, at);
+   }
+
+   m_board[toIdx(at)] = static_cast<uint8_t>(piece);
+   setBits(piece, at);
+   addScoreTerms(piece, at);
+
+   if (isKing(piece))
+      initKingMovedFlag(color(piece));
+   else if (isRook(piece))
+      initRookMovedFlags(color(piece));
+
+   invalidateScore();
 }
 
-inline bool Position::hasKingMoved(Color side) const
+constexpr std::optional<Piece> Position::operator[](Square at) const
 {
-   return m_pieces[Position::toColorIdx(side)].hasKingMoved();
+   const uint8_t val = m_board[toIdx(at)];
+   if (val == EmptySquare)
+      return std::nullopt;
+   return static_cast<Piece>(val);
 }
 
-inline bool Position::hasRookMoved(Color side, bool onKingside) const
+constexpr Bitboard Position::occupied(Piece piece) const
 {
-   return m_pieces[Position::toColorIdx(side)].hasRookMoved(onKingside);
+   return occupied(color(piece), toTypeIdx(piece));
 }
 
-inline Position::CastlingState Position::castlingState(Color side) const
+constexpr Bitboard Position::occupied(Color side, std::size_t typeIdx) const
 {
-   return pieces(side).castlingState();
+   const Bitboard colorBB = m_colorBB[toColorIdx(side)];
+   switch (typeIdx)
+   {
+   case RookIdx:
+      return colorBB & m_orthogonalSliderBB & ~m_diagonalSliderBB;
+   case BishopIdx:
+      return colorBB & m_diagonalSliderBB & ~m_orthogonalSliderBB;
+   case KnightIdx:
+      return colorBB & m_knightBB;
+   case QueenIdx:
+      return colorBB & m_diagonalSliderBB & m_orthogonalSliderBB;
+   case PawnIdx:
+      return colorBB & m_pawnBB;
+   default:
+      assert(typeIdx == KingIdx);
+      return colorBB &
+             ~(m_pawnBB | m_knightBB | m_diagonalSliderBB | m_orthogonalSliderBB);
+   }
 }
 
-inline void Position::setCastlingState(Color side, const CastlingState& state)
+inline std::optional<Score> Position::score() const
 {
-   pieces(side).setCastlingState(state);
+   if (m_score == NoScore)
+      return std::nullopt;
+   return m_score;
 }
 
-inline Square Position::piece(Color side, std::size_t idx) const
+constexpr uint64_t Position::pawnKey() const
 {
-   return m_pieces[Position::toColorIdx(side)].placement(idx);
+   // Mixing the two pawn bitboards takes a few instructions, so the key is calculated
+   // when needed instead of being stored in the hot state and updated with each move.
+   // Uses the finalizer of MurmurHash3.
+   auto mix = [](uint64_t x)
+   {
+      x ^= x >> 33;
+      x *= 0xff51afd7ed558ccdull;
+      x ^= x >> 33;
+      x *= 0xc4ceb9fe1a85ec53ull;
+      x ^= x >> 33;
+      return x;
+   };
+   const Bitboard whitePawns = m_pawnBB & m_colorBB[WhiteIdx];
+   const Bitboard blackPawns = m_pawnBB & m_colorBB[BlackIdx];
+   return mix(whitePawns ^ mix(blackPawns));
 }
 
-inline Position::ColorPlacements& Position::pieces(Color side)
+constexpr void Position::clear()
 {
-   return m_pieces[toColorIdx(side)];
+   m_board = makeEmptyBoard();
+   m_colorBB = {EmptyBB, EmptyBB};
+   m_pawnBB = EmptyBB;
+   m_knightBB = EmptyBB;
+   m_diagonalSliderBB = EmptyBB;
+   m_orthogonalSliderBB = EmptyBB;
+   m_score = NoScore;
+   m_psq = {};
+   m_phase = 0;
+   m_castlingRights = 0;
+   m_enPassantSquare = NoSquare;
 }
 
-inline const Position::ColorPlacements& Position::pieces(Color side) const
+constexpr std::optional<Square> Position::enPassantSquare() const
 {
-   return m_pieces[toColorIdx(side)];
+   if (m_enPassantSquare == NoSquare)
+      return std::nullopt;
+   return static_cast<Square>(m_enPassantSquare);
 }
 
-inline std::size_t Position::toColorIdx(Color side)
+constexpr void Position::setEnPassantSquare(std::optional<Square> square)
 {
-   return side == White ? WhiteIdx : BlackIdx;
+   m_enPassantSquare = square ? static_cast<uint8_t>(*square) : NoSquare;
 }
 
-inline bool Position::operator==(const Position& other) const
+constexpr bool Position::hasCastled(Color side) const
 {
-   return isEqual(other, false);
+   return hasCastlingBit(side, CastledBit);
 }
 
-inline bool Position::operator!=(const Position& other) const
+constexpr void Position::setHasCastled(Color side)
 {
-   return !(*this == other);
+   setCastlingBit(side, CastledBit, true);
 }
 
-inline bool Position::isEqual(const Position& other, bool withGameState) const
+constexpr bool Position::hasKingMoved(Color side) const
 {
-   bool isEqual = m_board == other.m_board &&
-                  m_pieces[WhiteIdx].isEqual(other.m_pieces[WhiteIdx], withGameState) &&
-                  m_pieces[BlackIdx].isEqual(other.m_pieces[BlackIdx], withGameState);
-   if (withGameState)
-      isEqual &= m_enPassantSquare == other.m_enPassantSquare;
-   return isEqual;
+   return hasCastlingBit(side, KingMovedBit);
 }
 
-inline size_t Position::count(Color side) const
+constexpr bool Position::hasRookMoved(Color side, bool onKingside) const
 {
-   return m_pieces[toColorIdx(side)].count();
+   return hasCastlingBit(side, onKingside ? KingsideRookMovedBit : QueensideRookMovedBit);
 }
 
-inline size_t Position::count(Piece piece) const
+constexpr Position::CastlingState Position::castlingState(Color side) const
 {
-   return m_pieces[toColorIdx(piece)].pieceCount(piece);
+   return {hasKingMoved(side), hasRookMoved(side, true), hasRookMoved(side, false),
+           hasCastled(side)};
 }
 
-
-///////////////////
-// Implementation of Position::ColorPlacements.
-
-inline std::size_t Position::ColorPlacements::count() const
+constexpr void Position::setCastlingState(Color side, const CastlingState& state)
 {
-   return m_rooks.count() + m_bishops.count() + m_knights.count() + m_queens.count() +
-          m_pawns.count() + (m_king.has_value() ? 1 : 0);
+   setCastlingBit(side, KingMovedBit, state.hasKingMoved);
+   setCastlingBit(side, KingsideRookMovedBit, state.hasKingsideRookMoved);
+   setCastlingBit(side, QueensideRookMovedBit, state.hasQueensideRookMoved);
+   setCastlingBit(side, CastledBit, state.hasCastled);
 }
 
-
-inline bool Position::ColorPlacements::hasRookMoved(bool onKingside) const
+constexpr bool Position::hasCastlingBit(Color side, uint8_t bit) const
 {
-   return onKingside ? m_castlingState.hasKingsideRookMoved
-                     : m_castlingState.hasQueensideRookMoved;
+   const unsigned shift = side == White ? 0 : BlackCastlingShift;
+   return (m_castlingRights & (bit << shift)) != 0;
 }
 
-inline bool Position::ColorPlacements::isEqual(const ColorPlacements& other,
-                                               bool withCastlingState) const
+constexpr void Position::setCastlingBit(Color side, uint8_t bit, bool on)
 {
-   bool isEqual = m_rooks == other.m_rooks && m_bishops == other.m_bishops &&
-                  m_knights == other.m_knights && m_queens == other.m_queens &&
-                  m_pawns == other.m_pawns && m_king == other.m_king;
-   if (withCastlingState)
-      isEqual &= m_castlingState == other.m_castlingState;
-   return isEqual;
+   const unsigned shift = side == White ? 0 : BlackCastlingShift;
+   if (on)
+      m_castlingRights |= static_cast<uint8_t>(bit << shift);
+   else
+      m_castlingRights &= static_cast<uint8_t>(~(bit << shift));
 }
 
-inline void Position::ColorPlacements::initKingMovedFlag(Color side, Square at)
+constexpr std::optional<Square> Position::kingLocation(Color side) const
 {
-   m_castlingState.hasKingMoved = side == White ? (at != e1) : (at != e8);
+   const Bitboard kingBB = occupied(side, KingIdx);
+   if (kingBB != EmptyBB)
+      return lowestSquare(kingBB);
+   return {};
 }
 
+constexpr void Position::setBits(Piece piece, Square at)
+{
+   const Bitboard bit = toBitboard(at);
+   m_colorBB[toColorIdx(piece)] |= bit;
 
-///////////////////
-// Implementation of Position::PiecePlacements.
+   if (isPawn(piece))
+      m_pawnBB |= bit;
+   else if (isKnight(piece))
+      m_knightBB |= bit;
+   if (isBishop(piece) || isQueen(piece))
+      m_diagonalSliderBB |= bit;
+   if (isRook(piece) || isQueen(piece))
+      m_orthogonalSliderBB |= bit;
+}
 
-template <std::size_t N> Position::PiecePlacements<N>::PiecePlacements()
+constexpr void Position::clearBits(Piece piece, Square at)
 {
-   std::fill(std::begin(m_sortedLocations), std::end(m_sortedLocations), NoSquare);
+   const Bitboard mask = ~toBitboard(at);
+   m_colorBB[toColorIdx(piece)] &= mask;
+   m_pawnBB &= mask;
+   m_knightBB &= mask;
+   m_diagonalSliderBB &= mask;
+   m_orthogonalSliderBB &= mask;
 }
 
-template <std::size_t N> void Position::PiecePlacements<N>::add(Square at)
+constexpr void Position::addScoreTerms(Piece piece, Square at)
 {
-   assert(m_numPieces < m_sortedLocations.max_size());
-   m_sortedLocations[m_numPieces++] = at;
-   sort();
+   m_psq[toColorIdx(piece)] += dcs::pieceSquareValue(piece, at);
+   m_phase += dcs::phaseWeight(piece);
 }
 
-
-template <std::size_t N> void Position::PiecePlacements<N>::remove(Square at)
+constexpr void Position::removeScoreTerms(Piece piece, Square at)
 {
-   auto pos = std::find(std::begin(m_sortedLocations), std::end(m_sortedLocations), at);
-   if (pos != std::end(m_sortedLocations))
-   {
-      --m_numPieces;
-      *pos = NoSquare;
-      sort();
-   }
+   m_psq[toColorIdx(piece)] -= dcs::pieceSquareValue(piece, at);
+   m_phase -= dcs::phaseWeight(piece);
 }
 
-
-template <std::size_t N> void Position::PiecePlacements<N>::move(Square from, Square to)
+constexpr void Position::initKingMovedFlag(Color side)
 {
-   auto pos = std::find(std::begin(m_sortedLocations), std::end(m_sortedLocations), from);
-   if (pos != std::end(m_sortedLocations))
-   {
-      *pos = to;
-      sort();
-   }
+   const auto at = kingLocation(side);
+   setCastlingBit(side, KingMovedBit, at != (side == White ? e1 : e8));
 }
 
-
-template <std::size_t N>
-std::vector<Square> Position::PiecePlacements<N>::locations() const
+constexpr void Position::initRookMovedFlags(Color side)
 {
-   std::vector<Square> locs;
-   locs.reserve(m_numPieces);
+   // Init flags for both rooks based on the current state of the position.
+   const Bitboard rooks = occupied(side, RookIdx);
+   setCastlingBit(side, KingsideRookMovedBit, !contains(rooks, side == White ? h1 : h8));
+   setCastlingBit(side, QueensideRookMovedBit, !contains(rooks, side == White ? a1 : a8));
+}
 
-   auto first = std::begin(m_sortedLocations);
-   std::copy(first, first + m_numPieces, std::back_inserter(locs));
+constexpr std::size_t Position::toColorIdx(Color side)
+{
+   return side == White ? WhiteIdx : BlackIdx;
+}
 
-   return locs;
+constexpr std::size_t Position::toTypeIdx(Piece piece)
+{
+   // Indexed by piece enum value with the color stripped off.
+   constexpr std::array<std::size_t, NumPieceTypes> TypeIndices = {
+      KingIdx, QueenIdx, RookIdx, BishopIdx, KnightIdx, PawnIdx};
+   return TypeIndices[static_cast<std::size_t>(piece) % NumPieceTypes];
 }
 
+constexpr bool Position::operator==(const Position& other) const
+{
+   return isEqual(other, false);
+}
 
-template <std::size_t N>
-bool Position::PiecePlacements<N>::operator==(const PiecePlacements& other) const
+constexpr bool Position::operator!=(const Position& other) const
 {
-   return m_numPieces == other.m_numPieces &&
-          m_sortedLocations == other.m_sortedLocations;
+   return !(*this == other);
 }
 
+constexpr bool Position::isEqual(const Position& other, bool withGameState) const
+{
+   // The bitboards are derived from the board, so comparing the boards is sufficient.
+   bool isEqual = m_board == other.m_board;
+   if (withGameState)
+   {
+      isEqual &= m_enPassantSquare == other.m_enPassantSquare &&
+                 m_castlingRights == other.m_castlingRights;
+   }
+   return isEqual;
+}
 
-template <std::size_t N>
-bool Position::PiecePlacements<N>::operator!=(const PiecePlacements& other) const
+constexpr size_t Position::count(Color side) const
 {
-   return !(*this == other);
+   return popCount(occupied(side));
 }
 
-template <std::size_t N> void Position::PiecePlacements<N>::sort()
+constexpr size_t Position::count(Piece piece) const
 {
-   std::sort(std::begin(m_sortedLocations), std::end(m_sortedLocations));
+   return popCount(occupied(piece));
 }
 
 
@@ -414,12 +560,14 @@ class PlacementIterator
  public:
    using iterator_category = std::bidirectional_iterator_tag;
    using value_type = Placement;
+   using difference_type = std::ptrdiff_t;
    using pointer = const Placement*;
    using reference = const Placement&;
 
  private:
    // Only the position class needs access to this ctor.
-   PlacementIterator(const Position* pos, Color side, std::size_t idx);
+   // Positions the iterator at the first piece of the given or a following type.
+   PlacementIterator(const Position* pos, Color side, std::size_t typeIdx);
 
  public:
    PlacementIterator() = default;
@@ -441,7 +589,8 @@ class PlacementIterator
 
    friend bool operator==(const PlacementIterator& a, const PlacementIterator& b)
    {
-      return a.m_pos == b.m_pos && a.m_side == b.m_side && a.m_idx == b.m_idx;
+      return a.m_pos == b.m_pos && a.m_side == b.m_side && a.m_typeIdx == b.m_typeIdx &&
+             a.m_at == b.m_at;
    }
 
    friend bool operator!=(const PlacementIterator& a, const PlacementIterator& b)
@@ -452,13 +601,13 @@ class PlacementIterator
    friend bool operator<(const PlacementIterator& a, const PlacementIterator& b)
    {
       assert(a.m_pos == b.m_pos && a.m_side == b.m_side);
-      return a.m_idx < b.m_idx;
+      return a.m_typeIdx < b.m_typeIdx ||
+             (a.m_typeIdx == b.m_typeIdx && a.m_at < b.m_at);
    }
 
    friend bool operator>(const PlacementIterator& a, const PlacementIterator& b)
    {
-      assert(a.m_pos == b.m_pos && a.m_side == b.m_side);
-      return a.m_idx > b.m_idx;
+      return b < a;
    }
 
    friend bool operator<=(const PlacementIterator& a, const PlacementIterator& b)
@@ -475,22 +624,31 @@ class PlacementIterator
    {
       std::swap(a.m_pos, b.m_pos);
       std::swap(a.m_side, b.m_side);
-      std::swap(a.m_idx, b.m_idx);
+      std::swap(a.m_typeIdx, b.m_typeIdx);
+      std::swap(a.m_at, b.m_at);
    }
 
+ private:
+   Bitboard occupied() const { return m_pos->occupied(m_side, m_typeIdx); }
+   // Positions the iterator at the first piece of the current or a following type.
+   void advanceToNonEmptyType();
+
  private:
    const Position* m_pos = nullptr;
    Color m_side = White;
-   // Index of piece.
-   std::size_t m_idx = 0;
+   // Index of piece type. Position::NumPieceTypes for the end iterator.
+   std::size_t m_typeIdx = 0;
+   // Square of piece. Zero for the end iterator.
+   std::size_t m_at = 0;
 };
 
 
 inline PlacementIterator::PlacementIterator(const Position* pos, Color side,
-                                            std::size_t idx)
-: m_pos{pos}, m_side{side}, m_idx{idx}
+                                            std::size_t typeIdx)
+: m_pos{pos}, m_side{side}, m_typeIdx{typeIdx}
 {
    assert(m_pos);
+   advanceToNonEmptyType();
 }
 
 inline PlacementIterator::value_type PlacementIterator::operator*() const
@@ -500,7 +658,17 @@ inline PlacementIterator::value_type PlacementIterator::operator*() const
 
 inline PlacementIterator& PlacementIterator::operator++()
 {
-   ++m_idx;
+   assert(m_typeIdx < Position::NumPieceTypes);
+   const Bitboard remaining = squaresAbove(occupied(), at());
+   if (remaining != EmptyBB)
+   {
+      m_at = Position::toIdx(lowestSquare(remaining));
+   }
+   else
+   {
+      ++m_typeIdx;
+      advanceToNonEmptyType();
+   }
    return *this;
 }
 
@@ -513,7 +681,20 @@ inline PlacementIterator PlacementIterator::operator++(int)
 
 inline PlacementIterator& PlacementIterator::operator--()
 {
-   --m_idx;
+   const Bitboard preceding =
+      m_typeIdx < Position::NumPieceTypes ? squaresBelow(occupied(), at()) : EmptyBB;
+   if (preceding != EmptyBB)
+   {
+      m_at = Position::toIdx(highestSquare(preceding));
+      return *this;
+   }
+
+   do
+   {
+      assert(m_typeIdx > 0);
+      --m_typeIdx;
+   } while (occupied() == EmptyBB);
+   m_at = Position::toIdx(highestSquare(occupied()));
    return *this;
 }
 
@@ -532,8 +713,21 @@ inline Piece PlacementIterator::piece() const
 
 inline Square PlacementIterator::at() const
 {
-   const Square loc = m_pos->piece(m_side, m_idx);
-   return loc;
+   return static_cast<Square>(m_at);
+}
+
+inline void PlacementIterator::advanceToNonEmptyType()
+{
+   for (; m_typeIdx < Position::NumPieceTypes; ++m_typeIdx)
+   {
+      const Bitboard bb = occupied();
+      if (bb != EmptyBB)
+      {
+         m_at = Position::toIdx(lowestSquare(bb));
+         return;
+      }
+   }
+   m_at = 0;
 }
 
 ///////////////////
@@ -546,12 +740,13 @@ class PieceIterator
  public:
    using iterator_category = std::bidirectional_iterator_tag;
    using value_type = Square;
+   using difference_type = std::ptrdiff_t;
    using pointer = const Square*;
    using reference = const Square&;
 
  private:
    // Only the position class needs access to this ctor.
-   PieceIterator(const Position* pos, Piece piece, std::size_t idx);
+   PieceIterator(const Position* pos, Piece piece, std::size_t at);
 
  public:
    PieceIterator() = default;
@@ -569,7 +764,7 @@ class PieceIterator
 
    friend bool operator==(const PieceIterator& a, const PieceIterator& b)
    {
-      return a.m_pos == b.m_pos && a.m_piece == b.m_piece && a.m_idx == b.m_idx;
+      return a.m_pos == b.m_pos && a.m_piece == b.m_piece && a.m_at == b.m_at;
    }
 
    friend bool operator!=(const PieceIterator& a, const PieceIterator& b)
@@ -580,13 +775,13 @@ class PieceIterator
    friend bool operator<(const PieceIterator& a, const PieceIterator& b)
    {
       assert(a.m_pos == b.m_pos && a.m_piece == b.m_piece);
-      return a.m_idx < b.m_idx;
+      return a.m_at < b.m_at;
    }
 
    friend bool operator>(const PieceIterator& a, const PieceIterator& b)
    {
       assert(a.m_pos == b.m_pos && a.m_piece == b.m_piece);
-      return a.m_idx > b.m_idx;
+      return a.m_at > b.m_at;
    }
 
    friend bool operator<=(const PieceIterator& a, const PieceIterator& b)
@@ -603,31 +798,40 @@ class PieceIterator
    {
       std::swap(a.m_pos, b.m_pos);
       std::swap(a.m_piece, b.m_piece);
-      std::swap(a.m_idx, b.m_idx);
+      std::swap(a.m_at, b.m_at);
    }
 
  private:
+   Bitboard occupied() const { return m_pos->occupied(m_piece); }
+
+ private:
+   // Square value of the end iterator.
+   static constexpr std::size_t EndAt = 64;
+
    const Position* m_pos = nullptr;
    Piece m_piece = Pw;
-   // Index of piece.
-   std::size_t m_idx = 0;
+   // Square of piece. EndAt for the end iterator.
+   std::size_t m_at = 0;
 };
 
 
-inline PieceIterator::PieceIterator(const Position* pos, Piece piece, std::size_t idx)
-: m_pos{pos}, m_piece{piece}, m_idx{idx}
+inline PieceIterator::PieceIterator(const Position* pos, Piece piece, std::size_t at)
+: m_pos{pos}, m_piece{piece}, m_at{at}
 {
    assert(m_pos);
 }
 
 inline PieceIterator::value_type PieceIterator::operator*() const
 {
-   return m_pos->pieces(color(m_piece)).pieceLocation(m_piece, m_idx);
+   assert(m_at < EndAt);
+   return static_cast<Square>(m_at);
 }
 
 inline PieceIterator& PieceIterator::operator++()
 {
-   ++m_idx;
+   assert(m_at < EndAt);
+   const Bitboard remaining = squaresAbove(occupied(), static_cast<Square>(m_at));
+   m_at = remaining != EmptyBB ? Position::toIdx(lowestSquare(remaining)) : EndAt;
    return *this;
 }
 
@@ -640,7 +844,10 @@ inline PieceIterator PieceIterator::operator++(int)
 
 inline PieceIterator& PieceIterator::operator--()
 {
-   --m_idx;
+   const Bitboard preceding =
+      m_at < EndAt ? squaresBelow(occupied(), static_cast<Square>(m_at)) : occupied();
+   assert(preceding != EmptyBB);
+   m_at = Position::toIdx(highestSquare(preceding));
    return *this;
 }
 
@@ -662,21 +869,31 @@ inline PlacementIterator Position::begin(Color side) const
 
 inline PlacementIterator Position::end(Color side) const
 {
-   return PlacementIterator{this, side, count(side)};
+   return PlacementIterator{this, side, NumPieceTypes};
 }
 
 inline PieceIterator Position::begin(Piece piece) const
 {
-   return PieceIterator{this, piece, 0};
+   const Bitboard bb = occupied(piece);
+   return PieceIterator{this, piece,
+                        bb != EmptyBB ? toIdx(lowestSquare(bb)) : PieceIterator::EndAt};
 }
 
 inline PieceIterator Position::end(Piece piece) const
 {
-   return PieceIterator{this, piece, count(piece)};
+   return PieceIterator{this, piece, PieceIterator::EndAt};
 }
 
 ///////////////////
 
-extern const Position StartPos;
+// Initial position of a game. Built at compile time.
+// clang-format off
+inline constexpr Position StartPos{
+   "Rba8 Nbb8 Bbc8 Qbd8 Kbe8 Bbf8 Nbg8 Rbh8 "
+   "ba7  bb7  bc7  bd7  be7  bf7  bg7  bh7 "
+   "wa2  wb2  wc2  wd2  we2  wf2  wg2  wh2 "
+   "Rwa1 Nwb1 Bwc1 Qwd1 Kwe1 Bwf1 Nwg1 Rwh1"
+};
+// clang-format on
 
 } // namespace matt2
@@ -5,7 +5,7 @@
 #include "rules.h"
 #include <algorithm>
 #include <cmath>
-#include <functional>
+#include <type_traits>
 
 using namespace matt2;
 
@@ -14,19 +14,91 @@ namespace
 {
 ///////////////////
 
+// Moves are added to collections of either full or packed moves. Packed moves are
+// built from their squares and flags directly, so that generating them does not pay for
+// constructing full moves.
+template <typename MoveCollection>
+constexpr bool IsPackedCollection =
+   std::is_same_v<typename MoveCollection::value_type, PackedMove>;
+
+template <typename MoveCollection>
+void addBasicMove(MoveCollection& moves, Piece piece, Square from, Square to,
+                  std::optional<Piece> taken)
+{
+   using Flag = PackedMove::Flag;
+   if constexpr (IsPackedCollection<MoveCollection>)
+      moves.push_back(PackedMove{from, to, taken ? Flag::Capture : Flag::Quiet});
+   else
+      moves.push_back(BasicMove{Relocation{piece, from, to}, taken});
+}
+
+template <typename MoveCollection>
+void addDoublePawnPush(MoveCollection& moves, Piece pawn, Square from, Square to)
+{
+   if constexpr (IsPackedCollection<MoveCollection>)
+      moves.push_back(PackedMove{from, to, PackedMove::Flag::DoublePawnPush});
+   else
+      moves.push_back(BasicMove{Relocation{pawn, from, to}, EnablesEnPassant});
+}
+
+template <typename MoveCollection>
+void addPromotion(MoveCollection& moves, Piece pawn, Square from, Square to,
+                  Piece promotedTo, std::optional<Piece> taken)
+{
+   if constexpr (IsPackedCollection<MoveCollection>)
+      moves.push_back(
+         PackedMove{from, to, PackedMove::promotionFlag(promotedTo, taken.has_value())});
+   else
+      moves.push_back(Promotion{Relocation{pawn, from, to}, promotedTo, taken});
+}
+
+template <Color Us, typename MoveCollection>
+void addCastling(MoveCollection& moves, bool onKingside)
+{
+   using Flag = PackedMove::Flag;
+   if constexpr (IsPackedCollection<MoveCollection>)
+   {
+      constexpr Square KingFrom = Us == White ? e1 : e8;
+      if (onKingside)
+         moves.push_back(
+            PackedMove{KingFrom, Us == White ? g1 : g8, Flag::KingsideCastling});
+      else
+         moves.push_back(
+            PackedMove{KingFrom, Us == White ? c1 : c8, Flag::QueensideCastling});
+   }
+   else
+   {
+      if (onKingside)
+         moves.push_back(Castling{Kingside, Us});
+      else
+         moves.push_back(Castling{Queenside, Us});
+   }
+}
+
+template <typename MoveCollection>
+void addEnPassant(MoveCollection& moves, Piece pawn, Square from, Square to)
+{
+   if constexpr (IsPackedCollection<MoveCollection>)
+      moves.push_back(PackedMove{from, to, PackedMove::Flag::EnPassant});
+   else
+      moves.push_back(EnPassant{Relocation{pawn, from, to}});
+}
+
+
+template <typename MoveCollection>
 std::optional<Piece> collectBasicMove(Piece piece, Square from, Square to,
-                                      const Position& pos, std::vector<Move>& moves)
+                                      const Position& pos, MoveCollection& moves)
 {
    auto destPiece = pos[to];
    if (!destPiece || !haveSameColor(piece, *destPiece))
-      moves.push_back(BasicMove{Relocation{piece, from, to}, destPiece});
+      addBasicMove(moves, piece, from, to, destPiece);
    return destPiece;
 }
 
 
-template <std::size_t N>
+template <std::size_t N, typename MoveCollection>
 void collectOffsetMoves(Piece piece, Square at, const Position& pos,
-                        const std::array<Offset, N>& offsets, std::vector<Move>& moves)
+                        const std::array<Offset, N>& offsets, MoveCollection& moves)
 {
    for (const auto& off : offsets)
       if (isOnBoard(at, off))
@@ -34,10 +106,10 @@ void collectOffsetMoves(Piece piece, Square at, const Position& pos,
 }
 
 
-template <std::size_t N>
+template <std::size_t N, typename MoveCollection>
 void collectDirectionalMoves(Piece piece, Square at, const Position& pos,
                              const std::array<Offset, N>& directions,
-                             std::vector<Move>& moves)
+                             MoveCollection& moves)
 {
    for (const auto& off : directions)
    {
@@ -55,80 +127,44 @@ void collectDirectionalMoves(Piece piece, Square at, const Position& pos,
 }
 
 
-bool isPromotion(Piece pawn, Square to)
-{
-   assert(isPawn(pawn));
-   return rank(to) == (isWhite(pawn) ? r8 : r1);
-}
+// Rank direction in which the pawns of a color move.
+template <Color Us> constexpr int PawnDirection = Us == White ? 1 : -1;
 
 
-void collectPromotions(Piece pawn, Square at, Square to, std::optional<Piece> taken,
-                       std::vector<Move>& moves)
+template <Color Us> bool isPromotion(Square to)
 {
-   // Add move for each possible promotion.
-   // Note that validity of the moves has already been verified.
-   using Promotions_t = std::array<Piece, 4>;
-   static constexpr Promotions_t WhitePromotions = {Qw, Rw, Bw, Nw};
-   static constexpr Promotions_t BlackPromotions = {Qb, Rb, Bb, Nb};
-
-   const Relocation movement{pawn, at, to};
-
-   const Promotions_t& promotions = isWhite(pawn) ? WhitePromotions : BlackPromotions;
-   for (const Piece& promotedTo : promotions)
-      moves.push_back(Promotion{movement, promotedTo, taken});
+   return rank(to) == (Us == White ? r8 : r1);
 }
 
 
-bool collectForwardPawnMove(Piece pawn, Square at, const Position& pos, Offset forward,
-                            std::vector<Move>& moves)
+template <Color Us, typename MoveCollection>
+void collectPromotions(Square at, Square to, std::optional<Piece> taken,
+                       MoveCollection& moves)
 {
-   assert(isPawn(pawn));
-   // To avoid duplicate checking, caller should check that destination square is on
-   // the board.
-   assert(isOnBoard(at, forward));
-
-   bool moveCollected = false;
-
-   Square to = at + forward;
-   auto destPiece = pos[to];
-   if (!destPiece)
-   {
-      assert(std::abs(forward.dr) == 1 || std::abs(forward.dr) == 2);
-      if (std::abs(forward.dr) == 1)
-      {
-         if (isPromotion(pawn, to))
-            collectPromotions(pawn, at, to, destPiece, moves);
-         else
-            moves.push_back(BasicMove{Relocation{pawn, at, to}});
-      }
-      else
-      {
-         // Moving by two squares allows opponent to use en-passant rule in the
-         // next move.
-         moves.push_back(BasicMove{Relocation{pawn, at, to}, EnablesEnPassant});
-      }
-
-      moveCollected = true;
-   }
+   // Add move for each possible promotion.
+   // Note that validity of the moves has already been verified.
+   static constexpr std::array<Piece, 4> Promotions = {queen(Us), rook(Us), bishop(Us),
+                                                       knight(Us)};
 
-   return moveCollected;
+   for (const Piece& promotedTo : Promotions)
+      addPromotion(moves, pawn(Us), at, to, promotedTo, taken);
 }
 
 
-void collectDiagonalPawnMove(Piece pawn, Square at, const Position& pos, Offset diagonal,
-                             std::vector<Move>& moves)
+template <Color Us, typename MoveCollection>
+void collectDiagonalPawnMove(Square at, const Position& pos, Offset diagonal,
+                             MoveCollection& moves)
 {
-   assert(isPawn(pawn));
    if (isOnBoard(at, diagonal))
    {
       Square to = at + diagonal;
       auto destPiece = pos[to];
-      if (destPiece.has_value() && !haveSameColor(pawn, *destPiece))
+      if (destPiece.has_value() && color(*destPiece) != Us)
       {
-         if (isPromotion(pawn, to))
-            collectPromotions(pawn, at, to, destPiece, moves);
+         if (isPromotion<Us>(to))
+            collectPromotions<Us>(at, to, destPiece, moves);
          else
-            moves.push_back(BasicMove{Relocation{pawn, at, to}, destPiece});
+            addBasicMove(moves, pawn(Us), at, to, destPiece);
       }
    }
 }
@@ -136,70 +172,50 @@ void collectDiagonalPawnMove(Piece pawn, Square at, const Position& pos, Offset
 
 ///////////////////
 
+// Policies for which squares pieces can move to. Passed as template arguments, so that
+// the square checks are inlined into the collection loops.
 enum class SquareFilterPolicy
 {
    OnlyEmpty,
    EmptyOrOpponent
 };
 
-using SquareFilterFn = std::function<bool(Square)>;
-
-SquareFilterFn makeEmptySquareFilter(const Position& pos)
+template <SquareFilterPolicy Policy>
+bool passesSquareFilter(Square at, Color opponent, const Position& pos)
 {
-   return [&pos](Square at) { return !pos[at]; };
-}
-
-SquareFilterFn makeEmptyOrOpponentSquareFilter(Color opponent, const Position& pos)
-{
-   return [opponent, &pos](Square at)
-   {
-      const auto destPiece = pos[at];
+   const auto destPiece = pos[at];
+   if constexpr (Policy == SquareFilterPolicy::OnlyEmpty)
+      return !destPiece;
+   else
       return !destPiece || color(*destPiece) == opponent;
-   };
-}
-
-SquareFilterFn makeSquareFilter(SquareFilterPolicy policy, Piece piece,
-                                const Position& pos)
-{
-   switch (policy)
-   {
-   case SquareFilterPolicy::OnlyEmpty:
-      return makeEmptySquareFilter(pos);
-   case SquareFilterPolicy::EmptyOrOpponent:
-      return makeEmptyOrOpponentSquareFilter(!color(piece), pos);
-   default:
-      assert(false && "Unknown square filter policy.");
-      return {};
-   }
 }
 
 
 ///////////////////
 
-template <std::size_t N>
+template <SquareFilterPolicy Policy, std::size_t N>
 void collectOffsetSquares(Piece piece, Square at, const Position& pos,
-                          SquareFilterPolicy policy, const std::array<Offset, N>& offsets,
+                          const std::array<Offset, N>& offsets,
                           std::vector<Square>& squares)
 {
-   SquareFilterFn filterFn = makeSquareFilter(policy, piece, pos);
+   const Color opponent = !color(piece);
 
    for (const auto& off : offsets)
       if (isOnBoard(at, off))
       {
          const Square to = at + off;
-         if (filterFn(to))
+         if (passesSquareFilter<Policy>(to, opponent, pos))
             squares.push_back(to);
       }
 }
 
 
-template <std::size_t N>
+template <SquareFilterPolicy Policy, std::size_t N>
 void collectDirectionalSquares(Piece piece, Square at, const Position& pos,
-                               SquareFilterPolicy policy,
                                const std::array<Offset, N>& directions,
                                std::vector<Square>& squares)
 {
-   SquareFilterFn filterFn = makeSquareFilter(policy, piece, pos);
+   const Color opponent = !color(piece);
 
    for (const auto& off : directions)
    {
@@ -210,7 +226,7 @@ void collectDirectionalSquares(Piece piece, Square at, const Position& pos,
       while (isOnBoard(to, off))
       {
          to = to + off;
-         if (filterFn(to))
+         if (passesSquareFilter<Policy>(to, opponent, pos))
             squares.push_back(to);
          if (pos[to])
             break;
@@ -221,75 +237,116 @@ void collectDirectionalSquares(Piece piece, Square at, const Position& pos,
 
 ///////////////////
 
-bool isPawnOnInitialRank(Piece pawn, Square at)
+template <Color Us> bool isPawnOnInitialRank(Square at)
+{
+   return rank(at) == (Us == White ? r2 : r7);
+}
+
+
+template <Color Them> bool isAttackedByImpl(Square sq, const Position& pos)
 {
-   const Rank initialRank = isWhite(pawn) ? r2 : r7;
-   return rank(at) == initialRank;
+   // Pieces attack the square if a piece of the same kind on the square would attack
+   // them. Pawns attack diagonally forward, so look for them diagonally backward.
+   const Bitboard occupied = pos.occupied();
+   const Bitboard queens = pos.occupied(queen(Them));
+   return (pawnAttacks(!Them, toBitboard(sq)) & pos.occupied(pawn(Them))) != EmptyBB ||
+          (knightAttacks(sq) & pos.occupied(knight(Them))) != EmptyBB ||
+          (bishopAttacks(sq, occupied) & (pos.occupied(bishop(Them)) | queens)) !=
+             EmptyBB ||
+          (rookAttacks(sq, occupied) & (pos.occupied(rook(Them)) | queens)) != EmptyBB ||
+          (kingAttacks(sq) & pos.occupied(king(Them))) != EmptyBB;
 }
 
 
-bool areCastlingSquaresOccupied(Color side, bool onKingside, const Position& pos)
+template <Color Us> bool areCastlingSquaresOccupied(bool onKingside, const Position& pos)
 {
    // Squares between king and rook that cannot be occupied for each castling type.
    // Note that these are not the same as the squares that cannot be attacked for
    // castling.
-   static const std::vector<Square> WhiteKingside = {f1, g1};
-   static const std::vector<Square> WhiteQueenside = {b1, c1, d1};
-   static const std::vector<Square> BlackKingside = {f8, g8};
-   static const std::vector<Square> BlackQueenside = {b8, c8, d8};
+   static constexpr Bitboard Kingside = Us == White
+                                           ? toBitboard(f1) | toBitboard(g1)
+                                           : toBitboard(f8) | toBitboard(g8);
+   static constexpr Bitboard Queenside =
+      Us == White ? toBitboard(b1) | toBitboard(c1) | toBitboard(d1)
+                  : toBitboard(b8) | toBitboard(c8) | toBitboard(d8);
 
-   const std::vector<Square>& squares =
-      side == White ? (onKingside ? WhiteKingside : WhiteQueenside)
-                    : (onKingside ? BlackKingside : BlackQueenside);
+   return (pos.occupied() & (onKingside ? Kingside : Queenside)) != EmptyBB;
+}
 
-   for (Square sq : squares)
-      if (pos[sq].has_value())
+
+// Squares that castling king moves across for each castling type, including the king's
+// initial square.
+// Note that castling can still happen if the rook is attacked or moving across an
+// attacked square (i.e. b1/b8 when castling queen-side).
+// Note that these are not the same as the squares that cannot be occupied for castling.
+template <Color Us> constexpr Bitboard kingCastlingPath(bool onKingside)
+{
+   if (onKingside)
+      return Us == White ? toBitboard(e1) | toBitboard(f1) | toBitboard(g1)
+                         : toBitboard(e8) | toBitboard(f8) | toBitboard(g8);
+   return Us == White ? toBitboard(c1) | toBitboard(d1) | toBitboard(e1)
+                      : toBitboard(c8) | toBitboard(d8) | toBitboard(e8);
+}
+
+
+template <Color Us> bool areCastlingSquaresAttacked(bool onKingside, const Position& pos)
+{
+   Bitboard path = kingCastlingPath<Us>(onKingside);
+   while (path != EmptyBB)
+      if (isAttackedByImpl<!Us>(popLowestSquare(path), pos))
          return true;
    return false;
 }
 
 
-bool areCastlingSquaresAttacked(Color side, bool onKingside, const Position& pos)
+template <Color Us>
+bool areCastlingSquaresAttacked(bool onKingside, const AttackInfo& attacks)
 {
-   // Squares that castling king moves across for each castling type, including the king's
-   // initial square.
-   // Note that castling can still happen if the rook is attacked or moving across an
-   // attacked square (i.e. g1/g8 when castling queen-side).
-   // Note that these are not the same as the squares that cannot be
-   // occupied for castling.
-   static const std::vector<Square> WhiteKingside = {e1, f1, g1};
-   static const std::vector<Square> WhiteQueenside = {c1, d1, e1};
-   static const std::vector<Square> BlackKingside = {e8, f8, g8};
-   static const std::vector<Square> BlackQueenside = {c8, d8, e8};
+   return (kingCastlingPath<Us>(onKingside) & attacks.attacks(!Us)) != EmptyBB;
+}
 
-   const std::vector<Square>& squares =
-      side == White ? (onKingside ? WhiteKingside : WhiteQueenside)
-                    : (onKingside ? BlackKingside : BlackQueenside);
-   const Color opponent = !side;
 
-   for (auto sq : squares)
-      if (pos.canAttack(sq, opponent))
-         return true;
-   return false;
+template <Color Us> bool haveCastlingRook(bool onKingside, const Position& pos)
+{
+   static constexpr Square KingsideRookSq = Us == White ? h1 : h8;
+   static constexpr Square QueensideRookSq = Us == White ? a1 : a8;
+   return contains(pos.occupied(rook(Us)), onKingside ? KingsideRookSq : QueensideRookSq);
 }
 
 
-bool haveCastlingRook(Color side, bool onKingside, const Position& pos)
+template <Color Us> bool canCastleImpl(bool onKingside, const Position& pos)
 {
-   const Square rookSq = makeSquare(onKingside ? fh : fa, side == White ? r1 : r8);
-   const auto piece = pos[rookSq];
-   return piece.has_value() && isRook(*piece) && color(*piece) == side;
+   return !pos.hasKingMoved(Us) && haveCastlingRook<Us>(onKingside, pos) &&
+          !pos.hasRookMoved(Us, onKingside) &&
+          !areCastlingSquaresOccupied<Us>(onKingside, pos) &&
+          !areCastlingSquaresAttacked<Us>(onKingside, pos);
 }
 
-} // namespace
 
+template <Color Us>
+bool canCastleImpl(bool onKingside, const Position& pos, const AttackInfo& attacks)
+{
+   return !pos.hasKingMoved(Us) && haveCastlingRook<Us>(onKingside, pos) &&
+          !pos.hasRookMoved(Us, onKingside) &&
+          !areCastlingSquaresOccupied<Us>(onKingside, pos) &&
+          !areCastlingSquaresAttacked<Us>(onKingside, attacks);
+}
 
-namespace matt2
+
+template <Color Us> bool isCheckImpl(const Position& pos)
 {
+   const auto kingSq = pos.kingLocation(Us);
+   if (!kingSq)
+      return true;
+   return isAttackedByImpl<!Us>(*kingSq, pos);
+}
+
+
 ///////////////////
 
-void collectKingMoves(Piece king, Square at, const Position& pos,
-                      std::vector<Move>& moves)
+template <typename MoveCollection>
+void collectKingMovesImpl(Piece king, Square at, const Position& pos,
+                          MoveCollection& moves)
 {
    assert(isKing(king));
    static constexpr std::array<Offset, 8> Offsets{
@@ -299,8 +356,9 @@ void collectKingMoves(Piece king, Square at, const Position& pos,
 }
 
 
-void collectQueenMoves(Piece queen, Square at, const Position& pos,
-                       std::vector<Move>& moves)
+template <typename MoveCollection>
+void collectQueenMovesImpl(Piece queen, Square at, const Position& pos,
+                           MoveCollection& moves)
 {
    assert(isQueen(queen));
    static constexpr std::array<Offset, 8> Directions{
@@ -309,8 +367,9 @@ void collectQueenMoves(Piece queen, Square at, const Position& pos,
 }
 
 
-void collectRookMoves(Piece rook, Square at, const Position& pos,
-                      std::vector<Move>& moves)
+template <typename MoveCollection>
+void collectRookMovesImpl(Piece rook, Square at, const Position& pos,
+                          MoveCollection& moves)
 {
    assert(isRook(rook));
    static constexpr std::array<Offset, 4> Directions{
@@ -319,8 +378,9 @@ void collectRookMoves(Piece rook, Square at, const Position& pos,
 }
 
 
-void collectBishopMoves(Piece bishop, Square at, const Position& pos,
-                        std::vector<Move>& moves)
+template <typename MoveCollection>
+void collectBishopMovesImpl(Piece bishop, Square at, const Position& pos,
+                            MoveCollection& moves)
 {
    assert(isBishop(bishop));
    static constexpr std::array<Offset, 4> Directions{
@@ -329,8 +389,9 @@ void collectBishopMoves(Piece bishop, Square at, const Position& pos,
 }
 
 
-void collectKnightMoves(Piece knight, Square at, const Position& pos,
-                        std::vector<Move>& moves)
+template <typename MoveCollection>
+void collectKnightMovesImpl(Piece knight, Square at, const Position& pos,
+                            MoveCollection& moves)
 {
    assert(isKnight(knight));
    static constexpr std::array<Offset, 8> Offsets{
@@ -339,62 +400,94 @@ void collectKnightMoves(Piece knight, Square at, const Position& pos,
 }
 
 
-void collectPawnMoves(Piece pawn, Square at, const Position& pos,
-                      std::vector<Move>& moves)
+template <Color Us, typename MoveCollection>
+void collectPawnMovesImpl(Square at, const Position& pos, MoveCollection& moves)
 {
-   assert(isPawn(pawn));
+   static constexpr Offset Forward{0, PawnDirection<Us>};
 
    // Move one square forward if square is not occupied.
-   bool couldMoveForward = false;
-   const Offset forward{0, isWhite(pawn) ? 1 : -1};
-   if (isOnBoard(at, forward))
-      couldMoveForward = collectForwardPawnMove(pawn, at, pos, forward, moves);
-
-   // Move two squares forward if pawn is on initial rank and no other piece is
-   // in front of it.
-   // Note that checking for the initial rank also covers checking whether the
-   // destination square is on the board.
-   if (isPawnOnInitialRank(pawn, at) && couldMoveForward)
+   if (isOnBoard(at, Forward) && !pos[at + Forward])
    {
-      const Offset forwardBy2{0, isWhite(pawn) ? 2 : -2};
-      collectForwardPawnMove(pawn, at, pos, forwardBy2, moves);
+      const Square to = at + Forward;
+      if (isPromotion<Us>(to))
+         collectPromotions<Us>(at, to, std::nullopt, moves);
+      else
+         addBasicMove(moves, pawn(Us), at, to, std::nullopt);
+
+      // Move two squares forward if pawn is on initial rank and no other piece is
+      // in front of it.
+      // Note that checking for the initial rank also covers checking whether the
+      // destination square is on the board.
+      if (isPawnOnInitialRank<Us>(at))
+      {
+         static constexpr Offset ForwardBy2{0, 2 * PawnDirection<Us>};
+         const Square toBy2 = at + ForwardBy2;
+         // Moving by two squares allows opponent to use en-passant rule in the
+         // next move.
+         if (!pos[toBy2])
+            addDoublePawnPush(moves, pawn(Us), at, toBy2);
+      }
    }
 
    // Add moves for taking pieces diagonally.
-   const Offset diagonalRight{1, forward.dr};
-   collectDiagonalPawnMove(pawn, at, pos, diagonalRight, moves);
-   const Offset diagonalLeft{-1, forward.dr};
-   collectDiagonalPawnMove(pawn, at, pos, diagonalLeft, moves);
+   collectDiagonalPawnMove<Us>(at, pos, Offset{1, PawnDirection<Us>}, moves);
+   collectDiagonalPawnMove<Us>(at, pos, Offset{-1, PawnDirection<Us>}, moves);
 }
 
-void collectMoves(Piece piece, Square at, const Position& pos, std::vector<Move>& moves)
+
+template <typename MoveCollection>
+void collectPawnMovesImpl(Piece pawn, Square at, const Position& pos,
+                          MoveCollection& moves)
+{
+   assert(isPawn(pawn));
+   if (isWhite(pawn))
+      collectPawnMovesImpl<White>(at, pos, moves);
+   else
+      collectPawnMovesImpl<Black>(at, pos, moves);
+}
+
+template <typename MoveCollection>
+void collectMovesImpl(Piece piece, Square at, const Position& pos,
+                      MoveCollection& moves)
 {
    if (isKing(piece))
-      collectKingMoves(piece, at, pos, moves);
+      collectKingMovesImpl(piece, at, pos, moves);
    else if (isQueen(piece))
-      collectQueenMoves(piece, at, pos, moves);
+      collectQueenMovesImpl(piece, at, pos, moves);
    else if (isRook(piece))
-      collectRookMoves(piece, at, pos, moves);
+      collectRookMovesImpl(piece, at, pos, moves);
    else if (isBishop(piece))
-      collectBishopMoves(piece, at, pos, moves);
+      collectBishopMovesImpl(piece, at, pos, moves);
    else if (isKnight(piece))
-      collectKnightMoves(piece, at, pos, moves);
+      collectKnightMovesImpl(piece, at, pos, moves);
    else if (isPawn(piece))
-      collectPawnMoves(piece, at, pos, moves);
+      collectPawnMovesImpl(piece, at, pos, moves);
    else
       throw std::runtime_error("Unknown piece.");
 }
 
-void collectCastlingMoves(Color side, const Position& pos, std::vector<Move>& moves)
+template <Color Us, typename MoveCollection>
+void collectCastlingMovesImpl(const Position& pos, MoveCollection& moves)
 {
-   if (canCastle(side, true, pos))
-      moves.push_back(Castling{Kingside, side});
-   if (canCastle(side, false, pos))
-      moves.push_back(Castling{Queenside, side});
+   if (canCastleImpl<Us>(true, pos))
+      addCastling<Us>(moves, true);
+   if (canCastleImpl<Us>(false, pos))
+      addCastling<Us>(moves, false);
 }
 
 
-void collectEnPassantMoves(Color side, const Position& pos, std::vector<Move>& moves)
+template <typename MoveCollection>
+void collectCastlingMovesImpl(Color side, const Position& pos, MoveCollection& moves)
+{
+   if (side == White)
+      collectCastlingMovesImpl<White>(pos, moves);
+   else
+      collectCastlingMovesImpl<Black>(pos, moves);
+}
+
+
+template <Color Us, typename MoveCollection>
+void collectEnPassantMovesImpl(const Position& pos, MoveCollection& moves)
 {
    // Is en-passant enabled?
    const auto epSquare = pos.enPassantSquare();
@@ -403,13 +496,13 @@ void collectEnPassantMoves(Color side, const Position& pos, std::vector<Move>& m
    const File epFile = file(*epSquare);
 
    // Is en-passant enabled by opponent?
-   const auto epPiece = pos[*epSquare];
-   if (!epPiece.has_value() || color(*epPiece) == side)
+   if (!contains(pos.occupied(!Us), *epSquare))
       return;
 
-   const auto fromRank = side == White ? r5 : r4;
-   const auto toRank = side == White ? r6 : r3;
-   Square to = makeSquare(epFile, toRank);
+   static constexpr Rank FromRank = Us == White ? r5 : r4;
+   static constexpr Rank ToRank = Us == White ? r6 : r3;
+   const Square to = makeSquare(epFile, ToRank);
+   const Bitboard pawns = pos.occupied(pawn(Us));
 
    // Try both neighboring files.
    static constexpr std::array<int, 2> FileOffsets = {-1, 1};
@@ -418,19 +511,208 @@ void collectEnPassantMoves(Color side, const Position& pos, std::vector<Move>& m
       // Is the neighboring file on the board?
       if (isValid(epFile, off))
       {
-         const Square from = makeSquare(epFile + off, fromRank);
-
          // Is a pawn of matching color on the right square to make an en-passent
          // move?
-         if (const auto piece = pos[from];
-             piece.has_value() && isPawn(*piece) && color(*piece) == side)
-         {
-            moves.push_back(EnPassant{Relocation(*piece, from, to)});
-         }
+         const Square from = makeSquare(epFile + off, FromRank);
+         if (contains(pawns, from))
+            addEnPassant(moves, pawn(Us), from, to);
       }
    }
 }
 
+
+template <typename MoveCollection>
+void collectEnPassantMovesImpl(Color side, const Position& pos, MoveCollection& moves)
+{
+   if (side == White)
+      collectEnPassantMovesImpl<White>(pos, moves);
+   else
+      collectEnPassantMovesImpl<Black>(pos, moves);
+}
+
+
+template <typename CollectFn> void collectForPieces(Bitboard pieces, CollectFn collect)
+{
+   while (pieces != EmptyBB)
+      collect(popLowestSquare(pieces));
+}
+
+
+template <Color Us, typename MoveCollection>
+void collectSideMovesImpl(const Position& pos, MoveCollection& moves)
+{
+   // Visit pieces in the same order as iterating the placements of a side.
+   collectForPieces(pos.occupied(rook(Us)),
+                    [&](Square at) { collectRookMovesImpl(rook(Us), at, pos, moves); });
+   collectForPieces(pos.occupied(bishop(Us)),
+                    [&](Square at) { collectBishopMovesImpl(bishop(Us), at, pos, moves); });
+   collectForPieces(pos.occupied(knight(Us)),
+                    [&](Square at) { collectKnightMovesImpl(knight(Us), at, pos, moves); });
+   collectForPieces(pos.occupied(queen(Us)),
+                    [&](Square at) { collectQueenMovesImpl(queen(Us), at, pos, moves); });
+   collectForPieces(pos.occupied(pawn(Us)),
+                    [&](Square at) { collectPawnMovesImpl<Us>(at, pos, moves); });
+   collectForPieces(pos.occupied(king(Us)),
+                    [&](Square at) { collectKingMovesImpl(king(Us), at, pos, moves); });
+
+   collectCastlingMovesImpl<Us>(pos, moves);
+   collectEnPassantMovesImpl<Us>(pos, moves);
+}
+
+} // namespace
+
+
+namespace matt2
+{
+///////////////////
+
+void collectKingMoves(Piece king, Square at, const Position& pos,
+                      std::vector<Move>& moves)
+{
+   collectKingMovesImpl(king, at, pos, moves);
+}
+
+void collectKingMoves(Piece king, Square at, const Position& pos, MoveList& moves)
+{
+   collectKingMovesImpl(king, at, pos, moves);
+}
+
+void collectKingMoves(Piece king, Square at, const Position& pos,
+                      PackedMoveList& moves)
+{
+   collectKingMovesImpl(king, at, pos, moves);
+}
+
+void collectQueenMoves(Piece queen, Square at, const Position& pos,
+                       std::vector<Move>& moves)
+{
+   collectQueenMovesImpl(queen, at, pos, moves);
+}
+
+void collectQueenMoves(Piece queen, Square at, const Position& pos, MoveList& moves)
+{
+   collectQueenMovesImpl(queen, at, pos, moves);
+}
+
+void collectQueenMoves(Piece queen, Square at, const Position& pos,
+                       PackedMoveList& moves)
+{
+   collectQueenMovesImpl(queen, at, pos, moves);
+}
+
+void collectRookMoves(Piece rook, Square at, const Position& pos,
+                      std::vector<Move>& moves)
+{
+   collectRookMovesImpl(rook, at, pos, moves);
+}
+
+void collectRookMoves(Piece rook, Square at, const Position& pos, MoveList& moves)
+{
+   collectRookMovesImpl(rook, at, pos, moves);
+}
+
+void collectRookMoves(Piece rook, Square at, const Position& pos,
+                      PackedMoveList& moves)
+{
+   collectRookMovesImpl(rook, at, pos, moves);
+}
+
+void collectBishopMoves(Piece bishop, Square at, const Position& pos,
+                        std::vector<Move>& moves)
+{
+   collectBishopMovesImpl(bishop, at, pos, moves);
+}
+
+void collectBishopMoves(Piece bishop, Square at, const Position& pos, MoveList& moves)
+{
+   collectBishopMovesImpl(bishop, at, pos, moves);
+}
+
+void collectBishopMoves(Piece bishop, Square at, const Position& pos,
+                        PackedMoveList& moves)
+{
+   collectBishopMovesImpl(bishop, at, pos, moves);
+}
+
+void collectKnightMoves(Piece knight, Square at, const Position& pos,
+                        std::vector<Move>& moves)
+{
+   collectKnightMovesImpl(knight, at, pos, moves);
+}
+
+void collectKnightMoves(Piece knight, Square at, const Position& pos, MoveList& moves)
+{
+   collectKnightMovesImpl(knight, at, pos, moves);
+}
+
+void collectKnightMoves(Piece knight, Square at, const Position& pos,
+                        PackedMoveList& moves)
+{
+   collectKnightMovesImpl(knight, at, pos, moves);
+}
+
+void collectPawnMoves(Piece pawn, Square at, const Position& pos,
+                      std::vector<Move>& moves)
+{
+   collectPawnMovesImpl(pawn, at, pos, moves);
+}
+
+void collectPawnMoves(Piece pawn, Square at, const Position& pos, MoveList& moves)
+{
+   collectPawnMovesImpl(pawn, at, pos, moves);
+}
+
+void collectPawnMoves(Piece pawn, Square at, const Position& pos,
+                      PackedMoveList& moves)
+{
+   collectPawnMovesImpl(pawn, at, pos, moves);
+}
+
+void collectMoves(Piece piece, Square at, const Position& pos, std::vector<Move>& moves)
+{
+   collectMovesImpl(piece, at, pos, moves);
+}
+
+void collectMoves(Piece piece, Square at, const Position& pos, MoveList& moves)
+{
+   collectMovesImpl(piece, at, pos, moves);
+}
+
+void collectMoves(Piece piece, Square at, const Position& pos, PackedMoveList& moves)
+{
+   collectMovesImpl(piece, at, pos, moves);
+}
+
+void collectCastlingMoves(Color side, const Position& pos, std::vector<Move>& moves)
+{
+   collectCastlingMovesImpl(side, pos, moves);
+}
+
+void collectCastlingMoves(Color side, const Position& pos, MoveList& moves)
+{
+   collectCastlingMovesImpl(side, pos, moves);
+}
+
+void collectCastlingMoves(Color side, const Position& pos, PackedMoveList& moves)
+{
+   collectCastlingMovesImpl(side, pos, moves);
+}
+
+void collectEnPassantMoves(Color side, const Position& pos, std::vector<Move>& moves)
+{
+   collectEnPassantMovesImpl(side, pos, moves);
+}
+
+void collectEnPassantMoves(Color side, const Position& pos, MoveList& moves)
+{
+   collectEnPassantMovesImpl(side, pos, moves);
+}
+
+void collectEnPassantMoves(Color side, const Position& pos, PackedMoveList& moves)
+{
+   collectEnPassantMovesImpl(side, pos, moves);
+}
+
 ///////////////////
 
 void collectAttackedByKing(Piece king, Square at, const Position& pos,
@@ -439,8 +721,8 @@ void collectAttackedByKing(Piece king, Square at, const Position& pos,
    assert(isKing(king));
    static constexpr std::array<Offset, 8> Offsets{
       Offset{1, 1}, {1, 0}, {1, -1}, {0, 1}, {0, -1}, {-1, 1}, {-1, 0}, {-1, -1}};
-   collectOffsetSquares(king, at, pos, SquareFilterPolicy::EmptyOrOpponent, Offsets,
-                        attacked);
+   collectOffsetSquares<SquareFilterPolicy::EmptyOrOpponent>(king, at, pos, Offsets,
+                                                             attacked);
 }
 
 
@@ -450,8 +732,8 @@ void collectAttackedByQueen(Piece queen, Square at, const Position& pos,
    assert(isQueen(queen));
    static constexpr std::array<Offset, 8> Directions{
       Offset{1, 1}, {1, 0}, {1, -1}, {0, 1}, {0, -1}, {-1, 1}, {-1, 0}, {-1, -1}};
-   collectDirectionalSquares(queen, at, pos, SquareFilterPolicy::EmptyOrOpponent,
-                             Directions, attacked);
+   collectDirectionalSquares<SquareFilterPolicy::EmptyOrOpponent>(
+      queen, at, pos, Directions, attacked);
 }
 
 
@@ -461,8 +743,8 @@ void collectAttackedByRook(Piece rook, Square at, const Position& pos,
    assert(isRook(rook));
    static constexpr std::array<Offset, 4> Directions{
       Offset{1, 0}, {0, 1}, {0, -1}, {-1, 0}};
-   collectDirectionalSquares(rook, at, pos, SquareFilterPolicy::EmptyOrOpponent,
-                             Directions, attacked);
+   collectDirectionalSquares<SquareFilterPolicy::EmptyOrOpponent>(
+      rook, at, pos, Directions, attacked);
 }
 
 void collectAttackedByBishop(Piece bishop, Square at, const Position& pos,
@@ -471,8 +753,8 @@ void collectAttackedByBishop(Piece bishop, Square at, const Position& pos,
    assert(isBishop(bishop));
    static constexpr std::array<Offset, 4> Directions{
       Offset{1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
-   collectDirectionalSquares(bishop, at, pos, SquareFilterPolicy::EmptyOrOpponent,
-                             Directions, attacked);
+   collectDirectionalSquares<SquareFilterPolicy::EmptyOrOpponent>(
+      bishop, at, pos, Directions, attacked);
 }
 
 void collectAttackedByKnight(Piece knight, Square at, const Position& pos,
@@ -481,8 +763,8 @@ void collectAttackedByKnight(Piece knight, Square at, const Position& pos,
    assert(isKnight(knight));
    static constexpr std::array<Offset, 8> Offsets{
       Offset{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
-   collectOffsetSquares(knight, at, pos, SquareFilterPolicy::EmptyOrOpponent, Offsets,
-                        attacked);
+   collectOffsetSquares<SquareFilterPolicy::EmptyOrOpponent>(knight, at, pos, Offsets,
+                                                             attacked);
 }
 
 void collectAttackedByEnPassant(Piece pawn, Square at, const Position& pos,
@@ -509,10 +791,10 @@ void collectAttackedByPawn(Piece pawn, Square at, const Position& pos,
                            std::vector<Square>& attacked)
 {
    assert(isPawn(pawn));
-   const int forward = isWhite(pawn) ? 1 : -1;
-   const std::array<Offset, 2> Offsets{Offset{1, forward}, {-1, forward}};
-   collectOffsetSquares(pawn, at, pos, SquareFilterPolicy::EmptyOrOpponent, Offsets,
-                        attacked);
+   static constexpr std::array<Offset, 2> WhiteOffsets{Offset{1, 1}, {-1, 1}};
+   static constexpr std::array<Offset, 2> BlackOffsets{Offset{1, -1}, {-1, -1}};
+   collectOffsetSquares<SquareFilterPolicy::EmptyOrOpponent>(
+      pawn, at, pos, isWhite(pawn) ? WhiteOffsets : BlackOffsets, attacked);
 
    collectAttackedByEnPassant(pawn, at, pos, attacked);
 }
@@ -548,27 +830,26 @@ void collectAttackedBySide(Color side, const Position& pos, std::vector<Square>&
 
 bool canCastle(Color side, bool onKingside, const Position& pos)
 {
-   return !pos.hasKingMoved(side) && haveCastlingRook(side, onKingside, pos) &&
-          !pos.hasRookMoved(side, onKingside) &&
-          !areCastlingSquaresOccupied(side, onKingside, pos) &&
-          !areCastlingSquaresAttacked(side, onKingside, pos);
+   return side == White ? canCastleImpl<White>(onKingside, pos)
+                        : canCastleImpl<Black>(onKingside, pos);
 }
 
-bool isCheck(Color side, const Position& pos)
+bool canCastle(Color side, bool onKingside, const Position& pos,
+               const AttackInfo& attacks)
 {
-   const auto kingSq = pos.kingLocation(side);
-   if (!kingSq)
-      return true;
+   return side == White ? canCastleImpl<White>(onKingside, pos, attacks)
+                        : canCastleImpl<Black>(onKingside, pos, attacks);
+}
 
-   std::vector<Square> attackedSorted;
-   collectAttackedBySide(!side, pos, attackedSorted);
+bool isCheck(Color side, const Position& pos)
+{
+   return side == White ? isCheckImpl<White>(pos) : isCheckImpl<Black>(pos);
+}
 
-   const auto endIter = std::end(attackedSorted);
-   const auto geIter = std::lower_bound(std::begin(attackedSorted), endIter, *kingSq);
-   // We still have to check for equality because the iterator returned by
-   // lower_bound points to the first element that is not less than the search for
-   // value.
-   return geIter != endIter && *geIter == *kingSq;
+bool isCheck(Color side, const Position& pos, const AttackInfo& attacks)
+{
+   // Positions without king count as check, same as for the other overload.
+   return attacks.isCheck(side) || pos.count(king(side)) == 0;
 }
 
 bool isMate(Color side, const Position& pos)
@@ -576,4 +857,28 @@ bool isMate(Color side, const Position& pos)
    return pos.count(king(side)) == 0;
 }
 
+///////////////////
+
+template <Color Us> void collectSideMoves(const Position& pos, PackedMoveList& moves)
+{
+   collectSideMovesImpl<Us>(pos, moves);
+}
+
+template <Color Us> bool isCheck(const Position& pos)
+{
+   return isCheckImpl<Us>(pos);
+}
+
+template <Color Them> bool isAttackedBy(Square sq, const Position& pos)
+{
+   return isAttackedByImpl<Them>(sq, pos);
+}
+
+template void collectSideMoves<White>(const Position& pos, PackedMoveList& moves);
+template void collectSideMoves<Black>(const Position& pos, PackedMoveList& moves);
+template bool isCheck<White>(const Position& pos);
+template bool isCheck<Black>(const Position& pos);
+template bool isAttackedBy<White>(Square sq, const Position& pos);
+template bool isAttackedBy<Black>(Square sq, const Position& pos);
+
 } // namespace matt2
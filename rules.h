@@ -3,6 +3,7 @@
 // MIT license
 //
 #pragma once
+#include "attack_info.h"
 #include "move.h"
 #include "piece.h"
 #include "position.h"
@@ -34,6 +35,35 @@ void collectMoves(Piece piece, Square at, const Position& pos, std::vector<Move>
 void collectCastlingMoves(Color side, const Position& pos, std::vector<Move>& moves);
 void collectEnPassantMoves(Color side, const Position& pos, std::vector<Move>& moves);
 
+// Overloads that collect into a move list that does not allocate heap memory. Meant
+// to be used in performance critical code.
+void collectKingMoves(Piece king, Square at, const Position& pos, MoveList& moves);
+void collectQueenMoves(Piece queen, Square at, const Position& pos, MoveList& moves);
+void collectRookMoves(Piece rook, Square at, const Position& pos, MoveList& moves);
+void collectBishopMoves(Piece bishop, Square at, const Position& pos, MoveList& moves);
+void collectKnightMoves(Piece knight, Square at, const Position& pos, MoveList& moves);
+void collectPawnMoves(Piece pawn, Square at, const Position& pos, MoveList& moves);
+void collectMoves(Piece piece, Square at, const Position& pos, MoveList& moves);
+void collectCastlingMoves(Color side, const Position& pos, MoveList& moves);
+void collectEnPassantMoves(Color side, const Position& pos, MoveList& moves);
+
+// Overloads that collect packed moves.
+void collectKingMoves(Piece king, Square at, const Position& pos,
+                      PackedMoveList& moves);
+void collectQueenMoves(Piece queen, Square at, const Position& pos,
+                       PackedMoveList& moves);
+void collectRookMoves(Piece rook, Square at, const Position& pos,
+                      PackedMoveList& moves);
+void collectBishopMoves(Piece bishop, Square at, const Position& pos,
+                        PackedMoveList& moves);
+void collectKnightMoves(Piece knight, Square at, const Position& pos,
+                        PackedMoveList& moves);
+void collectPawnMoves(Piece pawn, Square at, const Position& pos,
+                      PackedMoveList& moves);
+void collectMoves(Piece piece, Square at, const Position& pos, PackedMoveList& moves);
+void collectCastlingMoves(Color side, const Position& pos, PackedMoveList& moves);
+void collectEnPassantMoves(Color side, const Position& pos, PackedMoveList& moves);
+
 
 ///////////////////
 
@@ -60,6 +90,23 @@ void collectAttackedBySide(Color side, const Position& pos,
 
 bool canCastle(Color side, bool onKingside, const Position& pos);
 bool isCheck(Color side, const Position& pos);
+// Overloads that look up attacked squares in the attacks of the position instead of
+// tracing the moves of the opponent's pieces.
+bool canCastle(Color side, bool onKingside, const Position& pos,
+               const AttackInfo& attacks);
+bool isCheck(Color side, const Position& pos, const AttackInfo& attacks);
 bool isMate(Color side, const Position& pos);
 
+///////////////////
+
+// Versions for a side that is known at compile time. All color decisions are made at
+// compile time. Instantiated for both colors.
+
+// Collect packed moves for all pieces of a side, including castling and en-passant
+// moves. Moves that lead to check are not eliminated.
+template <Color Us> void collectSideMoves(const Position& pos, PackedMoveList& moves);
+template <Color Us> bool isCheck(const Position& pos);
+// Checks whether a given square can be attacked by a piece of a side.
+template <Color Them> bool isAttackedBy(Square sq, const Position& pos);
+
 } // namespace matt2
@@ -4,22 +4,56 @@
 //
 #include "scoring.h"
 #include "daily_chess_scoring.h"
+#include "eval_cache.h"
+#include "position.h"
+#include "zobrist.h"
 
 namespace matt2
 {
 ///////////////////
 
-double calcScore(const Position& pos)
+Score calcScore(const Position& pos)
 {
    return dcs::score(pos);
 }
 
-double calcMateScore(Color side, const Position& pos, size_t atDepth)
+Score calcScore(const Position& pos, EvalCache& cache)
+{
+   // Scores do not depend on the side to move.
+   const uint64_t key = zobristHash(pos, White);
+   if (const auto cached = cache.probe(key); cached.has_value())
+      return *cached;
+
+   const Score score = dcs::score(pos);
+   cache.store(key, score);
+   return score;
+}
+
+Score calcScore(const Position& pos, Score alpha, Score beta, EvalCache* cache)
+{
+   if (!cache)
+      return dcs::score(pos, alpha, beta);
+
+   const uint64_t key = zobristHash(pos, White);
+   if (const auto cached = cache->probe(key); cached.has_value())
+      return *cached;
+
+   // Bounds are not cached because they are only valid for the window.
+   const Score summed = dcs::summedScore(pos);
+   if (dcs::isOutsideLazyWindow(summed, alpha, beta))
+      return summed;
+
+   const Score score = dcs::score(pos);
+   cache->store(key, score);
+   return score;
+}
+
+Score calcMateScore(Color side, const Position& pos, size_t atDepth)
 {
    return dcs::scoreMate(pos, atDepth, side);
 }
 
-double calcTieScore(Color side, const Position& pos)
+Score calcTieScore(Color side, const Position& pos)
 {
    return dcs::scoreTie(pos, side);
 }
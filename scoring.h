@@ -4,10 +4,14 @@
 //
 #pragma once
 #include "piece.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 
 namespace matt2
 {
+class EvalCache;
 class Position;
 }
 
@@ -16,45 +20,203 @@ namespace matt2
 {
 ///////////////////
 
+// Score of a position in centipawns from white's point of view, i.e. positive scores
+// are good for white and negative scores are good for black.
+// All scores fit into 16 bits, so that they can be stored compactly.
+using Score = int32_t;
+
+// Bound of all scores. Only used as initial value for searches.
+constexpr Score InfiniteScore = 32000;
+// Score of a side being mated at the root of the search tree. Mates deeper in the tree
+// are scored closer to zero by the number of plies to the mate, so that faster mates
+// are preferred. Evaluations of positions are always below the range of mate scores.
+constexpr Score MateScore = 31000;
+constexpr Score MaxMatePly = 1000;
+
+// Returns the score of a given side being mated at a given ply.
+constexpr Score matedScore(Color side, std::size_t atPly)
+{
+   assert(atPly < static_cast<std::size_t>(MaxMatePly));
+   const Score amount = MateScore - static_cast<Score>(atPly);
+   // Needs to be a bad score for the mated side.
+   return side == White ? -amount : amount;
+}
+
+constexpr bool isMateScore(Score score)
+{
+   return score > MateScore - MaxMatePly || score < -(MateScore - MaxMatePly);
+}
+
+// Returns the ply at which the mate of a mate score happens.
+constexpr std::size_t matePly(Score score)
+{
+   assert(isMateScore(score));
+   return static_cast<std::size_t>(MateScore - (score < 0 ? -score : score));
+}
+
+///////////////////
+
+// Pair of middlegame and endgame scores packed into a single integer, so that both
+// phases are added and subtracted with one instruction. The endgame score is held in
+// the upper 16 bits and the middlegame score in the lower 16 bits. The lower half is
+// treated as signed, so the upper half is off by one for negative middlegame scores.
+// This is corrected when the halves are extracted.
+class ScorePair
+{
+ public:
+   constexpr ScorePair() = default;
+   constexpr ScorePair(Score mg, Score eg);
+   // Pair with the same score for both phases.
+   constexpr explicit ScorePair(Score both) : ScorePair{both, both} {}
+
+   constexpr Score mg() const;
+   constexpr Score eg() const;
+
+   constexpr ScorePair& operator+=(ScorePair other);
+   constexpr ScorePair& operator-=(ScorePair other);
+
+   friend constexpr ScorePair operator+(ScorePair a, ScorePair b) { return a += b; }
+   friend constexpr ScorePair operator-(ScorePair a, ScorePair b) { return a -= b; }
+   friend constexpr ScorePair operator-(ScorePair a) { return ScorePair{} - a; }
+   friend constexpr ScorePair operator*(ScorePair a, int factor);
+   friend constexpr bool operator==(ScorePair a, ScorePair b) = default;
+
+ private:
+   // Calculations are done with unsigned values to get wrap-around instead of
+   // undefined behavior for the carries between the halves.
+   static constexpr ScorePair fromPacked(uint32_t packed);
+
+ private:
+   int32_t m_packed = 0;
+};
+
+static_assert(sizeof(ScorePair) == 4);
+
+///////////////////
+
 // Better score than.
-inline bool bt(double a, double b, bool calcMax)
+inline bool bt(Score a, Score b, bool calcMax)
 {
    return calcMax ? a > b : a < b;
 }
 
-inline bool bt(double a, double b, Color side)
+inline bool bt(Score a, Score b, Color side)
 {
    return bt(a, b, side == White);
 }
 
 // Compare scores: 1, 0, -1
-inline int cmp(double a, double b, bool calcMax)
+inline int cmp(Score a, Score b, bool calcMax)
 {
    if (a == b)
       return 0;
    return bt(a, b, calcMax) ? 1 : -1;
 }
 
-inline int cmp(double a, double b, Color side)
+inline int cmp(Score a, Score b, Color side)
 {
    return cmp(a, b, side == White);
 }
 
 // Get worst score value.
-inline double getWorstScoreValue(bool calcMax)
+inline Score getWorstScoreValue(bool calcMax)
 {
-   return calcMax ? std::numeric_limits<double>::lowest()
-                  : std::numeric_limits<double>::max();
+   return calcMax ? -InfiniteScore : InfiniteScore;
 }
 
-inline double getWorstScoreValue(Color side)
+inline Score getWorstScoreValue(Color side)
 {
    return getWorstScoreValue(side == White);
 }
 
+// Versions for a side that is known at compile time.
+template <Color Us> bool bt(Score a, Score b)
+{
+   if constexpr (Us == White)
+      return a > b;
+   else
+      return a < b;
+}
+
+template <Color Us> int cmp(Score a, Score b)
+{
+   if (a == b)
+      return 0;
+   return bt<Us>(a, b) ? 1 : -1;
+}
+
+template <Color Us> constexpr Score getWorstScoreValue()
+{
+   if constexpr (Us == White)
+      return -InfiniteScore;
+   else
+      return InfiniteScore;
+}
+
 // Calculate the score of a given position.
-double calcScore(const Position& pos);
-double calcMateScore(Color side, const Position& pos, size_t atDepth);
-double calcTieScore(Color side, const Position& pos);
+Score calcScore(const Position& pos);
+// Calculate the score of a given position or look it up in a given cache.
+Score calcScore(const Position& pos, EvalCache& cache);
+// Calculate the score of a given position for a search window (alpha, beta) from
+// white's point of view. Positions that are clearly outside of the window are scored
+// lazily and get a bound instead of their exact score. Exact scores are looked up in
+// and stored to a given cache, if any.
+Score calcScore(const Position& pos, Score alpha, Score beta, EvalCache* cache = nullptr);
+Score calcMateScore(Color side, const Position& pos, size_t atDepth);
+Score calcTieScore(Color side, const Position& pos);
+
+
+///////////////////
+// Implementation of ScorePair.
+
+constexpr ScorePair::ScorePair(Score mg, Score eg)
+: m_packed{static_cast<int32_t>((static_cast<uint32_t>(eg) << 16) +
+                                static_cast<uint32_t>(mg))}
+{
+   assert(mg >= std::numeric_limits<int16_t>::min() &&
+          mg <= std::numeric_limits<int16_t>::max());
+   assert(eg >= std::numeric_limits<int16_t>::min() &&
+          eg <= std::numeric_limits<int16_t>::max());
+}
+
+constexpr Score ScorePair::mg() const
+{
+   return static_cast<int16_t>(static_cast<uint16_t>(static_cast<uint32_t>(m_packed)));
+}
+
+constexpr Score ScorePair::eg() const
+{
+   // Adding half of the lower range carries the borrow of a negative lower half back
+   // into the upper half.
+   const uint32_t upper = (static_cast<uint32_t>(m_packed) + 0x8000u) >> 16;
+   return static_cast<int16_t>(static_cast<uint16_t>(upper));
+}
+
+constexpr ScorePair& ScorePair::operator+=(ScorePair other)
+{
+   *this = fromPacked(static_cast<uint32_t>(m_packed) +
+                      static_cast<uint32_t>(other.m_packed));
+   return *this;
+}
+
+constexpr ScorePair& ScorePair::operator-=(ScorePair other)
+{
+   *this = fromPacked(static_cast<uint32_t>(m_packed) -
+                      static_cast<uint32_t>(other.m_packed));
+   return *this;
+}
+
+constexpr ScorePair operator*(ScorePair a, int factor)
+{
+   return ScorePair::fromPacked(static_cast<uint32_t>(a.m_packed) *
+                                static_cast<uint32_t>(factor));
+}
+
+constexpr ScorePair ScorePair::fromPacked(uint32_t packed)
+{
+   ScorePair pair;
+   pair.m_packed = static_cast<int32_t>(packed);
+   return pair;
+}
 
 } // namespace matt2
@@ -5,7 +5,9 @@
 #pragma once
 #include "piece.h"
 #include <cassert>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 #ifdef min
 #undef min
@@ -60,7 +62,7 @@ inline char toChar(File f)
    return 'a' + static_cast<char>(f);
 }
 
-inline File fileFromChar(char lowercaseChar)
+constexpr File fileFromChar(char lowercaseChar)
 {
    return static_cast<File>(lowercaseChar - 'a');
 }
@@ -135,7 +137,7 @@ inline char toChar(Rank r)
    return '1' + static_cast<char>(r);
 }
 
-inline Rank rankFromChar(char lowercaseChar)
+constexpr Rank rankFromChar(char lowercaseChar)
 {
    return static_cast<Rank>(lowercaseChar - '1');
 }
@@ -259,31 +261,54 @@ constexpr Square h8 = Square::h8;
 // Create a square from a given notation. A square notation consists of a code for
 // the file, e.g. 'c', 'h', and a code for the rank, e.g. '2', '7'.
 // Examples: "f6", "b8".
-Square makeSquare(std::string_view notation);
+constexpr Square makeSquare(std::string_view notation)
+{
+   if (notation.size() < 2)
+      throw std::runtime_error("Invalid notation for square.");
+
+   // Read file.
+   const unsigned char file = notation[0];
+   if (file < 'a' || file > 'h')
+      throw std::runtime_error("Invalid file notation for square.");
+
+   // Read rank.
+   const unsigned char rank = notation[1];
+   if (rank < '1' || rank > '8')
+      throw std::runtime_error("Invalid rank notation for square.");
+
+   return static_cast<Square>((file - 'a') * 8 + (rank - '1'));
+}
 
 // Create square from file and rank.
-inline Square makeSquare(File f, Rank r)
+constexpr Square makeSquare(File f, Rank r)
 {
    return static_cast<Square>(static_cast<unsigned char>(f) * 8 +
                               static_cast<unsigned char>(r));
 }
 
-inline File file(Square sq)
+constexpr File file(Square sq)
 {
    return static_cast<File>(static_cast<unsigned char>(sq) / 8);
 }
 
-inline Rank rank(Square sq)
+constexpr Rank rank(Square sq)
 {
    return static_cast<Rank>(static_cast<unsigned char>(sq) % 8);
 }
 
-inline bool isValid(Square sq)
+constexpr bool isValid(Square sq)
 {
    // Square enum is based on an unsigned value and can never be less than zero.
    return static_cast<unsigned char>(sq) <= static_cast<unsigned char>(h8);
 }
 
+// Returns the square on the same file with the rank mirrored along the middle of the
+// board, i.e. the square as seen from the other side.
+constexpr Square flipRank(Square sq)
+{
+   return makeSquare(file(sq), static_cast<Rank>(7 - static_cast<unsigned char>(rank(sq))));
+}
+
 inline Square operator++(Square& sq)
 {
    sq = static_cast<Square>((static_cast<std::size_t>(sq) + 1) % 64);
@@ -0,0 +1,198 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "attack_info_tests.h"
+#include "attack_info.h"
+#include "perft.h"
+#include "position.h"
+#include "rules.h"
+#include "test_util.h"
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+Bitboard toBitboard(std::initializer_list<Square> squares)
+{
+   Bitboard bb = EmptyBB;
+   for (Square sq : squares)
+      bb |= matt2::toBitboard(sq);
+   return bb;
+}
+
+
+void testPieceAttacks()
+{
+   {
+      const std::string caseLabel = "knightAttacks";
+
+      VERIFY(knightAttacks(a1) == toBitboard({b3, c2}), caseLabel);
+      VERIFY(knightAttacks(d4) == toBitboard({b3, b5, c2, c6, e2, e6, f3, f5}),
+             caseLabel);
+      VERIFY(knightAttacks(h8) == toBitboard({f7, g6}), caseLabel);
+   }
+   {
+      const std::string caseLabel = "kingAttacks";
+
+      VERIFY(kingAttacks(a1) == toBitboard({a2, b1, b2}), caseLabel);
+      VERIFY(kingAttacks(e8) == toBitboard({d8, d7, e7, f7, f8}), caseLabel);
+   }
+   {
+      const std::string caseLabel = "pawnAttacks";
+
+      VERIFY(pawnAttacks(White, toBitboard({a2, e4})) == toBitboard({b3, d5, f5}),
+             caseLabel);
+      VERIFY(pawnAttacks(Black, toBitboard({h7, e4})) == toBitboard({g6, d3, f3}),
+             caseLabel);
+      // Pawns on the last rank don't wrap around to the next file.
+      VERIFY(pawnAttacks(White, toBitboard({c8})) == EmptyBB, caseLabel);
+      VERIFY(pawnAttacks(Black, toBitboard({c1})) == EmptyBB, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Slider attacks on empty board";
+
+      VERIFY(popCount(rookAttacks(d4, EmptyBB)) == 14, caseLabel);
+      VERIFY(popCount(bishopAttacks(d4, EmptyBB)) == 13, caseLabel);
+      VERIFY(popCount(queenAttacks(a1, EmptyBB)) == 21, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Slider attacks stop at occupied squares";
+
+      const Bitboard occupied = toBitboard({d6, b4, d2, g4, f6, b2});
+      VERIFY(rookAttacks(d4, occupied) ==
+                toBitboard({d5, d6, c4, b4, d3, d2, e4, f4, g4}),
+             caseLabel);
+      VERIFY(bishopAttacks(d4, occupied) ==
+                toBitboard({e5, f6, c5, b6, a7, c3, b2, e3, f2, g1}),
+             caseLabel);
+   }
+}
+
+
+void testAttackInfoSets()
+{
+   {
+      const std::string caseLabel = "AttackInfo attacks by piece and side";
+
+      const Position pos{"Kwe1 Rwa1 wb2 Kbe8 Nbc6"};
+      const AttackInfo attacks{pos};
+
+      VERIFY(attacks.attacks(Rw) == toBitboard({a2, a3, a4, a5, a6, a7, a8, b1, c1, d1,
+                                                e1}),
+             caseLabel);
+      VERIFY(attacks.attacks(Pw) == toBitboard({a3, c3}), caseLabel);
+      VERIFY(attacks.attacks(Nb) == toBitboard({a5, a7, b4, b8, d4, d8, e5, e7}),
+             caseLabel);
+      VERIFY(attacks.attacks(White) == (attacks.attacks(Kw) | attacks.attacks(Rw) |
+                                        attacks.attacks(Pw)),
+             caseLabel);
+      VERIFY(attacks.attacks(Qw) == EmptyBB, caseLabel);
+   }
+   {
+      const std::string caseLabel = "AttackInfo double attacks";
+
+      const Position pos{"Kwa1 Nwc3 Rwe1 wd4 wf4 Kbh8"};
+      const AttackInfo attacks{pos};
+
+      // Squares attacked by two of king, knight and rook and the square between the
+      // pawns.
+      VERIFY(attacks.doubleAttacks(White) == toBitboard({a2, b1, d1, e2, e4, e5}),
+             caseLabel);
+      VERIFY(attacks.doubleAttacks(Black) == EmptyBB, caseLabel);
+   }
+   {
+      const std::string caseLabel = "AttackInfo king zone attacks";
+
+      const Position pos{"Kwg1 wf2 wg2 wh2 Kba8 Qbg4 Nbe4"};
+      const AttackInfo attacks{pos};
+
+      VERIFY(attacks.kingZone(White) == toBitboard({f1, f2, g1, g2, h1, h2}), caseLabel);
+      // Queen attacks g2, knight attacks f2.
+      VERIFY(attacks.kingZoneAttacks(White) == 2, caseLabel);
+      VERIFY(attacks.kingZoneAttackers(White) == 2, caseLabel);
+      VERIFY(attacks.kingZoneAttacks(Black) == 0, caseLabel);
+      VERIFY(attacks.kingZoneAttackers(Black) == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "AttackInfo mobility";
+
+      const Position pos{"Kwa1 Nwd4 Rwh1 wh3 Kba8 bc6"};
+      const AttackInfo attacks{pos};
+
+      // Knight square b5 is covered by the pawn.
+      VERIFY(attacks.mobility(Nw) == 7, caseLabel);
+      // Rook is blocked by own pawn.
+      VERIFY(attacks.mobility(Rw) == 7, caseLabel);
+      VERIFY(attacks.mobility(Qw) == 0, caseLabel);
+   }
+}
+
+
+// Compares the attacks of a position against the attack checks of the rules.
+bool verifyAttacks(const Position& pos)
+{
+   const AttackInfo attacks{pos};
+   for (std::size_t i = 0; i < 64; ++i)
+   {
+      const auto sq = static_cast<Square>(i);
+      if (attacks.isAttacked(sq, White) != isAttackedBy<White>(sq, pos) ||
+          attacks.isAttacked(sq, Black) != isAttackedBy<Black>(sq, pos))
+         return false;
+   }
+
+   for (Color side : {White, Black})
+   {
+      if (isCheck(side, pos, attacks) != isCheck(side, pos))
+         return false;
+      for (bool onKingside : {true, false})
+      {
+         if (canCastle(side, onKingside, pos, attacks) !=
+             canCastle(side, onKingside, pos))
+            return false;
+      }
+   }
+   return true;
+}
+
+
+void testAttackInfoMatchesRules()
+{
+   {
+      const std::string caseLabel = "AttackInfo matches attack checks of rules";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         Position pos = entry.pos;
+         VERIFY(forEachTreePosition<White>(pos, 2, verifyAttacks), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "AttackInfo check detection";
+
+      const Position check{"Kwe1 Bbb4 Kbe8"};
+      VERIFY(isCheck(White, check, AttackInfo{check}), caseLabel);
+      VERIFY(!isCheck(Black, check, AttackInfo{check}), caseLabel);
+
+      const Position blocked{"Kwe1 Nwd2 Bbb4 Kbe8"};
+      VERIFY(!isCheck(White, blocked, AttackInfo{blocked}), caseLabel);
+
+      // Missing kings count as check.
+      const Position noKing{"Kwe1 Bbb4"};
+      VERIFY(isCheck(Black, noKing, AttackInfo{noKing}), caseLabel);
+   }
+}
+
+} // namespace
+
+///////////////////
+
+void testAttackInfo()
+{
+   testPieceAttacks();
+   testAttackInfoSets();
+   testAttackInfoMatchesRules();
+}
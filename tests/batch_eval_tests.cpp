@@ -0,0 +1,222 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "batch_eval_tests.h"
+#include "batch_eval.h"
+#include "daily_chess_scoring.h"
+#include "daily_chess_weights.h"
+#include "fen.h"
+#include "game.h"
+#include "micro_benchmark.h"
+#include "nnue.h"
+#include "perft.h"
+#include "position.h"
+#include "test_util.h"
+#include "thread_pool.h"
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+// FEN records of the perft suite positions.
+std::vector<std::string> suiteFens()
+{
+   std::vector<std::string> fens;
+   for (const PerftCase& entry : perftSuite())
+      fens.push_back(toFen(entry.pos, FenState{entry.side}));
+   return fens;
+}
+
+
+void testEvaluate()
+{
+   ThreadPool pool{2};
+   const std::vector<std::string> fens = suiteFens();
+
+   {
+      const std::string caseLabel = "BatchEvaluator::evaluate static scores";
+
+      BatchEvaluator evaluator{pool};
+      std::vector<std::optional<Score>> scores;
+      evaluator.evaluate(fens, scores);
+
+      VERIFY(scores.size() == fens.size(), caseLabel);
+      for (std::size_t i = 0; i < fens.size(); ++i)
+         VERIFY(scores[i] == dcs::score(perftSuite()[i].pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "BatchEvaluator::evaluate for invalid lines";
+
+      BatchEvaluator evaluator{pool};
+      std::vector<std::optional<Score>> scores;
+      evaluator.evaluate({"", "not a record", "8/8/8/8/8/8/4P3/8 w - - 0 1",
+                          "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1 [1.0]\r"},
+                         scores);
+
+      VERIFY(scores.size() == 4, caseLabel);
+      VERIFY(!scores[0] && !scores[1] && !scores[2], caseLabel);
+      VERIFY(scores[3] == dcs::score(Position{"Kwe1 we2 Kbe8"}), caseLabel);
+   }
+   {
+      const std::string caseLabel = "BatchEvaluator::evaluate with weights";
+
+      auto weights = std::make_shared<dcs::Weights>(dcs::DefaultWeights);
+      weights->set(dcs::param::RookValue,
+                   dcs::DefaultWeights[dcs::param::RookValue] + ScorePair{10});
+
+      BatchOptions options;
+      options.weights = weights;
+      BatchEvaluator evaluator{pool, options};
+      std::vector<std::optional<Score>> scores;
+      evaluator.evaluate(fens, scores);
+
+      for (std::size_t i = 0; i < fens.size(); ++i)
+         VERIFY(scores[i] == dcs::score(perftSuite()[i].pos, *weights), caseLabel);
+   }
+   {
+      const std::string caseLabel = "BatchEvaluator::evaluate with network";
+
+      BatchOptions options;
+      options.network = nnue::Network::makePieceSquareNetwork();
+      BatchEvaluator evaluator{pool, options};
+      std::vector<std::optional<Score>> scores;
+      evaluator.evaluate(fens, scores);
+
+      for (std::size_t i = 0; i < fens.size(); ++i)
+         VERIFY(scores[i] == nnue::evaluate(*options.network, perftSuite()[i].pos),
+                caseLabel);
+   }
+   {
+      const std::string caseLabel = "BatchEvaluator::evaluate with search";
+
+      BatchOptions options;
+      options.depth = 2;
+      BatchEvaluator evaluator{pool, options};
+      std::vector<std::optional<Score>> scores;
+      evaluator.evaluate(fens, scores);
+
+      for (std::size_t i = 0; i < fens.size(); ++i)
+      {
+         Position pos = perftSuite()[i].pos;
+         VERIFY(scores[i] == calcSearchScore(pos, perftSuite()[i].side, 2), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "BatchEvaluator for weights with search";
+
+      BatchOptions options;
+      options.depth = 1;
+      options.weights = std::make_shared<dcs::Weights>(dcs::DefaultWeights);
+
+      bool hasThrown = false;
+      try
+      {
+         BatchEvaluator evaluator{pool, options};
+      }
+      catch (const std::runtime_error&)
+      {
+         hasThrown = true;
+      }
+      VERIFY(hasThrown, caseLabel);
+   }
+}
+
+
+void testRun()
+{
+   {
+      const std::string caseLabel = "BatchEvaluator::run keeps the order of the lines";
+
+      // Spans several chunks.
+      const std::vector<std::string> fens = suiteFens();
+      const std::size_t numLines = 2 * BatchEvaluator::RecordsPerTask * 2 + 5;
+
+      std::stringstream in;
+      std::vector<std::string> expected;
+      for (std::size_t i = 0; i < numLines; ++i)
+      {
+         if (i % 1000 == 999)
+         {
+            in << "invalid line\n";
+            expected.emplace_back(BatchEvaluator::InvalidMark);
+            continue;
+         }
+         const std::size_t idx = i % fens.size();
+         in << fens[idx] << "\n";
+         expected.push_back(std::to_string(dcs::score(perftSuite()[idx].pos)));
+      }
+
+      ThreadPool pool{2};
+      BatchEvaluator evaluator{pool};
+      std::stringstream out;
+      const BatchStats stats = evaluator.run(in, out);
+
+      VERIFY(stats.numRecords == numLines, caseLabel);
+      VERIFY(stats.numInvalid == numLines / 1000, caseLabel);
+
+      std::string line;
+      std::size_t numMatching = 0;
+      for (std::size_t i = 0; std::getline(out, line); ++i)
+         if (i < expected.size() && line == expected[i])
+            ++numMatching;
+      VERIFY(numMatching == numLines, caseLabel);
+   }
+   {
+      const std::string caseLabel = "BatchEvaluator::run for empty input";
+
+      ThreadPool pool{2};
+      BatchEvaluator evaluator{pool};
+      std::stringstream in;
+      std::stringstream out;
+      const BatchStats stats = evaluator.run(in, out);
+
+      VERIFY(stats.numRecords == 0, caseLabel);
+      VERIFY(out.str().empty(), caseLabel);
+   }
+}
+
+
+void testBatchEvalBenchmark()
+{
+   constexpr std::size_t NumRepetitions = 20000;
+
+   std::stringstream in;
+   const std::vector<std::string> fens = suiteFens();
+   for (std::size_t i = 0; i < NumRepetitions; ++i)
+      for (const std::string& fen : fens)
+         in << fen << "\n";
+
+   ThreadPool pool;
+   BatchEvaluator evaluator{pool};
+   std::stringstream out;
+   BatchStats stats;
+
+   int64_t elapsedNsec = 0;
+   {
+      MicroBenchmark benchmark{elapsedNsec};
+      stats = evaluator.run(in, out);
+   }
+
+   const double elapsedSec = double(elapsedNsec) / 1000000000.;
+   std::cout << "BatchEvaluator performance: " << double(stats.numRecords) / elapsedSec
+             << " positions/sec with " << pool.size() << " threads.\n";
+}
+
+} // namespace
+
+///////////////////
+
+void testBatchEval()
+{
+   testEvaluate();
+   testRun();
+   testBatchEvalBenchmark();
+}
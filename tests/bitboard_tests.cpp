@@ -0,0 +1,179 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "bitboard_tests.h"
+#include "bitboard.h"
+#include "test_util.h"
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+void testToBitboard()
+{
+   {
+      const std::string caseLabel = "toBitboard";
+
+      VERIFY(toBitboard(a1) == 1, caseLabel);
+      VERIFY(toBitboard(a2) == 2, caseLabel);
+      VERIFY(toBitboard(h8) == Bitboard{1} << 63, caseLabel);
+   }
+}
+
+
+void testContains()
+{
+   {
+      const std::string caseLabel = "contains";
+
+      const Bitboard bb = toBitboard(c3) | toBitboard(h8);
+      VERIFY(contains(bb, c3), caseLabel);
+      VERIFY(contains(bb, h8), caseLabel);
+      VERIFY(!contains(bb, c4), caseLabel);
+      VERIFY(!contains(EmptyBB, a1), caseLabel);
+   }
+}
+
+
+void testPopCount()
+{
+   {
+      const std::string caseLabel = "popCount";
+
+      VERIFY(popCount(EmptyBB) == 0, caseLabel);
+      VERIFY(popCount(toBitboard(e4)) == 1, caseLabel);
+      VERIFY(popCount(~EmptyBB) == 64, caseLabel);
+   }
+}
+
+
+void testLowestAndHighestSquare()
+{
+   {
+      const std::string caseLabel = "lowestSquare and highestSquare";
+
+      const Bitboard bb = toBitboard(b5) | toBitboard(d2) | toBitboard(g7);
+      VERIFY(lowestSquare(bb) == b5, caseLabel);
+      VERIFY(highestSquare(bb) == g7, caseLabel);
+      VERIFY(lowestSquare(toBitboard(a1)) == a1, caseLabel);
+      VERIFY(highestSquare(toBitboard(h8)) == h8, caseLabel);
+   }
+}
+
+
+void testPopLowestSquare()
+{
+   {
+      const std::string caseLabel = "popLowestSquare";
+
+      Bitboard bb = toBitboard(h8) | toBitboard(a1) | toBitboard(e4);
+      VERIFY(popLowestSquare(bb) == a1, caseLabel);
+      VERIFY(popLowestSquare(bb) == e4, caseLabel);
+      VERIFY(popLowestSquare(bb) == h8, caseLabel);
+      VERIFY(bb == EmptyBB, caseLabel);
+   }
+}
+
+
+void testSquaresAboveAndBelow()
+{
+   {
+      const std::string caseLabel = "squaresAbove and squaresBelow";
+
+      const Bitboard bb = toBitboard(a1) | toBitboard(e4) | toBitboard(h8);
+      VERIFY(squaresAbove(bb, e4) == toBitboard(h8), caseLabel);
+      VERIFY(squaresBelow(bb, e4) == toBitboard(a1), caseLabel);
+      VERIFY(squaresAbove(bb, h8) == EmptyBB, caseLabel);
+      VERIFY(squaresBelow(bb, a1) == EmptyBB, caseLabel);
+      VERIFY(squaresAbove(bb, a1) == (toBitboard(e4) | toBitboard(h8)), caseLabel);
+   }
+}
+
+
+
+void testFileMasks()
+{
+   {
+      const std::string caseLabel = "fileMask";
+
+      VERIFY(fileMask(fa) == (toBitboard(a1) | toBitboard(a2) | toBitboard(a3) |
+                              toBitboard(a4) | toBitboard(a5) | toBitboard(a6) |
+                              toBitboard(a7) | toBitboard(a8)),
+             caseLabel);
+      VERIFY(contains(fileMask(fe), e5) && !contains(fileMask(fe), d5), caseLabel);
+   }
+   {
+      const std::string caseLabel = "occupiedFiles and filesMask";
+
+      VERIFY(occupiedFiles(EmptyBB) == 0, caseLabel);
+      VERIFY(occupiedFiles(toBitboard(a8) | toBitboard(c1) | toBitboard(c5)) == 0b101,
+             caseLabel);
+      VERIFY(filesMask(0) == EmptyBB, caseLabel);
+      VERIFY(filesMask(0b10000010) == (fileMask(fb) | fileMask(fh)), caseLabel);
+
+      // All sets of files.
+      bool ok = true;
+      for (unsigned files = 0; files < 256; ++files)
+      {
+         Bitboard expected = EmptyBB;
+         for (unsigned f = 0; f < 8; ++f)
+            if (files & (1u << f))
+               expected |= fileMask(static_cast<File>(f));
+         ok = ok && filesMask(static_cast<uint8_t>(files)) == expected &&
+              occupiedFiles(expected) == files;
+      }
+      VERIFY(ok, caseLabel);
+   }
+   {
+      const std::string caseLabel = "adjacentFiles";
+
+      VERIFY(adjacentFiles(toBitboard(a4)) == toBitboard(b4), caseLabel);
+      VERIFY(adjacentFiles(toBitboard(h4)) == toBitboard(g4), caseLabel);
+      VERIFY(adjacentFiles(toBitboard(d2)) == (toBitboard(c2) | toBitboard(e2)),
+             caseLabel);
+   }
+}
+
+
+void testSpans()
+{
+   {
+      const std::string caseLabel = "spanUp";
+
+      VERIFY(spanUp(toBitboard(c6)) == (toBitboard(c7) | toBitboard(c8)), caseLabel);
+      VERIFY(spanUp(toBitboard(c8)) == EmptyBB, caseLabel);
+      VERIFY(spanUp(toBitboard(a1)) == (fileMask(fa) & ~toBitboard(a1)), caseLabel);
+      // Does not spill into the next file.
+      VERIFY(spanUp(toBitboard(a8) | toBitboard(b7)) == toBitboard(b8), caseLabel);
+   }
+   {
+      const std::string caseLabel = "spanDown";
+
+      VERIFY(spanDown(toBitboard(c3)) == (toBitboard(c2) | toBitboard(c1)), caseLabel);
+      VERIFY(spanDown(toBitboard(c1)) == EmptyBB, caseLabel);
+      VERIFY(spanDown(toBitboard(h8)) == (fileMask(fh) & ~toBitboard(h8)), caseLabel);
+      // Does not spill into the previous file.
+      VERIFY(spanDown(toBitboard(b1) | toBitboard(a2)) == toBitboard(a1), caseLabel);
+   }
+}
+
+} // namespace
+
+
+///////////////////
+
+void testBitboard()
+{
+   testToBitboard();
+   testContains();
+   testPopCount();
+   testLowestAndHighestSquare();
+   testPopLowestSquare();
+   testSquaresAboveAndBelow();
+   testFileMasks();
+   testSpans();
+}
@@ -4,9 +4,14 @@
 //
 #include "daily_chess_scoring_tests.h"
 #include "daily_chess_scoring.h"
+#include "micro_benchmark.h"
+#include "perft.h"
 #include "position.h"
+#include "rules.h"
 #include "scoring.h"
 #include "test_util.h"
+#include <cstdint>
+#include <iostream>
 #include <stdexcept>
 
 using namespace matt2;
@@ -100,11 +105,11 @@ void testPawnScoring()
       const Position neighborA("wd5 bc7");
       const Position neighborB("wd5 be7");
 
-      VERIFY(cmp(score(passed, rule), 0., White) == 1, caseLabel);
+      VERIFY(cmp(score(passed, rule), 0, White) == 1, caseLabel);
       // No bonus because pawn is not passed.
-      VERIFY(cmp(score(blocked, rule), 0., White) == 0, caseLabel);
-      VERIFY(cmp(score(neighborA, rule), 0., White) == 0, caseLabel);
-      VERIFY(cmp(score(neighborB, rule), 0., White) == 0, caseLabel);
+      VERIFY(cmp(score(blocked, rule), 0, White) == 0, caseLabel);
+      VERIFY(cmp(score(neighborA, rule), 0, White) == 0, caseLabel);
+      VERIFY(cmp(score(neighborB, rule), 0, White) == 0, caseLabel);
    }
    {
       const std::string caseLabel =
@@ -117,35 +122,35 @@ void testPawnScoring()
       const Position neighborA("bf3 we2");
       const Position neighborB("bf3 wg2");
 
-      VERIFY(cmp(score(passed, rule), 0., Black) == 1, caseLabel);
+      VERIFY(cmp(score(passed, rule), 0, Black) == 1, caseLabel);
       // No bonus because pawn is not passed.
-      VERIFY(cmp(score(blocked, rule), 0., Black) == 0, caseLabel);
-      VERIFY(cmp(score(neighborA, rule), 0., Black) == 0, caseLabel);
-      VERIFY(cmp(score(neighborB, rule), 0., Black) == 0, caseLabel);
+      VERIFY(cmp(score(blocked, rule), 0, Black) == 0, caseLabel);
+      VERIFY(cmp(score(neighborA, rule), 0, Black) == 0, caseLabel);
+      VERIFY(cmp(score(neighborB, rule), 0, Black) == 0, caseLabel);
    }
    {
       const std::string caseLabel = "Daily chess scoring - Double pawn penalty - White";
 
       constexpr Rules rule = Rules::DoublePawnPenalty;
-      VERIFY(cmp(score(Position("wg4 wg5"), rule), 0., White) == -1, caseLabel);
+      VERIFY(cmp(score(Position("wg4 wg5"), rule), 0, White) == -1, caseLabel);
    }
    {
       const std::string caseLabel = "Daily chess scoring - Double pawn penalty - Black";
 
       constexpr Rules rule = Rules::DoublePawnPenalty;
-      VERIFY(cmp(score(Position("be3 be5"), rule), 0., Black) == -1, caseLabel);
+      VERIFY(cmp(score(Position("be3 be5"), rule), 0, Black) == -1, caseLabel);
    }
    {
       const std::string caseLabel = "Daily chess scoring - Isolated pawn penalty - White";
 
       constexpr Rules rule = Rules::IsolatedPawnPenalty;
-      VERIFY(cmp(score(Position("wg4 wc5"), rule), 0., White) == -1, caseLabel);
+      VERIFY(cmp(score(Position("wg4 wc5"), rule), 0, White) == -1, caseLabel);
    }
    {
       const std::string caseLabel = "Daily chess scoring - Isolated pawn penalty - Black";
 
       constexpr Rules rule = Rules::IsolatedPawnPenalty;
-      VERIFY(cmp(score(Position("bc6 be7"), rule), 0., Black) == -1, caseLabel);
+      VERIFY(cmp(score(Position("bc6 be7"), rule), 0, Black) == -1, caseLabel);
    }
 }
 
@@ -167,21 +172,21 @@ void testBishopScoring()
          "Daily chess scoring - Multiple bishops receive a bonus";
 
       constexpr Rules rule = Rules::MultipleBishopBonus;
-      VERIFY(cmp(score(Position("Bwe5 Bwd5"), rule), 0., White) == 1, caseLabel);
+      VERIFY(cmp(score(Position("Bwe5 Bwd5"), rule), 0, White) == 1, caseLabel);
    }
    {
       const std::string caseLabel =
          "Daily chess scoring - Penality if own pawn is diagonal neighbor of bishop";
 
       constexpr Rules rule = Rules::BishopAdjacentPawnPenality;
-      VERIFY(cmp(score(Position("Bwe5 wd4"), rule), 0., White) == -1, caseLabel);
+      VERIFY(cmp(score(Position("Bwe5 wd4"), rule), 0, White) == -1, caseLabel);
    }
    {
       const std::string caseLabel =
          "Daily chess scoring - Penality if opposing pawn is diagonal neighbor of bishop";
 
       constexpr Rules rule = Rules::BishopAdjacentPawnPenality;
-      VERIFY(cmp(score(Position("Bbf3 wg4"), rule), 0., Black) == -1, caseLabel);
+      VERIFY(cmp(score(Position("Bbf3 wg4"), rule), 0, Black) == -1, caseLabel);
    }
 }
 
@@ -213,16 +218,16 @@ void testRookScoring()
       const std::string caseLabel = "Daily chess scoring - Bonus for rook on 7th rank";
 
       constexpr Rules rule = Rules::RookSeventhRankBonus;
-      VERIFY(cmp(score(Position("Rwd7"), rule), 0., White) == 1, caseLabel);
-      VERIFY(cmp(score(Position("Rbd2"), rule), 0., Black) == 1, caseLabel);
+      VERIFY(cmp(score(Position("Rwd7"), rule), 0, White) == 1, caseLabel);
+      VERIFY(cmp(score(Position("Rbd2"), rule), 0, Black) == 1, caseLabel);
    }
    {
       const std::string caseLabel =
          "Daily chess scoring - Bonus for rooks on shared file";
 
       constexpr Rules rule = Rules::RookSharedFileBonus;
-      VERIFY(cmp(score(Position("Rwd3 Rwd6"), rule), 0., White) == 1, caseLabel);
-      VERIFY(cmp(score(Position("Rbg5 Rbg1"), rule), 0., Black) == 1, caseLabel);
+      VERIFY(cmp(score(Position("Rwd3 Rwd6"), rule), 0, White) == 1, caseLabel);
+      VERIFY(cmp(score(Position("Rbg5 Rbg1"), rule), 0, Black) == 1, caseLabel);
    }
    {
       const std::string caseLabel =
@@ -369,17 +374,25 @@ void testKingScoring()
 
       constexpr Rules rule = Rules::KingQuadrantPenalty;
 
+      // King safety only counts while there is enough material on the board, so the
+      // positions have queens and rooks in the quadrant opposite of the king.
+
       // a1 quadrant with more pieces for black.
-      VERIFY(cmp(score(Position("Kwa2 wb2 Bbd4 Nba4"), rule), 0., White) == -1,
-             caseLabel);
+      VERIFY(
+         cmp(score(Position("Kwa2 wb2 Bbd4 Nba4 Qwh8 Qbg8 Rwh7 Rbg7"), rule), 0, White) ==
+            -1,
+         caseLabel);
       // h1 quadrant with more pieces for black.
-      VERIFY(cmp(score(Position("Kwg2 wh2 Rwh1 Bbe4 Rbh4 Nbg3"), rule), 0., White) == -1,
+      VERIFY(cmp(score(Position("Kwg2 wh2 Rwh1 Bbe4 Rbh4 Nbg3"), rule), 0, White) == -1,
              caseLabel);
       // a8 quadrant with more pieces for white.
-      VERIFY(cmp(score(Position("Kba8 Nba7 Bwc5 wd5"), rule), 0., Black) == -1,
-             caseLabel);
+      VERIFY(
+         cmp(score(Position("Kba8 Nba7 Bwc5 wd5 Qwh1 Qbg1 Rwh2 Rbg2"), rule), 0, Black) ==
+            -1,
+         caseLabel);
       // h8 quadrant with more pieces for white.
-      VERIFY(cmp(score(Position("Kbg8 Nbf6 be7 Bwf5 we5 Rwg6"), rule), 0., Black) == -1,
+      VERIFY(cmp(score(Position("Kbg8 Nbf6 be7 Bwf5 we5 Rwg6 Qwa1 Qbb1 Rwa2 Rbb2"), rule),
+                 0, Black) == -1,
              caseLabel);
    }
    {
@@ -390,9 +403,9 @@ void testKingScoring()
       constexpr Rules rule = Rules::KingQuadrantPenalty;
 
       // White king in a8 quadrant.
-      VERIFY(cmp(score(Position("Kwa5 Bbd7 Nbe5"), rule), 0., White) == 0, caseLabel);
+      VERIFY(cmp(score(Position("Kwa5 Bbd7 Nbe5"), rule), 0, White) == 0, caseLabel);
       // Black king in h1 quadrant.
-      VERIFY(cmp(score(Position("Kbg2 Nbf3 Bwf4 we4 Rwg4"), rule), 0., Black) == 0,
+      VERIFY(cmp(score(Position("Kbg2 Nbf3 Bwf4 we4 Rwg4"), rule), 0, Black) == 0,
              caseLabel);
    }
    {
@@ -436,7 +449,7 @@ void testKingScoring()
       // Set black to have castled to prevent it from also getting a penality.
       hasNotCastled.setHasCastled(Black);
 
-      VERIFY(cmp(score(hasNotCastled, rule), 0., White) == -1, caseLabel);
+      VERIFY(cmp(score(hasNotCastled, rule), 0, White) == -1, caseLabel);
    }
    {
       const std::string caseLabel =
@@ -454,8 +467,53 @@ void testKingScoring()
       // Set black to have castled to prevent it from also getting a penality.
       queensideRookMoved.setHasCastled(Black);
 
-      VERIFY(cmp(score(kingsideRookMoved, rule), 0., White) == -1, caseLabel);
-      VERIFY(cmp(score(queensideRookMoved, rule), 0., White) == -1, caseLabel);
+      VERIFY(cmp(score(kingsideRookMoved, rule), 0, White) == -1, caseLabel);
+      VERIFY(cmp(score(queensideRookMoved, rule), 0, White) == -1, caseLabel);
+   }
+}
+
+void testAttackScoring()
+{
+   {
+      const std::string caseLabel = "Daily chess scoring - Mobility bonus";
+
+      constexpr Rules rule = Rules::MobilityBonus;
+
+      // Centralized knight against knight in the corner.
+      VERIFY(bt(score(Position("Kwa1 Nwd4 Kbh8"), rule),
+                score(Position("Kwa1 Nwh1 Kbh8"), rule), White),
+             caseLabel);
+      // Rook on open file against rook blocked by own pawns.
+      VERIFY(bt(score(Position("Kbe8 Rbd8 Kwa1"), rule),
+                score(Position("Kbe8 Rbh8 bh7 bg7 Kwa1"), rule), Black),
+             caseLabel);
+      // Squares covered by enemy pawns don't count.
+      VERIFY(bt(score(Position("Kwa1 Nwd4 Kbh8"), rule),
+                score(Position("Kwa1 Nwd4 Kbh8 bc6 bf6"), rule), White),
+             caseLabel);
+      // Same mobility for both sides.
+      VERIFY(score(StartPos, rule) == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Daily chess scoring - King zone attack penalty";
+
+      constexpr Rules rule = Rules::KingZoneAttackPenalty;
+
+      // King safety only counts while there is enough material on the board, so the
+      // positions have rooks that don't take part in the attacks.
+
+      const Position twoAttackers{
+         "Kwg1 wf2 wg2 wh2 Kbg8 bf7 bg7 bh7 Qbg4 Nbe4 Rwa2 Rba7"};
+      const Position oneAttacker{"Kwg1 wf2 wg2 wh2 Kbg8 bf7 bg7 bh7 Qbg4 Rwa2 Rba7"};
+      // Bishop attacks the square that the knight attacks already.
+      const Position threeAttackers{
+         "Kwg1 wf2 wg2 wh2 Kbg8 bf7 bg7 bh7 Qbg4 Nbe4 Bbc5 Rwa2 Rba7"};
+
+      VERIFY(cmp(score(twoAttackers, rule), 0, White) == -1, caseLabel);
+      // Single attacker is not penalised.
+      VERIFY(score(oneAttacker, rule) == 0, caseLabel);
+      VERIFY(bt(score(twoAttackers, rule), score(threeAttackers, rule), White),
+             caseLabel);
    }
 }
 
@@ -465,8 +523,8 @@ void testMateScore()
       const std::string caseLabel = "dcs::scoreMate";
 
       const Position& _ = StartPos;
-      VERIFY(cmp(scoreMate(_, 0, White), 0., White) == -1, caseLabel);
-      VERIFY(cmp(scoreMate(_, 5, Black), 0., Black) == -1, caseLabel);
+      VERIFY(cmp(scoreMate(_, 0, White), 0, White) == -1, caseLabel);
+      VERIFY(cmp(scoreMate(_, 5, Black), 0, Black) == -1, caseLabel);
    }
    {
       const std::string caseLabel = "dcs::scoreMate is worse for quicker mates";
@@ -485,17 +543,303 @@ void testTieScore()
          "dcs::scoreTie with white in better position should be "
          "bad for white and good for black";
 
-      VERIFY(cmp(scoreTie(Position("Kwe3 wf7 Kba1"), White), 0., White) == -1, caseLabel);
-      VERIFY(cmp(scoreTie(Position("Kwe3 wf7 Kba1"), Black), 0., Black) == 1, caseLabel);
+      VERIFY(cmp(scoreTie(Position("Kwe3 wf7 Kba1"), White), 0, White) == -1, caseLabel);
+      VERIFY(cmp(scoreTie(Position("Kwe3 wf7 Kba1"), Black), 0, Black) == 1, caseLabel);
    }
    {
       const std::string caseLabel =
          "dcs::scoreTie with white in worse position should be "
          "good for white and bad for black";
 
-      VERIFY(cmp(scoreTie(Position("Kwe3 bf7 Kba1"), White), 0., White) == 1, caseLabel);
-      VERIFY(cmp(scoreTie(Position("Kwe3 bf7 Kba1"), Black), 0., Black) == -1, caseLabel);
+      VERIFY(cmp(scoreTie(Position("Kwe3 bf7 Kba1"), White), 0, White) == 1, caseLabel);
+      VERIFY(cmp(scoreTie(Position("Kwe3 bf7 Kba1"), Black), 0, Black) == -1, caseLabel);
+   }
+}
+
+void testPositionTables()
+{
+   {
+      const std::string caseLabel = "dcs position bonuses of black are mirrored";
+
+      for (int i = 0; i < 64; ++i)
+      {
+         const Square sq = static_cast<Square>(i);
+         VERIFY(positionValue(Pb, sq) == positionValue(Pw, flipRank(sq)), caseLabel);
+         VERIFY(positionValue(Nb, sq) == positionValue(Nw, flipRank(sq)), caseLabel);
+      }
+      static_assert(positionValue(Pb, c3) == 18);
+      static_assert(positionValue(Pw, e7) == 30);
+   }
+   {
+      const std::string caseLabel = "dcs pieces without position bonus";
+
+      for (Piece piece : {Kw, Qw, Rw, Bw, Kb, Qb, Rb, Bb})
+         VERIFY(positionValue(piece, d4) == 0 && positionValue(piece, a1) == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs piece-square values include piece values";
+
+      VERIFY(pieceSquareValue(Nb, a8) == ScorePair{KnightValue - 14}, caseLabel);
+      VERIFY(pieceSquareValue(Pw, d5) == ScorePair{PawnValue + 26}, caseLabel);
+      VERIFY(pieceSquareValue(Qb, d5) == ScorePair{QueenValue}, caseLabel);
+   }
+}
+
+void testTaperedScoring()
+{
+   {
+      const std::string caseLabel = "dcs::taper";
+
+      VERIFY(taper(ScorePair{10, 40}, MaxPhase) == 10, caseLabel);
+      VERIFY(taper(ScorePair{10, 40}, 0) == 40, caseLabel);
+      VERIFY(taper(ScorePair{10, 40}, MaxPhase / 2) == 25, caseLabel);
+      VERIFY(taper(ScorePair{-10, -40}, MaxPhase / 2) == -25, caseLabel);
+      // Extra material from promotions counts as middlegame.
+      VERIFY(taper(ScorePair{10, 40}, MaxPhase + 4) == 10, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs king safety fades out in endgames";
+
+      constexpr Rules rule = Rules::KingCastlingPenalty;
+
+      // Neither side can castle anymore.
+      Position middlegame{"Kwe2 Qwd1 Rwa1 Rwh1 Kbe7 Qbd8 Rba8 Rbh8 Bbc8"};
+      middlegame.setHasCastled(Black);
+      Position endgame{"Kwe2 wa2 Kbe7"};
+      endgame.setHasCastled(Black);
+
+      VERIFY(cmp(score(middlegame, rule), 0, White) == -1, caseLabel);
+      VERIFY(score(endgame, rule) == 0, caseLabel);
    }
+   {
+      const std::string caseLabel = "dcs passed pawns are worth more in endgames";
+
+      constexpr Rules rule = Rules::PassedPawnBonus;
+
+      const Position middlegame{"Kwe1 Qwd1 Rwa1 Rwh1 wc5 Kbe8 Qbd8 Rba8 Rbh8"};
+      const Position endgame{"Kwe1 wc5 Kbe8"};
+      VERIFY(score(endgame, rule) > score(middlegame, rule), caseLabel);
+   }
+}
+
+// Checks that the reduced compile-time rules match the summed score and the runtime
+// rules for a position.
+bool verifyReducedScores(const Position& pos)
+{
+   return score<SummedRules>(pos) == summedScore(pos) &&
+          score<SummedRules>(pos) == score(pos, SummedRules);
+}
+
+void testCompileTimeRules()
+{
+   {
+      const std::string caseLabel = "dcs::hasRules";
+
+      static_assert(hasRules(Rules::All, Rules::KingCastlingPenalty));
+      static_assert(hasRules(SummedRules, Rules::KnightCenterBonus));
+      static_assert(!hasRules(SummedRules, Rules::KnightKingClosenessBonus));
+      static_assert(!hasRules(Rules::PawnPieceValue, SummedRules));
+   }
+   {
+      const std::string caseLabel = "dcs scores for compile-time and runtime rules";
+
+      // A mask with extra bits uses all rules but is not Rules::All, so it is scored by
+      // checking the rules at runtime.
+      constexpr Rules AllAtRuntime = static_cast<Rules>(~uint64_t{0});
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         VERIFY(score<Rules::All>(entry.pos) == score(entry.pos), caseLabel);
+         VERIFY(score<Rules::All>(entry.pos) == score(entry.pos, AllAtRuntime),
+                caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs scores for reduced compile-time rules";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         Position pos = entry.pos;
+         VERIFY(forEachTreePosition<White>(pos, 2, verifyReducedScores), caseLabel);
+      }
+   }
+}
+
+// Checks that the full score of a position is within the lazy margin of its summed
+// score.
+bool verifyLazyMargin(const Position& pos)
+{
+   const Score full = score(pos);
+   const Score summed = summedScore(pos);
+   return full <= summed + LazyMargin && full >= summed - LazyMargin;
+}
+
+void testLazyScore()
+{
+   {
+      const std::string caseLabel = "dcs lazy margin covers full scores";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         Position pos = entry.pos;
+         VERIFY(forEachTreePosition<White>(pos, 2, verifyLazyMargin), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs lazy score inside of window";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         const Score summed = summedScore(entry.pos);
+         VERIFY(score(entry.pos, summed - 1, summed + 1) == score(entry.pos), caseLabel);
+         VERIFY(score(entry.pos, summed - LazyMargin + 1, summed + LazyMargin - 1) ==
+                   score(entry.pos),
+                caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs lazy score outside of window";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         const Score summed = summedScore(entry.pos);
+         const Score full = score(entry.pos);
+
+         // Returns bounds that are on the same side of the window as the full score.
+         const Score below = summed + LazyMargin;
+         VERIFY(score(entry.pos, below, below + 100) == summed, caseLabel);
+         VERIFY(full <= below, caseLabel);
+         const Score above = summed - LazyMargin;
+         VERIFY(score(entry.pos, above - 100, above) == summed, caseLabel);
+         VERIFY(full >= above, caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs summed score of position";
+
+      VERIFY(summedScore(StartPos) == 0, caseLabel);
+      VERIFY(summedScore(Position{"Kwe1 Qwd1 Kbe8"}) == QueenValue, caseLabel);
+   }
+}
+
+void testEvalTrace()
+{
+   {
+      const std::string caseLabel = "dcs trace has same score as scoring without trace";
+
+      for (const PerftCase& entry : perftSuite())
+         VERIFY(traceScore(entry.pos).score == score(entry.pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs trace terms sum up to score";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         const EvalTrace trace = traceScore(entry.pos);
+
+         ScorePair sum;
+         for (std::size_t idx = 0; idx < NumRules; ++idx)
+            sum += trace.term(White, ruleAt(idx)) - trace.term(Black, ruleAt(idx));
+         VERIFY(taper(sum, trace.phase) == trace.score, caseLabel);
+         VERIFY(trace.phase == entry.pos.phase(), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs trace coefficients weigh up to score";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         const EvalTrace trace = traceScore(entry.pos);
+
+         ScorePair sum;
+         for (std::size_t i = 0; i < param::NumParams; ++i)
+         {
+            const auto id = static_cast<param::Id>(i);
+            sum += DefaultWeights[id] * trace.coefficients[id];
+         }
+         VERIFY(taper(sum, trace.phase) == trace.score, caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs trace terms match scores of single rules";
+
+      const Position& pos = perftSuite()[1].pos;
+      const EvalTrace trace = traceScore(pos);
+      for (std::size_t idx = 0; idx < NumRules; ++idx)
+      {
+         const Rules rule = ruleAt(idx);
+         const ScorePair diff = trace.term(White, rule) - trace.term(Black, rule);
+         VERIFY(taper(diff, trace.phase) == score(pos, rule), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs trace scores of pieces";
+
+      const EvalTrace trace = traceScore(Position{"Kwe1 wa2 wa3 Kbe8"});
+      const ScorePair pawnScore = trace.term(White, Rules::PawnPieceValue) +
+                                  trace.term(White, Rules::PawnPositionBonus) +
+                                  trace.term(White, Rules::PassedPawnBonus) +
+                                  trace.term(White, Rules::DoublePawnPenalty) +
+                                  trace.term(White, Rules::IsolatedPawnPenalty);
+      VERIFY(trace.pieceScore(Pw) == pawnScore, caseLabel);
+      VERIFY(trace.term(White, Rules::DoublePawnPenalty) == ScorePair{-7}, caseLabel);
+      VERIFY(trace.pieceScore(Pb) == ScorePair{}, caseLabel);
+      VERIFY(trace.pieceScore(Kb) == trace.term(Black, Rules::KingPieceValue) +
+                                        trace.term(Black, Rules::KingQuadrantPenalty) +
+                                        trace.term(Black, Rules::KingCastlingPenalty),
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs rule names";
+
+      VERIFY(ruleName(Rules::PawnPieceValue) == "PawnPieceValue", caseLabel);
+      VERIFY(ruleName(Rules::KingZoneAttackPenalty) == "KingZoneAttackPenalty",
+             caseLabel);
+      constexpr Rules rule = Rules::RookSeventhRankBonus;
+      VERIFY(ruleAt(ruleIndex(rule)) == rule, caseLabel);
+   }
+}
+
+// Measures the number of positions scored per second for the suite positions.
+double measureScoring(Rules rules)
+{
+   constexpr std::size_t NumRepetitions = 20000;
+   const auto& suite = perftSuite();
+
+   Score checksum = 0;
+   int64_t elapsedNsec = 0;
+   {
+      MicroBenchmark benchmark{elapsedNsec};
+      for (std::size_t i = 0; i < NumRepetitions; ++i)
+         for (const PerftCase& entry : suite)
+            checksum += score(entry.pos, rules);
+   }
+
+   {
+      const std::string caseLabel = "dcs::score benchmark scores all positions";
+      VERIFY(checksum != 0, caseLabel);
+   }
+
+   const double numScored = double(NumRepetitions * suite.size());
+   const double elapsedSec = double(elapsedNsec) / 1000000000.;
+   return numScored / elapsedSec;
+}
+
+void testScoringBenchmark()
+{
+   // Scores with all rules and with the position bonuses only. Without all piece value
+   // and position bonus rules the terms are not taken from the running sums of the
+   // positions but looked up for each piece.
+   constexpr Rules PositionBonuses = static_cast<Rules>(
+      static_cast<uint64_t>(Rules::PawnPositionBonus) |
+      static_cast<uint64_t>(Rules::KnightCenterBonus));
+
+   // The summed rules are scored by their compile-time instance.
+   std::cout << "dcs::score performance: " << measureScoring(Rules::All)
+             << " positions/sec with all rules, " << measureScoring(PositionBonuses)
+             << " positions/sec with position bonuses only, "
+             << measureScoring(SummedRules)
+             << " positions/sec with piece values and position bonuses.\n";
 }
 
 } // namespace
@@ -510,6 +854,13 @@ void testDailyChessScoring()
    testKnightScoring();
    testQueenScoring();
    testKingScoring();
+   testAttackScoring();
    testMateScore();
    testTieScore();
+   testPositionTables();
+   testTaperedScoring();
+   testCompileTimeRules();
+   testLazyScore();
+   testEvalTrace();
+   testScoringBenchmark();
 }
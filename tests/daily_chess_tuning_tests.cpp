@@ -0,0 +1,264 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "daily_chess_tuning_tests.h"
+#include "daily_chess_tuning.h"
+#include "fen.h"
+#include "micro_benchmark.h"
+#include "perft.h"
+#include "position.h"
+#include "test_util.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace matt2;
+using namespace dcs;
+
+
+namespace
+{
+///////////////////
+
+// Set of positions whose results follow from a knight more for either side.
+TuningSet makeKnightSet()
+{
+   TuningSet set;
+   for (int f = 0; f < 8; ++f)
+   {
+      const Square whiteSq = makeSquare(static_cast<File>(f), r3);
+      const Square blackSq = makeSquare(static_cast<File>(f), r6);
+
+      Position even{"Kwg1 wf2 wg2 wh2 Kbg8 bf7 bg7 bh7"};
+      set.add(even, GameResult::Draw);
+
+      Position whiteAhead = even;
+      whiteAhead.add(Placement{Nw, whiteSq});
+      set.add(whiteAhead, GameResult::Win);
+
+      Position blackAhead = even;
+      blackAhead.add(Placement{Nb, blackSq});
+      set.add(blackAhead, GameResult::Loss);
+   }
+   return set;
+}
+
+
+void testPackedPosition()
+{
+   {
+      const std::string caseLabel = "dcs::PackedPosition size";
+
+      VERIFY(sizeof(PackedPosition) == 32, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::pack and unpack";
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         PackedPosition packed;
+         VERIFY(pack(entry.pos, GameResult::Win, packed), caseLabel);
+         VERIFY(packed.result == GameResult::Win, caseLabel);
+
+         Position unpacked{"Kwa1 Kbh8"};
+         unpack(packed, unpacked);
+         VERIFY(unpacked == entry.pos, caseLabel);
+         VERIFY(unpacked.phase() == entry.pos.phase(), caseLabel);
+         VERIFY(unpacked.psqScore(White) == entry.pos.psqScore(White), caseLabel);
+         for (Color side : {White, Black})
+            VERIFY(unpacked.castlingState(side) == entry.pos.castlingState(side),
+                   caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs::pack keeps castling state";
+
+      Position pos{"Kwe1 Rwa1 Rwh1 Kbg8 Rbf8"};
+      pos.setCastlingState(White, {false, true, false, false});
+      pos.setCastlingState(Black, {true, true, true, true});
+
+      PackedPosition packed;
+      pack(pos, GameResult::Draw, packed);
+      Position unpacked;
+      unpack(packed, unpacked);
+      VERIFY(unpacked.castlingState(White) == pos.castlingState(White), caseLabel);
+      VERIFY(unpacked.castlingState(Black) == pos.castlingState(Black), caseLabel);
+   }
+}
+
+
+void testTuningSet()
+{
+   const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "matt2_dcs_tuning_tests.epd";
+
+   {
+      const std::string caseLabel = "dcs::TuningSet::load";
+
+      {
+         std::ofstream out{path};
+         out << "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 [0.5]\n"
+             << "4k3/8/8/8/8/8/4P3/4K3 w - - 1-0\n"
+             << "4k3/8/8/8/8/8/4P3/4K3 b - - c9 \"0-1\";\n"
+             << "4k3/8/8/8/8/8/4P3/4K3 w - - 0 30; 1/2-1/2\n"
+             << "\n"
+             // Invalid result, invalid position and no kings.
+             << "4k3/8/8/8/8/8/4P3/4K3 w - - 0 30 2-0\n"
+             << "4k3/8/8/8/8/8/4P3/4K3 x - - 1.0\n"
+             << "8/8/8/8/8/8/4P3/8 w - - 1.0\n";
+      }
+
+      ThreadPool pool{2};
+      const TuningSet set = TuningSet::load(path.string(), pool);
+
+      VERIFY(set.size() == 4, caseLabel);
+      VERIFY(set.numSkipped() == 3, caseLabel);
+      if (set.size() == 4)
+      {
+         VERIFY(set[0].result == GameResult::Draw, caseLabel);
+         VERIFY(set[1].result == GameResult::Win, caseLabel);
+         VERIFY(set[2].result == GameResult::Loss, caseLabel);
+         VERIFY(set[3].result == GameResult::Draw, caseLabel);
+
+         Position pos;
+         unpack(set[0], pos);
+         VERIFY(pos == StartPos, caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "dcs::TuningSet::load for missing file";
+
+      std::filesystem::remove(path);
+      ThreadPool pool{1};
+      bool hasThrown = false;
+      try
+      {
+         TuningSet::load(path.string(), pool);
+      }
+      catch (const std::runtime_error&)
+      {
+         hasThrown = true;
+      }
+      VERIFY(hasThrown, caseLabel);
+   }
+}
+
+
+void testTexelTuner()
+{
+   const TuningSet set = makeKnightSet();
+   ThreadPool pool{2};
+
+   {
+      const std::string caseLabel = "dcs::TexelTuner keeps start weights";
+
+      TexelTuner tuner{set, pool};
+      VERIFY(tuner.weights() == DefaultWeights, caseLabel);
+      VERIFY(tuner.epoch() == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::TexelTuner::fitScale";
+
+      TexelTuner tuner{set, pool};
+      const double unfittedError = tuner.error();
+      const double scale = tuner.fitScale();
+      VERIFY(scale > 0. && scale != 1., caseLabel);
+      VERIFY(tuner.error() < unfittedError, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::TexelTuner reduces error";
+
+      // Start with a knight value that is too low for the results of the set.
+      Weights start = DefaultWeights;
+      start.set(param::KnightValue, ScorePair{100});
+
+      TexelTuner tuner{set, pool, start, 8, 2.};
+      const double startError = tuner.error();
+      for (int i = 0; i < 5; ++i)
+         tuner.runEpoch();
+      VERIFY(tuner.epoch() == 5, caseLabel);
+      VERIFY(tuner.error() < startError, caseLabel);
+      VERIFY(tuner.weights()[param::KnightValue].mg() > 100, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::TexelTuner checkpoints";
+
+      const std::filesystem::path path =
+         std::filesystem::temp_directory_path() / "matt2_dcs_tuning_tests.ckpt";
+
+      TexelTuner tuner{set, pool, DefaultWeights, 8, 2.};
+      tuner.fitScale();
+      tuner.runEpoch();
+      tuner.saveCheckpoint(path.string());
+
+      TexelTuner resumed{set, pool, DefaultWeights, 8, 2.};
+      resumed.loadCheckpoint(path.string());
+      VERIFY(resumed.epoch() == 1, caseLabel);
+      VERIFY(resumed.scale() == tuner.scale(), caseLabel);
+      VERIFY(resumed.weights() == tuner.weights(), caseLabel);
+
+      // Resumed tuning continues exactly like uninterrupted tuning.
+      tuner.runEpoch();
+      resumed.runEpoch();
+      VERIFY(resumed.weights() == tuner.weights(), caseLabel);
+      VERIFY(resumed.error() == tuner.error(), caseLabel);
+
+      {
+         std::ofstream out{path};
+         out << "texel-checkpoint 1\nepoch 2\n";
+      }
+      bool hasThrown = false;
+      try
+      {
+         resumed.loadCheckpoint(path.string());
+      }
+      catch (const std::runtime_error&)
+      {
+         hasThrown = true;
+      }
+      VERIFY(hasThrown, caseLabel);
+      VERIFY(resumed.epoch() == 2, caseLabel);
+
+      std::filesystem::remove(path);
+   }
+}
+
+
+void testTuningBenchmark()
+{
+   constexpr std::size_t NumRepetitions = 2000;
+
+   TuningSet set;
+   for (std::size_t i = 0; i < NumRepetitions; ++i)
+      for (const PerftCase& entry : perftSuite())
+         set.add(entry.pos, GameResult::Draw);
+
+   ThreadPool pool{1};
+   TexelTuner tuner{set, pool};
+
+   int64_t elapsedNsec = 0;
+   {
+      MicroBenchmark benchmark{elapsedNsec};
+      tuner.runEpoch();
+   }
+
+   const double elapsedSec = double(elapsedNsec) / 1000000000.;
+   std::cout << "dcs::TexelTuner performance: " << double(set.size()) / elapsedSec
+             << " positions/sec per thread.\n";
+}
+
+} // namespace
+
+///////////////////
+
+void testDailyChessTuning()
+{
+   testPackedPosition();
+   testTuningSet();
+   testTexelTuner();
+   testTuningBenchmark();
+}
@@ -0,0 +1,248 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "daily_chess_weights_tests.h"
+#include "daily_chess_scoring.h"
+#include "daily_chess_weights.h"
+#include "pawn_table.h"
+#include "perft.h"
+#include "position.h"
+#include "test_util.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+using namespace matt2;
+using namespace dcs;
+
+
+namespace
+{
+///////////////////
+
+// Tapered sum of the weights multiplied by their coefficients in the trace of a
+// position.
+Score weighCoefficients(const Position& pos, const Weights& weights)
+{
+   const EvalTrace trace = traceScore(pos, weights);
+
+   ScorePair sum;
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+   {
+      const auto id = static_cast<param::Id>(i);
+      sum += weights[id] * trace.coefficients[id];
+   }
+   return taper(sum, trace.phase);
+}
+
+Weights makeRandomWeights(unsigned seed)
+{
+   std::mt19937 gen{seed};
+   std::uniform_int_distribution<int> dist{-50, 50};
+
+   Weights weights = DefaultWeights;
+   for (std::size_t i = 0; i < param::NumParams; ++i)
+   {
+      const auto id = static_cast<param::Id>(i);
+      weights.set(id, weights[id] + ScorePair{dist(gen), dist(gen)});
+   }
+   return weights;
+}
+
+
+void testParamIds()
+{
+   {
+      const std::string caseLabel = "dcs::param::pieceValue";
+
+      VERIFY(param::pieceValue(Pw) == param::PawnValue, caseLabel);
+      VERIFY(param::pieceValue(Qb) == param::QueenValue, caseLabel);
+      VERIFY(param::pieceValue(Nb) == param::pieceValue(Nw), caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::param::positionBonus";
+
+      VERIFY(param::positionBonus(Pw, a1) == param::PawnPositionBonus, caseLabel);
+      VERIFY(param::positionBonus(Nw, h8) == param::NumParams - 1, caseLabel);
+      // Black pieces use the weights of the mirrored square.
+      VERIFY(param::positionBonus(Nb, e5) == param::positionBonus(Nw, e4), caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::param::name";
+
+      VERIFY(param::name(param::PawnValue) == "PawnValue", caseLabel);
+      VERIFY(param::name(param::KingZoneDoubleAttackPenalty) ==
+                "KingZoneDoubleAttackPenalty",
+             caseLabel);
+      VERIFY(param::name(param::positionBonus(Nw, e4)) == "KnightPositionBonus.e4",
+             caseLabel);
+      VERIFY(param::name(param::positionBonus(Pb, c7)) == "PawnPositionBonus.c2",
+             caseLabel);
+
+      std::set<std::string> names;
+      for (std::size_t i = 0; i < param::NumParams; ++i)
+         names.insert(param::name(static_cast<param::Id>(i)));
+      VERIFY(names.size() == param::NumParams, caseLabel);
+   }
+}
+
+
+void testWeights()
+{
+   {
+      const std::string caseLabel = "dcs default weights";
+
+      VERIFY(DefaultWeights[param::PawnValue] == ScorePair{materialValue(Pw)}, caseLabel);
+      VERIFY(DefaultWeights[param::PassedPawnRankFactor] == PassedPawnRankFactor,
+             caseLabel);
+      VERIFY(DefaultWeights[param::positionBonus(Nw, e4)] ==
+                ScorePair{positionValue(Nw, e4)},
+             caseLabel);
+      VERIFY(DefaultWeights.hasDefaultPieceSquares(), caseLabel);
+      VERIFY(!Weights{}.hasDefaultPieceSquares(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::Weights::set";
+
+      Weights weights = DefaultWeights;
+      weights.set(param::RookSeventhRankBonus, ScorePair{30, 10});
+      VERIFY(weights[param::RookSeventhRankBonus] == (ScorePair{30, 10}), caseLabel);
+      VERIFY(weights.hasDefaultPieceSquares(), caseLabel);
+
+      weights.set(param::positionBonus(Pw, d4), ScorePair{40});
+      VERIFY(!weights.hasDefaultPieceSquares(), caseLabel);
+      weights.set(param::KnightValue, ScorePair{300});
+      weights.set(param::positionBonus(Pw, d4), DefaultWeights[param::positionBonus(Pw, d4)]);
+      VERIFY(!weights.hasDefaultPieceSquares(), caseLabel);
+      weights.set(param::KnightValue, DefaultWeights[param::KnightValue]);
+      VERIFY(weights.hasDefaultPieceSquares(), caseLabel);
+   }
+}
+
+
+void testWeightedScoring()
+{
+   {
+      const std::string caseLabel = "dcs score with default weights";
+
+      for (const PerftCase& entry : perftSuite())
+         VERIFY(score(entry.pos, DefaultWeights) == score(entry.pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs score with weights and given pawn table";
+
+      PawnTable table{16};
+      for (const PerftCase& entry : perftSuite())
+         VERIFY(score(entry.pos, table, DefaultWeights) == score(entry.pos), caseLabel);
+      VERIFY(table.misses() > 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs score with changed weights";
+
+      const Position pos{"Kwg1 Rwd1 wf2 wg2 wh2 Kbe8 Nbc6 bb7 bd5"};
+      Weights weights = DefaultWeights;
+      weights.set(param::RookValue, DefaultWeights[param::RookValue] + ScorePair{10});
+      VERIFY(score(pos, weights) == score(pos) + 10, caseLabel);
+
+      // Position bonuses are not taken from the running sums of the position.
+      weights = DefaultWeights;
+      const param::Id bonus = param::positionBonus(Nb, c6);
+      weights.set(bonus, DefaultWeights[bonus] + ScorePair{20});
+      VERIFY(score(pos, weights) == score(pos) - 20, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs trace coefficients weigh up to score for any "
+                                    "weights";
+
+      for (unsigned seed = 1; seed <= 3; ++seed)
+      {
+         const Weights weights = makeRandomWeights(seed);
+         for (const PerftCase& entry : perftSuite())
+         {
+            const Score expected = score(entry.pos, weights);
+            VERIFY(traceScore(entry.pos, weights).score == expected, caseLabel);
+            VERIFY(weighCoefficients(entry.pos, weights) == expected, caseLabel);
+         }
+      }
+   }
+}
+
+
+void testWeightsFiles()
+{
+   const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "matt2_dcs_weights_tests.txt";
+
+   {
+      const std::string caseLabel = "dcs::Weights::save and load";
+
+      const Weights weights = makeRandomWeights(7);
+      weights.save(path.string());
+      VERIFY(Weights::load(path.string()) == weights, caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::Weights::load keeps defaults of missing weights";
+
+      {
+         std::ofstream out{path};
+         out << "# Comment\n\nQueenValue 950 1000\n  KnightPositionBonus.e4 -3 4\n";
+      }
+      const Weights weights = Weights::load(path.string());
+
+      VERIFY(weights[param::QueenValue] == (ScorePair{950, 1000}), caseLabel);
+      VERIFY(weights[param::positionBonus(Nw, e4)] == (ScorePair{-3, 4}), caseLabel);
+      VERIFY(weights[param::RookValue] == DefaultWeights[param::RookValue], caseLabel);
+      VERIFY(!weights.hasDefaultPieceSquares(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "dcs::Weights::load for invalid files";
+
+      for (const char* content :
+           {"QueenValue 950\n", "QueenValue 950 1000 3\n", "QueenValue one two\n",
+            "KingValue 1000 1000\n", "QueenValue 40000 1000\n"})
+      {
+         {
+            std::ofstream out{path};
+            out << content;
+         }
+
+         bool hasThrown = false;
+         try
+         {
+            Weights::load(path.string());
+         }
+         catch (const std::runtime_error&)
+         {
+            hasThrown = true;
+         }
+         VERIFY(hasThrown, caseLabel);
+      }
+
+      std::filesystem::remove(path);
+      bool hasThrown = false;
+      try
+      {
+         Weights::load(path.string());
+      }
+      catch (const std::runtime_error&)
+      {
+         hasThrown = true;
+      }
+      VERIFY(hasThrown, caseLabel);
+   }
+}
+
+} // namespace
+
+///////////////////
+
+void testDailyChessWeights()
+{
+   testParamIds();
+   testWeights();
+   testWeightedScoring();
+   testWeightsFiles();
+}
@@ -0,0 +1,152 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "eval_cache_tests.h"
+#include "eval_cache.h"
+#include "perft.h"
+#include "position.h"
+#include "rules.h"
+#include "scoring.h"
+#include "test_util.h"
+#include "thread_pool.h"
+#include "zobrist.h"
+#include <atomic>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+void testEvalCacheProbe()
+{
+   {
+      const std::string caseLabel = "EvalCache size";
+
+      EvalCache cache{1};
+      VERIFY(cache.size() == 1024 * 1024 / 8, caseLabel);
+   }
+   {
+      const std::string caseLabel = "EvalCache::probe for uncached key";
+
+      EvalCache cache{1};
+      VERIFY(!cache.probe(0x1234567890abcdefull).has_value(), caseLabel);
+      VERIFY(cache.hits() == 0 && cache.misses() == 1, caseLabel);
+   }
+   {
+      const std::string caseLabel = "EvalCache::probe for stored key";
+
+      EvalCache cache{1};
+      cache.store(0x1234567890abcdefull, 123);
+      const auto score = cache.probe(0x1234567890abcdefull);
+      VERIFY(score.has_value() && *score == 123, caseLabel);
+      VERIFY(cache.hits() == 1 && cache.misses() == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "EvalCache::probe for negative score";
+
+      EvalCache cache{1};
+      cache.store(0x1234567890abcdefull, -4567);
+      const auto score = cache.probe(0x1234567890abcdefull);
+      VERIFY(score.has_value() && *score == -4567, caseLabel);
+   }
+   {
+      const std::string caseLabel = "EvalCache::probe for key of same slot";
+
+      // Keys that only differ in their upper bits map to the same entry.
+      EvalCache cache{1};
+      cache.store(0x1234567890abcdefull, 123);
+      VERIFY(!cache.probe(0x2234567890abcdefull).has_value(), caseLabel);
+
+      // Storing replaces the previous entry.
+      cache.store(0x2234567890abcdefull, 45);
+      VERIFY(!cache.probe(0x1234567890abcdefull).has_value(), caseLabel);
+      VERIFY(cache.probe(0x2234567890abcdefull) == 45, caseLabel);
+   }
+   {
+      const std::string caseLabel = "EvalCache::store for score out of range";
+
+      EvalCache cache{1};
+      cache.store(0x1234567890abcdefull, 40000);
+      VERIFY(!cache.probe(0x1234567890abcdefull).has_value(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "EvalCache::clear";
+
+      EvalCache cache{1};
+      cache.store(0x1234567890abcdefull, 123);
+      cache.probe(0x1234567890abcdefull);
+      cache.clear();
+      VERIFY(cache.hits() == 0 && cache.misses() == 0, caseLabel);
+      VERIFY(!cache.probe(0x1234567890abcdefull).has_value(), caseLabel);
+   }
+}
+
+
+// Scores the positions of the move tree below a given position with a shared cache and
+// compares them to uncached scores.
+template <Color Us>
+bool verifyCachedScores(Position& pos, std::size_t depth, EvalCache& cache)
+{
+   return forEachTreePosition<Us>(pos, depth, [&](const Position& p)
+                                  { return calcScore(p, cache) == calcScore(p); });
+}
+
+void testCachedScores()
+{
+   {
+      const std::string caseLabel = "Cached scores are unchanged";
+
+      EvalCache cache{4};
+      for (const PerftCase& entry : perftSuite())
+      {
+         Position pos = entry.pos;
+         VERIFY(verifyCachedScores<White>(pos, 2, cache), caseLabel);
+         // Scoring the same tree again mostly hits the cache. Only entries that were
+         // replaced by other positions of the tree are missed.
+         const uint64_t hits = cache.hits();
+         const uint64_t misses = cache.misses();
+         VERIFY(verifyCachedScores<White>(pos, 2, cache), caseLabel);
+         VERIFY(cache.hits() - hits > 50 * (cache.misses() - misses), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "Shared cache never returns wrong scores";
+
+      // Threads store and probe scores derived from the keys into a tiny cache, so that
+      // entries are overwritten concurrently all the time.
+      EvalCache cache{0};
+      std::atomic<std::size_t> numWrong = 0;
+      ThreadPool pool{4};
+      pool.run(8,
+               [&cache, &numWrong](std::size_t taskIdx)
+               {
+                  uint64_t state = taskIdx;
+                  for (std::size_t i = 0; i < 20000; ++i)
+                  {
+                     const uint64_t key = zobrist::nextRandom(state);
+                     const Score expected = static_cast<Score>(key >> 52) - 2048;
+                     cache.store(key, expected);
+                     const auto score = cache.probe(key);
+                     if (score.has_value() && *score != expected)
+                        ++numWrong;
+                  }
+               });
+
+      VERIFY(numWrong == 0, caseLabel);
+      VERIFY(cache.hits() + cache.misses() == 8 * 20000, caseLabel);
+   }
+}
+
+} // namespace
+
+
+///////////////////
+
+void testEvalCache()
+{
+   testEvalCacheProbe();
+   testCachedScores();
+}
@@ -0,0 +1,7 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+
+void testEvalCache();
@@ -0,0 +1,330 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "fen_tests.h"
+#include "fen.h"
+#include "micro_benchmark.h"
+#include "perft.h"
+#include "position.h"
+#include "test_util.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+// FEN records of the perft suite positions.
+const std::vector<std::pair<std::string, std::string>> SuiteFens = {
+   {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+   {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+   {"pos3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+   {"pos4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"},
+   {"pos5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"},
+   {"pos6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"},
+};
+
+
+void verifyInvalidFen(std::string_view fen, const std::string& caseLabel)
+{
+   try
+   {
+      Position pos;
+      readFen(fen, pos);
+      FAIL("Exception expected.", caseLabel);
+   }
+   catch (std::runtime_error&)
+   {
+   }
+   catch (...)
+   {
+      FAIL("Other exception type expected.", caseLabel);
+   }
+}
+
+
+void testReadFen()
+{
+   {
+      const std::string caseLabel = "readFen for initial position";
+
+      Position pos;
+      const FenState state = readFen(StartFen, pos);
+
+      VERIFY(pos.isEqual(StartPos, true), caseLabel);
+      VERIFY((state == FenState{White, 0, 1}), caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen at compile time";
+
+      constexpr Position start = makeFenPosition(StartFen);
+      static_assert(start.isEqual(StartPos, true));
+
+      constexpr Position pos = makeFenPosition("4k3/8/8/3pP3/8/8/8/R3K3 w Q d6 0 3");
+      static_assert(pos.enPassantSquare() == d5);
+      static_assert(!pos.hasKingMoved(White) && !pos.hasRookMoved(White, false));
+      static_assert(pos.hasKingMoved(Black));
+
+      VERIFY(start == StartPos, caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen for perft suite positions";
+
+      for (const auto& [name, fen] : SuiteFens)
+      {
+         Position pos;
+         const FenState state = readFen(fen, pos);
+
+         const PerftCase* suiteCase = findPerftCase(name);
+         VERIFY(suiteCase != nullptr, caseLabel);
+         VERIFY(pos == suiteCase->pos, caseLabel);
+         VERIFY(state.sideToMove == suiteCase->side, caseLabel);
+         // Same move tree as the suite's position.
+         VERIFY(perft(pos, state.sideToMove, 2) == suiteCase->nodes[1], caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "readFen for side to move and counters";
+
+      Position pos;
+      const FenState state = readFen("4k3/8/8/8/8/8/8/4K3 b - - 17 42", pos);
+
+      VERIFY(pos == Position{"Kwe1 Kbe8"}, caseLabel);
+      VERIFY((state == FenState{Black, 17, 42}), caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen without counters";
+
+      Position pos;
+      const FenState state = readFen("4k3/8/8/8/8/8/8/4K3 w - -", pos);
+
+      VERIFY((state == FenState{White, 0, 1}), caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen for castling rights";
+
+      Position pos;
+      readFen("r3k2r/8/8/8/8/8/8/R3K2R w Kq - 0 1", pos);
+
+      VERIFY(!pos.hasKingMoved(White), caseLabel);
+      VERIFY(!pos.hasRookMoved(White, true), caseLabel);
+      VERIFY(pos.hasRookMoved(White, false), caseLabel);
+      VERIFY(!pos.hasKingMoved(Black), caseLabel);
+      VERIFY(pos.hasRookMoved(Black, true), caseLabel);
+      VERIFY(!pos.hasRookMoved(Black, false), caseLabel);
+
+      readFen("r3k2r/8/8/8/8/8/8/R3K2R w - - 0 1", pos);
+      VERIFY(pos.hasKingMoved(White), caseLabel);
+      VERIFY(pos.hasKingMoved(Black), caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen ignores castling rights of misplaced pieces";
+
+      Position pos;
+      readFen("4k3/8/8/8/8/8/8/R4K1R w KQ - 0 1", pos);
+
+      VERIFY(pos.hasKingMoved(White), caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen for en-passant square";
+
+      Position pos;
+      readFen("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 3", pos);
+      VERIFY(pos.enPassantSquare() == d5, caseLabel);
+
+      readFen("4k3/8/8/8/3Pp3/8/8/4K3 b - d3 0 3", pos);
+      VERIFY(pos.enPassantSquare() == d4, caseLabel);
+
+      readFen("4k3/8/8/8/8/8/8/4K3 w - - 0 1", pos);
+      VERIFY(!pos.enPassantSquare().has_value(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen replaces previous position";
+
+      Position pos{"Kwa1 Kbh8 Qwd4"};
+      pos.makeMove(PackedMove{d4, d5});
+      readFen("4k3/8/8/8/8/8/8/4K3 w - - 0 1", pos);
+
+      VERIFY(pos == Position{"Kwe1 Kbe8"}, caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFen for invalid records";
+
+      verifyInvalidFen("", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w -", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/4K3 w - - 0 1", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/8/4K3 w - - 0 1", caseLabel);
+      verifyInvalidFen("4k4/8/8/8/8/8/8/4K3 w - - 0 1", caseLabel);
+      verifyInvalidFen("4k2/8/8/8/8/8/8/4K3 w - - 0 1", caseLabel);
+      verifyInvalidFen("4x3/8/8/8/8/8/8/4K3 w - - 0 1", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 x - - 0 1", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w X - 0 1", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w - e4 0 1", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w - e6 0 1", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w - - x 1", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w - - 0 1x", caseLabel);
+      verifyInvalidFen("4k3/8/8/8/8/8/8/4K3 w - - 0 1 2", caseLabel);
+   }
+}
+
+
+void testReadFenPrefix()
+{
+   {
+      const std::string caseLabel = "readFenPrefix for complete records";
+
+      for (const auto& [name, fen] : SuiteFens)
+      {
+         Position expected;
+         const FenState expectedState = readFen(fen, expected);
+
+         Position pos;
+         VERIFY(readFenPrefix(fen, pos) == expectedState, caseLabel);
+         VERIFY(pos.isEqual(expected, true), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "readFenPrefix ignores what follows the record";
+
+      Position expected;
+      const FenState expectedState =
+         readFen("4k3/8/8/8/3Pp3/8/8/4K3 b - d3 5 30", expected);
+
+      for (const char* line :
+           {"4k3/8/8/8/3Pp3/8/8/4K3 b - d3 5 30 [0.5]",
+            "4k3/8/8/8/3Pp3/8/8/4K3 b - d3 5 30; 1-0",
+            "4k3/8/8/8/3Pp3/8/8/4K3 b - d3 5 30 bm Kf7; id \"x\";"})
+      {
+         Position pos;
+         VERIFY(readFenPrefix(line, pos) == expectedState, caseLabel);
+         VERIFY(pos.isEqual(expected, true), caseLabel);
+      }
+
+      Position pos;
+      VERIFY(readFenPrefix("4k3/8/8/8/3Pp3/8/8/4K3 b - d3; c9 \"0-1\";", pos) ==
+                FenState{Black},
+             caseLabel);
+      VERIFY(pos.isEqual(expected, true), caseLabel);
+      VERIFY(readFenPrefix("4k3/8/8/8/3Pp3/8/8/4K3 b - d3 12 1/2-1/2", pos) ==
+                (FenState{Black, 12, 1}),
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "readFenPrefix for invalid records";
+
+      for (const char* line :
+           {"", "4k3/8/8/8/8/8/8/4K3 w -", "4k3/8/8/8/8/8/8/4K3 x - - 0 1",
+            "4x3/8/8/8/8/8/8/4K3 w - - 1-0"})
+      {
+         bool hasThrown = false;
+         try
+         {
+            Position pos;
+            readFenPrefix(line, pos);
+         }
+         catch (const std::runtime_error&)
+         {
+            hasThrown = true;
+         }
+         VERIFY(hasThrown, caseLabel);
+      }
+   }
+}
+
+
+void testWriteFen()
+{
+   {
+      const std::string caseLabel = "toFen for initial position";
+
+      VERIFY(toFen(StartPos, FenState{}) == StartFen, caseLabel);
+   }
+   {
+      const std::string caseLabel = "toFen round trip for perft suite positions";
+
+      for (const auto& [name, fen] : SuiteFens)
+      {
+         Position pos;
+         const FenState state = readFen(fen, pos);
+         VERIFY(toFen(pos, state) == fen, caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "toFen for en-passant square";
+
+      Position pos;
+      const FenState state = readFen("4k3/8/8/8/3Pp3/8/8/4K3 b - d3 0 3", pos);
+      VERIFY(toFen(pos, state) == "4k3/8/8/8/3Pp3/8/8/4K3 b - d3 0 3", caseLabel);
+   }
+   {
+      const std::string caseLabel = "toFen for castling rights after moves";
+
+      Position pos{StartPos};
+      pos.remove("Nwg1");
+      pos.remove("Bwf1");
+      pos.makeMove(PackedMove{h1, g1});
+      VERIFY(toFen(pos, FenState{Black, 1, 1}) ==
+                "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQK1R1 b Qkq - 1 1",
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "writeFen replaces string content";
+
+      std::string fen = "previous content";
+      writeFen(fen, Position{"Kwe1 Kbe8"}, FenState{});
+      VERIFY(fen == "4k3/8/8/8/8/8/8/4K3 w - - 0 1", caseLabel);
+   }
+}
+
+
+void testFenBenchmark()
+{
+   constexpr std::size_t NumRepetitions = 20000;
+
+   Position pos;
+   std::string fen;
+   std::size_t numChars = 0;
+   int64_t elapsedNsec = 0;
+   {
+      MicroBenchmark benchmark{elapsedNsec};
+      for (std::size_t i = 0; i < NumRepetitions; ++i)
+      {
+         for (const auto& entry : SuiteFens)
+         {
+            const FenState state = readFen(entry.second, pos);
+            numChars += writeFen(fen, pos, state).size();
+         }
+      }
+   }
+
+   {
+      const std::string caseLabel = "FEN benchmark reads and writes all records";
+      VERIFY(numChars > 0, caseLabel);
+   }
+
+   const double numRecords = double(NumRepetitions * SuiteFens.size());
+   const double elapsedSec = double(elapsedNsec) / 1000000000.;
+   std::cout << "FEN performance: " << numRecords / elapsedSec
+             << " records/sec read and written.\n";
+}
+
+} // namespace
+
+
+///////////////////
+
+void testFen()
+{
+   testReadFen();
+   testReadFenPrefix();
+   testWriteFen();
+   testFenBenchmark();
+}
@@ -5,9 +5,11 @@
 #include "game_tests.h"
 #include "game.h"
 #include "micro_benchmark.h"
+#include "scoring.h"
 #include "test_util.h"
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 using namespace matt2;
 
@@ -40,6 +42,77 @@ void testPositionCtor()
    }
 }
 
+void testFenCtor()
+{
+   {
+      const std::string caseLabel = "Game::Game(fen)";
+
+      Game g{"4k3/8/8/8/8/8/8/K7 b - - 3 12"};
+      VERIFY(g.countMoves() == 0, caseLabel);
+      VERIFY(g.currentMoveIdx() == -1, caseLabel);
+      VERIFY(g.nextTurn() == Black, caseLabel);
+      VERIFY(g.current() == Position{"Kwa1 Kbe8"}, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Game::Game(fen) for invalid record";
+
+      try
+      {
+         Game g{"4k3/8/8/8/8/8/8/K7 x - - 3 12"};
+         FAIL("Exception expected.", caseLabel);
+      }
+      catch (std::runtime_error&)
+      {
+      }
+      catch (...)
+      {
+         FAIL("Other exception type expected.", caseLabel);
+      }
+   }
+}
+
+void testGameFen()
+{
+   {
+      const std::string caseLabel = "Game::fen for initial position";
+
+      VERIFY(Game().fen() == StartFen, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Game::fen after moves";
+
+      Game g;
+      g.enterNextMove("e2e4");
+      VERIFY(g.fen() == "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+             caseLabel);
+
+      g.enterNextMove("g8f6");
+      VERIFY(g.fen() == "rnbqkb1r/pppppppp/5n2/8/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 1 2",
+             caseLabel);
+
+      g.enterNextMove("e1e2");
+      VERIFY(g.fen() == "rnbqkb1r/pppppppp/5n2/8/4P3/8/PPPPKPPP/RNBQ1BNR b kq - 2 2",
+             caseLabel);
+
+      g.enterNextMove("f6e4");
+      VERIFY(g.fen() == "rnbqkb1r/pppppppp/8/8/4n3/8/PPPPKPPP/RNBQ1BNR w kq - 0 3",
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "Game::fen when navigating moves";
+
+      Game g{"4k3/8/8/8/8/8/8/K7 b - - 3 12"};
+      g.enterNextMove("e8d8");
+      g.enterNextMove("a1b1");
+      VERIFY(g.fen() == "3k4/8/8/8/8/8/8/1K6 b - - 5 13", caseLabel);
+
+      g.backward();
+      VERIFY(g.fen() == "3k4/8/8/8/8/8/8/K7 w - - 4 13", caseLabel);
+      g.backward();
+      VERIFY(g.fen() == "4k3/8/8/8/8/8/8/K7 b - - 3 12", caseLabel);
+   }
+}
+
 void testNextTurn()
 {
    {
@@ -147,6 +220,77 @@ void testCalcNextMove()
    std::cout << "Game performance: " << elapsedMsec << " ms.\n";
 }
 
+void testCalcSearchScore()
+{
+   {
+      const std::string caseLabel = "calcSearchScore without depth scores the position";
+
+      Position pos{"Kwg1 Rwd1 wf2 wg2 wh2 Kbe8 Nbc6 bb7 bd5"};
+      VERIFY(calcSearchScore(pos, White, 0) == calcScore(pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "calcSearchScore for winning capture";
+
+      Position pos{"Kwb1 Rwe4 Bwg4 Kbd8 Bbf5"};
+      const Position before = pos;
+      const Score score = calcSearchScore(pos, Black, 1);
+
+      VERIFY(score == calcScore(Position{"Kwb1 Bwg4 Kbd8 Bbe4"}), caseLabel);
+      VERIFY(pos == before, caseLabel);
+      for (SearchMode mode : {SearchMode::MakeUnmake, SearchMode::CopyMake})
+         VERIFY(calcSearchScore(pos, Black, 2, mode) == calcSearchScore(pos, Black, 2),
+                caseLabel);
+   }
+   {
+      const std::string caseLabel = "calcSearchScore for mate";
+
+      // Black is mated at the root.
+      Position mated{"Kwc1 Rwf7 Rwg8 Kbc8"};
+      VERIFY(calcSearchScore(mated, Black, 2) == matedScore(Black, 0), caseLabel);
+
+      // White mates with its first move.
+      Position mating{"Kwc1 Rwf7 Rwg1 Kbc8"};
+      const Score score = calcSearchScore(mating, White, 2);
+      VERIFY(isMateScore(score) && score > 0, caseLabel);
+   }
+}
+
+void testSearchModeBenchmark()
+{
+   // Positions of the Polgar chess book problems.
+   const std::vector<Position> positions = {
+      Position{"Kwg1 Qwf6 Bwc3 wh2 wg2 wf2 Kbg8 Qbd8 Rbf8 Bbg7 bh7 bg6 bf7"},
+      Position{"Kwc1 Qwh6 Rwd1 Nwg5 wb2 wc2 we5 Kbg8 Qbc7 Rbc8 Rbf8 bh7 bg6 bf7"}};
+
+   auto runSearches = [&positions](SearchMode mode, std::vector<Position>& results)
+   {
+      int64_t elapsedNsec = 0;
+      {
+         MicroBenchmark benchmark{elapsedNsec};
+         for (const auto& pos : positions)
+         {
+            Game g{pos, White};
+            g.calcNextMove(2, mode);
+            results.push_back(g.current());
+         }
+      }
+      return double(elapsedNsec) / 1000000.;
+   };
+
+   std::vector<Position> makeUnmakeResults;
+   const double makeUnmakeMsec = runSearches(SearchMode::MakeUnmake, makeUnmakeResults);
+   std::vector<Position> copyMakeResults;
+   const double copyMakeMsec = runSearches(SearchMode::CopyMake, copyMakeResults);
+
+   {
+      const std::string caseLabel = "Search modes find the same moves";
+      VERIFY(makeUnmakeResults == copyMakeResults, caseLabel);
+   }
+
+   std::cout << "Search performance: make/unmake " << makeUnmakeMsec << " ms, copy-make "
+             << copyMakeMsec << " ms.\n";
+}
+
 void testEnterNextMove()
 {
    {
@@ -513,8 +657,12 @@ void testGame()
 {
    testDefaultCtor();
    testPositionCtor();
+   testFenCtor();
+   testGameFen();
    testNextTurn();
    testCalcNextMove();
+   testCalcSearchScore();
+   testSearchModeBenchmark();
    testEnterNextMove();
    testCanMove();
    testIsMate();
@@ -2,10 +2,21 @@
 // Jun-2021, Michael Lindner
 // MIT license
 //
+#include "attack_info_tests.h"
+#include "batch_eval_tests.h"
+#include "bitboard_tests.h"
 #include "daily_chess_scoring_tests.h"
+#include "daily_chess_tuning_tests.h"
+#include "daily_chess_weights_tests.h"
+#include "eval_cache_tests.h"
+#include "fen_tests.h"
 #include "game_tests.h"
 #include "move_tests.h"
+#include "nnue_tests.h"
 #include "notation_tests.h"
+#include "packed_move_tests.h"
+#include "pawn_table_tests.h"
+#include "perft_tests.h"
 #include "piece_tests.h"
 #include "piece_value_scoring_tests.h"
 #include "placement_tests.h"
@@ -14,20 +25,33 @@
 #include "rules_tests.h"
 #include "scoring_tests.h"
 #include "square_tests.h"
+#include "thread_pool_tests.h"
+#include "zobrist_tests.h"
 #include <cstdlib>
 #include <iostream>
 
 
 int main()
 {
+   testAttackInfo();
+   testBatchEval();
+   testBitboard();
    testColor();
    testDailyChessScoring();
+   testDailyChessTuning();
+   testDailyChessWeights();
    testDiagonal();
+   testEvalCache();
+   testFen();
    testFile();
    testGame();
    testMoves();
+   testNnue();
    testNotations();
    testOffset();
+   testPackedMove();
+   testPawnTable();
+   testPerft();
    testPiece();
    testPieceIterator();
    testPieceValueScoring();
@@ -40,6 +64,8 @@ int main()
    testRules();
    testScoring();
    testSquare();
+   testThreadPool();
+   testZobrist();
 
    std::cout << "matt2 tests finished.\n";
    return EXIT_SUCCESS;
@@ -0,0 +1,373 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "nnue_tests.h"
+#include "daily_chess_scoring.h"
+#include "game.h"
+#include "micro_benchmark.h"
+#include "nnue.h"
+#include "perft.h"
+#include "position.h"
+#include "rules.h"
+#include "scoring.h"
+#include "test_util.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+using namespace matt2;
+using namespace nnue;
+
+
+namespace
+{
+///////////////////
+
+// Creates a network with random weights that are small enough for the neurons to not
+// overflow.
+NetworkWeights makeRandomWeights(unsigned seed)
+{
+   std::mt19937 gen{seed};
+   std::uniform_int_distribution<int> dist{-32, 32};
+   const auto rnd = [&]() { return static_cast<int16_t>(dist(gen)); };
+
+   NetworkWeights weights;
+   std::generate(weights.hiddenBiases.begin(), weights.hiddenBiases.end(), rnd);
+   std::generate(weights.featureWeights.begin(), weights.featureWeights.end(), rnd);
+   std::generate(weights.outputWeights.begin(), weights.outputWeights.end(), rnd);
+   weights.outputBias = 1000;
+   return weights;
+}
+
+
+// Scores a position by following the definition of the network without any of the
+// optimizations.
+Score calcReferenceScore(const NetworkWeights& weights, const Position& pos)
+{
+   int64_t sum = weights.outputBias;
+   for (Color perspective : {White, Black})
+   {
+      for (std::size_t n = 0; n < HiddenSize; ++n)
+      {
+         int32_t neuron = weights.hiddenBiases[n];
+         for (std::size_t sq = 0; sq < 64; ++sq)
+         {
+            const auto at = static_cast<Square>(sq);
+            const auto piece = pos[at];
+            if (piece)
+            {
+               const std::size_t feature = featureIndex(perspective, *piece, at);
+               neuron += weights.featureWeights[feature * HiddenSize + n];
+            }
+         }
+         const int32_t clipped = std::clamp<int32_t>(neuron, 0, ActivationMax);
+         const std::size_t outIdx = perspectiveIdx(perspective) * HiddenSize + n;
+         sum += clipped * weights.outputWeights[outIdx];
+      }
+   }
+   return static_cast<Score>(sum / OutputScale);
+}
+
+
+// Compares the incrementally updated accumulators of the positions of a move tree
+// against accumulators calculated from scratch.
+template <Color Us>
+bool verifyIncrementalUpdates(const Network& net, AccumulatorStack& stack, Position& pos,
+                              std::size_t depth)
+{
+   return forEachTreePosition<Us>(
+      pos, depth,
+      [&](const Position& p)
+      {
+         Accumulator expected;
+         refresh(expected, net, p);
+         return stack.top().values == expected.values;
+      },
+      [&](Position& p, PackedMove m) { return stack.makeMove(p, m); },
+      [&](Position& p, PackedMove m, const Position::UndoState& undo)
+      { stack.unmakeMove(p, m, undo); });
+}
+
+
+void testFeatures()
+{
+   {
+      const std::string caseLabel = "featureIndex for white perspective";
+
+      VERIFY(featureIndex(White, Kw, a1) == 0, caseLabel);
+      VERIFY(featureIndex(White, Pw, h8) == 5 * 64 + 63, caseLabel);
+      VERIFY(featureIndex(White, Kb, a1) == 6 * 64, caseLabel);
+      VERIFY(featureIndex(White, Pb, h8) == NumFeatures - 1, caseLabel);
+   }
+   {
+      const std::string caseLabel = "featureIndex for black perspective";
+
+      // Own pieces come first and the board is mirrored.
+      VERIFY(featureIndex(Black, Kb, a8) == 0, caseLabel);
+      VERIFY(featureIndex(Black, Pw, h1) == 11 * 64 + 63, caseLabel);
+      VERIFY(featureIndex(Black, Nb, e5) == featureIndex(White, Nw, e4), caseLabel);
+   }
+}
+
+
+void testNetworkFiles()
+{
+   const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "matt2_nnue_tests.nnue";
+
+   {
+      const std::string caseLabel = "Network::save and Network::load";
+
+      const NetworkWeights weights = makeRandomWeights(1);
+      const auto created = Network::create(weights);
+      created->save(path.string());
+      const auto loaded = Network::load(path.string());
+
+      VERIFY(std::equal(loaded->hiddenBiases(), loaded->hiddenBiases() + HiddenSize,
+                        weights.hiddenBiases.begin()),
+             caseLabel);
+      VERIFY(std::equal(loaded->featureWeights(0),
+                        loaded->featureWeights(0) + NumFeatures * HiddenSize,
+                        weights.featureWeights.begin()),
+             caseLabel);
+      VERIFY(std::equal(loaded->outputWeights(White),
+                        loaded->outputWeights(White) + 2 * HiddenSize,
+                        weights.outputWeights.begin()),
+             caseLabel);
+      VERIFY(loaded->outputBias() == weights.outputBias, caseLabel);
+      VERIFY(evaluate(*loaded, perftSuite()[1].pos) ==
+                evaluate(*created, perftSuite()[1].pos),
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "Network::load for invalid file";
+
+      std::filesystem::resize_file(path, 1000);
+      bool hasThrown = false;
+      try
+      {
+         Network::load(path.string());
+      }
+      catch (const std::runtime_error&)
+      {
+         hasThrown = true;
+      }
+      VERIFY(hasThrown, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Network::load for missing file";
+
+      std::filesystem::remove(path);
+      bool hasThrown = false;
+      try
+      {
+         Network::load(path.string());
+      }
+      catch (const std::runtime_error&)
+      {
+         hasThrown = true;
+      }
+      VERIFY(hasThrown, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Network::create for invalid weights";
+
+      NetworkWeights weights;
+      weights.hiddenBiases.pop_back();
+      bool hasThrown = false;
+      try
+      {
+         Network::create(weights);
+      }
+      catch (const std::runtime_error&)
+      {
+         hasThrown = true;
+      }
+      VERIFY(hasThrown, caseLabel);
+   }
+}
+
+
+void testEvaluation()
+{
+   {
+      const std::string caseLabel = "nnue::evaluate matches reference calculation";
+
+      const NetworkWeights weights = makeRandomWeights(2);
+      const auto net = Network::create(weights);
+      for (const PerftCase& entry : perftSuite())
+         VERIFY(evaluate(*net, entry.pos) == calcReferenceScore(weights, entry.pos),
+                caseLabel);
+   }
+   {
+      const std::string caseLabel = "Incremental updates match refreshed accumulators";
+
+      const auto net = Network::create(makeRandomWeights(3));
+      for (const PerftCase& entry : perftSuite())
+      {
+         Position pos = entry.pos;
+         AccumulatorStack stack{*net};
+         stack.reset(pos);
+         const bool isValid = entry.side == White
+                                 ? verifyIncrementalUpdates<White>(*net, stack, pos, 3)
+                                 : verifyIncrementalUpdates<Black>(*net, stack, pos, 3);
+         VERIFY(isValid, caseLabel);
+         VERIFY(stack.size() == 1, caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "Piece-square network";
+
+      const auto net = Network::makePieceSquareNetwork();
+      VERIFY(evaluate(*net, StartPos) == 0, caseLabel);
+
+      for (const PerftCase& entry : perftSuite())
+      {
+         // Middlegame values of all pieces but kings. The network rounds each value
+         // down to a multiple of four.
+         Score expected = 0;
+         std::size_t numPieces = 0;
+         for (std::size_t sq = 0; sq < 64; ++sq)
+         {
+            const auto at = static_cast<Square>(sq);
+            const auto piece = entry.pos[at];
+            if (!piece || isKing(*piece))
+               continue;
+            const Score value = dcs::pieceSquareValue(*piece, at).mg();
+            expected += color(*piece) == White ? value : -value;
+            ++numPieces;
+         }
+
+         const Score diff = std::abs(evaluate(*net, entry.pos) - expected);
+         VERIFY(diff <= static_cast<Score>(3 * numPieces), caseLabel);
+      }
+   }
+}
+
+
+void testSearchWithNetwork()
+{
+   {
+      const std::string caseLabel = "Game::calcNextMove with network";
+
+      // Taking the free queen is the best move by material alone.
+      Game g{Position{"Kwg1 Rwd1 wg2 wh2 Kbg8 Qbd5 bg7 bh7"}, White};
+      g.setNetwork(Network::makePieceSquareNetwork());
+      const auto [ok, descr] = g.calcNextMove(1);
+
+      VERIFY(ok, caseLabel);
+      VERIFY(g.current() == Position{"Kwg1 Rwd5 wg2 wh2 Kbg8 bg7 bh7"}, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Search modes find the same moves with network";
+
+      const Position pos{"Kwg1 Qwf6 Bwc3 wh2 wg2 wf2 Kbg8 Qbd8 Rbf8 Bbg7 bh7 bg6 bf7"};
+      std::shared_ptr<const Network> net = Network::makePieceSquareNetwork();
+
+      Game makeUnmake{pos, White};
+      makeUnmake.setNetwork(net);
+      makeUnmake.calcNextMove(2, SearchMode::MakeUnmake);
+      Game copyMake{pos, White};
+      copyMake.setNetwork(net);
+      copyMake.calcNextMove(2, SearchMode::CopyMake);
+
+      VERIFY(makeUnmake.current() == copyMake.current(), caseLabel);
+   }
+}
+
+///////////////////
+
+// Visits the positions of a move tree and scores each one either with the network, whose
+// accumulators are updated incrementally, or with the rules.
+template <Color Us>
+Score walkTree(Position& pos, std::size_t depth, AccumulatorStack* stack,
+               std::size_t& numNodes)
+{
+   ++numNodes;
+   Score sum = stack ? stack->evaluate() : calcScore(pos);
+   if (depth == 0)
+      return sum;
+
+   PackedMoveList moves;
+   collectSideMoves<Us>(pos, moves);
+   for (PackedMove m : moves)
+   {
+      if (stack)
+         stack->push(pos, m);
+      const auto undo = pos.makeMove(m);
+      sum += walkTree<!Us>(pos, depth - 1, stack, numNodes);
+      pos.unmakeMove(m, undo);
+      if (stack)
+         stack->pop();
+   }
+   return sum;
+}
+
+
+void testNnueBenchmark()
+{
+   const auto net = Network::makePieceSquareNetwork();
+   const auto& suite = perftSuite();
+
+   // Scoring single positions. The network calculates its accumulators from scratch.
+   constexpr std::size_t NumRepetitions = 10000;
+   const auto measureEvals = [&](bool withNetwork)
+   {
+      Score checksum = 0;
+      int64_t elapsedNsec = 0;
+      {
+         MicroBenchmark benchmark{elapsedNsec};
+         for (std::size_t i = 0; i < NumRepetitions; ++i)
+            for (const PerftCase& entry : suite)
+               checksum += withNetwork ? evaluate(*net, entry.pos) : calcScore(entry.pos);
+      }
+      {
+         const std::string caseLabel = "nnue benchmark scores all positions";
+         VERIFY(checksum != 0, caseLabel);
+      }
+      return double(NumRepetitions * suite.size()) / (double(elapsedNsec) / 1000000000.);
+   };
+
+   // Scoring all positions of move trees. The network updates its accumulators
+   // incrementally.
+   const auto measureNodes = [&](bool withNetwork)
+   {
+      std::size_t numNodes = 0;
+      int64_t elapsedNsec = 0;
+      {
+         MicroBenchmark benchmark{elapsedNsec};
+         for (const PerftCase& entry : suite)
+         {
+            Position pos = entry.pos;
+            AccumulatorStack stack{*net};
+            stack.reset(pos);
+            AccumulatorStack* stackPtr = withNetwork ? &stack : nullptr;
+            entry.side == White ? walkTree<White>(pos, 2, stackPtr, numNodes)
+                                : walkTree<Black>(pos, 2, stackPtr, numNodes);
+         }
+      }
+      return double(numNodes) / (double(elapsedNsec) / 1000000000.);
+   };
+
+   std::cout << "nnue performance (" << simdName() << "): " << measureEvals(true)
+             << " evals/sec vs " << measureEvals(false) << " evals/sec with rules, "
+             << measureNodes(true) << " nodes/sec vs " << measureNodes(false)
+             << " nodes/sec with rules.\n";
+}
+
+} // namespace
+
+///////////////////
+
+void testNnue()
+{
+   testFeatures();
+   testNetworkFiles();
+   testEvaluation();
+   testSearchWithNetwork();
+   testNnueBenchmark();
+}
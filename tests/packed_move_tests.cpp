@@ -0,0 +1,242 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "packed_move_tests.h"
+#include "move.h"
+#include "packed_move.h"
+#include "position.h"
+#include "test_util.h"
+#include <stdexcept>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+void testPackedMoveDefaultCtor()
+{
+   {
+      const std::string caseLabel = "PackedMove default ctor.";
+
+      PackedMove m;
+      VERIFY(m.isNull(), caseLabel);
+      VERIFY(m.value() == 0, caseLabel);
+   }
+}
+
+
+void testPackedMoveEncoding()
+{
+   {
+      const std::string caseLabel = "PackedMove encodes squares and flag.";
+
+      PackedMove m{e2, e4, PackedMove::Flag::DoublePawnPush};
+      VERIFY(m.from() == e2, caseLabel);
+      VERIFY(m.to() == e4, caseLabel);
+      VERIFY(m.flag() == PackedMove::Flag::DoublePawnPush, caseLabel);
+      VERIFY(!m.isNull(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "PackedMove encodes corner squares.";
+
+      PackedMove m{h8, a1, PackedMove::Flag::QueenPromotionCapture};
+      VERIFY(m.from() == h8, caseLabel);
+      VERIFY(m.to() == a1, caseLabel);
+      VERIFY(m.flag() == PackedMove::Flag::QueenPromotionCapture, caseLabel);
+   }
+}
+
+
+void testPackedMoveFlags()
+{
+   {
+      const std::string caseLabel = "PackedMove flags for quiet move.";
+
+      PackedMove m{b1, c3};
+      VERIFY(!m.isCapture(), caseLabel);
+      VERIFY(!m.isPromotion(), caseLabel);
+      VERIFY(!m.isCastling(), caseLabel);
+      VERIFY(!m.isEnPassant(), caseLabel);
+      VERIFY(!m.isDoublePawnPush(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "PackedMove flags for en-passant.";
+
+      PackedMove m{e5, d6, PackedMove::Flag::EnPassant};
+      VERIFY(m.isCapture(), caseLabel);
+      VERIFY(m.isEnPassant(), caseLabel);
+      VERIFY(!m.isPromotion(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "PackedMove flags for castling.";
+
+      PackedMove kingside{e1, g1, PackedMove::Flag::KingsideCastling};
+      VERIFY(kingside.isCastling(), caseLabel);
+      VERIFY(kingside.isKingsideCastling(), caseLabel);
+      VERIFY(!kingside.isCapture(), caseLabel);
+
+      PackedMove queenside{e8, c8, PackedMove::Flag::QueensideCastling};
+      VERIFY(queenside.isCastling(), caseLabel);
+      VERIFY(!queenside.isKingsideCastling(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "PackedMove flags for promotions.";
+
+      PackedMove m{b7, b8, PackedMove::Flag::RookPromotion};
+      VERIFY(m.isPromotion(), caseLabel);
+      VERIFY(!m.isCapture(), caseLabel);
+
+      PackedMove mc{b7, a8, PackedMove::Flag::KnightPromotionCapture};
+      VERIFY(mc.isPromotion(), caseLabel);
+      VERIFY(mc.isCapture(), caseLabel);
+   }
+}
+
+
+void testPackedMovePromotedTo()
+{
+   {
+      const std::string caseLabel = "PackedMove::promotedTo.";
+
+      VERIFY(PackedMove(b7, b8, PackedMove::Flag::KnightPromotion).promotedTo(White) == Nw,
+             caseLabel);
+      VERIFY(PackedMove(b7, b8, PackedMove::Flag::BishopPromotion).promotedTo(White) == Bw,
+             caseLabel);
+      VERIFY(PackedMove(b2, b1, PackedMove::Flag::RookPromotionCapture).promotedTo(Black) ==
+                Rb,
+             caseLabel);
+      VERIFY(PackedMove(b2, b1, PackedMove::Flag::QueenPromotion).promotedTo(Black) == Qb,
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "PackedMove::promotionFlag.";
+
+      VERIFY(PackedMove::promotionFlag(Qw, false) == PackedMove::Flag::QueenPromotion,
+             caseLabel);
+      VERIFY(PackedMove::promotionFlag(Nb, true) == PackedMove::Flag::KnightPromotionCapture,
+             caseLabel);
+      VERIFY(PackedMove::promotionFlag(Bw, true) == PackedMove::Flag::BishopPromotionCapture,
+             caseLabel);
+      VERIFY(PackedMove::promotionFlag(Rb, false) == PackedMove::Flag::RookPromotion,
+             caseLabel);
+   }
+}
+
+
+void testPackedMoveToString()
+{
+   {
+      const std::string caseLabel = "toString for PackedMove.";
+
+      VERIFY(toString(PackedMove(e2, e4, PackedMove::Flag::DoublePawnPush)) == "e2e4",
+             caseLabel);
+      VERIFY(toString(PackedMove(e1, g1, PackedMove::Flag::KingsideCastling)) == "e1g1",
+             caseLabel);
+      VERIFY(toString(PackedMove(b7, b8, PackedMove::Flag::QueenPromotion)) == "b7b8q",
+             caseLabel);
+      VERIFY(toString(PackedMove(g2, h1, PackedMove::Flag::KnightPromotionCapture)) ==
+                "g2h1n",
+             caseLabel);
+   }
+}
+
+
+void testPackAndUnpack()
+{
+   {
+      const std::string caseLabel = "pack and unpack basic move.";
+
+      Position pos{"Kwe1 Kbe8 Nwb1"};
+      const Move m = BasicMove(Relocation("Nwb1c3"));
+      const PackedMove packed = pack(m);
+      VERIFY(packed == PackedMove(b1, c3), caseLabel);
+      VERIFY(unpack(packed, pos) == m, caseLabel);
+   }
+   {
+      const std::string caseLabel = "pack and unpack capture.";
+
+      Position pos{"Kwe1 Kbe8 Nwb1 bc3"};
+      const Move m = BasicMove(Relocation("Nwb1c3"), Pb);
+      const PackedMove packed = pack(m);
+      VERIFY(packed == PackedMove(b1, c3, PackedMove::Flag::Capture), caseLabel);
+      VERIFY(unpack(packed, pos) == m, caseLabel);
+   }
+   {
+      const std::string caseLabel = "pack and unpack double pawn push.";
+
+      Position pos{"Kwe1 Kbe8 wd2"};
+      const Move m = BasicMove(Relocation("wd2d4"), EnablesEnPassant);
+      const PackedMove packed = pack(m);
+      VERIFY(packed.isDoublePawnPush(), caseLabel);
+      VERIFY(unpack(packed, pos) == m, caseLabel);
+   }
+   {
+      const std::string caseLabel = "pack and unpack castling.";
+
+      Position pos{"Kwe1 Kbe8 Rwa1 Rbh8"};
+      const Move wm = Castling(Queenside, White);
+      const PackedMove wpacked = pack(wm);
+      VERIFY(wpacked == PackedMove(e1, c1, PackedMove::Flag::QueensideCastling), caseLabel);
+      VERIFY(unpack(wpacked, pos) == wm, caseLabel);
+
+      const Move bm = Castling(Kingside, Black);
+      const PackedMove bpacked = pack(bm);
+      VERIFY(bpacked == PackedMove(e8, g8, PackedMove::Flag::KingsideCastling), caseLabel);
+      VERIFY(unpack(bpacked, pos) == bm, caseLabel);
+   }
+   {
+      const std::string caseLabel = "pack and unpack en-passant.";
+
+      Position pos{"Kwe1 Kbe8 we5 bd5"};
+      const Move m = EnPassant(Relocation("we5d6"));
+      const PackedMove packed = pack(m);
+      VERIFY(packed == PackedMove(e5, d6, PackedMove::Flag::EnPassant), caseLabel);
+      VERIFY(unpack(packed, pos) == m, caseLabel);
+   }
+   {
+      const std::string caseLabel = "pack and unpack promotion.";
+
+      Position pos{"Kwe1 Kbe8 wb7 Nba8"};
+      const Move m = Promotion(Relocation("wb7a8"), Qw, Nb);
+      const PackedMove packed = pack(m);
+      VERIFY(packed == PackedMove(b7, a8, PackedMove::Flag::QueenPromotionCapture),
+             caseLabel);
+      VERIFY(unpack(packed, pos) == m, caseLabel);
+   }
+   {
+      const std::string caseLabel = "unpack move from empty square.";
+
+      Position pos{"Kwe1 Kbe8"};
+      try
+      {
+         unpack(PackedMove(b1, c3), pos);
+         FAIL("Exception expected.", caseLabel);
+      }
+      catch (std::runtime_error&)
+      {
+         // Expected
+      }
+      catch (...)
+      {
+         FAIL("Other exception type expected.", caseLabel);
+      }
+   }
+}
+
+} // namespace
+
+
+///////////////////
+
+void testPackedMove()
+{
+   testPackedMoveDefaultCtor();
+   testPackedMoveEncoding();
+   testPackedMoveFlags();
+   testPackedMovePromotedTo();
+   testPackedMoveToString();
+   testPackAndUnpack();
+}
@@ -0,0 +1,153 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "pawn_table_tests.h"
+#include "daily_chess_scoring.h"
+#include "pawn_table.h"
+#include "perft.h"
+#include "position.h"
+#include "rules.h"
+#include "test_util.h"
+
+using namespace matt2;
+using namespace dcs;
+
+
+namespace
+{
+///////////////////
+
+void testPawnTableProbe()
+{
+   {
+      const std::string caseLabel = "PawnTable::probe for uncached structure";
+
+      PawnTable table{16};
+      VERIFY(table.probe(Position{"Kwe1 wa2 Kbe8"}) == nullptr, caseLabel);
+      VERIFY(table.hits() == 0 && table.misses() == 1, caseLabel);
+   }
+   {
+      const std::string caseLabel = "PawnTable::probe for stored structure";
+
+      PawnTable table{16};
+      PawnEntry& stored = table.store(Position{"Kwe1 wa2 Kbe8"});
+      stored.numDoubledFiles = {3, 4};
+
+      // Only the pawns matter.
+      const PawnEntry* entry = table.probe(Position{"Kwg1 Qwd1 wa2 Kbe8"});
+      VERIFY(entry != nullptr, caseLabel);
+      VERIFY(entry->numDoubledFiles[0] == 3, caseLabel);
+      VERIFY(table.hits() == 1 && table.misses() == 0, caseLabel);
+
+      VERIFY(table.probe(Position{"Kwe1 wa3 Kbe8"}) == nullptr, caseLabel);
+      VERIFY(table.probe(Position{"Kwe1 ba2 Kbe8"}) == nullptr, caseLabel);
+   }
+   {
+      const std::string caseLabel = "PawnTable::probe for positions without pawns";
+
+      // Empty entries are valid for positions without pawns.
+      PawnTable table{16};
+      const PawnEntry* entry = table.probe(Position{"Kwe1 Kbe8"});
+      VERIFY(entry != nullptr && entry->pawnFiles[0] == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "PawnTable::clear";
+
+      PawnTable table{16};
+      table.store(Position{"Kwe1 wa2 Kbe8"});
+      table.probe(Position{"Kwe1 wa2 Kbe8"});
+      table.clear();
+      VERIFY(table.hits() == 0 && table.misses() == 0, caseLabel);
+      VERIFY(table.probe(Position{"Kwe1 wa2 Kbe8"}) == nullptr, caseLabel);
+   }
+}
+
+
+void testPawnEntry()
+{
+   {
+      const std::string caseLabel = "PawnEntry calculated for pawn structure";
+
+      const Position pos{"Kwe1 wa2 wh5 wc3 wc4 bg7 Kbe8"};
+      PawnTable table{16};
+      score(pos, table);
+      const PawnEntry* entry = table.probe(pos);
+      VERIFY(entry != nullptr, caseLabel);
+
+      const std::size_t w = PawnEntry::colorIdx(White);
+      const std::size_t b = PawnEntry::colorIdx(Black);
+      VERIFY(entry->passedPawns[w] == (toBitboard(a2) | toBitboard(c3) | toBitboard(c4)),
+             caseLabel);
+      VERIFY(entry->passedPawns[b] == EmptyBB, caseLabel);
+      // Sum of the ranks of the passed pawns.
+      VERIFY(entry->passedPawnRanks[w] == 6 && entry->passedPawnRanks[b] == 0, caseLabel);
+      VERIFY(entry->numDoubledFiles[w] == 1 && entry->numDoubledFiles[b] == 0, caseLabel);
+      // The pawns on all files are isolated.
+      VERIFY(entry->numIsolatedFiles[w] == 3 && entry->numIsolatedFiles[b] == 1, caseLabel);
+      VERIFY(entry->pawnFiles[w] == 0b10000101, caseLabel);
+      VERIFY(entry->pawnFiles[b] == 0b01000000, caseLabel);
+      VERIFY(entry->openFiles() == 0b00111010, caseLabel);
+      VERIFY(entry->halfOpenFiles(White) == 0b01000000, caseLabel);
+      VERIFY(entry->halfOpenFiles(Black) == 0b10000101, caseLabel);
+   }
+   {
+      const std::string caseLabel = "PawnEntry passed pawns with opponent pawns in front";
+
+      // White d4 is stopped by black e5 on the adjacent file and black a3 by white b2.
+      // White g5 and black f4 have passed each other.
+      const Position pos{"Kwe1 wd4 wg5 wb2 Kbe8 be5 bf4 ba3"};
+      PawnTable table{16};
+      score(pos, table);
+      const PawnEntry* entry = table.probe(pos);
+      VERIFY(entry != nullptr, caseLabel);
+
+      const std::size_t w = PawnEntry::colorIdx(White);
+      const std::size_t b = PawnEntry::colorIdx(Black);
+      VERIFY(entry->passedPawns[w] == toBitboard(g5), caseLabel);
+      VERIFY(entry->passedPawns[b] == toBitboard(f4), caseLabel);
+   }
+}
+
+
+// Scores the positions of the move tree below a given position with a shared table and
+// compares them to scores without cached pawn structures.
+template <Color Us>
+bool verifyCachedScores(Position& pos, std::size_t depth, PawnTable& table)
+{
+   return forEachTreePosition<Us>(pos, depth,
+                                  [&](const Position& p)
+                                  {
+                                     PawnTable fresh{1};
+                                     return score(p, table) == score(p, fresh);
+                                  });
+}
+
+void testCachedScores()
+{
+   {
+      const std::string caseLabel = "Scores with cached pawn structures are unchanged";
+
+      PawnTable table;
+      for (const PerftCase& entry : perftSuite())
+      {
+         Position pos = entry.pos;
+         VERIFY(verifyCachedScores<White>(pos, 2, table), caseLabel);
+      }
+
+      // Most positions in a move tree share their pawn structure with other positions.
+      VERIFY(table.hits() > 4 * table.misses(), caseLabel);
+   }
+}
+
+} // namespace
+
+
+///////////////////
+
+void testPawnTable()
+{
+   testPawnTableProbe();
+   testPawnEntry();
+   testCachedScores();
+}
@@ -0,0 +1,221 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "perft_tests.h"
+#include "perft.h"
+#include "test_util.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+void testPerftNodes()
+{
+   {
+      const std::string caseLabel = "perft for depth zero";
+
+      Position pos = StartPos;
+      VERIFY(perft(pos, White, 0) == 1, caseLabel);
+   }
+   {
+      const std::string caseLabel = "perft for suite positions";
+
+      // Limit the node counts to keep the test fast.
+      constexpr uint64_t MaxNodes = 100000;
+
+      for (const auto& perftCase : perftSuite())
+      {
+         Position pos = perftCase.pos;
+         for (std::size_t i = 0; i < perftCase.nodes.size(); ++i)
+         {
+            if (perftCase.nodes[i] > MaxNodes)
+               break;
+            VERIFY(perft(pos, perftCase.side, i + 1) == perftCase.nodes[i],
+                   caseLabel + " " + perftCase.name);
+         }
+      }
+   }
+   {
+      const std::string caseLabel = "perft restores position";
+
+      Position pos = findPerftCase("kiwipete")->pos;
+      perft(pos, White, 3);
+      VERIFY(pos.isEqual(findPerftCase("kiwipete")->pos, true), caseLabel);
+   }
+}
+
+
+void testPerftStats()
+{
+   {
+      const std::string caseLabel = "perftStats for start position";
+
+      Position pos = StartPos;
+      const PerftStats stats = perftStats(pos, White, 3);
+
+      VERIFY(stats.nodes == 8902, caseLabel);
+      VERIFY(stats.captures == 34, caseLabel);
+      VERIFY(stats.enPassants == 0, caseLabel);
+      VERIFY(stats.castles == 0, caseLabel);
+      VERIFY(stats.promotions == 0, caseLabel);
+      VERIFY(stats.checks == 12, caseLabel);
+      VERIFY(stats.mates == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "perftStats for kiwipete position";
+
+      Position pos = findPerftCase("kiwipete")->pos;
+      const PerftStats stats = perftStats(pos, White, 2);
+
+      VERIFY(stats.nodes == 2039, caseLabel);
+      VERIFY(stats.captures == 351, caseLabel);
+      VERIFY(stats.enPassants == 1, caseLabel);
+      VERIFY(stats.castles == 91, caseLabel);
+      VERIFY(stats.promotions == 0, caseLabel);
+      VERIFY(stats.checks == 3, caseLabel);
+      VERIFY(stats.mates == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "perftStats for position 3";
+
+      Position pos = findPerftCase("pos3")->pos;
+      const PerftStats stats = perftStats(pos, White, 3);
+
+      VERIFY(stats.nodes == 2812, caseLabel);
+      VERIFY(stats.captures == 209, caseLabel);
+      VERIFY(stats.enPassants == 2, caseLabel);
+      VERIFY(stats.castles == 0, caseLabel);
+      VERIFY(stats.promotions == 0, caseLabel);
+      VERIFY(stats.checks == 267, caseLabel);
+      VERIFY(stats.mates == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "perftStats for position 4";
+
+      Position pos = findPerftCase("pos4")->pos;
+      const PerftStats stats = perftStats(pos, White, 3);
+
+      VERIFY(stats.nodes == 9467, caseLabel);
+      VERIFY(stats.captures == 1021, caseLabel);
+      VERIFY(stats.enPassants == 4, caseLabel);
+      VERIFY(stats.castles == 0, caseLabel);
+      VERIFY(stats.promotions == 120, caseLabel);
+      VERIFY(stats.checks == 38, caseLabel);
+      VERIFY(stats.mates == 22, caseLabel);
+   }
+   {
+      const std::string caseLabel = "perftStats node count matches perft";
+
+      Position pos = findPerftCase("pos5")->pos;
+      VERIFY(perftStats(pos, White, 2).nodes == perft(pos, White, 2), caseLabel);
+   }
+}
+
+
+void testParallelPerft()
+{
+   {
+      const std::string caseLabel = "parallel perft for suite positions";
+
+      PerftOptions options;
+      options.numThreads = 4;
+
+      for (const auto& perftCase : perftSuite())
+      {
+         VERIFY(perft(perftCase.pos, perftCase.side, 3, options) == perftCase.nodes[2],
+                caseLabel + " " + perftCase.name);
+      }
+   }
+   {
+      const std::string caseLabel = "parallel perft with hash table";
+
+      PerftOptions options;
+      options.numThreads = 4;
+      options.hashSizeMB = 1;
+
+      for (const auto& perftCase : perftSuite())
+      {
+         VERIFY(perft(perftCase.pos, perftCase.side, 3, options) == perftCase.nodes[2],
+                caseLabel + " " + perftCase.name);
+      }
+      VERIFY(perft(StartPos, White, 4, options) == 197281, caseLabel);
+   }
+   {
+      const std::string caseLabel = "parallel perft does not depend on thread count";
+
+      const PerftCase& kiwipete = *findPerftCase("kiwipete");
+      for (std::size_t numThreads : {1, 2, 3, 8})
+      {
+         for (std::size_t splitPlies : {1, 2})
+         {
+            PerftOptions options;
+            options.numThreads = numThreads;
+            options.hashSizeMB = 1;
+            options.splitPlies = splitPlies;
+
+            VERIFY(perft(kiwipete.pos, White, 3, options) == 97862, caseLabel);
+         }
+      }
+   }
+   {
+      const std::string caseLabel = "parallel perft for shallow depths";
+
+      PerftOptions options;
+      options.numThreads = 2;
+
+      VERIFY(perft(StartPos, White, 0, options) == 1, caseLabel);
+      VERIFY(perft(StartPos, White, 1, options) == 20, caseLabel);
+      VERIFY(perft(StartPos, White, 2, options) == 400, caseLabel);
+   }
+}
+
+
+void testPerftDivide()
+{
+   {
+      const std::string caseLabel = "perftDivide for start position";
+
+      Position pos = StartPos;
+      const auto entries = perftDivide(pos, White, 3);
+
+      VERIFY(entries.size() == 20, caseLabel);
+      const uint64_t total = std::accumulate(
+         entries.begin(), entries.end(), uint64_t{0},
+         [](uint64_t sum, const PerftDivideEntry& e) { return sum + e.nodes; });
+      VERIFY(total == 8902, caseLabel);
+
+      for (const auto& entry : entries)
+         if (entry.move == PackedMove{e2, e4, PackedMove::Flag::DoublePawnPush})
+            VERIFY(entry.nodes == 600, caseLabel);
+   }
+   {
+      const std::string caseLabel = "perftDivide for depth one";
+
+      Position pos = findPerftCase("kiwipete")->pos;
+      const auto entries = perftDivide(pos, White, 1);
+
+      VERIFY(entries.size() == 48, caseLabel);
+      VERIFY((std::all_of(entries.begin(), entries.end(),
+                          [](const PerftDivideEntry& e) { return e.nodes == 1; })),
+             caseLabel);
+   }
+}
+
+} // namespace
+
+
+///////////////////
+
+void testPerft()
+{
+   testPerftNodes();
+   testPerftStats();
+   testParallelPerft();
+   testPerftDivide();
+}
@@ -4,11 +4,13 @@
 //
 #include "position_tests.h"
 #include "position.h"
+#include "rules.h"
 #include "test_util.h"
 #include <algorithm>
 #include <array>
 #include <map>
 #include <stdexcept>
+#include <vector>
 
 using namespace matt2;
 
@@ -155,6 +157,19 @@ void testPositionNotationCtor()
          {Kb, {e8}}, {Kw, {e1}}, {Pw, {a2}}, {Pb, {f7, g7}}, {Nw, {d5, g3}}};
       VERIFY(verifyPositionLocations(pos, expectedLocs), caseLabel);
    }
+   {
+      const std::string caseLabel = "Position notation ctor at compile time";
+
+      constexpr Position pos{"Kbe8 Kwe1 Rwh1 wa2 bf7"};
+      static_assert(pos[h1] == Rw);
+      static_assert(pos.count(White) == 3);
+      static_assert(!pos.hasKingMoved(White) && !pos.hasRookMoved(White, true));
+      static_assert(pos.hasRookMoved(White, false));
+      static_assert(StartPos.count(White) == 16 && StartPos.count(Black) == 16);
+      static_assert(StartPos.kingLocation(Black) == e8);
+
+      VERIFY(pos == Position("Kbe8 Kwe1 Rwh1 wa2 bf7"), caseLabel);
+   }
    {
       const std::string caseLabel = "Position notation ctor for invalid notation";
 
@@ -321,6 +336,28 @@ void testPositionRemove()
       VERIFY(pos[b2] == std::nullopt, caseLabel);
       VERIFY(pos.locations(Pw).size() == 2, caseLabel);
    }
+   {
+      const std::string caseLabel =
+         "Position::remove keeps remaining pieces of one type accessible";
+
+      Position pos{"Kwe1 wa2 wb2 wc2 wd2"};
+      pos.remove("wa2");
+      pos.remove("wc2");
+      pos.move(Relocation{"wd2d4"});
+      pos.add("wh3");
+      VERIFY((pos.locations(Pw) == std::vector<Square>{b2, d4, h3}), caseLabel);
+      VERIFY(pos.count(Pw) == 3, caseLabel);
+
+      std::vector<Square> iterated{pos.begin(Pw), pos.end(Pw)};
+      std::sort(iterated.begin(), iterated.end());
+      VERIFY((iterated == std::vector<Square>{b2, d4, h3}), caseLabel);
+
+      pos.remove("wb2");
+      pos.remove("wd4");
+      pos.remove("wh3");
+      VERIFY(pos.locations(Pw).empty(), caseLabel);
+      VERIFY(pos.count(White) == 1, caseLabel);
+   }
    {
       const std::string caseLabel = "Position::remove multiple pieces";
 
@@ -695,7 +732,7 @@ void testPositionScore()
       Position pos = StartPos;
       pos.updateScore();
       VERIFY(pos.score().has_value(), caseLabel);
-      VERIFY(pos.score() == 0., caseLabel);
+      VERIFY(pos.score() == 0, caseLabel);
    }
 }
 
@@ -705,7 +742,177 @@ void testPositionUpdateScore()
       const std::string caseLabel = "Position::updateScore for starting position";
 
       Position pos = StartPos;
-      VERIFY(pos.updateScore() == 0., caseLabel);
+      VERIFY(pos.updateScore() == 0, caseLabel);
+   }
+}
+
+// Sums the piece values and piece-square bonuses of a side from scratch.
+ScorePair calcPsqScore(const Position& pos, Color side)
+{
+   ScorePair sum;
+   for (auto it = pos.begin(side), end = pos.end(side); it != end; ++it)
+      sum += dcs::pieceSquareValue(it.piece(), it.at());
+   return sum;
+}
+
+bool verifyPsqScores(const Position& pos)
+{
+   return pos.psqScore(White) == calcPsqScore(pos, White) &&
+          pos.psqScore(Black) == calcPsqScore(pos, Black);
+}
+
+void testPositionPsqScore()
+{
+   {
+      const std::string caseLabel = "Position psq score for starting position";
+
+      const int material = dcs::KingValue + dcs::QueenValue + 2 * dcs::RookValue +
+                           2 * dcs::BishopValue + 2 * dcs::KnightValue +
+                           8 * dcs::PawnValue;
+      // Only the knights in the corners of the board have a bonus.
+      const ScorePair expected{material - 14};
+      VERIFY(StartPos.psqScore(White) == expected, caseLabel);
+      VERIFY(StartPos.psqScore(Black) == expected, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position psq score for add, remove and move";
+
+      Position pos{"Kwe1 Kbe8"};
+      pos.add("Nwd4");
+      VERIFY((pos.psqScore(White) == ScorePair{dcs::KingValue + dcs::KnightValue + 7}),
+             caseLabel);
+
+      pos.move(Relocation{"Nwd4a1"});
+      VERIFY((pos.psqScore(White) == ScorePair{dcs::KingValue + dcs::KnightValue - 14}),
+             caseLabel);
+
+      // Replace the knight.
+      pos.add("bc3");
+      pos.add("ba1");
+      VERIFY((pos.psqScore(White) == ScorePair{dcs::KingValue}), caseLabel);
+      VERIFY(verifyPsqScores(pos), caseLabel);
+
+      pos.remove("ba1");
+      pos.remove("Kbe8");
+      VERIFY((pos.psqScore(Black) == ScorePair{dcs::PawnValue + 18}), caseLabel);
+      VERIFY(verifyPsqScores(pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position psq score for made and unmade moves";
+
+      // Position with castling, en-passant, captures and promotions.
+      Position pos{"Rba8 Kbe8 Nbb8 wc7 bd5 we5 Qwd1 Kwe1 Rwh1"};
+      pos.setEnPassantSquare(d5);
+      const Position orig = pos;
+
+      PackedMoveList moves;
+      collectSideMoves<White>(pos, moves);
+      VERIFY(!moves.empty(), caseLabel);
+
+      for (PackedMove m : moves)
+      {
+         const auto undo = pos.makeMove(m);
+         VERIFY(verifyPsqScores(pos), caseLabel);
+         pos.unmakeMove(m, undo);
+         VERIFY(pos.psqScore(White) == orig.psqScore(White), caseLabel);
+         VERIFY(pos.psqScore(Black) == orig.psqScore(Black), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "Position psq score after clear";
+
+      Position pos = StartPos;
+      pos.clear();
+      VERIFY(pos.psqScore(White) == ScorePair{}, caseLabel);
+      VERIFY(pos.psqScore(Black) == ScorePair{}, caseLabel);
+   }
+}
+
+// Sums the phase weights of all pieces from scratch.
+int calcPhase(const Position& pos)
+{
+   int phase = 0;
+   for (Color side : {White, Black})
+      for (auto it = pos.begin(side), end = pos.end(side); it != end; ++it)
+         phase += dcs::phaseWeight(it.piece());
+   return phase;
+}
+
+void testPositionPhase()
+{
+   {
+      const std::string caseLabel = "Position phase for starting position";
+
+      VERIFY(StartPos.phase() == dcs::MaxPhase, caseLabel);
+      VERIFY(Position{"Kwe1 wa2 bh7 Kbe8"}.phase() == 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position phase for add and remove";
+
+      Position pos{"Kwe1 Kbe8"};
+      pos.add("Qwd1");
+      pos.add("Rbh8");
+      VERIFY(pos.phase() == 6, caseLabel);
+      // Replace the queen.
+      pos.add("Nbd1");
+      VERIFY(pos.phase() == 3, caseLabel);
+      pos.remove("Rbh8");
+      VERIFY(pos.phase() == 1, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position phase for made and unmade moves";
+
+      // Position with captures and promotions.
+      Position pos{"Rba8 Kbe8 Nbb8 wc7 bd5 we5 Qwd1 Kwe1 Rwh1"};
+      const int origPhase = pos.phase();
+
+      PackedMoveList moves;
+      collectSideMoves<White>(pos, moves);
+      for (PackedMove m : moves)
+      {
+         const auto undo = pos.makeMove(m);
+         VERIFY(pos.phase() == calcPhase(pos), caseLabel);
+         pos.unmakeMove(m, undo);
+         VERIFY(pos.phase() == origPhase, caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "Position phase after clear";
+
+      Position pos = StartPos;
+      pos.clear();
+      VERIFY(pos.phase() == 0, caseLabel);
+   }
+}
+
+void testPositionPawnKey()
+{
+   {
+      const std::string caseLabel = "Position::pawnKey depends only on pawns";
+
+      VERIFY(Position("Kwe1 wa2 bh7 Kbe8").pawnKey() ==
+                Position("Kwg1 Qwd1 wa2 bh7 Nbb8 Kbe8").pawnKey(),
+             caseLabel);
+      VERIFY(Position("Kwe1 Kbe8").pawnKey() == Position().pawnKey(), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::pawnKey differs for pawn structures";
+
+      const uint64_t key = Position("wa2 bh7").pawnKey();
+      VERIFY(Position("wa3 bh7").pawnKey() != key, caseLabel);
+      VERIFY(Position("ba2 wh7").pawnKey() != key, caseLabel);
+      VERIFY(Position("wa2").pawnKey() != key, caseLabel);
+      VERIFY(StartPos.pawnKey() != key, caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::pawnKey after making moves";
+
+      Position pos = StartPos;
+      const uint64_t startKey = pos.pawnKey();
+      pos.makeMove(PackedMove{g1, f3});
+      VERIFY(pos.pawnKey() == startKey, caseLabel);
+      pos.makeMove(PackedMove{e7, e5, PackedMove::Flag::DoublePawnPush});
+      VERIFY(pos.pawnKey() != startKey, caseLabel);
    }
 }
 
@@ -864,6 +1071,31 @@ void testPositionHasRookMoved()
       VERIFY(pos.hasRookMoved(Black, true), caseLabel);
       VERIFY(pos.hasRookMoved(Black, false), caseLabel);
    }
+   {
+      const std::string caseLabel =
+         "Position::hasRookMoved is 'false' after other rook on a- or h-file moved";
+
+      Position pos{"Kwe1 Rwa1 Rwh1 Kbe8 Rba8 Rbh8 Rwa4 Rbh5"};
+      pos.move(Relocation{"Rwa4b4"});
+      pos.move(Relocation{"Rbh5g5"});
+
+      VERIFY(!pos.hasRookMoved(White, true), caseLabel);
+      VERIFY(!pos.hasRookMoved(White, false), caseLabel);
+      VERIFY(!pos.hasRookMoved(Black, true), caseLabel);
+      VERIFY(!pos.hasRookMoved(Black, false), caseLabel);
+   }
+   {
+      const std::string caseLabel =
+         "Position::hasRookMoved is 'true' after rook moved back to initial square and "
+         "pawn promoted to rook";
+
+      Position pos{"Kwe1 Rwh1 wb7 Kbe8"};
+      pos.makeMove(PackedMove{h1, h2});
+      pos.makeMove(PackedMove{h2, h1});
+      pos.makeMove(PackedMove{b7, b8, PackedMove::Flag::RookPromotion});
+
+      VERIFY(pos.hasRookMoved(White, true), caseLabel);
+   }
 }
 
 void testPositionCanAttackForPlacement()
@@ -1123,6 +1355,150 @@ void testPositionCanAttackForColor()
    }
 }
 
+void testPositionOccupied()
+{
+   {
+      const std::string caseLabel = "Position::occupied for start position";
+
+      VERIFY(popCount(StartPos.occupied()) == 32, caseLabel);
+      VERIFY(popCount(StartPos.occupied(White)) == 16, caseLabel);
+      VERIFY(StartPos.occupied(Kb) == toBitboard(e8), caseLabel);
+      VERIFY(StartPos.occupied(Qw) == toBitboard(d1), caseLabel);
+      VERIFY(StartPos.occupied(Rw) == (toBitboard(a1) | toBitboard(h1)), caseLabel);
+      VERIFY(StartPos.occupied(Bb) == (toBitboard(c8) | toBitboard(f8)), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::occupied after changes";
+
+      Position pos{"Kwe1 Qwd1 Kbe8 bd7"};
+      pos.move(Relocation{"Qwd1d7"});
+      VERIFY(pos.occupied(Qw) == toBitboard(d7), caseLabel);
+      VERIFY(pos.occupied(Pb) == EmptyBB, caseLabel);
+      VERIFY(pos.occupied(Black) == toBitboard(e8), caseLabel);
+
+      pos.remove("Qwd7");
+      VERIFY(pos.occupied(White) == toBitboard(e1), caseLabel);
+      VERIFY(pos.kingLocation(White) == e1, caseLabel);
+   }
+}
+
+void testPositionMakeAndUnmakeMove()
+{
+   {
+      const std::string caseLabel = "Position::makeMove for quiet move";
+
+      Position pos{"Kwe1 Kbe8 Nwb1"};
+      const Position orig = pos;
+      const PackedMove m{b1, c3};
+      const auto undo = pos.makeMove(m);
+      VERIFY(pos[c3] == Nw, caseLabel);
+      VERIFY(!pos[b1].has_value(), caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(pos.isEqual(orig, true), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::makeMove for capture";
+
+      Position pos{"Kwe1 Kbe8 Bwc1 bh6"};
+      const Position orig = pos;
+      const PackedMove m{c1, h6, PackedMove::Flag::Capture};
+      const auto undo = pos.makeMove(m);
+      VERIFY(pos[h6] == Bw, caseLabel);
+      VERIFY(pos.count(Black) == 1, caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(pos.isEqual(orig, true), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::makeMove for double pawn push";
+
+      Position pos{"Kwe1 Kbe8 wd2"};
+      const Position orig = pos;
+      const PackedMove m{d2, d4, PackedMove::Flag::DoublePawnPush};
+      const auto undo = pos.makeMove(m);
+      VERIFY(pos.enPassantSquare() == d4, caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(pos.isEqual(orig, true), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::makeMove for en-passant";
+
+      Position pos{"Kwe1 Kbe8 we5 bd7"};
+      pos.makeMove(PackedMove{d7, d5, PackedMove::Flag::DoublePawnPush});
+      const Position orig = pos;
+      const PackedMove m{e5, d6, PackedMove::Flag::EnPassant};
+      const auto undo = pos.makeMove(m);
+      VERIFY(pos[d6] == Pw, caseLabel);
+      VERIFY(!pos[d5].has_value(), caseLabel);
+      VERIFY(!pos.enPassantSquare().has_value(), caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(pos.isEqual(orig, true), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::makeMove for kingside castling";
+
+      Position pos{"Kwe1 Kbe8 Rwh1"};
+      const Position orig = pos;
+      const PackedMove m{e1, g1, PackedMove::Flag::KingsideCastling};
+      const auto undo = pos.makeMove(m);
+      VERIFY(pos[g1] == Kw, caseLabel);
+      VERIFY(pos[f1] == Rw, caseLabel);
+      VERIFY(pos.hasCastled(White), caseLabel);
+      VERIFY(pos.hasKingMoved(White), caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(pos.isEqual(orig, true), caseLabel);
+      VERIFY(!pos.hasCastled(White), caseLabel);
+      VERIFY(!pos.hasKingMoved(White), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::makeMove for queenside castling";
+
+      Position pos{"Kwe1 Kbe8 Rba8"};
+      const Position orig = pos;
+      const PackedMove m{e8, c8, PackedMove::Flag::QueensideCastling};
+      const auto undo = pos.makeMove(m);
+      VERIFY(pos[c8] == Kb, caseLabel);
+      VERIFY(pos[d8] == Rb, caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(pos.isEqual(orig, true), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::makeMove for promotion with capture";
+
+      Position pos{"Kwe1 Kbe8 wb7 Nba8"};
+      const Position orig = pos;
+      const PackedMove m{b7, a8, PackedMove::Flag::QueenPromotionCapture};
+      const auto undo = pos.makeMove(m);
+      VERIFY(pos[a8] == Qw, caseLabel);
+      VERIFY(!pos[b7].has_value(), caseLabel);
+      VERIFY(pos.count(Black) == 1, caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(pos.isEqual(orig, true), caseLabel);
+   }
+   {
+      const std::string caseLabel = "Position::makeMove for sequence of moves";
+
+      Position pos = StartPos;
+      const std::vector<PackedMove> moves = {
+         PackedMove{e2, e4, PackedMove::Flag::DoublePawnPush},
+         PackedMove{d7, d5, PackedMove::Flag::DoublePawnPush},
+         PackedMove{e4, d5, PackedMove::Flag::Capture},
+         PackedMove{g8, f6},
+         PackedMove{g1, f3},
+      };
+      // Callers keep the info to unmake the moves in a stack of their own.
+      std::vector<Position::UndoState> undoStack;
+      for (auto m : moves)
+         undoStack.push_back(pos.makeMove(m));
+
+      for (auto it = moves.rbegin(); it != moves.rend(); ++it)
+      {
+         pos.unmakeMove(*it, undoStack.back());
+         undoStack.pop_back();
+      }
+      VERIFY(pos.isEqual(StartPos, true), caseLabel);
+   }
+}
+
 ///////////////////
 
 void testPlacementIterCopyCtor()
@@ -1884,6 +2260,9 @@ void testPosition()
    testPositionLocations();
    testPositionScore();
    testPositionUpdateScore();
+   testPositionPsqScore();
+   testPositionPhase();
+   testPositionPawnKey();
    testPositionEnPassantSquare();
    testPositionSetEnPassantFile();
    testPositionHasCastledAndSetHasCastled();
@@ -1891,6 +2270,8 @@ void testPosition()
    testPositionHasRookMoved();
    testPositionCanAttackForPlacement();
    testPositionCanAttackForColor();
+   testPositionOccupied();
+   testPositionMakeAndUnmakeMove();
 }
 
 void testPlacementIterator()
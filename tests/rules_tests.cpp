@@ -3,9 +3,11 @@
 // MIT license
 //
 #include "rules_tests.h"
+#include "micro_benchmark.h"
 #include "rules.h"
 #include "test_util.h"
 #include <algorithm>
+#include <iostream>
 #include <stdexcept>
 
 using namespace matt2;
@@ -674,6 +676,148 @@ void testCollectMoves()
    }
 }
 
+void testCollectMovesIntoMoveList()
+{
+   {
+      const std::string caseLabel = "collectMoves into move list for each piece";
+
+      const Position pos{"Kwe1 Qwd1 Rwa1 Bwc1 Nwb1 wd2 Kbe8 bc3"};
+      for (auto it = pos.begin(White); it != pos.end(White); ++it)
+      {
+         MoveList moves;
+         collectMoves(it.piece(), it.at(), pos, moves);
+
+         std::vector<Move> expected;
+         collectMoves(it.piece(), it.at(), pos, expected);
+
+         VERIFY(moves.size() == expected.size(), caseLabel);
+         VERIFY(std::equal(moves.begin(), moves.end(), expected.begin()), caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "collectCastlingMoves into move list";
+
+      const Position pos{"Kwe1 Rwa1 Rwh1 Kbe8"};
+      MoveList moves;
+      collectCastlingMoves(White, pos, moves);
+
+      VERIFY(moves.size() == 2, caseLabel);
+      VERIFY(moves[0] == Move(Castling(Kingside, White)), caseLabel);
+      VERIFY(moves[1] == Move(Castling(Queenside, White)), caseLabel);
+   }
+   {
+      const std::string caseLabel = "collectEnPassantMoves into move list";
+
+      Position pos{"Kwe1 wd5 Kbe8 be5"};
+      pos.setEnPassantSquare(e5);
+      MoveList moves;
+      collectEnPassantMoves(White, pos, moves);
+
+      VERIFY(moves.size() == 1, caseLabel);
+      VERIFY(moves[0] == Move(EnPassant(Pw, d5, e6)), caseLabel);
+   }
+   {
+      const std::string caseLabel = "packed moves match packed full moves";
+
+      Position epPos{"Kwe1 Rwa1 Rwh1 wd5 wb7 Kbe8 be5 Nbc8"};
+      epPos.setEnPassantSquare(e5);
+      const std::vector<Position> positions = {
+         StartPos, Position{"Kwe1 Rwa1 Rwh1 wb7 Kbe8 Rbh8 bc2 Nbd5"}, epPos};
+
+      for (const auto& pos : positions)
+      {
+         for (Color side : {White, Black})
+         {
+            MoveList full;
+            PackedMoveList packed;
+            for (auto it = pos.begin(side); it != pos.end(side); ++it)
+            {
+               collectMoves(it.piece(), it.at(), pos, full);
+               collectMoves(it.piece(), it.at(), pos, packed);
+            }
+            collectCastlingMoves(side, pos, full);
+            collectCastlingMoves(side, pos, packed);
+            collectEnPassantMoves(side, pos, full);
+            collectEnPassantMoves(side, pos, packed);
+
+            VERIFY(full.size() == packed.size(), caseLabel);
+            for (std::size_t i = 0; i < full.size() && i < packed.size(); ++i)
+               VERIFY(pack(full[i]) == packed[i], caseLabel);
+         }
+      }
+   }
+   {
+      const std::string caseLabel = "move list holds max number of moves without growing";
+
+      MoveList moves;
+      for (std::size_t i = 0; i < MaxMoves; ++i)
+         moves.push_back(BasicMove{Kw, e1, e2});
+
+      VERIFY(moves.capacity() == MaxMoves, caseLabel);
+   }
+}
+
+void testCollectSideMoves()
+{
+   const std::vector<Position> positions = {
+      StartPos,
+      Position{"Kwe1 Rwa1 Rwh1 wb7 Kbe8 Rbh8 bc2 Nbd5"},
+      Position{"Kwg1 Qwf6 Bwc3 wh2 wg2 wf2 Kbg8 Qbd8 Rbf8 Bbg7 bh7 bg6 bf7"},
+      Position{"Kwc1 Qwh6 Rwd1 Nwg5 wb2 wc2 we5 Kbg8 Qbc7 Rbc8 Rbf8 bh7 bg6 bf7"}};
+
+   // Collects moves with the functions that take the side at runtime.
+   auto collectReference = [](Color side, const Position& pos)
+   {
+      PackedMoveList moves;
+      const auto endIter = pos.end(side);
+      for (auto iter = pos.begin(side); iter < endIter; ++iter)
+         collectMoves(iter.piece(), iter.at(), pos, moves);
+      collectCastlingMoves(side, pos, moves);
+      collectEnPassantMoves(side, pos, moves);
+      return moves;
+   };
+
+   {
+      const std::string caseLabel = "collectSideMoves for white";
+
+      for (const auto& pos : positions)
+      {
+         PackedMoveList moves;
+         collectSideMoves<White>(pos, moves);
+         const PackedMoveList expected = collectReference(White, pos);
+
+         VERIFY((std::equal(moves.begin(), moves.end(), expected.begin(), expected.end())),
+                caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "collectSideMoves for black";
+
+      for (const auto& pos : positions)
+      {
+         PackedMoveList moves;
+         collectSideMoves<Black>(pos, moves);
+         const PackedMoveList expected = collectReference(Black, pos);
+
+         VERIFY((std::equal(moves.begin(), moves.end(), expected.begin(), expected.end())),
+                caseLabel);
+      }
+   }
+   {
+      const std::string caseLabel = "collectSideMoves with en-passant move";
+
+      Position pos{"Kwe1 wd5 Kbe8 be7"};
+      pos.makeMove(PackedMove{e7, e5, PackedMove::Flag::DoublePawnPush});
+
+      PackedMoveList moves;
+      collectSideMoves<White>(pos, moves);
+
+      VERIFY((std::find(moves.begin(), moves.end(),
+                        PackedMove{d5, e6, PackedMove::Flag::EnPassant}) != moves.end()),
+             caseLabel);
+   }
+}
+
 void testCollectCastlingMoves()
 {
    {
@@ -1652,6 +1796,88 @@ void testIsCheck()
       VERIFY(!isCheck(Black, StartPos), caseLabel);
       VERIFY(isCheck(White, Position("")), caseLabel);
    }
+   {
+      const std::string caseLabel = "isCheck for side known at compile time";
+
+      VERIFY(isCheck<White>(Position("Kbf2 bb4 Bbf6 Kwd4")), caseLabel);
+      VERIFY(!isCheck<White>(Position("Kbf2 bb4 Bbf6 Kwd3")), caseLabel);
+      VERIFY(isCheck<Black>(Position("Kbf2 bb4 Bbf6 Kwd4 Rwa2")), caseLabel);
+      VERIFY(!isCheck<Black>(Position("Kbf2 bb4 Bbf6 Kwd3 wa5 wb5 wc4 Rwh7")), caseLabel);
+      VERIFY(!isCheck<Black>(StartPos), caseLabel);
+      VERIFY(isCheck<White>(Position("")), caseLabel);
+   }
+}
+
+void testIsAttackedBy()
+{
+   {
+      const std::string caseLabel = "isAttackedBy for pawns";
+
+      const Position pos{"wd4 be5"};
+      VERIFY(isAttackedBy<White>(c5, pos), caseLabel);
+      VERIFY(isAttackedBy<White>(e5, pos), caseLabel);
+      VERIFY(!isAttackedBy<White>(d5, pos), caseLabel);
+      VERIFY(!isAttackedBy<White>(c3, pos), caseLabel);
+      VERIFY(isAttackedBy<Black>(d4, pos), caseLabel);
+      VERIFY(isAttackedBy<Black>(f4, pos), caseLabel);
+      VERIFY(!isAttackedBy<Black>(d6, pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "isAttackedBy for sliders that are blocked";
+
+      const Position pos{"Rwa1 wa3 Bbh8 bd4 Qbh1"};
+      VERIFY(isAttackedBy<White>(a2, pos), caseLabel);
+      VERIFY(isAttackedBy<White>(a3, pos), caseLabel);
+      VERIFY(!isAttackedBy<White>(a4, pos), caseLabel);
+      VERIFY(isAttackedBy<White>(e1, pos), caseLabel);
+      VERIFY(isAttackedBy<Black>(e5, pos), caseLabel);
+      VERIFY(!isAttackedBy<Black>(b2, pos), caseLabel);
+      VERIFY(isAttackedBy<Black>(b1, pos), caseLabel);
+      VERIFY(isAttackedBy<Black>(a1, pos), caseLabel);
+      VERIFY(isAttackedBy<Black>(a8, pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "isAttackedBy for knights and kings";
+
+      const Position pos{"Nwb1 Kbh8"};
+      VERIFY(isAttackedBy<White>(a3, pos), caseLabel);
+      VERIFY(isAttackedBy<White>(c3, pos), caseLabel);
+      VERIFY(isAttackedBy<White>(d2, pos), caseLabel);
+      VERIFY(!isAttackedBy<White>(b3, pos), caseLabel);
+      VERIFY(isAttackedBy<Black>(g7, pos), caseLabel);
+      VERIFY(!isAttackedBy<Black>(f6, pos), caseLabel);
+      VERIFY(!isAttackedBy<Black>(a3, pos), caseLabel);
+   }
+   {
+      const std::string caseLabel = "isAttackedBy matches collectAttackedBySide";
+
+      const std::vector<Position> positions = {
+         StartPos,
+         Position{"Kwg1 Qwf6 Bwc3 wh2 wg2 wf2 Kbg8 Qbd8 Rbf8 Bbg7 bh7 bg6 bf7"},
+         Position{"Kwc1 Qwh6 Rwd1 Nwg5 wb2 wc2 we5 Kbg8 Qbc7 Rbc8 Rbf8 bh7 bg6 bf7"}};
+
+      for (const auto& pos : positions)
+      {
+         for (Color side : {White, Black})
+         {
+            std::vector<Square> attacked;
+            collectAttackedBySide(side, pos, attacked);
+
+            for (int i = 0; i < 64; ++i)
+            {
+               const Square sq = static_cast<Square>(i);
+               // Squares occupied by own pieces are not collected as attacked.
+               const auto piece = pos[sq];
+               if (piece && color(*piece) == side)
+                  continue;
+
+               const bool isAttacked =
+                  side == White ? isAttackedBy<White>(sq, pos) : isAttackedBy<Black>(sq, pos);
+               VERIFY(isAttacked == contains(attacked, sq), caseLabel);
+            }
+         }
+      }
+   }
 }
 
 void testIsMate()
@@ -1668,6 +1894,45 @@ void testIsMate()
    }
 }
 
+void testAttackCollectionBenchmark()
+{
+   const std::vector<Position> positions = {
+      StartPos,
+      Position{"Kwg1 Qwf6 Bwc3 wh2 wg2 wf2 Kbg8 Qbd8 Rbf8 Bbg7 bh7 bg6 bf7"},
+      Position{"Kwc1 Qwh6 Rwd1 Nwg5 wb2 wc2 we5 Kbg8 Qbc7 Rbc8 Rbf8 bh7 bg6 bf7"}};
+   constexpr std::size_t NumIterations = 20000;
+
+   std::size_t numAttacked = 0;
+   int64_t elapsedNsec = 0;
+   {
+      MicroBenchmark benchmark{elapsedNsec};
+
+      std::vector<Square> attacked;
+      attacked.reserve(64);
+      for (std::size_t i = 0; i < NumIterations; ++i)
+      {
+         for (const auto& pos : positions)
+         {
+            for (Color side : {White, Black})
+            {
+               attacked.clear();
+               collectAttackedBySide(side, pos, attacked);
+               numAttacked += attacked.size();
+            }
+         }
+      }
+   }
+
+   {
+      const std::string caseLabel = "Attack collection benchmark collects squares";
+      VERIFY(numAttacked > 0, caseLabel);
+   }
+
+   const double elapsedMsec = double(elapsedNsec) / 1000000.;
+   std::cout << "Attack collection performance: " << elapsedMsec << " ms for "
+             << NumIterations * positions.size() * 2 << " collections.\n";
+}
+
 } // namespace
 
 
@@ -1682,6 +1947,8 @@ void testRules()
    testCollectKnightMoves();
    testCollectPawnMoves();
    testCollectMoves();
+   testCollectMovesIntoMoveList();
+   testCollectSideMoves();
    testCollectCastlingMoves();
    testCollectEnPassantMoves();
    testCollectAttackedByKing();
@@ -1693,5 +1960,7 @@ void testRules()
    testcollectAttackedBySide();
    testCanCastle();
    testIsCheck();
+   testIsAttackedBy();
    testIsMate();
+   testAttackCollectionBenchmark();
 }
@@ -6,6 +6,8 @@
 #include "position.h"
 #include "scoring.h"
 #include "test_util.h"
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 using namespace matt2;
@@ -20,16 +22,16 @@ void testBetterScoreForMinMaxFlag()
    {
       const std::string caseLabel = "bt for max calculation";
 
-      VERIFY(bt(10., 5., true), caseLabel);
-      VERIFY(bt(-5., -10., true), caseLabel);
-      VERIFY(!bt(5., 10., true), caseLabel);
+      VERIFY(bt(10, 5, true), caseLabel);
+      VERIFY(bt(-5, -10, true), caseLabel);
+      VERIFY(!bt(5, 10, true), caseLabel);
    }
    {
       const std::string caseLabel = "bt for min calculation";
 
-      VERIFY(bt(5., 10., false), caseLabel);
-      VERIFY(bt(-10., -5., false), caseLabel);
-      VERIFY(!bt(10., 5., false), caseLabel);
+      VERIFY(bt(5, 10, false), caseLabel);
+      VERIFY(bt(-10, -5, false), caseLabel);
+      VERIFY(!bt(10, 5, false), caseLabel);
    }
 }
 
@@ -38,16 +40,16 @@ void testBetterScoreForSide()
    {
       const std::string caseLabel = "bt for white";
 
-      VERIFY(bt(10., 5., White), caseLabel);
-      VERIFY(bt(-5., -10., White), caseLabel);
-      VERIFY(!bt(5., 10., White), caseLabel);
+      VERIFY(bt(10, 5, White), caseLabel);
+      VERIFY(bt(-5, -10, White), caseLabel);
+      VERIFY(!bt(5, 10, White), caseLabel);
    }
    {
       const std::string caseLabel = "bt for black";
 
-      VERIFY(bt(5., 10., Black), caseLabel);
-      VERIFY(bt(-10., -5., Black), caseLabel);
-      VERIFY(!bt(10., 5., Black), caseLabel);
+      VERIFY(bt(5, 10, Black), caseLabel);
+      VERIFY(bt(-10, -5, Black), caseLabel);
+      VERIFY(!bt(10, 5, Black), caseLabel);
    }
 }
 
@@ -56,22 +58,22 @@ void testCmpScoreForMinMaxFlag()
    {
       const std::string caseLabel = "cmp for max calculation";
 
-      VERIFY(cmp(10., 5., true) == 1, caseLabel);
-      VERIFY(cmp(-5., -10., true) == 1, caseLabel);
-      VERIFY(cmp(5., 5., true) == 0, caseLabel);
-      VERIFY(cmp(-1., -1., true) == 0, caseLabel);
-      VERIFY(cmp(5., 10., true) == -1, caseLabel);
-      VERIFY(cmp(-2., 2., true) == -1, caseLabel);
+      VERIFY(cmp(10, 5, true) == 1, caseLabel);
+      VERIFY(cmp(-5, -10, true) == 1, caseLabel);
+      VERIFY(cmp(5, 5, true) == 0, caseLabel);
+      VERIFY(cmp(-1, -1, true) == 0, caseLabel);
+      VERIFY(cmp(5, 10, true) == -1, caseLabel);
+      VERIFY(cmp(-2, 2, true) == -1, caseLabel);
    }
    {
       const std::string caseLabel = "cmp for min calculation";
 
-      VERIFY(cmp(5., 10., false) == 1, caseLabel);
-      VERIFY(cmp(-5., -4., false) == 1, caseLabel);
-      VERIFY(cmp(5., 5., false) == 0, caseLabel);
-      VERIFY(cmp(-1., -1., false) == 0, caseLabel);
-      VERIFY(cmp(5., 1., false) == -1, caseLabel);
-      VERIFY(cmp(2., -2., false) == -1, caseLabel);
+      VERIFY(cmp(5, 10, false) == 1, caseLabel);
+      VERIFY(cmp(-5, -4, false) == 1, caseLabel);
+      VERIFY(cmp(5, 5, false) == 0, caseLabel);
+      VERIFY(cmp(-1, -1, false) == 0, caseLabel);
+      VERIFY(cmp(5, 1, false) == -1, caseLabel);
+      VERIFY(cmp(2, -2, false) == -1, caseLabel);
    }
 }
 
@@ -80,22 +82,22 @@ void testCmpScoreForSide()
    {
       const std::string caseLabel = "cmp for white";
 
-      VERIFY(cmp(10., 5., White) == 1, caseLabel);
-      VERIFY(cmp(-5., -10., White) == 1, caseLabel);
-      VERIFY(cmp(5., 5., White) == 0, caseLabel);
-      VERIFY(cmp(-1., -1., White) == 0, caseLabel);
-      VERIFY(cmp(5., 10., White) == -1, caseLabel);
-      VERIFY(cmp(-2., 2., White) == -1, caseLabel);
+      VERIFY(cmp(10, 5, White) == 1, caseLabel);
+      VERIFY(cmp(-5, -10, White) == 1, caseLabel);
+      VERIFY(cmp(5, 5, White) == 0, caseLabel);
+      VERIFY(cmp(-1, -1, White) == 0, caseLabel);
+      VERIFY(cmp(5, 10, White) == -1, caseLabel);
+      VERIFY(cmp(-2, 2, White) == -1, caseLabel);
    }
    {
       const std::string caseLabel = "cmp for black";
 
-      VERIFY(cmp(5., 10., Black) == 1, caseLabel);
-      VERIFY(cmp(-5., -4., Black) == 1, caseLabel);
-      VERIFY(cmp(5., 5., Black) == 0, caseLabel);
-      VERIFY(cmp(-1., -1., Black) == 0, caseLabel);
-      VERIFY(cmp(5., 1., Black) == -1, caseLabel);
-      VERIFY(cmp(2., -2., Black) == -1, caseLabel);
+      VERIFY(cmp(5, 10, Black) == 1, caseLabel);
+      VERIFY(cmp(-5, -4, Black) == 1, caseLabel);
+      VERIFY(cmp(5, 5, Black) == 0, caseLabel);
+      VERIFY(cmp(-1, -1, Black) == 0, caseLabel);
+      VERIFY(cmp(5, 1, Black) == -1, caseLabel);
+      VERIFY(cmp(2, -2, Black) == -1, caseLabel);
    }
 }
 
@@ -104,8 +106,8 @@ void testGetWorstScoreForMinMaxFlag()
    {
       const std::string caseLabel = "getWorstScoreValue for min-max flag";
 
-      VERIFY(getWorstScoreValue(true) < -100000, caseLabel);
-      VERIFY(getWorstScoreValue(false) > 100000, caseLabel);
+      VERIFY(getWorstScoreValue(true) < matedScore(White, 0), caseLabel);
+      VERIFY(getWorstScoreValue(false) > matedScore(Black, 0), caseLabel);
    }
 }
 
@@ -114,8 +116,94 @@ void testGetWorstScoreForSide()
    {
       const std::string caseLabel = "getWorstScoreValue for side";
 
-      VERIFY(getWorstScoreValue(White) < -100000, caseLabel);
-      VERIFY(getWorstScoreValue(Black) > 100000, caseLabel);
+      VERIFY(getWorstScoreValue(White) < matedScore(White, 0), caseLabel);
+      VERIFY(getWorstScoreValue(Black) > matedScore(Black, 0), caseLabel);
+   }
+}
+
+void testMatedScore()
+{
+   {
+      const std::string caseLabel = "matedScore is bad for mated side";
+
+      VERIFY(matedScore(White, 0) < 0, caseLabel);
+      VERIFY(matedScore(Black, 3) > 0, caseLabel);
+   }
+   {
+      const std::string caseLabel = "matedScore is worse for quicker mates";
+
+      VERIFY(matedScore(White, 1) < matedScore(White, 2), caseLabel);
+      VERIFY(matedScore(Black, 1) > matedScore(Black, 2), caseLabel);
+   }
+   {
+      const std::string caseLabel = "matedScore fits into 16 bits";
+
+      VERIFY(matedScore(White, 0) >= std::numeric_limits<int16_t>::min(), caseLabel);
+      VERIFY(matedScore(Black, 0) <= std::numeric_limits<int16_t>::max(), caseLabel);
+   }
+}
+
+void testIsMateScore()
+{
+   {
+      const std::string caseLabel = "isMateScore for mate scores";
+
+      VERIFY(isMateScore(matedScore(White, 0)), caseLabel);
+      VERIFY(isMateScore(matedScore(Black, 20)), caseLabel);
+      VERIFY(matePly(matedScore(White, 7)) == 7, caseLabel);
+      VERIFY(matePly(matedScore(Black, 12)) == 12, caseLabel);
+   }
+   {
+      const std::string caseLabel = "isMateScore for position scores";
+
+      VERIFY(!isMateScore(0), caseLabel);
+      VERIFY(!isMateScore(calcScore(Position("Kwe1 Qwd1 Qwc1 Qwb1 Kbe8"))), caseLabel);
+   }
+}
+
+void testScorePair()
+{
+   {
+      const std::string caseLabel = "ScorePair ctor";
+
+      VERIFY(ScorePair{}.mg() == 0 && ScorePair{}.eg() == 0, caseLabel);
+      VERIFY((ScorePair{12, -34}.mg() == 12), caseLabel);
+      VERIFY((ScorePair{12, -34}.eg() == -34), caseLabel);
+      VERIFY((ScorePair{-5}.mg() == -5 && ScorePair{-5}.eg() == -5), caseLabel);
+   }
+   {
+      const std::string caseLabel = "ScorePair arithmetic";
+
+      const ScorePair a{-120, 35};
+      const ScorePair b{40, -300};
+      VERIFY(((a + b) == ScorePair{-80, -265}), caseLabel);
+      VERIFY(((a - b) == ScorePair{-160, 335}), caseLabel);
+      VERIFY((-a == ScorePair{120, -35}), caseLabel);
+      VERIFY(((b * 3) == ScorePair{120, -900}), caseLabel);
+      VERIFY(((a * -2) == ScorePair{240, -70}), caseLabel);
+
+      ScorePair sum;
+      sum += a;
+      sum += a;
+      sum -= b;
+      VERIFY((sum.mg() == -280 && sum.eg() == 370), caseLabel);
+   }
+   {
+      const std::string caseLabel = "ScorePair with signs changing through sums";
+
+      ScorePair sum{-1, -1};
+      for (int i = 0; i < 1000; ++i)
+         sum += ScorePair{3, -2};
+      VERIFY((sum.mg() == 2999 && sum.eg() == -2001), caseLabel);
+      for (int i = 0; i < 2000; ++i)
+         sum -= ScorePair{3, -2};
+      VERIFY((sum.mg() == -3001 && sum.eg() == 1999), caseLabel);
+   }
+   {
+      const std::string caseLabel = "ScorePair at compile time";
+
+      static_assert((ScorePair{-7, 9} + ScorePair{7, -10}).eg() == -1);
+      static_assert((ScorePair{-7, 9} + ScorePair{7, -10}).mg() == 0);
    }
 }
 
@@ -124,7 +212,7 @@ void testCalcScore()
    {
       const std::string caseLabel = "calcScore should return a score";
 
-      VERIFY(calcScore(Position("wa2 wb2")) != 0., caseLabel);
+      VERIFY(calcScore(Position("wa2 wb2")) != 0, caseLabel);
    }
 }
 
@@ -133,7 +221,7 @@ void testCalcMateScore()
    {
       const std::string caseLabel = "calcMateScore should return a score";
 
-      VERIFY(calcMateScore(White, Position("wa2 wb2"), 0) != 0., caseLabel);
+      VERIFY(calcMateScore(White, Position("wa2 wb2"), 0) != 0, caseLabel);
    }
 }
 
@@ -142,7 +230,7 @@ void testCalcTieScore()
    {
       const std::string caseLabel = "calcTieScore should return a score";
 
-      VERIFY(calcTieScore(White, Position("Kwe1 wa2 wb2 Kbh6")) != 0., caseLabel);
+      VERIFY(calcTieScore(White, Position("Kwe1 wa2 wb2 Kbh6")) != 0, caseLabel);
    }
 }
 
@@ -159,6 +247,9 @@ void testScoring()
    testCmpScoreForSide();
    testGetWorstScoreForMinMaxFlag();
    testGetWorstScoreForSide();
+   testMatedScore();
+   testIsMateScore();
+   testScorePair();
    testCalcScore();
    testCalcMateScore();
    testCalcTieScore();
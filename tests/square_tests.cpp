@@ -1086,6 +1086,21 @@ void testSquareIncrementOperator()
    }
 }
 
+void testFlipRank()
+{
+   {
+      const std::string caseLabel = "flipRank(Square)";
+
+      VERIFY(flipRank(a1) == a8, caseLabel);
+      VERIFY(flipRank(c3) == c6, caseLabel);
+      VERIFY(flipRank(e4) == e5, caseLabel);
+      VERIFY(flipRank(h7) == h2, caseLabel);
+      for (int i = 0; i < 64; ++i)
+         VERIFY(flipRank(flipRank(static_cast<Square>(i))) == static_cast<Square>(i),
+                caseLabel);
+   }
+}
+
 void testSquareToString()
 {
    {
@@ -1673,6 +1688,7 @@ void testSquare()
    testGettingRankOfSquare();
    testSquareIsValid();
    testSquareIncrementOperator();
+   testFlipRank();
    testSquareToString();
 }
 
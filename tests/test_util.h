@@ -3,6 +3,10 @@
 // MIT license
 //
 #pragma once
+#include "move.h"
+#include "position.h"
+#include "rules.h"
+#include <cstddef>
 #include <string>
 
 
@@ -11,3 +15,41 @@ bool verify(bool cond, const std::string& label, const std::string& reason,
 
 #define VERIFY(cond, label) (verify(cond, label, #cond, __FILE__, __LINE__))
 #define FAIL(reason, label) (verify(false, label, reason, __FILE__, __LINE__))
+
+
+// Calls a check for a given position and the positions of the move tree below it up to
+// a given depth. Stops at the first position that fails the check. Moves are made and
+// unmade through the given callables, so that state that follows the position can be
+// updated together with it.
+template <matt2::Color Us, typename Check, typename MakeMove, typename UnmakeMove>
+bool forEachTreePosition(matt2::Position& pos, std::size_t depth, const Check& check,
+                         const MakeMove& makeMove, const UnmakeMove& unmakeMove)
+{
+   if (!check(pos))
+      return false;
+   if (depth == 0)
+      return true;
+
+   matt2::PackedMoveList moves;
+   matt2::collectSideMoves<Us>(pos, moves);
+   for (matt2::PackedMove m : moves)
+   {
+      const auto undo = makeMove(pos, m);
+      const bool ok =
+         forEachTreePosition<!Us>(pos, depth - 1, check, makeMove, unmakeMove);
+      unmakeMove(pos, m, undo);
+      if (!ok)
+         return false;
+   }
+   return true;
+}
+
+template <matt2::Color Us, typename Check>
+bool forEachTreePosition(matt2::Position& pos, std::size_t depth, const Check& check)
+{
+   return forEachTreePosition<Us>(
+      pos, depth, check,
+      [](matt2::Position& p, matt2::PackedMove m) { return p.makeMove(m); },
+      [](matt2::Position& p, matt2::PackedMove m, const matt2::Position::UndoState& undo)
+      { p.unmakeMove(m, undo); });
+}
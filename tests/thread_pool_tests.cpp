@@ -0,0 +1,107 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "thread_pool_tests.h"
+#include "test_util.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+void testThreadPoolSize()
+{
+   {
+      const std::string caseLabel = "ThreadPool size for hardware threads";
+
+      ThreadPool pool;
+      VERIFY(pool.size() >= 1, caseLabel);
+   }
+#ifdef HAVE_THREADS
+   {
+      const std::string caseLabel = "ThreadPool size for given thread count";
+
+      ThreadPool pool{3};
+      VERIFY(pool.size() == 3, caseLabel);
+   }
+#endif
+}
+
+
+void testThreadPoolRun()
+{
+   {
+      const std::string caseLabel = "ThreadPool::run runs each task once";
+
+      ThreadPool pool{4};
+      std::vector<int> runs(100, 0);
+      pool.run(runs.size(), [&runs](std::size_t taskIdx) { ++runs[taskIdx]; });
+
+      VERIFY((std::all_of(runs.begin(), runs.end(), [](int n) { return n == 1; })),
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "ThreadPool::run for multiple batches";
+
+      ThreadPool pool{2};
+      std::atomic<std::size_t> sum = 0;
+      for (std::size_t batch = 0; batch < 10; ++batch)
+         pool.run(10, [&sum](std::size_t taskIdx) { sum += taskIdx; });
+
+      VERIFY(sum == 450, caseLabel);
+   }
+   {
+      const std::string caseLabel = "ThreadPool::run without tasks";
+
+      ThreadPool pool{2};
+      bool hasRun = false;
+      pool.run(0, [&hasRun](std::size_t) { hasRun = true; });
+
+      VERIFY(!hasRun, caseLabel);
+   }
+   {
+      const std::string caseLabel = "ThreadPool::run rethrows exception of task";
+
+      ThreadPool pool{2};
+      std::atomic<std::size_t> numRun = 0;
+      try
+      {
+         pool.run(10,
+                  [&numRun](std::size_t taskIdx)
+                  {
+                     ++numRun;
+                     if (taskIdx == 3)
+                        throw std::runtime_error("Task failed.");
+                  });
+         FAIL("Exception expected.", caseLabel);
+      }
+      catch (std::runtime_error&)
+      {
+         // All tasks are finished even if one fails.
+         VERIFY(numRun == 10, caseLabel);
+      }
+      catch (...)
+      {
+         FAIL("Other exception type expected.", caseLabel);
+      }
+   }
+}
+
+} // namespace
+
+
+///////////////////
+
+void testThreadPool()
+{
+   testThreadPoolSize();
+   testThreadPoolRun();
+}
@@ -0,0 +1,129 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "zobrist_tests.h"
+#include "position.h"
+#include "test_util.h"
+#include "zobrist.h"
+#include <set>
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+void testZobristKeys()
+{
+   {
+      const std::string caseLabel = "Zobrist keys are unique";
+
+      std::set<uint64_t> keys;
+      for (uint64_t key : zobrist::Keys.pieceSquare)
+         keys.insert(key);
+      for (uint64_t key : zobrist::Keys.castling)
+         keys.insert(key);
+      for (uint64_t key : zobrist::Keys.enPassantFile)
+         keys.insert(key);
+      keys.insert(zobrist::Keys.blackToMove);
+
+      VERIFY(keys.size() == zobrist::NumPieces * zobrist::NumSquares +
+                               zobrist::NumCastlingFlags + zobrist::NumFiles + 1,
+             caseLabel);
+      VERIFY(keys.count(0) == 0, caseLabel);
+   }
+}
+
+
+void testZobristHash()
+{
+   {
+      const std::string caseLabel = "zobristHash for same positions";
+
+      VERIFY(zobristHash(StartPos, White) == zobristHash(Position{StartPos}, White),
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "zobristHash depends on side to move";
+
+      VERIFY(zobristHash(StartPos, White) != zobristHash(StartPos, Black), caseLabel);
+   }
+   {
+      const std::string caseLabel = "zobristHash depends on placements";
+
+      VERIFY(zobristHash(Position{"Kwe1 Kbe8 wd2"}, White) !=
+                zobristHash(Position{"Kwe1 Kbe8 wd3"}, White),
+             caseLabel);
+      VERIFY(zobristHash(Position{"Kwe1 Kbe8 wd2"}, White) !=
+                zobristHash(Position{"Kwe1 Kbe8 bd2"}, White),
+             caseLabel);
+   }
+   {
+      const std::string caseLabel = "zobristHash for transposed move orders";
+
+      Position a = StartPos;
+      a.makeMove(PackedMove{b1, c3});
+      a.makeMove(PackedMove{g8, f6});
+      a.makeMove(PackedMove{g1, f3});
+
+      Position b = StartPos;
+      b.makeMove(PackedMove{g1, f3});
+      b.makeMove(PackedMove{g8, f6});
+      b.makeMove(PackedMove{b1, c3});
+
+      VERIFY(zobristHash(a, Black) == zobristHash(b, Black), caseLabel);
+   }
+   {
+      const std::string caseLabel = "zobristHash depends on en-passant square";
+
+      Position a{"Kwe1 Kbe8 we2 bd4"};
+      a.makeMove(PackedMove{e2, e4, PackedMove::Flag::DoublePawnPush});
+      const Position b{"Kwe1 Kbe8 we4 bd4"};
+
+      VERIFY(zobristHash(a, Black) != zobristHash(b, Black), caseLabel);
+   }
+   {
+      const std::string caseLabel =
+         "zobristHash ignores en-passant square that cannot be used";
+
+      Position a{"Kwe1 Kbe8 we2 bc4"};
+      a.makeMove(PackedMove{e2, e4, PackedMove::Flag::DoublePawnPush});
+      const Position b{"Kwe1 Kbe8 we4 bc4"};
+
+      VERIFY(zobristHash(a, Black) == zobristHash(b, Black), caseLabel);
+   }
+   {
+      const std::string caseLabel = "zobristHash depends on castling state";
+
+      Position a{"Kwe1 Rwh1 Kbe8"};
+      a.makeMove(PackedMove{h1, h2});
+      a.makeMove(PackedMove{h2, h1});
+      const Position b{"Kwe1 Rwh1 Kbe8"};
+
+      VERIFY(zobristHash(a, White) != zobristHash(b, White), caseLabel);
+   }
+   {
+      const std::string caseLabel = "zobristHash is restored after unmaking move";
+
+      Position pos = StartPos;
+      const uint64_t hash = zobristHash(pos, White);
+      const PackedMove m{e2, e4, PackedMove::Flag::DoublePawnPush};
+      const auto undo = pos.makeMove(m);
+      VERIFY(zobristHash(pos, Black) != hash, caseLabel);
+      pos.unmakeMove(m, undo);
+      VERIFY(zobristHash(pos, White) == hash, caseLabel);
+   }
+}
+
+} // namespace
+
+
+///////////////////
+
+void testZobrist()
+{
+   testZobristKeys();
+   testZobristHash();
+}
@@ -0,0 +1,149 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "thread_pool.h"
+#include <algorithm>
+
+
+namespace matt2
+{
+///////////////////
+
+#ifdef HAVE_THREADS
+
+ThreadPool::ThreadPool(std::size_t numThreads)
+{
+   if (numThreads == 0)
+      numThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+   m_workers.reserve(numThreads);
+   for (std::size_t i = 0; i < numThreads; ++i)
+      m_workers.emplace_back([this]() { work(); });
+}
+
+
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard lock{m_mutex};
+      m_stop = true;
+   }
+   m_batchStarted.notify_all();
+
+   for (auto& worker : m_workers)
+      worker.join();
+}
+
+
+std::size_t ThreadPool::size() const
+{
+   return m_workers.size();
+}
+
+
+void ThreadPool::run(std::size_t numTasks, const Task& task)
+{
+   if (numTasks == 0)
+      return;
+
+   std::unique_lock lock{m_mutex};
+   m_task = &task;
+   m_numTasks = numTasks;
+   m_nextTask = 0;
+   m_numFinished = 0;
+   m_error = nullptr;
+   ++m_batch;
+   m_batchStarted.notify_all();
+
+   m_batchFinished.wait(lock, [this]() { return m_numFinished == m_numTasks; });
+   m_task = nullptr;
+
+   if (m_error)
+      std::rethrow_exception(m_error);
+}
+
+
+void ThreadPool::work()
+{
+   uint64_t lastBatch = 0;
+
+   std::unique_lock lock{m_mutex};
+   while (true)
+   {
+      m_batchStarted.wait(lock,
+                          [this, lastBatch]() { return m_stop || m_batch != lastBatch; });
+      if (m_stop)
+         return;
+
+      lastBatch = m_batch;
+      runTasks(lock);
+   }
+}
+
+
+void ThreadPool::runTasks(std::unique_lock<std::mutex>& lock)
+{
+   while (m_task && m_nextTask < m_numTasks)
+   {
+      const std::size_t taskIdx = m_nextTask++;
+      const Task& task = *m_task;
+
+      lock.unlock();
+      std::exception_ptr error;
+      try
+      {
+         task(taskIdx);
+      }
+      catch (...)
+      {
+         error = std::current_exception();
+      }
+      lock.lock();
+
+      if (error && !m_error)
+         m_error = error;
+      if (++m_numFinished == m_numTasks)
+         m_batchFinished.notify_all();
+   }
+}
+
+#else
+
+ThreadPool::ThreadPool(std::size_t /*numThreads*/)
+{
+}
+
+
+ThreadPool::~ThreadPool() = default;
+
+
+std::size_t ThreadPool::size() const
+{
+   return 1;
+}
+
+
+void ThreadPool::run(std::size_t numTasks, const Task& task)
+{
+   std::exception_ptr error;
+   for (std::size_t i = 0; i < numTasks; ++i)
+   {
+      try
+      {
+         task(i);
+      }
+      catch (...)
+      {
+         if (!error)
+            error = std::current_exception();
+      }
+   }
+
+   if (error)
+      std::rethrow_exception(error);
+}
+
+#endif // HAVE_THREADS
+
+} // namespace matt2
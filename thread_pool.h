@@ -0,0 +1,78 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "build_env.h"
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+#ifdef HAVE_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+
+namespace matt2
+{
+///////////////////
+
+// Fixed set of worker threads that process batches of tasks.
+// Without thread support all tasks run on the calling thread.
+class ThreadPool
+{
+ public:
+   using Task = std::function<void(std::size_t taskIdx)>;
+
+ public:
+   // Zero threads uses the number of hardware threads.
+   explicit ThreadPool(std::size_t numThreads = 0);
+   ~ThreadPool();
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   std::size_t size() const;
+   // Runs a task for each index in [0, numTasks) and waits until all of them are
+   // finished. Tasks are started in index order but can finish in any order. The first
+   // exception thrown by a task is rethrown after all tasks are finished.
+   void run(std::size_t numTasks, const Task& task);
+
+ private:
+#ifdef HAVE_THREADS
+   void work();
+   // Runs tasks of the current batch until none are left. Expects the lock to be held
+   // and holds it again when returning.
+   void runTasks(std::unique_lock<std::mutex>& lock);
+#endif
+
+ private:
+#ifdef HAVE_THREADS
+   std::vector<std::thread> m_workers;
+   std::mutex m_mutex;
+   std::condition_variable m_batchStarted;
+   std::condition_variable m_batchFinished;
+   bool m_stop = false;
+   // Increases for each batch, so that workers can tell batches apart.
+   uint64_t m_batch = 0;
+   const Task* m_task = nullptr;
+   std::size_t m_numTasks = 0;
+   std::size_t m_nextTask = 0;
+   std::size_t m_numFinished = 0;
+   std::exception_ptr m_error;
+#endif
+};
+
+
+// Returns the range of a task when splitting a given range evenly into tasks.
+inline std::pair<std::size_t, std::size_t>
+taskRange(std::size_t first, std::size_t last, std::size_t taskIdx, std::size_t numTasks)
+{
+   const std::size_t size = last - first;
+   return {first + size * taskIdx / numTasks, first + size * (taskIdx + 1) / numTasks};
+}
+
+} // namespace matt2
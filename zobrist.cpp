@@ -0,0 +1,74 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#include "zobrist.h"
+#include "bitboard.h"
+#include "position.h"
+
+using namespace matt2;
+
+
+namespace
+{
+///////////////////
+
+// Checks whether a pawn of the side to move is next to the pawn that can be taken
+// en-passant. Positions that only differ in an en-passant square that cannot be used
+// are the same, so the square should only affect the hash if it can be used.
+bool canTakeEnPassant(const Position& pos, Square epSquare, Color sideToMove)
+{
+   const Bitboard pawns = pos.occupied(pawn(sideToMove));
+   for (int df : {-1, 1})
+   {
+      const Offset off{df, 0};
+      if (isOnBoard(epSquare, off) && contains(pawns, epSquare + off))
+         return true;
+   }
+   return false;
+}
+
+} // namespace
+
+
+namespace matt2
+{
+///////////////////
+
+uint64_t zobristHash(const Position& pos, Color sideToMove)
+{
+   uint64_t hash = 0;
+
+   Bitboard occupied = pos.occupied();
+   while (occupied != EmptyBB)
+   {
+      const Square sq = popLowestSquare(occupied);
+      hash ^= zobrist::pieceKey(*pos[sq], sq);
+   }
+
+   std::size_t flagIdx = 0;
+   for (Color side : {White, Black})
+   {
+      const bool flags[] = {pos.hasKingMoved(side), pos.hasRookMoved(side, true),
+                            pos.hasRookMoved(side, false), pos.hasCastled(side)};
+      for (bool isSet : flags)
+      {
+         if (isSet)
+            hash ^= zobrist::Keys.castling[flagIdx];
+         ++flagIdx;
+      }
+   }
+
+   if (const auto epSquare = pos.enPassantSquare();
+       epSquare.has_value() && canTakeEnPassant(pos, *epSquare, sideToMove))
+   {
+      hash ^= zobrist::Keys.enPassantFile[static_cast<std::size_t>(file(*epSquare))];
+   }
+
+   if (sideToMove == Black)
+      hash ^= zobrist::Keys.blackToMove;
+
+   return hash;
+}
+
+} // namespace matt2
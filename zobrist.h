@@ -0,0 +1,84 @@
+//
+// Oct-2026, Michael Lindner
+// MIT license
+//
+#pragma once
+#include "piece.h"
+#include "square.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace matt2
+{
+class Position;
+}
+
+
+namespace matt2
+{
+///////////////////
+
+// Random keys for Zobrist hashing of positions. The hash of a position is the xor of
+// the keys of all its properties. Keys are generated at compile time with a fixed seed,
+// so hashes are the same across runs and platforms.
+namespace zobrist
+{
+
+constexpr std::size_t NumPieces = 12;
+constexpr std::size_t NumSquares = 64;
+// One key per castling flag, i.e. king moved, king-side rook moved, queen-side rook
+// moved and castled for each color.
+constexpr std::size_t NumCastlingFlags = 8;
+constexpr std::size_t NumFiles = 8;
+
+// SplitMix64 generator.
+constexpr uint64_t nextRandom(uint64_t& state)
+{
+   state += 0x9e3779b97f4a7c15ull;
+   uint64_t z = state;
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+   return z ^ (z >> 31);
+}
+
+struct KeyTable
+{
+   std::array<uint64_t, NumPieces * NumSquares> pieceSquare{};
+   std::array<uint64_t, NumCastlingFlags> castling{};
+   std::array<uint64_t, NumFiles> enPassantFile{};
+   uint64_t blackToMove = 0;
+};
+
+constexpr KeyTable makeKeys()
+{
+   uint64_t state = 0x6d61747432ull;
+   KeyTable keys;
+   for (auto& key : keys.pieceSquare)
+      key = nextRandom(state);
+   for (auto& key : keys.castling)
+      key = nextRandom(state);
+   for (auto& key : keys.enPassantFile)
+      key = nextRandom(state);
+   keys.blackToMove = nextRandom(state);
+   return keys;
+}
+
+inline constexpr KeyTable Keys = makeKeys();
+
+constexpr uint64_t pieceKey(Piece piece, Square sq)
+{
+   return Keys.pieceSquare[static_cast<std::size_t>(piece) * NumSquares +
+                           static_cast<std::size_t>(sq)];
+}
+
+} // namespace zobrist
+
+///////////////////
+
+// Calculates the Zobrist hash of a position for a given side to move. Takes the
+// placements, castling state and en-passant square into account. The en-passant square
+// only counts if a pawn of the side to move is in place to use it.
+uint64_t zobristHash(const Position& pos, Color sideToMove);
+
+} // namespace matt2